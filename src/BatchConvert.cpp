@@ -0,0 +1,303 @@
+//-----------------------------------------------------------------------------
+// BatchConvert.cpp
+// Created at 2026.10.17 21:30
+// License: see LICENSE file
+//
+// batch mode (--batch): conversion of many input/output pairs from a manifest
+// in one process, largest input files first, summary of per-file timings
+//-----------------------------------------------------------------------------
+#include "BatchConvert.h"
+
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <thread>
+
+#include "Trace.h"
+
+namespace name_fs = std::experimental::filesystem;
+
+namespace
+{
+    const double Megabyte = 1024.0 * 1024.0;
+    const size_t SlowestFileCount = 5;
+
+    bool addJob(const name_fs::path &baseDirectory, const std::string &input, const std::string &output,
+                std::vector<BatchJob> &jobs)
+    {
+        if (input.empty() || output.empty())
+        {
+            return false;
+        }
+        BatchJob job;
+        name_fs::path inputPath(input);
+        name_fs::path outputPath(output);
+        job.inputPath = (inputPath.is_relative() ? baseDirectory / inputPath : inputPath).u8string();
+        job.outputPath = (outputPath.is_relative() ? baseDirectory / outputPath : outputPath).u8string();
+        std::error_code errorCode;
+        job.inputSize = name_fs::file_size(job.inputPath, errorCode);
+        if (errorCode)
+        {
+            job.inputSize = 0; // conversion reports the error
+        }
+        jobs.push_back(job);
+        return true;
+    }
+
+    bool readJsonManifest(const std::string &contents, const name_fs::path &baseDirectory, std::vector<BatchJob> &jobs)
+    {
+        Json::CharReaderBuilder jsonBuilder;
+        Json::Value jsonRoot;
+        std::string errors;
+        std::istringstream isContents(contents);
+        if (!Json::parseFromStream(jsonBuilder, isContents, &jsonRoot, &errors))
+        {
+            std::cout << "Batch manifest is not valid JSON: " << errors << std::endl;
+            return false;
+        }
+        const Json::Value &jFiles = jsonRoot.isObject() ? jsonRoot["files"] : jsonRoot;
+        if (!jFiles.isArray())
+        {
+            std::cout << "Batch manifest must be an array of {\"input\", \"output\"} objects" << std::endl;
+            return false;
+        }
+        for (Json::ArrayIndex fileIndex = 0; fileIndex < jFiles.size(); ++fileIndex)
+        {
+            const Json::Value &jFile = jFiles[fileIndex];
+            if (!jFile.isObject() || !jFile["input"].isString() || !jFile["output"].isString() ||
+                !addJob(baseDirectory, jFile["input"].asString(), jFile["output"].asString(), jobs))
+            {
+                std::cout << "Batch manifest entry " << fileIndex << " must have input and output strings" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool readListManifest(const std::string &contents, const name_fs::path &baseDirectory, std::vector<BatchJob> &jobs)
+    {
+        std::istringstream isContents(contents);
+        std::string line;
+        for (uint32_t lineNumber = 1; std::getline(isContents, line); ++lineNumber)
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+            size_t first = line.find_first_not_of(" \t");
+            if (first == std::string::npos || line[first] == '#')
+            {
+                continue;
+            }
+            std::string input;
+            std::string output;
+            std::string extra;
+            size_t tab = line.find('\t', first);
+            if (tab != std::string::npos)
+            {
+                // tab separated fields can have spaces
+                input = line.substr(first, tab - first);
+                output = line.substr(tab + 1);
+                extra = output.find('\t') != std::string::npos ? output : std::string();
+            }
+            else
+            {
+                std::istringstream isFields(line);
+                isFields >> input >> output >> extra;
+            }
+            if (!extra.empty() || !addJob(baseDirectory, input, output, jobs))
+            {
+                std::cout << "Batch manifest line " << lineNumber << " must have input and output paths" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+bool readBatchManifest(const std::string &manifestPath, std::vector<BatchJob> &jobs)
+{
+    std::ifstream ifManifest(manifestPath, std::ios::in | std::ios::binary);
+    if (!ifManifest.is_open())
+    {
+        std::cout << "Failed to open batch manifest " << manifestPath << std::endl;
+        return false;
+    }
+    std::string contents((std::istreambuf_iterator<char>(ifManifest)), std::istreambuf_iterator<char>());
+    name_fs::path baseDirectory = name_fs::path(manifestPath).parent_path();
+    size_t first = contents.find_first_not_of(" \t\r\n");
+    bool isJson = first != std::string::npos && (contents[first] == '[' || contents[first] == '{');
+    if (!(isJson ? readJsonManifest(contents, baseDirectory, jobs) : readListManifest(contents, baseDirectory, jobs)))
+    {
+        return false;
+    }
+    if (jobs.empty())
+    {
+        std::cout << "Batch manifest " << manifestPath << " has no files" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::vector<BatchFileResult> runBatch(const std::vector<BatchJob> &jobs, uint32_t jobCount,
+                                      const BatchConverter &converter)
+{
+    std::vector<BatchFileResult> results(jobs.size());
+    std::vector<size_t> order(jobs.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&jobs](size_t left, size_t right)
+    {
+        return jobs[left].inputSize > jobs[right].inputSize;
+    });
+    std::atomic<size_t> nextOrderIndex(0);
+    auto batchStart = std::chrono::steady_clock::now();
+    auto worker = [&](uint32_t workerIndex)
+    {
+        setTraceThreadName("batch " + std::to_string(workerIndex));
+        for (size_t orderIndex = nextOrderIndex++; orderIndex < order.size(); orderIndex = nextOrderIndex++)
+        {
+            const BatchJob &job = jobs[order[orderIndex]];
+            auto fileStart = std::chrono::steady_clock::now();
+            BatchFileResult result;
+            {
+                TraceZone fileZone("batchFile");
+                fileZone.arg("inputBytes", static_cast<int64_t>(job.inputSize));
+                // one failed file must not stop the batch
+                try
+                {
+                    result = converter(job);
+                }
+                catch (const std::exception &exception)
+                {
+                    result = BatchFileResult();
+                    result.error = exception.what();
+                }
+                catch (...)
+                {
+                    result = BatchFileResult();
+                    result.error = "unknown exception";
+                }
+            }
+            auto fileEnd = std::chrono::steady_clock::now();
+            result.inputPath = job.inputPath;
+            result.outputPath = job.outputPath;
+            result.inputSize = job.inputSize;
+            result.startSeconds = std::chrono::duration<double>(fileStart - batchStart).count();
+            result.seconds = std::chrono::duration<double>(fileEnd - fileStart).count();
+            if (!result.success && result.error.empty())
+            {
+                result.error = "conversion failed";
+            }
+            results[order[orderIndex]] = std::move(result);
+        }
+    };
+    jobCount = std::max(1u, std::min(jobCount, static_cast<uint32_t>(jobs.size())));
+    std::vector<std::thread> threads;
+    for (uint32_t workerIndex = 0; workerIndex < jobCount; ++workerIndex)
+    {
+        threads.push_back(std::thread(worker, workerIndex));
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    return results;
+}
+
+void printBatchSummary(const std::vector<BatchFileResult> &results, double wallSeconds)
+{
+    uint32_t failedCount = 0;
+    uint32_t cacheHitCount = 0;
+    uint64_t inputBytes = 0;
+    for (const auto &result : results)
+    {
+        failedCount += result.success ? 0 : 1;
+        cacheHitCount += result.cacheHit ? 1 : 0;
+        inputBytes += result.inputSize;
+    }
+    std::cout << "Batch: " << results.size() << " files, " << results.size() - failedCount << " converted ("
+              << cacheHitCount << " from cache), " << failedCount << " failed; "
+              << std::fixed << std::setprecision(1) << inputBytes / Megabyte << " MB input in "
+              << std::setprecision(3) << wallSeconds << " s, " << std::setprecision(1)
+              << (wallSeconds > 0.0 ? inputBytes / Megabyte / wallSeconds : 0.0) << " MB/s" << std::endl;
+
+    std::vector<const BatchFileResult*> slowest;
+    for (const auto &result : results)
+    {
+        slowest.push_back(&result);
+    }
+    size_t slowestCount = std::min(SlowestFileCount, slowest.size());
+    std::partial_sort(slowest.begin(), slowest.begin() + slowestCount, slowest.end(),
+                      [](const BatchFileResult *left, const BatchFileResult *right)
+    {
+        return left->seconds > right->seconds;
+    });
+    std::cout << "Slowest files:" << std::endl;
+    for (size_t resultIndex = 0; resultIndex < slowestCount; ++resultIndex)
+    {
+        const auto &result = *slowest[resultIndex];
+        std::cout << "    " << std::setprecision(3) << std::setw(9) << result.seconds << " s, started at "
+                  << std::setw(9) << result.startSeconds << " s, " << std::setprecision(1) << std::setw(8)
+                  << result.inputSize / Megabyte << " MB  " << result.inputPath << std::endl;
+    }
+    if (failedCount > 0)
+    {
+        std::cout << "Failed files:" << std::endl;
+        for (const auto &result : results)
+        {
+            if (!result.success)
+            {
+                std::cout << "    " << result.inputPath << ": " << result.error << std::endl;
+            }
+        }
+    }
+}
+
+bool exportBatchSummaryToFile(const std::string &fileName, const std::vector<BatchFileResult> &results,
+                              double wallSeconds)
+{
+    Json::Value jsonRoot;
+    Json::Value jFileArray(Json::arrayValue);
+    uint32_t failedCount = 0;
+    uint32_t cacheHitCount = 0;
+    uint64_t inputBytes = 0;
+    for (const auto &result : results)
+    {
+        Json::Value jFile;
+        jFile["input"] = result.inputPath;
+        jFile["output"] = result.outputPath;
+        jFile["inputBytes"] = Json::UInt64(result.inputSize);
+        jFile["success"] = result.success;
+        if (!result.success)
+        {
+            jFile["error"] = result.error;
+        }
+        jFile["cacheHit"] = result.cacheHit;
+        jFile["startSeconds"] = result.startSeconds;
+        jFile["seconds"] = result.seconds;
+        jFile["meshes"] = Json::UInt64(result.meshCount);
+        jFile["triangles"] = Json::UInt64(result.triangleCount);
+        jFile["vertices"] = Json::UInt64(result.vertexCount);
+        jFileArray.append(jFile);
+        failedCount += result.success ? 0 : 1;
+        cacheHitCount += result.cacheHit ? 1 : 0;
+        inputBytes += result.inputSize;
+    }
+    jsonRoot["wallSeconds"] = wallSeconds;
+    jsonRoot["fileCount"] = Json::UInt64(results.size());
+    jsonRoot["failedCount"] = failedCount;
+    jsonRoot["cacheHitCount"] = cacheHitCount;
+    jsonRoot["inputBytes"] = Json::UInt64(inputBytes);
+    jsonRoot["files"] = jFileArray;
+
+    std::ofstream ofSummary(fileName, std::ios::out | std::ios::trunc);
+    if (!ofSummary.is_open())
+    {
+        return false;
+    }
+    Json::StreamWriterBuilder jsonBuilder;
+    std::unique_ptr<Json::StreamWriter> writer(jsonBuilder.newStreamWriter());
+    writer->write(jsonRoot, &ofSummary);
+    ofSummary << std::endl;
+    return ofSummary.good();
+}
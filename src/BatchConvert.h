@@ -0,0 +1,54 @@
+//-----------------------------------------------------------------------------
+// BatchConvert.h
+// Created at 2026.10.17 21:30
+// License: see LICENSE file
+//
+// batch mode (--batch): conversion of many input/output pairs from a manifest
+// in one process, largest input files first, summary of per-file timings
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+
+#include <functional>
+
+struct BatchJob
+{
+    std::string inputPath;
+    std::string outputPath;
+    uint64_t inputSize = 0; // bytes, 0 when the file can't be found
+};
+
+struct BatchFileResult
+{
+    std::string inputPath;
+    std::string outputPath;
+    uint64_t inputSize = 0;
+    bool success = false;
+    bool cacheHit = false;
+    std::string error;
+    double startSeconds = 0.0; // since batch start
+    double seconds = 0.0;
+    uint64_t meshCount = 0;
+    uint64_t triangleCount = 0;
+    uint64_t vertexCount = 0;
+};
+
+// manifest is a JSON array of {"input": ..., "output": ...} objects (or such
+// array in "files" member of the root object), or a text file with one
+// "input output" pair per line: fields are separated by a tab, or by spaces
+// when the line has no tab; empty lines and lines starting with # are skipped.
+// Relative paths are relative to the manifest directory
+bool readBatchManifest(const std::string &manifestPath, std::vector<BatchJob> &jobs);
+
+// converts one file, called on batch threads at the same time
+using BatchConverter = std::function<BatchFileResult(const BatchJob &job)>;
+
+// runs converter on jobCount threads, largest input files first so that big
+// files don't finish last. Returns results in manifest order
+std::vector<BatchFileResult> runBatch(const std::vector<BatchJob> &jobs, uint32_t jobCount,
+                                      const BatchConverter &converter);
+
+// totals, slowest files and all failures
+void printBatchSummary(const std::vector<BatchFileResult> &results, double wallSeconds);
+bool exportBatchSummaryToFile(const std::string &fileName, const std::vector<BatchFileResult> &results,
+                              double wallSeconds);
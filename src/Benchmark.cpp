@@ -0,0 +1,2021 @@
+//-----------------------------------------------------------------------------
+// Benchmark.cpp
+// Created at 2026.10.17 10:40
+// License: see LICENSE file
+//
+// built-in benchmarks of mesh processing steps on synthetic data
+//-----------------------------------------------------------------------------
+#include "Benchmark.h"
+
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <random>
+
+#include "Common.h"
+#include "ConversionServer.h"
+#include "ConvertMesh.h"
+#include "ExportMesh.h"
+#include "ImportFBXNative.h"
+#include "IndexSet.h"
+#include "MeshGenerators.h"
+#include "MeshInstancing.h"
+#include "MeshReader.h"
+#include "Meshlet.h"
+#include "Overdraw.h"
+#include "PhaseStats.h"
+#include "RawMesh.h"
+#include "StreamCompression.h"
+#include "ThreadPool.h"
+#include "Utils.h"
+#include "VertexCache.h"
+#include "VertexEncoding.h"
+#include "VertexLayout.h"
+#include "VertexPacking.h"
+#include "VertexWeld.h"
+
+namespace name_fs = std::experimental::filesystem;
+
+namespace
+{
+    using BenchmarkClock = std::chrono::steady_clock;
+
+    inline double millisecondsSince(BenchmarkClock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(BenchmarkClock::now() - start).count();
+    }
+
+    // corner counts used when benchmark is started without arguments
+    std::vector<uint64_t> getCornerCounts(const std::vector<std::string> &args)
+    {
+        std::vector<uint64_t> cornerCounts;
+        for (const auto &arg : args)
+        {
+            cornerCounts.push_back(std::stoull(arg));
+        }
+        if (cornerCounts.empty())
+        {
+            cornerCounts = { 100000, 1000000, 5000000 };
+        }
+        return cornerCounts;
+    }
+
+    // triangulated quad grid with ~cornerCount triangle corners.
+    // smooth grid shares normal/uv between all corners of a control point,
+    // hard edge grid has separate normal for each quad (like CAD meshes)
+    std::vector<IndexSet> generateGridCorners(uint64_t cornerCount, bool hardEdges)
+    {
+        uint32_t quadsX = std::max<uint32_t>(1, static_cast<uint32_t>(std::sqrt(cornerCount / 6.0)));
+        uint32_t quadsY = std::max<uint32_t>(1, static_cast<uint32_t>(cornerCount / 6 / quadsX));
+        std::vector<IndexSet> corners;
+        corners.reserve(size_t(quadsX) * quadsY * 6);
+        for (uint32_t y = 0; y < quadsY; ++y)
+        {
+            for (uint32_t x = 0; x < quadsX; ++x)
+            {
+                uint32_t quadIndex = y * quadsX + x;
+                uint32_t quadPoints[4] = {
+                    y * (quadsX + 1) + x,
+                    y * (quadsX + 1) + x + 1,
+                    (y + 1) * (quadsX + 1) + x + 1,
+                    (y + 1) * (quadsX + 1) + x
+                };
+                const uint32_t triangleCorners[6] = { 0, 1, 2, 0, 2, 3 };
+                for (auto corner : triangleCorners)
+                {
+                    IndexSet indexSet;
+                    indexSet.controlPoint = quadPoints[corner];
+                    indexSet.normal = hardEdges ? quadIndex : quadPoints[corner];
+                    indexSet.uv = quadPoints[corner];
+                    corners.push_back(indexSet);
+                }
+            }
+        }
+        return corners;
+    }
+
+    struct BenchmarkVector4
+    {
+        double mData[4];
+    };
+
+    // triangle corners of quad grid with separate normal for every corner
+    // (like eByPolygonVertex normals in FBX). Normals are tilted from +Z by
+    // up to maxTiltDegrees, creaseStep > 0 rotates normals of every creaseStep-th
+    // quad column by 90 degrees to get hard edges
+    std::vector<IndexSet> generateNormalGridCorners(uint64_t cornerCount, double maxTiltDegrees, uint32_t creaseStep,
+                                                    std::vector<BenchmarkVector4> &normals)
+    {
+        auto corners = generateGridCorners(cornerCount, false);
+        uint32_t quadsX = std::max<uint32_t>(1, static_cast<uint32_t>(std::sqrt(cornerCount / 6.0)));
+        normals.resize(corners.size());
+        uint32_t randomState = 12345;
+        for (uint32_t cornerIndex = 0; cornerIndex < corners.size(); ++cornerIndex)
+        {
+            randomState = randomState * 1664525u + 1013904223u;
+            double tilt = (randomState >> 8) / double(1 << 24) * maxTiltDegrees * Pi / 180.0;
+            randomState = randomState * 1664525u + 1013904223u;
+            double direction = (randomState >> 8) / double(1 << 24) * 2.0 * Pi;
+            BenchmarkVector4 normal = { { std::sin(tilt) * std::cos(direction), std::sin(tilt) * std::sin(direction), std::cos(tilt), 0.0 } };
+            uint32_t quadColumn = (cornerIndex / 6) % quadsX;
+            if (creaseStep > 0 && (quadColumn / creaseStep) % 2 == 1)
+            {
+                std::swap(normal.mData[0], normal.mData[2]);
+            }
+            normals[cornerIndex] = normal;
+            corners[cornerIndex].normal = cornerIndex;
+        }
+        return corners;
+    }
+
+    // copy of the original std::map based normal merge, O(V * I).
+    // Used as reference to compare results on small meshes
+    void mergeVertexNormalsReference(std::vector<IndexSet> &uniqueVertices,
+                                     std::vector<uint32_t> &indexVector,
+                                     std::vector<BenchmarkVector4> &normals,
+                                     double cosThreshold)
+    {
+        auto dot = [](const BenchmarkVector4 &left, const BenchmarkVector4 &right)
+        {
+            return left.mData[0] * right.mData[0] + left.mData[1] * right.mData[1] + left.mData[2] * right.mData[2];
+        };
+        std::map<IndexSet, uint32_t> orderedVertices;
+        for (uint32_t vertexIndex = 0; vertexIndex < uniqueVertices.size(); ++vertexIndex)
+        {
+            orderedVertices.insert(std::make_pair(uniqueVertices[vertexIndex], vertexIndex));
+        }
+        OrderedIndexMap<uint32_t, uint32_t> orderedIndexMap;
+        for (uint32_t position = 0; position < indexVector.size(); ++position)
+        {
+            orderedIndexMap.add(indexVector[position], position);
+        }
+        int currentControlPoint = -1;
+        int currentUV = -1;
+        BenchmarkVector4 currentNormalValue = { { 0.0, 0.0, 0.0, 0.0 } };
+        std::vector<uint32_t> verticesToMerge;
+        std::map<uint32_t, std::vector<uint32_t>> normalVerticesToMerge;
+        for (const auto &orderedVertexPair : orderedVertices)
+        {
+            const auto &vertexNormal = normals[orderedVertexPair.first.normal];
+            if (currentControlPoint == -1 || currentControlPoint != int(orderedVertexPair.first.controlPoint))
+            {
+                if (verticesToMerge.size() > 1)
+                {
+                    normalVerticesToMerge.insert(std::make_pair(currentControlPoint, verticesToMerge));
+                }
+                currentControlPoint = orderedVertexPair.first.controlPoint;
+                currentUV = orderedVertexPair.first.uv;
+                currentNormalValue = vertexNormal;
+                verticesToMerge.clear();
+                verticesToMerge.push_back(orderedVertexPair.second);
+            }
+            else if (currentUV == int(orderedVertexPair.first.uv))
+            {
+                if (dot(currentNormalValue, vertexNormal) > cosThreshold)
+                {
+                    verticesToMerge.push_back(orderedVertexPair.second);
+                }
+            }
+            else
+            {
+                currentUV = orderedVertexPair.first.uv;
+                if (verticesToMerge.size() > 1)
+                {
+                    normalVerticesToMerge.insert(std::make_pair(currentControlPoint, verticesToMerge));
+                }
+                verticesToMerge.clear();
+            }
+        }
+        if (verticesToMerge.size() > 1)
+        {
+            normalVerticesToMerge.insert(std::make_pair(currentControlPoint, verticesToMerge));
+        }
+        for (const auto &mergePair : normalVerticesToMerge)
+        {
+            std::vector<std::map<IndexSet, uint32_t>::iterator> vertexIterators;
+            double normalSum[4] = { 0.0, 0.0, 0.0, 0.0 };
+            for (const auto vertexIndex : mergePair.second)
+            {
+                auto it = std::find_if(orderedVertices.begin(), orderedVertices.end(),
+                    [vertexIndex](const std::pair<IndexSet, uint32_t> &vertexPair) { return vertexPair.second == vertexIndex; });
+                vertexIterators.push_back(it);
+                for (int component = 0; component < 4; ++component)
+                {
+                    normalSum[component] += normals[it->first.normal].mData[component];
+                }
+            }
+            double length = std::sqrt(normalSum[0] * normalSum[0] + normalSum[1] * normalSum[1] + normalSum[2] * normalSum[2]);
+            auto &mergedNormal = normals[vertexIterators[0]->first.normal].mData;
+            for (int component = 0; component < 3; ++component)
+            {
+                mergedNormal[component] = normalSum[component] / length;
+            }
+            mergedNormal[3] = normalSum[3] / vertexIterators.size();
+            std::replace_if(indexVector.begin(), indexVector.end(), [&vertexIterators](const uint32_t &index)
+            {
+                for (size_t iterIndex = 1; iterIndex < vertexIterators.size(); ++iterIndex)
+                {
+                    if (index == vertexIterators[iterIndex]->second)
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }, vertexIterators[0]->second);
+            uniqueVertices.erase(std::remove_if(uniqueVertices.begin(), uniqueVertices.end(), [&vertexIterators](const IndexSet &vertex)
+            {
+                for (size_t iterIndex = 1; iterIndex < vertexIterators.size(); ++iterIndex)
+                {
+                    if (vertex == vertexIterators[iterIndex]->first)
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }), uniqueVertices.end());
+            orderedIndexMap.merge(mergePair.second);
+        }
+        if (!normalVerticesToMerge.empty())
+        {
+            indexVector = orderedIndexMap.createVector();
+        }
+    }
+
+    int benchmarkMerge(const std::vector<std::string> &args)
+    {
+        const uint64_t maxReferenceCornerCount = 60000;
+        const double thresholdAngle = 45.0;
+        const double cosThreshold = std::cos(thresholdAngle * Pi / 180.0);
+        std::vector<std::string> cornerArgs = args;
+        if (cornerArgs.empty())
+        {
+            cornerArgs = { "30000", "300000", "3000000" };
+        }
+        std::cout << "mesh            corners   vertices     merged  reference, ms   grouped, ms  ns/corner" << std::endl;
+        for (auto cornerCount : getCornerCounts(cornerArgs))
+        {
+            for (uint32_t creaseStep = 0; creaseStep < 5; creaseStep += 4)
+            {
+                std::vector<BenchmarkVector4> normals;
+                auto corners = generateNormalGridCorners(cornerCount, thresholdAngle / 2.0, creaseStep, normals);
+                std::vector<uint32_t> indices;
+                std::vector<IndexSet> vertices;
+                weldVertices(corners, VertexWeldMethod::HashTable, indices, vertices);
+                size_t weldedVertexCount = vertices.size();
+
+                double referenceTime = -1.0;
+                std::vector<uint32_t> referenceIndices = indices;
+                std::vector<IndexSet> referenceVertices = vertices;
+                std::vector<BenchmarkVector4> referenceNormals = normals;
+                bool compareWithReference = cornerCount <= maxReferenceCornerCount && creaseStep == 0;
+                if (compareWithReference)
+                {
+                    auto start = BenchmarkClock::now();
+                    mergeVertexNormalsReference(referenceVertices, referenceIndices, referenceNormals, cosThreshold);
+                    referenceTime = millisecondsSince(start);
+                }
+
+                auto start = BenchmarkClock::now();
+                mergeVertexNormals(vertices, indices, normals, cosThreshold);
+                double mergeTime = millisecondsSince(start);
+
+                if (compareWithReference)
+                {
+                    bool sameNormals = true;
+                    for (const auto &vertex : vertices)
+                    {
+                        for (int component = 0; component < 4; ++component)
+                        {
+                            sameNormals = sameNormals && std::abs(normals[vertex.normal].mData[component] -
+                                referenceNormals[vertex.normal].mData[component]) < 1e-12;
+                        }
+                    }
+                    if (indices != referenceIndices || vertices != referenceVertices || !sameNormals)
+                    {
+                        std::cout << "merge: results of reference and grouped merge differ" << std::endl;
+                        return -1;
+                    }
+                }
+                std::cout << std::left << std::setw(12) << (creaseStep ? "crease grid" : "smooth grid") << std::right
+                          << std::setw(11) << corners.size()
+                          << std::setw(11) << vertices.size()
+                          << std::setw(11) << weldedVertexCount - vertices.size()
+                          << std::fixed << std::setprecision(2);
+                if (referenceTime >= 0.0)
+                {
+                    std::cout << std::setw(15) << referenceTime;
+                }
+                else
+                {
+                    std::cout << std::setw(15) << "-";
+                }
+                std::cout << std::setw(14) << mergeTime
+                          << std::setw(11) << mergeTime * 1e6 / corners.size()
+                          << std::endl;
+            }
+        }
+        return 0;
+    }
+
+    int benchmarkWeld(const std::vector<std::string> &args)
+    {
+        std::cout << "mesh            corners   vertices     map, ms    hash, ms  speedup" << std::endl;
+        for (auto cornerCount : getCornerCounts(args))
+        {
+            for (int hardEdges = 0; hardEdges < 2; ++hardEdges)
+            {
+                auto corners = generateGridCorners(cornerCount, hardEdges != 0);
+
+                std::vector<uint32_t> mapIndices, hashIndices;
+                std::vector<IndexSet> mapVertices, hashVertices;
+                auto start = BenchmarkClock::now();
+                weldVertices(corners, VertexWeldMethod::OrderedMap, mapIndices, mapVertices);
+                double mapTime = millisecondsSince(start);
+                start = BenchmarkClock::now();
+                weldVertices(corners, VertexWeldMethod::HashTable, hashIndices, hashVertices);
+                double hashTime = millisecondsSince(start);
+
+                if (mapIndices != hashIndices || mapVertices != hashVertices)
+                {
+                    std::cout << "weld: results of OrderedMap and HashTable differ" << std::endl;
+                    return -1;
+                }
+                std::cout << std::left << std::setw(12) << (hardEdges ? "hard grid" : "smooth grid") << std::right
+                          << std::setw(11) << corners.size()
+                          << std::setw(11) << hashVertices.size()
+                          << std::fixed << std::setprecision(2)
+                          << std::setw(12) << mapTime
+                          << std::setw(12) << hashTime
+                          << std::setw(8) << (hashTime > 0.0 ? mapTime / hashTime : 0.0) << "x"
+                          << std::endl;
+            }
+        }
+        return 0;
+    }
+
+    // triangles rotated to start from the smallest index and sorted, to compare triangle sets
+    std::vector<std::array<uint32_t, 3>> getSortedTriangles(const std::vector<uint32_t> &indices)
+    {
+        std::vector<std::array<uint32_t, 3>> triangles;
+        for (size_t corner = 0; corner + 2 < indices.size(); corner += 3)
+        {
+            std::array<uint32_t, 3> triangle = { indices[corner], indices[corner + 1], indices[corner + 2] };
+            while (triangle[0] > triangle[1] || triangle[0] > triangle[2])
+            {
+                std::rotate(triangle.begin(), triangle.begin() + 1, triangle.end());
+            }
+            triangles.push_back(triangle);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    int benchmarkVertexCache(const std::vector<std::string> &args)
+    {
+        // overfetch is for 12 byte positions, without and with vertex fetch reordering
+        std::cout << "mesh              triangles  method      ACMR    ATVR        ms   overfetch  fetch opt." << std::endl;
+        for (auto cornerCount : getCornerCounts(args))
+        {
+            std::vector<uint32_t> gridIndices;
+            std::vector<IndexSet> vertices;
+            weldVertices(generateGridCorners(cornerCount, false), VertexWeldMethod::HashTable, gridIndices, vertices);
+            uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+
+            // grid order is close to FBX polygon order, shuffled order is the worst case
+            std::vector<uint32_t> shuffledIndices = gridIndices;
+            std::vector<uint32_t> triangleOrder(shuffledIndices.size() / 3);
+            std::iota(triangleOrder.begin(), triangleOrder.end(), 0);
+            std::shuffle(triangleOrder.begin(), triangleOrder.end(), std::mt19937(12345));
+            for (size_t triangle = 0; triangle < triangleOrder.size(); ++triangle)
+            {
+                std::copy_n(gridIndices.begin() + triangleOrder[triangle] * 3, 3, shuffledIndices.begin() + triangle * 3);
+            }
+            auto referenceTriangles = getSortedTriangles(gridIndices);
+
+            for (int shuffled = 0; shuffled < 2; ++shuffled)
+            {
+                for (auto method : { VertexCacheMethod::None, VertexCacheMethod::Forsyth, VertexCacheMethod::Tipsify })
+                {
+                    std::vector<uint32_t> indices = shuffled ? shuffledIndices : gridIndices;
+                    auto start = BenchmarkClock::now();
+                    optimizeVertexCache(indices, vertexCount, method);
+                    double time = millisecondsSince(start);
+                    if (getSortedTriangles(indices) != referenceTriangles)
+                    {
+                        std::cout << "vcache: triangles changed by reordering" << std::endl;
+                        return -1;
+                    }
+                    const char *methodNames[] = { "none", "forsyth", "tipsify" };
+                    auto stats = analyzeVertexCache(indices, vertexCount);
+                    auto fetchStats = analyzeVertexFetch(indices, vertexCount, 12);
+
+                    // vertex fetch reordering must keep every corner pointing to the same vertex
+                    std::vector<uint32_t> fetchIndices = indices;
+                    std::vector<IndexSet> fetchVertices = vertices;
+                    optimizeVertexFetch(fetchIndices, fetchVertices);
+                    for (size_t corner = 0; corner < indices.size(); ++corner)
+                    {
+                        if (!(fetchVertices[fetchIndices[corner]] == vertices[indices[corner]]))
+                        {
+                            std::cout << "vcache: vertex fetch reordering changed vertices" << std::endl;
+                            return -1;
+                        }
+                    }
+                    auto sortedFetchStats = analyzeVertexFetch(fetchIndices, vertexCount, 12);
+                    std::cout << std::left << std::setw(16) << (shuffled ? "shuffled grid" : "grid") << std::right
+                              << std::setw(11) << stats.triangleCount << "  "
+                              << std::left << std::setw(8) << methodNames[static_cast<int>(method)] << std::right
+                              << std::fixed << std::setprecision(3)
+                              << std::setw(8) << stats.acmr()
+                              << std::setw(8) << stats.atvr()
+                              << std::setprecision(2) << std::setw(10) << time
+                              << std::setw(12) << fetchStats.overfetch()
+                              << std::setw(12) << sortedFetchStats.overfetch() << std::endl;
+                }
+            }
+        }
+        return 0;
+    }
+
+    // torus with segments x rings quads, indices in row order, positions xyz per vertex.
+    // Unlike a sphere, torus faces occlude each other, so it has overdraw
+    void generateTorus(uint32_t segments, uint32_t rings, std::vector<uint32_t> &indices, std::vector<float> &positions)
+    {
+        const double majorRadius = 1.0;
+        const double minorRadius = 0.4;
+        positions.clear();
+        indices.clear();
+        for (uint32_t segment = 0; segment < segments; ++segment)
+        {
+            double u = 2.0 * Pi * segment / segments;
+            for (uint32_t ring = 0; ring < rings; ++ring)
+            {
+                double v = 2.0 * Pi * ring / rings;
+                double radius = majorRadius + minorRadius * std::cos(v);
+                positions.push_back(static_cast<float>(radius * std::cos(u)));
+                positions.push_back(static_cast<float>(radius * std::sin(u)));
+                positions.push_back(static_cast<float>(minorRadius * std::sin(v)));
+            }
+        }
+        for (uint32_t segment = 0; segment < segments; ++segment)
+        {
+            for (uint32_t ring = 0; ring < rings; ++ring)
+            {
+                uint32_t v00 = segment * rings + ring;
+                uint32_t v01 = segment * rings + (ring + 1) % rings;
+                uint32_t v10 = ((segment + 1) % segments) * rings + ring;
+                uint32_t v11 = ((segment + 1) % segments) * rings + (ring + 1) % rings;
+                indices.insert(indices.end(), { v00, v10, v11, v00, v11, v01 });
+            }
+        }
+    }
+
+    int benchmarkOverdraw(const std::vector<std::string> &args)
+    {
+        std::vector<float> thresholds;
+        for (const auto &arg : args)
+        {
+            thresholds.push_back(std::stof(arg));
+        }
+        if (thresholds.empty())
+        {
+            thresholds = { 1.0f, 1.05f, 1.2f, 2.0f, 3.0f };
+        }
+        std::vector<uint32_t> torusIndices;
+        std::vector<float> positions;
+        generateTorus(200, 100, torusIndices, positions);
+        uint32_t vertexCount = static_cast<uint32_t>(positions.size() / 3);
+        optimizeVertexCache(torusIndices, vertexCount, VertexCacheMethod::Tipsify);
+        auto referenceTriangles = getSortedTriangles(torusIndices);
+
+        auto cacheStats = analyzeVertexCache(torusIndices, vertexCount);
+        auto start = BenchmarkClock::now();
+        auto overdrawStats = analyzeOverdraw(torusIndices, positions);
+        double analyzeTime = millisecondsSince(start);
+        std::cout << "torus, " << cacheStats.triangleCount << " triangles, tipsify order: ACMR "
+                  << std::fixed << std::setprecision(3) << cacheStats.acmr()
+                  << ", overdraw " << overdrawStats.overdraw()
+                  << std::setprecision(1) << " (software rasterizer " << analyzeTime << " ms)" << std::endl;
+        std::cout << "threshold     ACMR  overdraw        ms   order" << std::endl;
+        for (auto threshold : thresholds)
+        {
+            std::vector<uint32_t> indices = torusIndices;
+            start = BenchmarkClock::now();
+            bool reordered = optimizeOverdraw(indices, positions, threshold);
+            double time = millisecondsSince(start);
+            if (getSortedTriangles(indices) != referenceTriangles)
+            {
+                std::cout << "overdraw: triangles changed by reordering" << std::endl;
+                return -1;
+            }
+            std::cout << std::fixed << std::setprecision(2) << std::setw(9) << threshold
+                      << std::setprecision(3) << std::setw(9) << analyzeVertexCache(indices, vertexCount).acmr()
+                      << std::setw(10) << analyzeOverdraw(indices, positions).overdraw()
+                      << std::setprecision(2) << std::setw(10) << time
+                      << (reordered ? "   sorted" : "   input") << std::endl;
+        }
+        return 0;
+    }
+
+    int benchmarkMeshlets(const std::vector<std::string> &args)
+    {
+        std::cout << "triangles  limits    meshlets  vertices  triangles  culled        ms" << std::endl;
+        for (auto cornerCount : getCornerCounts(args))
+        {
+            uint32_t quadsX = std::max<uint32_t>(1, static_cast<uint32_t>(std::sqrt(cornerCount / 6.0)));
+            RawMesh rawMesh = generateGridRawMesh(quadsX, quadsX);
+            std::vector<IndexSet> corners;
+            triangulatePolygons(rawMesh, corners);
+            std::vector<uint32_t> indices;
+            std::vector<IndexSet> vertices;
+            weldVertices(corners, VertexWeldMethod::HashTable, indices, vertices);
+            uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+            optimizeVertexCache(indices, vertexCount, VertexCacheMethod::Tipsify);
+            std::vector<float> positions;
+            for (const auto &vertex : vertices)
+            {
+                const auto &controlPoint = rawMesh.controlPoints[vertex.controlPoint].mData;
+                positions.insert(positions.end(), { float(controlPoint[0]), float(controlPoint[1]), float(controlPoint[2]) });
+            }
+
+            const uint32_t limits[][2] = { { 64, 124 }, { 128, 256 }, { 256, 512 } };
+            for (const auto &limit : limits)
+            {
+                MeshletData meshletData;
+                auto start = BenchmarkClock::now();
+                buildMeshlets(indices, vertexCount, limit[0], limit[1], meshletData);
+                computeMeshletBounds(meshletData, positions);
+                double time = millisecondsSince(start);
+
+                // meshlets must reproduce the index buffer
+                size_t corner = 0;
+                for (const auto &meshlet : meshletData.meshlets)
+                {
+                    if (meshlet.vertexCount > limit[0] || meshlet.triangleCount > limit[1])
+                    {
+                        std::cout << "meshlets: meshlet exceeds limits" << std::endl;
+                        return -1;
+                    }
+                    for (uint32_t triangleCorner = 0; triangleCorner < meshlet.triangleCount * 3; ++triangleCorner)
+                    {
+                        uint8_t localIndex = meshletData.triangles[meshlet.triangleOffset * 3 + triangleCorner];
+                        if (localIndex >= meshlet.vertexCount ||
+                            meshletData.vertices[meshlet.vertexOffset + localIndex] != indices[corner++])
+                        {
+                            std::cout << "meshlets: meshlet triangles differ from index buffer" << std::endl;
+                            return -1;
+                        }
+                    }
+                }
+                if (corner != indices.size())
+                {
+                    std::cout << "meshlets: not all triangles are in meshlets" << std::endl;
+                    return -1;
+                }
+
+                // grid faces +z, camera below it sees only back faces
+                const float camera[3] = { quadsX * 0.5f, quadsX * 0.5f, -10.0f };
+                uint32_t culledCount = 0;
+                for (const auto &bounds : meshletData.bounds)
+                {
+                    float view[3] = { bounds.center[0] - camera[0], bounds.center[1] - camera[1], bounds.center[2] - camera[2] };
+                    float distance = std::sqrt(view[0] * view[0] + view[1] * view[1] + view[2] * view[2]);
+                    float dot = view[0] * bounds.coneAxis[0] + view[1] * bounds.coneAxis[1] + view[2] * bounds.coneAxis[2];
+                    culledCount += dot >= bounds.coneCutoff * distance + bounds.radius ? 1 : 0;
+                }
+
+                size_t meshletCount = meshletData.meshlets.size();
+                std::cout << std::setw(9) << indices.size() / 3
+                          << std::setw(5) << limit[0] << "/" << std::left << std::setw(6) << limit[1] << std::right
+                          << std::setw(8) << meshletCount
+                          << std::fixed << std::setprecision(1)
+                          << std::setw(10) << double(meshletData.vertices.size()) / meshletCount
+                          << std::setw(11) << double(meshletData.triangles.size() / 3) / meshletCount
+                          << std::setw(8) << culledCount
+                          << std::setprecision(2) << std::setw(10) << time << std::endl;
+            }
+        }
+        return 0;
+    }
+
+    // grid with random positions far from origin, random unit normals/tangents and UVs
+    int benchmarkEncoding(const std::vector<std::string> &args)
+    {
+        std::cout << "triangles  encoding         bytes/vertex  position    normal deg  tangent deg  uv          ms" << std::endl;
+        std::mt19937 random(7);
+        std::uniform_real_distribution<double> unitRange(-1.0, 1.0);
+        auto randomUnitVector = [&random, &unitRange]()
+        {
+            RawVector4 vector = { { unitRange(random), unitRange(random), unitRange(random), 0.0 } };
+            double length = std::sqrt(vector.mData[0] * vector.mData[0] + vector.mData[1] * vector.mData[1] + vector.mData[2] * vector.mData[2]);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                vector.mData[axis] = length > 0.0 ? vector.mData[axis] / length : (axis == 2 ? 1.0 : 0.0);
+            }
+            return vector;
+        };
+        struct EncodingConfig
+        {
+            const char *name;
+            PositionEncoding position;
+            DirectionEncoding direction;
+            UVEncoding uv;
+        };
+        const EncodingConfig configs[] = {
+            { "float32", PositionEncoding::Float, DirectionEncoding::Float32, UVEncoding::Float32 },
+            { "unorm16/oct16", PositionEncoding::UNorm16, DirectionEncoding::Octahedral16, UVEncoding::Half },
+            { "unorm16/oct8", PositionEncoding::UNorm16, DirectionEncoding::Octahedral8, UVEncoding::Half },
+        };
+        for (auto cornerCount : getCornerCounts(args))
+        {
+            uint32_t quadsX = std::max<uint32_t>(1, static_cast<uint32_t>(std::sqrt(cornerCount / 6.0)));
+            RawMesh rawMesh = generateGridRawMesh(quadsX, quadsX);
+            for (auto &controlPoint : rawMesh.controlPoints)
+            {
+                controlPoint.mData[0] += 1000.0 + unitRange(random) * 0.25;
+                controlPoint.mData[1] -= 500.0 + unitRange(random) * 0.25;
+                controlPoint.mData[2] = unitRange(random) * 10.0;
+            }
+            for (auto &normal : rawMesh.normals)
+            {
+                normal = randomUnitVector();
+            }
+            for (auto &uv : rawMesh.UVs)
+            {
+                uv.mData[0] = unitRange(random) * 4.0;
+                uv.mData[1] = unitRange(random) * 4.0;
+            }
+            for (auto &corner : rawMesh.polygonVertices)
+            {
+                corner.tangent = static_cast<uint32_t>(rawMesh.tangents.size());
+                corner.binormal = static_cast<uint32_t>(rawMesh.binormals.size());
+                rawMesh.tangents.push_back(randomUnitVector());
+                rawMesh.binormals.push_back(randomUnitVector());
+            }
+
+            for (const auto &config : configs)
+            {
+                ImportSettings settings;
+                settings.mergeNormalThresholdAngle = 0.0f;
+                settings.importTangents = true;
+                settings.importBinormals = true;
+                settings.positionEncoding = config.position;
+                settings.normalEncoding = config.direction;
+                settings.tangentEncoding = config.direction;
+                settings.uvEncoding = config.uv;
+                MeshConvertStats stats;
+                auto start = BenchmarkClock::now();
+                StreamMesh mesh = convertRawMesh(rawMesh, settings, &stats);
+                double time = millisecondsSince(start);
+
+                const EncodingError *errors[] = { &stats.positionError, &stats.normalError, &stats.tangentError, &stats.uvError };
+                for (auto error : errors)
+                {
+                    if (!error->withinBounds())
+                    {
+                        std::cout << "encoding: " << config.name << " error " << error->maxError
+                                  << " exceeds bound " << error->maxBound << std::endl;
+                        return -1;
+                    }
+                }
+                uint64_t vertexBytes = 0;
+                for (const auto &stream : mesh.streams)
+                {
+                    if (stream.attributeType != static_cast<uint32_t>(AttributeType::Index) &&
+                        stream.attributeType != static_cast<uint32_t>(AttributeType::PositionDequantization))
+                    {
+                        vertexBytes += stream.data.size();
+                    }
+                }
+                const double degreesPerRadian = 180.0 / Pi;
+                std::cout << std::setw(9) << stats.vertexCacheAfter.triangleCount << "  "
+                          << std::left << std::setw(15) << config.name << std::right
+                          << std::fixed << std::setprecision(1)
+                          << std::setw(14) << double(vertexBytes) / stats.vertexCacheAfter.vertexCount
+                          << std::scientific << std::setprecision(2)
+                          << std::setw(10) << stats.positionError.maxError
+                          << std::fixed << std::setprecision(4)
+                          << std::setw(14) << stats.normalError.maxError * degreesPerRadian
+                          << std::setw(13) << stats.tangentError.maxError * degreesPerRadian
+                          << std::scientific << std::setprecision(2)
+                          << std::setw(10) << stats.uvError.maxError
+                          << std::fixed << std::setw(10) << time << std::endl;
+            }
+        }
+        return 0;
+    }
+
+    // attribute in separate or interleaved stream, float components only
+    struct AttributeView
+    {
+        uint32_t attributeType;
+        const uint8_t *data;
+        uint32_t stride;
+        uint32_t floatCount;
+    };
+
+    // sums are only kept so the reads aren't optimized away
+    volatile float attributeSumSink = 0.0f;
+
+    std::vector<AttributeView> getAttributeViews(const StreamMesh &mesh, bool positionOnly)
+    {
+        std::vector<AttributeView> views;
+        const VectorStream *interleavedStream = nullptr;
+        for (const auto &stream : mesh.streams)
+        {
+            auto attributeType = static_cast<AttributeType>(stream.attributeType);
+            if (attributeType == AttributeType::InterleavedVertex)
+            {
+                interleavedStream = &stream;
+            }
+            else if (attributeType == AttributeType::InterleavedLayout && interleavedStream != nullptr)
+            {
+                const auto *attributes = reinterpret_cast<const InterleavedAttribute*>(stream.data.data());
+                for (uint32_t attribute = 0; attribute < stream.elementCount; ++attribute)
+                {
+                    if (!positionOnly || attributes[attribute].attributeType == static_cast<uint32_t>(AttributeType::Position))
+                    {
+                        views.push_back({ attributes[attribute].attributeType,
+                                          interleavedStream->data.data() + attributes[attribute].offset,
+                                          interleavedStream->elementVectorSize, attributes[attribute].elementVectorSize });
+                    }
+                }
+            }
+            else if (attributeType == AttributeType::Position ||
+                     (!positionOnly && (attributeType == AttributeType::Normal || attributeType == AttributeType::UV ||
+                                        attributeType == AttributeType::Tangent || attributeType == AttributeType::Binormal)))
+            {
+                views.push_back({ stream.attributeType, stream.data.data(), stream.elementSize * stream.elementVectorSize,
+                                  stream.elementVectorSize });
+            }
+        }
+        return views;
+    }
+
+    // reads attributes of vertices in given order like vertex fetch does
+    float sumAttributes(const std::vector<AttributeView> &views, const std::vector<uint32_t> &order)
+    {
+        float sum = 0.0f;
+        for (auto vertex : order)
+        {
+            for (const auto &view : views)
+            {
+                const float *values = reinterpret_cast<const float*>(view.data + size_t(vertex) * view.stride);
+                for (uint32_t component = 0; component < view.floatCount; ++component)
+                {
+                    sum += values[component];
+                }
+            }
+        }
+        return sum;
+    }
+
+    // every attribute of referenceViews has the same values in views for all vertices.
+    // Compared per attribute type, because views of different layouts are in different order
+    bool attributeViewsEqual(const std::vector<AttributeView> &views, const std::vector<AttributeView> &referenceViews,
+                             uint32_t vertexCount)
+    {
+        if (views.size() != referenceViews.size())
+        {
+            return false;
+        }
+        for (const auto &referenceView : referenceViews)
+        {
+            auto view = std::find_if(views.begin(), views.end(), [&referenceView](const AttributeView &candidate)
+            {
+                return candidate.attributeType == referenceView.attributeType;
+            });
+            if (view == views.end() || view->floatCount != referenceView.floatCount)
+            {
+                return false;
+            }
+            for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+            {
+                if (memcmp(view->data + size_t(vertex) * view->stride, referenceView.data + size_t(vertex) * referenceView.stride,
+                           referenceView.floatCount * sizeof(float)) != 0)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    std::vector<uint32_t> getIndices(const StreamMesh &mesh)
+    {
+        std::vector<uint32_t> indices;
+        for (const auto &stream : mesh.streams)
+        {
+            if (stream.attributeType == static_cast<uint32_t>(AttributeType::Index))
+            {
+                indices.resize(stream.elementCount);
+                for (uint32_t index = 0; index < stream.elementCount; ++index)
+                {
+                    if (stream.elementSize == 2)
+                    {
+                        uint16_t value;
+                        memcpy(&value, stream.data.data() + index * 2, sizeof(value));
+                        indices[index] = value;
+                    }
+                    else
+                    {
+                        memcpy(&indices[index], stream.data.data() + index * 4, sizeof(uint32_t));
+                    }
+                }
+            }
+        }
+        return indices;
+    }
+
+    // CPU reads of separate streams (SoA) vs interleaved stream (AoS):
+    // position only pass (depth prepass) and all attributes, in index order and random order
+    int benchmarkLayout(const std::vector<std::string> &args)
+    {
+        std::cout << "vertices  layout        stride  pos/index  all/index  pos/random  all/random (ms)" << std::endl;
+        const int repeatCount = 5;
+        std::mt19937 random(11);
+        for (auto cornerCount : getCornerCounts(args))
+        {
+            uint32_t quadsX = std::max<uint32_t>(1, static_cast<uint32_t>(std::sqrt(cornerCount / 6.0)));
+            RawMesh rawMesh = generateGridRawMesh(quadsX, quadsX);
+            // one normal/uv/tangent/binormal per control point, so corners are welded
+            rawMesh.normals.assign(rawMesh.controlPoints.size(), RawVector4{ { 0.0, 0.0, 1.0, 0.0 } });
+            rawMesh.tangents.assign(rawMesh.controlPoints.size(), RawVector4{ { 1.0, 0.0, 0.0, 0.0 } });
+            rawMesh.binormals.assign(rawMesh.controlPoints.size(), RawVector4{ { 0.0, 1.0, 0.0, 0.0 } });
+            rawMesh.UVs.resize(rawMesh.controlPoints.size());
+            for (size_t point = 0; point < rawMesh.controlPoints.size(); ++point)
+            {
+                rawMesh.UVs[point] = { { rawMesh.controlPoints[point].mData[0] / quadsX, rawMesh.controlPoints[point].mData[1] / quadsX } };
+            }
+            for (auto &corner : rawMesh.polygonVertices)
+            {
+                corner.normal = corner.uv = corner.tangent = corner.binormal = corner.controlPoint;
+            }
+
+            struct LayoutConfig
+            {
+                const char *name;
+                VertexLayout layout;
+                uint32_t alignment;
+            };
+            const LayoutConfig configs[] = {
+                { "separate", VertexLayout::Separate, 4 },
+                { "interleaved", VertexLayout::Interleaved, 4 },
+                { "interleaved", VertexLayout::Interleaved, 64 },
+                { "split", VertexLayout::PositionSplit, 4 },
+            };
+            std::vector<uint32_t> randomOrder;
+            StreamMesh referenceMesh;
+            for (size_t configIndex = 0; configIndex < sizeof(configs) / sizeof(configs[0]); ++configIndex)
+            {
+                const auto &config = configs[configIndex];
+                ImportSettings settings;
+                settings.importTangents = true;
+                settings.importBinormals = true;
+                settings.vertexCacheMethod = VertexCacheMethod::Tipsify;
+                settings.optimizeVertexFetch = true;
+                settings.vertexLayout = config.layout;
+                settings.vertexStrideAlignment = config.alignment;
+                StreamMesh mesh = convertRawMesh(rawMesh, settings);
+                std::vector<uint32_t> indices = getIndices(mesh);
+                uint32_t vertexCount = 0;
+                uint32_t stride = 0;
+                for (const auto &stream : mesh.streams)
+                {
+                    if (stream.attributeType == static_cast<uint32_t>(AttributeType::InterleavedVertex))
+                    {
+                        stride = stream.elementVectorSize;
+                        vertexCount = stream.elementCount;
+                    }
+                    else if (stream.attributeType == static_cast<uint32_t>(AttributeType::Position))
+                    {
+                        vertexCount = stream.elementCount;
+                    }
+                }
+                if (randomOrder.empty())
+                {
+                    randomOrder.resize(vertexCount);
+                    std::iota(randomOrder.begin(), randomOrder.end(), 0u);
+                    std::shuffle(randomOrder.begin(), randomOrder.end(), random);
+                }
+
+                // every layout must give the same values as separate streams
+                if (configIndex == 0)
+                {
+                    referenceMesh = mesh;
+                }
+                else if (!attributeViewsEqual(getAttributeViews(mesh, false), getAttributeViews(referenceMesh, false), vertexCount))
+                {
+                    std::cout << "layout: " << config.name << " attribute values differ from separate streams" << std::endl;
+                    return -1;
+                }
+
+                std::cout << std::setw(8) << vertexCount << "  " << std::left << std::setw(12) << config.name << std::right
+                          << std::setw(8) << (stride > 0 ? std::to_string(stride) + "/" + std::to_string(config.alignment) : "-");
+                const std::vector<uint32_t> *orders[] = { &indices, &indices, &randomOrder, &randomOrder };
+                for (int pass = 0; pass < 4; ++pass)
+                {
+                    std::vector<AttributeView> views = getAttributeViews(mesh, pass % 2 == 0);
+                    double bestTime = 0.0;
+                    float sum = 0.0f;
+                    for (int repeat = 0; repeat < repeatCount; ++repeat)
+                    {
+                        auto start = BenchmarkClock::now();
+                        sum = sumAttributes(views, *orders[pass]);
+                        double time = millisecondsSince(start);
+                        bestTime = repeat == 0 ? time : std::min(bestTime, time);
+                    }
+                    attributeSumSink = attributeSumSink + sum;
+                    std::cout << std::fixed << std::setprecision(2) << std::setw(11) << bestTime;
+                }
+                std::cout << std::endl;
+            }
+        }
+        return 0;
+    }
+
+    // gather and double to float/unorm16 conversion at every SIMD level,
+    // sequential and random gather order. Output must match scalar kernels
+    int benchmarkPacking(const std::vector<std::string> &args)
+    {
+        std::cout << "vertices  kernel     simd      sequential ms  Mvertices/s   random ms  Mvertices/s" << std::endl;
+        const int repeatCount = 5;
+        std::mt19937 random(13);
+        std::uniform_real_distribution<double> valueRange(-1000.0, 1000.0);
+        SimdLevel initialLevel = getSimdLevel();
+        std::vector<SimdLevel> levels;
+        for (auto level : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 })
+        {
+            if (level <= getSupportedSimdLevel())
+            {
+                levels.push_back(level);
+            }
+        }
+        for (auto vertexCount : getCornerCounts(args))
+        {
+            std::vector<RawVector4> vectors(vertexCount);
+            std::vector<RawVector2> UVs(vertexCount);
+            for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+            {
+                vectors[vertex] = { { valueRange(random), valueRange(random), valueRange(random), 0.0 } };
+                UVs[vertex] = { { valueRange(random) * 0.001, valueRange(random) * 0.001 } };
+            }
+            std::vector<IndexSet> orders[2];
+            orders[0].resize(vertexCount);
+            for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+            {
+                orders[0][vertex].controlPoint = orders[0][vertex].uv = vertex;
+            }
+            orders[1] = orders[0];
+            std::shuffle(orders[1].begin(), orders[1].end(), random);
+            const float offset[3] = { -1000.0f, -1000.0f, -1000.0f };
+            const float scale[3] = { 2000.0f, 2000.0f, 2000.0f };
+
+            const char *kernelNames[] = { "float3", "float2", "unorm16x4" };
+            const size_t vertexSizes[] = { 12, 8, 8 };
+            for (int kernel = 0; kernel < 3; ++kernel)
+            {
+                std::vector<uint8_t> reference[2];
+                for (auto level : levels)
+                {
+                    setSimdLevel(level);
+                    std::cout << std::setw(8) << vertexCount << "  " << std::left << std::setw(11) << kernelNames[kernel]
+                              << std::setw(8) << getSimdLevelName(level) << std::right;
+                    for (int order = 0; order < 2; ++order)
+                    {
+                        std::vector<uint8_t> output(vertexCount * vertexSizes[kernel]);
+                        double bestTime = 0.0;
+                        for (int repeat = 0; repeat < repeatCount; ++repeat)
+                        {
+                            auto start = BenchmarkClock::now();
+                            switch (kernel)
+                            {
+                            case 0:
+                                packFloat3(vectors, orders[order], offsetof(IndexSet, controlPoint), output.data());
+                                break;
+                            case 1:
+                                packFloat2(UVs, orders[order], offsetof(IndexSet, uv), output.data());
+                                break;
+                            default:
+                                packUNorm16x4(vectors, orders[order], offsetof(IndexSet, controlPoint), offset, scale, output.data());
+                                break;
+                            }
+                            double time = millisecondsSince(start);
+                            bestTime = repeat == 0 ? time : std::min(bestTime, time);
+                        }
+                        if (level == SimdLevel::Scalar)
+                        {
+                            reference[order] = output;
+                        }
+                        else if (output != reference[order])
+                        {
+                            std::cout << std::endl << "packing: " << kernelNames[kernel] << " " << getSimdLevelName(level)
+                                      << " output differs from scalar" << std::endl;
+                            setSimdLevel(initialLevel);
+                            return -1;
+                        }
+                        std::cout << std::fixed << std::setprecision(2) << std::setw(order == 0 ? 15 : 12) << bestTime
+                                  << std::setprecision(1) << std::setw(13) << vertexCount / bestTime / 1000.0;
+                    }
+                    std::cout << std::endl;
+                }
+            }
+        }
+        setSimdLevel(initialLevel);
+        return 0;
+    }
+
+    int benchmarkRead(const std::vector<std::string> &args)
+    {
+        const double megabyte = 1024.0 * 1024.0;
+        uint32_t meshCount = args.size() > 0 ? std::stoul(args[0]) : 2000;
+        uint32_t cornerCount = args.size() > 1 ? std::stoul(args[1]) : 6000;
+        uint32_t quadsX = std::max<uint32_t>(1, static_cast<uint32_t>(std::sqrt(cornerCount / 6.0)));
+
+        ImportSettings settings;
+        settings.mergeNormalThresholdAngle = 45.0f;
+        RawMesh rawMesh = generateGridRawMesh(quadsX, quadsX);
+        StreamMesh mesh = convertRawMesh(rawMesh, settings);
+
+        name_fs::path directory = name_fs::temp_directory_path();
+        directory.append("ConvertFBXtoSMSH_benchmark_read");
+        std::error_code errorCode;
+        name_fs::create_directories(directory, errorCode);
+        if (errorCode)
+        {
+            std::cout << "read: can't create directory " << directory << std::endl;
+            return -1;
+        }
+
+        std::cout << "version     meshes   file size   open+validate, meshes/s   open+read all, meshes/s   MB/s" << std::endl;
+        int exitCode = 0;
+        for (uint32_t version = StreamConstants::MeshFileVersion1; version <= StreamConstants::MeshFileVersion3; ++version)
+        {
+            MeshFileFormat format;
+            format.version = version;
+            format.compression.codec = version == StreamConstants::MeshFileVersion3 ? StreamCodec::LZ4 : StreamCodec::None;
+            std::vector<std::string> fileNames;
+            for (uint32_t meshIndex = 0; meshIndex < meshCount; ++meshIndex)
+            {
+                name_fs::path filePath = directory;
+                filePath.append(std::to_string(meshIndex) + ".msh");
+                fileNames.push_back(filePath.u8string());
+                exportMeshToFile(fileNames.back(), mesh, format);
+            }
+            uint64_t fileSize = getMeshFileSize(mesh, format);
+
+            // files are in OS cache after writing, so this measures mapping and parsing cost
+            MeshFileReader reader;
+            auto start = BenchmarkClock::now();
+            for (const auto &fileName : fileNames)
+            {
+                if (!reader.open(fileName))
+                {
+                    std::cout << "read: " << fileName << ": " << reader.error() << std::endl;
+                    exitCode = -1;
+                    break;
+                }
+            }
+            double openTime = millisecondsSince(start);
+
+            uint64_t checksum = 0;
+            start = BenchmarkClock::now();
+            for (const auto &fileName : fileNames)
+            {
+                reader.open(fileName);
+                for (const auto &stream : reader.streams())
+                {
+                    const uint8_t *data = stream.data;
+                    for (uint64_t offset = 0; offset < stream.dataSize; offset += sizeof(uint32_t))
+                    {
+                        checksum += data[offset];
+                    }
+                }
+            }
+            double readTime = millisecondsSince(start);
+            reader.close();
+
+            std::cout << std::setw(7) << version
+                      << std::setw(11) << meshCount
+                      << std::setw(12) << fileSize
+                      << std::fixed << std::setprecision(0)
+                      << std::setw(26) << meshCount * 1000.0 / openTime
+                      << std::setw(26) << meshCount * 1000.0 / readTime
+                      << std::setw(7) << meshCount * fileSize / megabyte * 1000.0 / readTime
+                      << (checksum == 0 ? " (empty)" : "") << std::endl;
+        }
+        name_fs::remove_all(directory, errorCode);
+        return exitCode;
+    }
+
+    // original exportMeshToFile: one ofstream::write call for every header field
+    bool exportMeshToFileReference(const std::string &fileName, const StreamMesh &meshData)
+    {
+        std::ofstream ofs(fileName, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+        if (!ofs.is_open())
+        {
+            return false;
+        }
+        auto writeValue = [&ofs](uint32_t value) { ofs.write((char*)&value, sizeof(value)); };
+        writeValue(meshData.header.magicMESH);
+        writeValue(meshData.header.headerSize);
+        writeValue(StreamConstants::MeshFileVersion1);
+        writeValue(meshData.header.streamCount);
+        for (const auto &streamData : meshData.streams)
+        {
+            writeValue(streamData.magicSTRM);
+            writeValue(streamData.streamSize);
+            writeValue(streamData.elementCount);
+            writeValue(streamData.elementType);
+            writeValue(streamData.elementSize);
+            writeValue(streamData.elementVectorSize);
+            writeValue(streamData.attributeType);
+            ofs.write((char*)streamData.data.data(), streamData.data.size());
+        }
+        ofs.close();
+        return !ofs.fail();
+    }
+
+    std::vector<char> readWholeFile(const std::string &fileName)
+    {
+        std::ifstream ifs(fileName, std::ios_base::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+
+    int benchmarkWrite(const std::vector<std::string> &args)
+    {
+        const double megabyte = 1024.0 * 1024.0;
+        uint32_t meshCount = args.size() > 0 ? std::stoul(args[0]) : 2000;
+        uint32_t cornerCount = args.size() > 1 ? std::stoul(args[1]) : 600;
+        uint32_t quadsX = std::max<uint32_t>(1, static_cast<uint32_t>(std::sqrt(cornerCount / 6.0)));
+
+        ImportSettings settings;
+        settings.mergeNormalThresholdAngle = 45.0f;
+        RawMesh rawMesh = generateGridRawMesh(quadsX, quadsX);
+        StreamMesh mesh = convertRawMesh(rawMesh, settings);
+
+        name_fs::path directory = name_fs::temp_directory_path();
+        directory.append("ConvertFBXtoSMSH_benchmark_write");
+        std::error_code errorCode;
+        name_fs::create_directories(directory, errorCode);
+        if (errorCode)
+        {
+            std::cout << "write: can't create directory " << directory << std::endl;
+            return -1;
+        }
+        std::vector<std::string> fileNames;
+        for (uint32_t meshIndex = 0; meshIndex < meshCount; ++meshIndex)
+        {
+            name_fs::path filePath = directory;
+            filePath.append(std::to_string(meshIndex) + ".msh");
+            fileNames.push_back(filePath.u8string());
+        }
+
+        struct WriteMethod
+        {
+            const char *name;
+            MeshFileFormat format;
+            bool reference;
+        };
+        MeshFileFormat formatV1;
+        formatV1.version = StreamConstants::MeshFileVersion1;
+        MeshFileFormat formatV2;
+        MeshFileFormat formatV2Direct;
+        formatV2Direct.directIO = true;
+        const WriteMethod methods[] = {
+            { "v1 ofstream per field", formatV1, true },
+            { "v1 single write", formatV1, false },
+            { "v2 single write", formatV2, false },
+            { "v2 direct I/O", formatV2Direct, false },
+        };
+
+        // no fsync after writes: this measures serialization and syscall overhead, not the disk
+        std::cout << "method                   meshes   file size     files/s       MB/s" << std::endl;
+        int exitCode = 0;
+        std::vector<char> referenceContents;
+        for (const auto &method : methods)
+        {
+            // every method creates new files, truncating files of previous method would add its cost
+            for (const auto &fileName : fileNames)
+            {
+                name_fs::remove(fileName, errorCode);
+            }
+            uint64_t fileSize = getMeshFileSize(mesh, method.format);
+            bool success = true;
+            auto start = BenchmarkClock::now();
+            for (const auto &fileName : fileNames)
+            {
+                success &= method.reference ? exportMeshToFileReference(fileName, mesh)
+                                            : exportMeshToFile(fileName, mesh, method.format);
+            }
+            double time = millisecondsSince(start);
+            if (method.reference)
+            {
+                referenceContents = readWholeFile(fileNames.front());
+            }
+            else if (method.format.version == StreamConstants::MeshFileVersion1 &&
+                     readWholeFile(fileNames.front()) != referenceContents)
+            {
+                std::cout << "write: " << method.name << " output differs from reference" << std::endl;
+                exitCode = -1;
+            }
+            if (!success || readWholeFile(fileNames.back()).size() != fileSize)
+            {
+                std::cout << "write: " << method.name << " failed" << std::endl;
+                exitCode = -1;
+            }
+            std::cout << std::left << std::setw(22) << method.name << std::right
+                      << std::setw(9) << meshCount
+                      << std::setw(12) << fileSize
+                      << std::fixed << std::setprecision(0)
+                      << std::setw(12) << meshCount * 1000.0 / time
+                      << std::setw(11) << meshCount * fileSize / megabyte * 1000.0 / time << std::endl;
+        }
+        name_fs::remove_all(directory, errorCode);
+        return exitCode;
+    }
+
+    void printCorePhase(const char *name, uint64_t callCount, double seconds, uint64_t itemCount, const char *itemName)
+    {
+        std::cout << "    " << std::left << std::setw(16) << name << std::right
+                  << std::setw(6) << callCount
+                  << std::fixed << std::setprecision(2) << std::setw(11) << seconds * 1000.0
+                  << std::setw(12) << itemCount << " " << std::left << std::setw(10) << itemName << std::right
+                  << std::setprecision(2) << std::setw(10);
+        // phases which did nothing (e.g. optimization without options) have no meaningful throughput
+        if (seconds >= 1e-5)
+        {
+            std::cout << itemCount / seconds / 1e6 << std::endl;
+        }
+        else
+        {
+            std::cout << "-" << std::endl;
+        }
+    }
+
+    // whole conversion of generated RawMesh without FBX SDK: per-phase time and throughput
+    int benchmarkCore(const std::vector<std::string> &args)
+    {
+        std::vector<std::string> generators;
+        std::vector<std::string> countArgs;
+        for (const auto &arg : args)
+        {
+            if (!arg.empty() && std::isdigit(static_cast<unsigned char>(arg[0])))
+            {
+                countArgs.push_back(arg);
+            }
+            else
+            {
+                generators.push_back(arg);
+            }
+        }
+        if (generators.empty())
+        {
+            generators = { "grid", "sphere", "cad" };
+        }
+        std::vector<uint64_t> cornerCounts = getCornerCounts(countArgs);
+        if (countArgs.empty())
+        {
+            cornerCounts = { 1000000, 10000000 };
+        }
+
+        ImportSettings settings;
+        settings.mergeNormalThresholdAngle = 45.0f;
+        enablePhaseStats(true);
+        for (const auto &generator : generators)
+        {
+            for (auto cornerCount : cornerCounts)
+            {
+                RawMesh rawMesh;
+                auto start = BenchmarkClock::now();
+                if (!generateRawMesh(generator, cornerCount, rawMesh))
+                {
+                    std::cout << "core: unknown generator " << generator << ", use grid, sphere or cad" << std::endl;
+                    enablePhaseStats(false);
+                    return -1;
+                }
+                double generationTime = millisecondsSince(start) / 1000.0;
+                uint64_t corners = rawMesh.polygonVertices.size();
+
+                resetPhaseStats();
+                start = BenchmarkClock::now();
+                StreamMesh mesh = convertRawMesh(rawMesh, settings);
+                double conversionTime = millisecondsSince(start) / 1000.0;
+                std::vector<PhaseRecord> records = getPhaseRecords();
+
+                MeshFileFormat format;
+                std::vector<uint8_t> buffer(getMeshFileSize(mesh, format));
+                start = BenchmarkClock::now();
+                serializeMesh(mesh, format, buffer.data());
+                double serializationTime = millisecondsSince(start) / 1000.0;
+
+                std::cout << generator << ": " << corners << " corners, " << rawMesh.controlPoints.size()
+                          << " control points" << std::endl;
+                std::cout << "    phase            calls         ms       items            Mitems/s" << std::endl;
+                printCorePhase("generation", 1, generationTime, corners, "corners");
+                for (size_t phase = 0; phase < records.size(); ++phase)
+                {
+                    if (records[phase].callCount > 0)
+                    {
+                        printCorePhase(getPhaseName(static_cast<Phase>(phase)), records[phase].callCount,
+                                       records[phase].wallSeconds, records[phase].itemCount,
+                                       getPhaseItemName(static_cast<Phase>(phase)));
+                    }
+                }
+                printCorePhase("conversion", 1, conversionTime, corners, "corners");
+                printCorePhase("serialization", 1, serializationTime, buffer.size(), "bytes");
+            }
+        }
+        enablePhaseStats(false);
+        return 0;
+    }
+
+    // best of several runs of function, repeated until at least minMilliseconds passed
+    template <typename Function>
+    double bestMilliseconds(const Function &function, double minMilliseconds = 50.0)
+    {
+        double bestTime = 0.0;
+        double totalTime = 0.0;
+        for (uint32_t run = 0; run < 3 || totalTime < minMilliseconds; ++run)
+        {
+            auto start = BenchmarkClock::now();
+            function();
+            double time = millisecondsSince(start);
+            bestTime = run == 0 ? time : std::min(bestTime, time);
+            totalTime += time;
+        }
+        return bestTime;
+    }
+
+    // LZ4 with every filter on the streams of converted generated meshes: ratio,
+    // compression and decode speed, then open of whole version 2 and version 3 files
+    int benchmarkCompression(const std::vector<std::string> &args)
+    {
+        const double megabyte = 1024.0 * 1024.0;
+        const double gigabyte = 1024.0 * megabyte;
+        const char *attributeNames[] = {
+            "index", "position", "normal", "uv", "tangent", "binormal", "meshletDesc", "meshletVertex",
+            "meshletTriangle", "meshletBounds", "dequantization", "interleaved", "interleavedLayout"
+        };
+        std::vector<std::string> generators;
+        std::vector<std::string> countArgs;
+        for (const auto &arg : args)
+        {
+            if (!arg.empty() && std::isdigit(static_cast<unsigned char>(arg[0])))
+            {
+                countArgs.push_back(arg);
+            }
+            else
+            {
+                generators.push_back(arg);
+            }
+        }
+        if (generators.empty())
+        {
+            generators = { "grid", "sphere", "cad" };
+        }
+        std::vector<uint64_t> cornerCounts = getCornerCounts(countArgs);
+        if (countArgs.empty())
+        {
+            cornerCounts = { 1000000 };
+        }
+
+        // vertex cache and fetch order are what shipping assets use, they help compression too
+        ImportSettings settings;
+        settings.mergeNormalThresholdAngle = 45.0f;
+        settings.vertexCacheMethod = VertexCacheMethod::Forsyth;
+        settings.optimizeVertexFetch = true;
+        const StreamFilter filters[] = { StreamFilter::None, StreamFilter::Shuffle, StreamFilter::Delta };
+        for (const auto &generator : generators)
+        {
+            for (auto cornerCount : cornerCounts)
+            {
+                RawMesh rawMesh;
+                if (!generateRawMesh(generator, cornerCount, rawMesh))
+                {
+                    std::cout << "compression: unknown generator " << generator << ", use grid, sphere or cad" << std::endl;
+                    return -1;
+                }
+                StreamMesh mesh = convertRawMesh(rawMesh, settings);
+                std::cout << generator << ": " << rawMesh.polygonVertices.size() << " corners" << std::endl;
+                std::cout << "    stream                bytes   filter    ratio   compress MB/s   decode GB/s" << std::endl;
+                std::vector<uint8_t> compressed;
+                std::vector<uint8_t> decoded;
+                std::vector<uint8_t> scratch;
+                for (const auto &stream : mesh.streams)
+                {
+                    const auto &data = stream.data;
+                    if (data.empty())
+                    {
+                        continue;
+                    }
+                    decoded.resize(data.size());
+                    double copyTime = bestMilliseconds([&]() { memcpy(decoded.data(), data.data(), data.size()); });
+                    const char *attributeName = stream.attributeType < sizeof(attributeNames) / sizeof(attributeNames[0])
+                                                ? attributeNames[stream.attributeType] : "unknown";
+                    std::cout << "    " << std::left << std::setw(16) << attributeName << std::right
+                              << std::setw(11) << data.size() << "   memcpy"
+                              << std::setw(38) << std::fixed << std::setprecision(2)
+                              << data.size() / gigabyte * 1000.0 / copyTime << std::endl;
+                    for (auto filter : filters)
+                    {
+                        StreamCompressionSettings compression;
+                        compression.codec = StreamCodec::LZ4;
+                        compression.autoFilter = false;
+                        compression.filter = filter;
+                        compression.minSavingPercent = 0;
+                        CompressedStream compressedStream;
+                        double compressTime = bestMilliseconds([&]() { compressedStream = compressStream(stream, compression); });
+                        if (compressedStream.codec == StreamCodec::None)
+                        {
+                            std::cout << std::setw(42) << getStreamFilterName(filter) << "   incompressible" << std::endl;
+                            continue;
+                        }
+                        bool success = true;
+                        double decodeTime = bestMilliseconds([&]()
+                        {
+                            success = decompressStream(compressedStream.codec, compressedStream.filter,
+                                                       compressedStream.data.data(), compressedStream.data.size(),
+                                                       stream.elementSize, stream.elementVectorSize,
+                                                       decoded.data(), decoded.size(), scratch) && success;
+                        });
+                        if (!success || decoded != data)
+                        {
+                            std::cout << std::endl << "compression: " << attributeName << " " << getStreamFilterName(filter)
+                                      << " doesn't decode to original data" << std::endl;
+                            return -1;
+                        }
+                        std::cout << std::setw(42) << getStreamFilterName(filter)
+                                  << std::setw(9) << std::setprecision(2) << double(data.size()) / compressedStream.data.size()
+                                  << std::setw(16) << std::setprecision(0) << data.size() / megabyte * 1000.0 / compressTime
+                                  << std::setw(14) << std::setprecision(2) << data.size() / gigabyte * 1000.0 / decodeTime
+                                  << std::endl;
+                    }
+                }
+
+                // whole files in memory: version 2 streams are used in place, version 3 are decoded
+                std::cout << "    file          size   write ms   open GB/s (uncompressed bytes)" << std::endl;
+                uint64_t streamBytes = 0;
+                for (const auto &stream : mesh.streams)
+                {
+                    streamBytes += stream.data.size();
+                }
+                for (uint32_t version = StreamConstants::MeshFileVersion2; version <= StreamConstants::MeshFileVersion3; ++version)
+                {
+                    MeshFileFormat format;
+                    format.version = version;
+                    format.compression.codec = version == StreamConstants::MeshFileVersion3 ? StreamCodec::LZ4 : StreamCodec::None;
+                    std::vector<uint8_t> file;
+                    double writeTime = bestMilliseconds([&]()
+                    {
+                        file.resize(getMeshFileSize(mesh, format));
+                        serializeMesh(mesh, format, file.data());
+                    });
+                    MeshFileReader reader;
+                    bool success = true;
+                    double openTime = bestMilliseconds([&]() { success = reader.openMemory(file.data(), file.size()) && success; });
+                    if (!success)
+                    {
+                        std::cout << "compression: version " << version << " file: " << reader.error() << std::endl;
+                        return -1;
+                    }
+                    std::cout << "    version " << version << std::setw(11) << file.size()
+                              << std::setw(11) << std::setprecision(2) << writeTime
+                              << std::setw(12) << streamBytes / gigabyte * 1000.0 / openTime << std::endl;
+                }
+            }
+        }
+        return 0;
+    }
+
+    // load binary FBX files up to RawMesh: native reader vs FBX SDK. Peak RSS
+    // only grows, so a later loader shows growth above the earlier peak, run one
+    // loader per process to compare memory
+    int benchmarkFBXLoad(const std::vector<std::string> &args)
+    {
+        std::vector<std::string> files;
+        std::vector<std::string> loaders;
+        uint32_t threadCount = 0;
+        for (const auto &arg : args)
+        {
+            if (arg == "native" || arg == "sdk")
+            {
+                loaders.push_back(arg);
+            }
+            else if (!arg.empty() && std::isdigit(static_cast<unsigned char>(arg[0])))
+            {
+                threadCount = static_cast<uint32_t>(std::stoul(arg));
+            }
+            else
+            {
+                files.push_back(arg);
+            }
+        }
+        if (files.empty())
+        {
+            std::cout << "fbxload: no FBX files given" << std::endl;
+            return -1;
+        }
+        if (loaders.empty())
+        {
+            loaders = { "native", "sdk" };
+        }
+
+        ImportSettings settings;
+        settings.threadCount = threadCount;
+        for (const auto &file : files)
+        {
+            std::error_code errorCode;
+            uint64_t fileSize = name_fs::file_size(file, errorCode);
+            if (errorCode)
+            {
+                std::cout << "fbxload: can't open " << file << std::endl;
+                return -1;
+            }
+            std::cout << file << ": " << std::fixed << std::setprecision(1) << fileSize / 1e6 << " MB" << std::endl;
+            std::cout << "    loader           ms       MB/s  meshes     corners  peak RSS growth MB" << std::endl;
+            for (const auto &loader : loaders)
+            {
+                std::vector<RawMesh> rawMeshes;
+                uint64_t peakBefore = getPeakRSS();
+                auto start = BenchmarkClock::now();
+                bool loaded = false;
+                if (loader == "native")
+                {
+                    loaded = loadFBXRawMeshesNative(file, settings, rawMeshes);
+                }
+                else
+                {
+#ifndef NO_FBXSDK
+                    loaded = loadFBXRawMeshes(file, settings, rawMeshes);
+#else
+                    std::cout << "    sdk          - not available, built without FBX SDK" << std::endl;
+                    continue;
+#endif
+                }
+                double milliseconds = millisecondsSince(start);
+                uint64_t peakAfter = getPeakRSS();
+                if (!loaded)
+                {
+                    std::cout << "    " << loader << ": failed to load " << file << std::endl;
+                    return -1;
+                }
+                uint64_t cornerCount = 0;
+                for (const auto &rawMesh : rawMeshes)
+                {
+                    cornerCount += rawMesh.polygonVertices.size();
+                }
+                std::cout << "    " << std::left << std::setw(10) << loader << std::right
+                          << std::fixed << std::setprecision(2) << std::setw(11) << milliseconds
+                          << std::setprecision(1) << std::setw(11) << fileSize / 1e3 / std::max(milliseconds, 1e-3)
+                          << std::setw(8) << rawMeshes.size() << std::setw(12) << cornerCount
+                          << std::setw(20) << (peakAfter - peakBefore) / 1e6 << std::endl;
+            }
+        }
+        return 0;
+    }
+
+    void printLatencies(const char *mode, std::vector<double> milliseconds)
+    {
+        if (milliseconds.empty())
+        {
+            return;
+        }
+        std::sort(milliseconds.begin(), milliseconds.end());
+        std::cout << "    " << std::left << std::setw(12) << mode << std::right << std::setw(6) << milliseconds.size()
+                  << std::fixed << std::setprecision(2) << std::setw(11) << milliseconds.front()
+                  << std::setw(11) << milliseconds[milliseconds.size() / 2] << std::setw(11) << milliseconds.back() << std::endl;
+    }
+
+    // latency of single file conversions as editor tools see it: a new process
+    // per file (cold, given command line, includes shell start) vs requests to
+    // a running --serve process (warm). First warm request is shown separately
+    int benchmarkDaemon(const std::vector<std::string> &args)
+    {
+        if (args.size() < 3)
+        {
+            std::cout << "daemon: args are socket, FBX file, output path, [runs], [cold command line]" << std::endl;
+            return -1;
+        }
+        const std::string &socketPath = args[0];
+        uint32_t runCount = args.size() > 3 ? std::max(1u, static_cast<uint32_t>(std::stoul(args[3]))) : 10;
+        std::string coldCommand;
+        for (size_t argIndex = 4; argIndex < args.size(); ++argIndex)
+        {
+            coldCommand += (coldCommand.empty() ? "" : " ") + args[argIndex];
+        }
+
+        std::vector<double> coldMilliseconds;
+        for (uint32_t run = 0; run < runCount && !coldCommand.empty(); ++run)
+        {
+            auto start = BenchmarkClock::now();
+            int exitCode = std::system(coldCommand.c_str());
+            coldMilliseconds.push_back(millisecondsSince(start));
+            if (exitCode != 0)
+            {
+                std::cout << "daemon: cold command failed with " << exitCode << ": " << coldCommand << std::endl;
+                return -1;
+            }
+        }
+        Json::Value request;
+        request["input"] = name_fs::absolute(args[1]).u8string();
+        request["output"] = name_fs::absolute(args[2]).u8string();
+        request["options"] = Json::Value(Json::arrayValue);
+        std::vector<double> warmMilliseconds;
+        double firstWarmMilliseconds = 0.0;
+        for (uint32_t run = 0; run <= runCount; ++run)
+        {
+            auto start = BenchmarkClock::now();
+            Json::Value result;
+            if (!sendServerRequest(socketPath, request, ServerEventSink(), result))
+            {
+                std::cout << "daemon: no server at " << socketPath << ", start it with --serve" << std::endl;
+                return -1;
+            }
+            double milliseconds = millisecondsSince(start);
+            if (!result["success"].asBool())
+            {
+                std::cout << "daemon: request failed: " << result["error"].asString() << std::endl;
+                return -1;
+            }
+            if (run == 0)
+            {
+                firstWarmMilliseconds = milliseconds;
+            }
+            else
+            {
+                warmMilliseconds.push_back(milliseconds);
+            }
+        }
+        std::cout << "    mode          runs     min ms  median ms     max ms" << std::endl;
+        printLatencies("cold", coldMilliseconds);
+        printLatencies("warm first", { firstWarmMilliseconds });
+        printLatencies("warm", warmMilliseconds);
+        if (!coldMilliseconds.empty())
+        {
+            std::sort(coldMilliseconds.begin(), coldMilliseconds.end());
+            std::sort(warmMilliseconds.begin(), warmMilliseconds.end());
+            std::cout << "median cold/warm: " << std::setprecision(1)
+                      << coldMilliseconds[coldMilliseconds.size() / 2] / std::max(warmMilliseconds[warmMilliseconds.size() / 2], 1e-3)
+                      << "x" << std::endl;
+        }
+        return 0;
+    }
+
+    struct InstancingMode
+    {
+        const char *name;
+        float tolerance;
+        bool transformed;
+        uint32_t uniqueMeshCount;
+    };
+
+    // calls function with xyz of every element of a float3 stream and stores the result
+    using VectorFunction = std::function<void(double vector[3])>;
+
+    template <typename T>
+    void transformVectorStream(VectorStream &stream, const VectorFunction &function)
+    {
+        for (size_t elementIndex = 0; elementIndex < stream.elementCount; ++elementIndex)
+        {
+            T values[3];
+            memcpy(values, stream.data.data() + elementIndex * sizeof(values), sizeof(values));
+            double vector[3] = { static_cast<double>(values[0]), static_cast<double>(values[1]), static_cast<double>(values[2]) };
+            function(vector);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                values[axis] = static_cast<T>(vector[axis]);
+            }
+            memcpy(stream.data.data() + elementIndex * sizeof(values), values, sizeof(values));
+        }
+    }
+
+    // function gets xyz of positions, directionFunction xyz of normals, tangents and binormals
+    void transformMeshVectors(StreamMesh &mesh, const VectorFunction &function, const VectorFunction &directionFunction)
+    {
+        for (auto &stream : mesh.streams)
+        {
+            bool isPosition = stream.attributeType == static_cast<uint32_t>(AttributeType::Position);
+            bool isDirection = stream.attributeType == static_cast<uint32_t>(AttributeType::Normal) ||
+                               stream.attributeType == static_cast<uint32_t>(AttributeType::Tangent) ||
+                               stream.attributeType == static_cast<uint32_t>(AttributeType::Binormal);
+            if (!isPosition && !isDirection)
+            {
+                continue;
+            }
+            if (stream.elementSize == sizeof(float))
+            {
+                transformVectorStream<float>(stream, isPosition ? function : directionFunction);
+            }
+            else
+            {
+                transformVectorStream<double>(stream, isPosition ? function : directionFunction);
+            }
+        }
+    }
+
+    // v = q * v * conjugate(q), q is x, y, z, w like InstanceTransform::rotation
+    void rotateByQuaternion(const double rotation[4], double vector[3])
+    {
+        const double *q = rotation;
+        double t[3] = { 2.0 * (q[1] * vector[2] - q[2] * vector[1]),
+                        2.0 * (q[2] * vector[0] - q[0] * vector[2]),
+                        2.0 * (q[0] * vector[1] - q[1] * vector[0]) };
+        double rotated[3] = { vector[0] + q[3] * t[0] + q[1] * t[2] - q[2] * t[1],
+                              vector[1] + q[3] * t[1] + q[2] * t[0] - q[0] * t[2],
+                              vector[2] + q[3] * t[2] + q[0] * t[1] - q[1] * t[0] };
+        memcpy(vector, rotated, sizeof(rotated));
+    }
+
+    InstanceTransform getRandomTransform(std::mt19937 &random)
+    {
+        std::normal_distribution<double> normal;
+        std::uniform_real_distribution<double> uniform(-100.0, 100.0);
+        InstanceTransform transform;
+        double length = 0.0;
+        for (auto &component : transform.rotation)
+        {
+            component = normal(random);
+            length += component * component;
+        }
+        for (auto &component : transform.rotation)
+        {
+            component /= std::sqrt(length);
+        }
+        for (auto &component : transform.translation)
+        {
+            component = uniform(random);
+        }
+        transform.scale = std::exp2(uniform(random) / 100.0); // 0.5 .. 2
+        return transform;
+    }
+
+    void applyTransform(const InstanceTransform &transform, StreamMesh &mesh)
+    {
+        transformMeshVectors(mesh, [&transform](double position[3])
+        {
+            rotateByQuaternion(transform.rotation, position);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                position[axis] = transform.translation[axis] + transform.scale * position[axis];
+            }
+        }, [&transform](double direction[3]) { rotateByQuaternion(transform.rotation, direction); });
+    }
+
+    // moves every position value by +-offset, random sign
+    void perturbPositions(StreamMesh &mesh, double offset, std::mt19937 &random)
+    {
+        transformMeshVectors(mesh, [offset, &random](double position[3])
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                position[axis] += (random() & 1) ? offset : -offset;
+            }
+        }, [](double *) {});
+    }
+
+    // the steps of convertMeshes with --dedupe-meshes [--dedupe-transformed]:
+    // exact (or within tolerance) copies, then transformed copies of the meshes left
+    std::vector<uint32_t> deduplicateInstances(std::vector<StreamMesh> &meshes, float tolerance, bool transformed,
+                                               ThreadPool &threadPool, std::vector<InstanceTransform> &transforms)
+    {
+        InstancingStats stats;
+        uint32_t meshCount = static_cast<uint32_t>(meshes.size());
+        std::vector<uint32_t> meshRemap = deduplicateMeshes(meshes, tolerance, threadPool, stats);
+        transforms.assign(meshCount, InstanceTransform());
+        if (transformed)
+        {
+            std::vector<InstanceTransform> uniqueMeshTransforms;
+            auto transformedRemap = deduplicateTransformedMeshes(meshes, tolerance, std::vector<bool>(meshes.size(), true),
+                                                                 threadPool, stats, uniqueMeshTransforms);
+            for (uint32_t meshIndex = 0; meshIndex < meshCount; ++meshIndex)
+            {
+                transforms[meshIndex] = uniqueMeshTransforms[meshRemap[meshIndex]];
+                meshRemap[meshIndex] = transformedRemap[meshRemap[meshIndex]];
+            }
+        }
+        return meshRemap;
+    }
+
+    // largest difference of placement of a recovered transform from the applied one:
+    // rotation angle in radians, relative scale and translation
+    void addTransformErrors(const InstanceTransform &recovered, const InstanceTransform &applied, double errors[3])
+    {
+        double dot = 0.0;
+        for (int component = 0; component < 4; ++component)
+        {
+            dot += recovered.rotation[component] * applied.rotation[component];
+        }
+        double translationError = 0.0;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            translationError = std::max(translationError, std::abs(recovered.translation[axis] - applied.translation[axis]));
+        }
+        errors[0] = std::max(errors[0], 2.0 * std::acos(std::min(1.0, std::abs(dot))));
+        errors[1] = std::max(errors[1], std::abs(recovered.scale / applied.scale - 1.0));
+        errors[2] = std::max(errors[2], translationError);
+    }
+
+    // sphere of cornerCount corners, its exact copies, copies with positions
+    // moved by +-1e-6, rotated + scaled + translated copies and a grid: unique
+    // mesh counts and recovered transforms of every mode
+    int checkInstancing(uint64_t cornerCount, ThreadPool &threadPool)
+    {
+        const uint32_t copyCount = 4;
+        const float tolerance = 1.0e-3f;
+        std::mt19937 random(1);
+        ImportSettings settings;
+        RawMesh rawMesh;
+        generateRawMesh("sphere", cornerCount, rawMesh);
+        StreamMesh sphere = convertRawMesh(rawMesh, settings);
+        size_t sphereCornerCount = rawMesh.polygonVertices.size();
+        generateRawMesh("grid", cornerCount, rawMesh);
+        StreamMesh grid = convertRawMesh(rawMesh, settings);
+
+        std::vector<StreamMesh> meshes(1, sphere);
+        std::vector<InstanceTransform> appliedTransforms(1);
+        for (uint32_t copyIndex = 0; copyIndex < copyCount; ++copyIndex)
+        {
+            meshes.push_back(sphere);
+            appliedTransforms.emplace_back();
+            meshes.push_back(sphere);
+            perturbPositions(meshes.back(), 1.0e-6, random);
+            appliedTransforms.emplace_back();
+            meshes.push_back(sphere);
+            appliedTransforms.push_back(getRandomTransform(random));
+            applyTransform(appliedTransforms.back(), meshes.back());
+        }
+        meshes.push_back(grid);
+        appliedTransforms.emplace_back();
+
+        const InstancingMode modes[] = {
+            { "exact", 0.0f, false, 2 + 2 * copyCount },
+            { "tolerance", tolerance, false, 2 + copyCount },
+            { "transformed", tolerance, true, 2 },
+        };
+        std::cout << "check: sphere of " << sphereCornerCount << " corners, " << copyCount
+                  << " exact, perturbed by 1e-6 and transformed copies each, tolerance " << tolerance << std::endl;
+        int exitCode = 0;
+        for (const auto &mode : modes)
+        {
+            std::vector<StreamMesh> dedupedMeshes = meshes;
+            std::vector<InstanceTransform> transforms;
+            auto meshRemap = deduplicateInstances(dedupedMeshes, mode.tolerance, mode.transformed, threadPool, transforms);
+            double errors[3] = { 0.0, 0.0, 0.0 };
+            bool transformsFound = true;
+            for (size_t meshIndex = 0; meshIndex < meshes.size(); ++meshIndex)
+            {
+                if (!appliedTransforms[meshIndex].isIdentity() && mode.transformed)
+                {
+                    transformsFound &= meshRemap[meshIndex] == 0;
+                    addTransformErrors(transforms[meshIndex], appliedTransforms[meshIndex], errors);
+                }
+            }
+            bool valid = dedupedMeshes.size() == mode.uniqueMeshCount && transformsFound &&
+                         errors[0] < 1.0e-4 && errors[1] < 1.0e-5 && errors[2] < 1.0e-3;
+            std::cout << "    " << std::left << std::setw(12) << mode.name << std::right << dedupedMeshes.size()
+                      << " unique meshes (expected " << mode.uniqueMeshCount << ")";
+            if (mode.transformed)
+            {
+                std::cout << std::scientific << std::setprecision(2) << ", max error: rotation " << errors[0]
+                          << " rad, scale " << errors[1] << ", translation " << errors[2] << std::defaultfloat;
+            }
+            std::cout << (valid ? "" : "  MISMATCH") << std::endl;
+            if (!valid)
+            {
+                exitCode = -1;
+            }
+        }
+        return exitCode;
+    }
+
+    // meshCount meshes in groups of 4: a sphere with one of 16 triangle orders,
+    // stretched along x and y differently for every group (thousands of meshes
+    // share a hash without float data), its exact copy, perturbed copy and
+    // transformed copy
+    int benchmarkInstancing(const std::vector<std::string> &args)
+    {
+        uint32_t meshCount = args.size() > 0 ? std::stoul(args[0]) : 100000;
+        uint32_t cornerCount = args.size() > 1 ? std::stoul(args[1]) : 200;
+        uint64_t checkCornerCount = args.size() > 2 ? std::stoull(args[2]) : 40000;
+        ThreadPool threadPool(0);
+        if (checkInstancing(checkCornerCount, threadPool) != 0)
+        {
+            return -1;
+        }
+
+        const float tolerance = 1.0e-3f;
+        const uint32_t orderCount = 16;
+        const uint32_t groupCount = std::max(1u, meshCount / 4);
+        const uint32_t stretchSteps = static_cast<uint32_t>(std::ceil(std::sqrt(double(groupCount) / orderCount)));
+        std::mt19937 random(2);
+        ImportSettings settings;
+        RawMesh rawMesh;
+        generateRawMesh("sphere", cornerCount, rawMesh);
+        std::vector<StreamMesh> spheres(orderCount, convertRawMesh(rawMesh, settings));
+        for (uint32_t orderIndex = 0; orderIndex < orderCount; ++orderIndex)
+        {
+            for (auto &stream : spheres[orderIndex].streams)
+            {
+                if (stream.attributeType == static_cast<uint32_t>(AttributeType::Index) && !stream.data.empty())
+                {
+                    size_t shift = (size_t(orderIndex) * 3 * stream.elementSize) % stream.data.size();
+                    std::rotate(stream.data.begin(), stream.data.begin() + shift, stream.data.end());
+                }
+            }
+        }
+        std::vector<StreamMesh> meshes;
+        meshes.reserve(size_t(groupCount) * 4);
+        for (uint32_t groupIndex = 0; groupIndex < groupCount; ++groupIndex)
+        {
+            uint32_t stretchIndex = groupIndex / orderCount;
+            double stretch[2] = { 1.0 + double(stretchIndex % stretchSteps) / stretchSteps,
+                                  1.0 + double(stretchIndex / stretchSteps) / stretchSteps };
+            StreamMesh mesh = spheres[groupIndex % orderCount];
+            transformMeshVectors(mesh, [&stretch](double position[3])
+            {
+                position[0] *= stretch[0];
+                position[1] *= stretch[1];
+            }, [](double *) {});
+            meshes.push_back(mesh);
+            meshes.push_back(mesh);
+            meshes.push_back(mesh);
+            perturbPositions(meshes.back(), 1.0e-6, random);
+            meshes.push_back(std::move(mesh));
+            applyTransform(getRandomTransform(random), meshes.back());
+        }
+
+        const InstancingMode modes[] = {
+            { "exact", 0.0f, false, 3 * groupCount },
+            { "tolerance", tolerance, false, 2 * groupCount },
+            { "transformed", tolerance, true, groupCount },
+        };
+        std::cout << meshes.size() << " meshes of " << rawMesh.polygonVertices.size() << " corners, "
+                  << ThreadPool::resolveThreadCount(0) << " threads" << std::endl;
+        int exitCode = 0;
+        for (const auto &mode : modes)
+        {
+            std::vector<StreamMesh> dedupedMeshes = meshes;
+            std::vector<InstanceTransform> transforms;
+            auto start = BenchmarkClock::now();
+            deduplicateInstances(dedupedMeshes, mode.tolerance, mode.transformed, threadPool, transforms);
+            double time = millisecondsSince(start);
+            bool valid = dedupedMeshes.size() == mode.uniqueMeshCount;
+            std::cout << "    " << std::left << std::setw(12) << mode.name << std::right << std::setw(8)
+                      << dedupedMeshes.size() << " unique meshes (expected " << mode.uniqueMeshCount << ")   "
+                      << std::fixed << std::setprecision(1) << time << " ms" << std::defaultfloat
+                      << (valid ? "" : "  MISMATCH") << std::endl;
+            if (!valid)
+            {
+                exitCode = -1;
+            }
+        }
+        return exitCode;
+    }
+
+    struct BenchmarkEntry
+    {
+        const char *name;
+        const char *description;
+        int(*function)(const std::vector<std::string> &args);
+    };
+
+    const BenchmarkEntry benchmarks[] = {
+        { "weld", "vertex deduplication: std::map vs hash table. args: corner counts", benchmarkWeld },
+        { "read", "open and validate .msh files with MeshFileReader. args: mesh count, corners per mesh", benchmarkRead },
+        { "write", "write .msh files: per field ofstream vs single write vs direct I/O. args: mesh count, corners per mesh", benchmarkWrite },
+        { "vcache", "vertex cache triangle reordering and vertex fetch reordering. args: corner counts", benchmarkVertexCache },
+        { "overdraw", "triangle cluster sorting for overdraw on a torus. args: ACMR thresholds", benchmarkOverdraw },
+        { "meshlets", "meshlet building and bounds on a grid. args: corner counts", benchmarkMeshlets },
+        { "encoding", "quantized positions, octahedral normals/tangents, half UVs: size and max errors. args: corner counts", benchmarkEncoding },
+        { "layout", "CPU reads of separate vs interleaved vertex streams. args: corner counts", benchmarkLayout },
+        { "packing", "gather and convert kernels of vertex streams: scalar vs SSE2 vs AVX2. args: vertex counts", benchmarkPacking },
+        { "merge", "merge of vertices with similar normals, checked against original algorithm. args: corner counts", benchmarkMerge },
+        { "instancing", "deduplication of exact, perturbed by 1e-6 and rotated/scaled/translated copies: unique counts, recovered transforms, time. args: mesh count, corners per mesh, corners of checked mesh", benchmarkInstancing },
+        { "compression", "LZ4 and shuffle/delta filters of .msh streams: ratio, compress and decode speed. args: grid|sphere|cad, corner counts", benchmarkCompression },
+        { "core", "whole conversion of generated meshes without FBX SDK, per-phase throughput. args: grid|sphere|cad, corner counts", benchmarkCore },
+        { "fbxload", "load binary FBX up to polygon walk: native reader vs FBX SDK, time and peak RSS growth. args: FBX files, native|sdk, thread count", benchmarkFBXLoad },
+        { "daemon", "single file latency: new process per file vs warm --serve process. args: socket, FBX file, output path, runs, cold command line", benchmarkDaemon },
+    };
+}
+
+int runBenchmark(const std::string &name, const std::vector<std::string> &args)
+{
+    for (const auto &benchmark : benchmarks)
+    {
+        if (name == benchmark.name)
+        {
+            return benchmark.function(args);
+        }
+    }
+    std::cout << "Available benchmarks:" << std::endl;
+    for (const auto &benchmark : benchmarks)
+    {
+        std::cout << "    " << benchmark.name << " - " << benchmark.description << std::endl;
+    }
+    return name.empty() ? 0 : -1;
+}
@@ -0,0 +1,13 @@
+//-----------------------------------------------------------------------------
+// Benchmark.h
+// Created at 2026.10.17 10:40
+// License: see LICENSE file
+//
+// built-in benchmarks of mesh processing steps on synthetic data
+// command line: ConvertFBXtoSMSH --benchmark <name> [args]
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+
+// runs benchmark by name, returns process exit code
+int runBenchmark(const std::string &name, const std::vector<std::string> &args);
@@ -0,0 +1,22 @@
+//-----------------------------------------------------------------------------
+// BenchmarkMain.cpp
+// Created at 2026.10.17 19:20
+// License: see LICENSE file
+//
+// entry point of ConvertFBXtoSMSHBench, benchmark executable which doesn't
+// need FBX SDK: ConvertFBXtoSMSHBench <name> [args]
+//-----------------------------------------------------------------------------
+#include "stdafx.h"
+
+#include "Benchmark.h"
+
+int main(int argc, char* argv[])
+{
+    std::string benchmarkName = argc >= 2 ? argv[1] : "";
+    std::vector<std::string> benchmarkArgs;
+    for (int argIndex = 2; argIndex < argc; ++argIndex)
+    {
+        benchmarkArgs.push_back(argv[argIndex]);
+    }
+    return runBenchmark(benchmarkName, benchmarkArgs);
+}
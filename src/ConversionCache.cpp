@@ -0,0 +1,392 @@
+//-----------------------------------------------------------------------------
+// ConversionCache.cpp
+// Created at 2026.10.17 20:40
+// License: see LICENSE file
+//
+// content-addressed cache of conversion outputs (--cache): every entry is a
+// directory named by key with output files and entry.json, last use time is
+// modification time of entry.json
+//-----------------------------------------------------------------------------
+#include "ConversionCache.h"
+
+#include <chrono>
+#include <ctime>
+#include <random>
+
+#include "Hash.h"
+#include "MeshReader.h"
+
+namespace name_fs = std::experimental::filesystem;
+
+namespace
+{
+    const char EntryFileName[] = "entry.json";
+    const char LogFileName[] = "cache.log";
+    const char TemporarySuffix[] = ".tmp";
+    // unfinished entries of crashed runs are removed after that
+    const double StaleTemporarySeconds = 3600.0;
+    const double SecondsPerDay = 86400.0;
+
+    struct EntryInfo
+    {
+        name_fs::path path;
+        double ageSeconds = 0.0; // since last use
+        uint64_t byteCount = 0;
+    };
+
+    // cache directory can have other files, only key directories are entries
+    bool isKeyName(const std::string &name)
+    {
+        const size_t keyLength = 32;
+        return name.size() >= keyLength && std::all_of(name.begin(), name.begin() + keyLength, [](char c)
+        {
+            return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+        });
+    }
+
+    double getAgeSeconds(const name_fs::path &path)
+    {
+        std::error_code errorCode;
+        auto writeTime = name_fs::last_write_time(path, errorCode);
+        if (errorCode)
+        {
+            return 0.0;
+        }
+        return std::chrono::duration<double>(name_fs::file_time_type::clock::now() - writeTime).count();
+    }
+
+    bool readEntry(const name_fs::path &fileName, CacheEntry &entry)
+    {
+        std::ifstream ifEntry(fileName.u8string());
+        if (!ifEntry.is_open())
+        {
+            return false;
+        }
+        Json::CharReaderBuilder jsonBuilder;
+        Json::Value jsonRoot;
+        std::string errors;
+        if (!Json::parseFromStream(jsonBuilder, ifEntry, &jsonRoot, &errors) || !jsonRoot["files"].isArray())
+        {
+            return false;
+        }
+        entry.files.clear();
+        for (const auto &jFile : jsonRoot["files"])
+        {
+            entry.files.push_back(jFile.asString());
+        }
+        entry.byteCount = jsonRoot["bytes"].asUInt64();
+        entry.meshCount = jsonRoot["meshes"].asUInt64();
+        entry.triangleCount = jsonRoot["triangles"].asUInt64();
+        entry.vertexCount = jsonRoot["vertices"].asUInt64();
+        return true;
+    }
+
+    bool writeEntry(const name_fs::path &fileName, const CacheEntry &entry)
+    {
+        Json::Value jsonRoot;
+        Json::Value jFileArray(Json::arrayValue);
+        for (const auto &file : entry.files)
+        {
+            jFileArray.append(file);
+        }
+        jsonRoot["converterVersion"] = ConverterVersion;
+        jsonRoot["files"] = jFileArray;
+        jsonRoot["bytes"] = Json::UInt64(entry.byteCount);
+        jsonRoot["meshes"] = Json::UInt64(entry.meshCount);
+        jsonRoot["triangles"] = Json::UInt64(entry.triangleCount);
+        jsonRoot["vertices"] = Json::UInt64(entry.vertexCount);
+
+        std::ofstream ofEntry(fileName.u8string(), std::ios::out | std::ios::trunc);
+        if (!ofEntry.is_open())
+        {
+            return false;
+        }
+        Json::StreamWriterBuilder jsonBuilder;
+        std::unique_ptr<Json::StreamWriter> writer(jsonBuilder.newStreamWriter());
+        writer->write(jsonRoot, &ofEntry);
+        ofEntry << std::endl;
+        return ofEntry.good();
+    }
+
+    // entry file paths come from the cache directory, they must stay inside output directory
+    bool isSafeRelativePath(const std::string &path)
+    {
+        name_fs::path relativePath(path);
+        if (path.empty() || relativePath.is_absolute() || relativePath.has_root_name())
+        {
+            return false;
+        }
+        for (const auto &part : relativePath)
+        {
+            if (part == "..")
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // hard link, or copy when link can't be created (e.g. different file systems)
+    bool linkOrCopyFile(const name_fs::path &source, const name_fs::path &destination)
+    {
+        std::error_code errorCode;
+        name_fs::create_directories(destination.parent_path(), errorCode);
+        name_fs::remove(destination, errorCode);
+        errorCode.clear();
+        name_fs::create_hard_link(source, destination, errorCode);
+        if (errorCode)
+        {
+            errorCode.clear();
+            name_fs::copy_file(source, destination, name_fs::copy_options::overwrite_existing, errorCode);
+        }
+        return !errorCode;
+    }
+
+    // complete entries sorted from least recently used; stale temporary
+    // directories of crashed runs are removed
+    std::vector<EntryInfo> scanEntries(const name_fs::path &cacheDirectory)
+    {
+        std::vector<EntryInfo> entries;
+        std::error_code errorCode;
+        for (name_fs::directory_iterator iterator(cacheDirectory, errorCode), end; !errorCode && iterator != end;
+             iterator.increment(errorCode))
+        {
+            const name_fs::path &path = iterator->path();
+            if (!isKeyName(path.filename().u8string()) || !name_fs::is_directory(path, errorCode))
+            {
+                continue;
+            }
+            EntryInfo entryInfo;
+            entryInfo.path = path;
+            CacheEntry entry;
+            if (path.filename().u8string().find(TemporarySuffix) != std::string::npos ||
+                !readEntry(path / EntryFileName, entry))
+            {
+                if (getAgeSeconds(path) > StaleTemporarySeconds)
+                {
+                    std::error_code removeError;
+                    name_fs::remove_all(path, removeError);
+                }
+                continue;
+            }
+            entryInfo.ageSeconds = getAgeSeconds(path / EntryFileName);
+            entryInfo.byteCount = entry.byteCount;
+            entries.push_back(entryInfo);
+        }
+        std::sort(entries.begin(), entries.end(), [](const EntryInfo &left, const EntryInfo &right)
+        {
+            return left.ageSeconds > right.ageSeconds;
+        });
+        return entries;
+    }
+}
+
+std::string describeConversionSettings(const ImportSettings &settings, const MeshFileFormat &format,
+                                       const std::string &importerName)
+{
+    std::ostringstream description;
+    description << "converter " << ConverterVersion
+                << "\nimporter " << importerName
+                << "\nmeshVersion " << format.version
+                << "\nstreamAlignment " << format.streamAlignment
+                << "\ncompressionCodec " << static_cast<int>(format.compression.codec)
+                << "\ncompressionAutoFilter " << format.compression.autoFilter
+                << "\ncompressionFilter " << static_cast<int>(format.compression.filter)
+                << "\ncompressionMinSavingPercent " << format.compression.minSavingPercent
+                << "\nconvertPositionsToFloat32 " << settings.convertPositionsToFloat32
+                << "\npositionEncoding " << static_cast<int>(settings.positionEncoding)
+                << "\nnormalEncoding " << static_cast<int>(settings.normalEncoding)
+                << "\ntangentEncoding " << static_cast<int>(settings.tangentEncoding)
+                << "\nuvEncoding " << static_cast<int>(settings.uvEncoding)
+                << "\nvertexLayout " << static_cast<int>(settings.vertexLayout)
+                << "\nvertexStrideAlignment " << settings.vertexStrideAlignment
+                << "\nimportVertexColors " << settings.importVertexColors
+                << "\nimportUVs " << settings.importUVs
+                << "\nimportNormals " << settings.importNormals
+                << "\nmergeNormalThresholdAngle " << std::setprecision(9) << settings.mergeNormalThresholdAngle
+                << "\nimportTangents " << settings.importTangents
+                << "\nimportBinormals " << settings.importBinormals
+                << "\nvertexWeldMethod " << static_cast<int>(settings.vertexWeldMethod)
+                << "\nvertexCacheMethod " << static_cast<int>(settings.vertexCacheMethod)
+                << "\noverdrawThreshold " << settings.overdrawThreshold
+                << "\noptimizeVertexFetch " << settings.optimizeVertexFetch
+                << "\nmeshletMaxVertices " << settings.meshletMaxVertices
+                << "\nmeshletMaxTriangles " << settings.meshletMaxTriangles
+                << "\ndeduplicateMeshes " << settings.deduplicateMeshes
+                << "\ndeduplicateTolerance " << settings.deduplicateTolerance
+                << "\ndeduplicateTransformedMeshes " << settings.deduplicateTransformedMeshes
+                << "\ncompactSceneJson " << settings.compactSceneJson
+                << "\ntextureRelativePath " << settings.textureRelativePath << "\n";
+    return description.str();
+}
+
+std::string getCacheKey(const std::string &inputPath, const std::string &settingsDescription)
+{
+    MappedFile inputFile;
+    if (!inputFile.open(inputPath))
+    {
+        return std::string();
+    }
+    uint64_t contentHash = hash64(inputFile.data(), inputFile.size());
+    uint64_t settingsHash = hash64(settingsDescription.data(), settingsDescription.size());
+    return hashToHexString(contentHash) + hashToHexString(settingsHash);
+}
+
+bool restoreFromCache(const std::string &cacheDirectory, const std::string &key, const std::string &outputPath,
+                      CacheEntry &entry)
+{
+    name_fs::path entryPath = name_fs::path(cacheDirectory) / key;
+    if (!readEntry(entryPath / EntryFileName, entry))
+    {
+        return false;
+    }
+    for (const auto &file : entry.files)
+    {
+        if (!isSafeRelativePath(file) || !linkOrCopyFile(entryPath / file, name_fs::path(outputPath) / file))
+        {
+            return false;
+        }
+    }
+    // modification time of entry file is last use time for eviction
+    std::error_code errorCode;
+    name_fs::last_write_time(entryPath / EntryFileName, name_fs::file_time_type::clock::now(), errorCode);
+    return true;
+}
+
+bool storeInCache(const std::string &cacheDirectory, const std::string &key, const std::string &outputPath,
+                  CacheEntry &entry)
+{
+    name_fs::path entryPath = name_fs::path(cacheDirectory) / key;
+    std::error_code errorCode;
+    if (name_fs::exists(entryPath / EntryFileName, errorCode))
+    {
+        return true;
+    }
+    // files go to a unique temporary directory which is renamed when complete
+    std::random_device randomDevice;
+    name_fs::path temporaryPath = name_fs::path(cacheDirectory) /
+        (key + TemporarySuffix + hashToHexString((uint64_t(randomDevice()) << 32) | randomDevice()));
+    name_fs::create_directories(temporaryPath, errorCode);
+    if (errorCode)
+    {
+        return false;
+    }
+    bool success = true;
+    entry.byteCount = 0;
+    for (const auto &file : entry.files)
+    {
+        name_fs::path sourcePath = name_fs::path(outputPath) / file;
+        uint64_t fileSize = name_fs::file_size(sourcePath, errorCode);
+        if (errorCode || !isSafeRelativePath(file) || !linkOrCopyFile(sourcePath, temporaryPath / file))
+        {
+            success = false;
+            break;
+        }
+        entry.byteCount += fileSize;
+    }
+    success = success && writeEntry(temporaryPath / EntryFileName, entry);
+    if (success)
+    {
+        name_fs::rename(temporaryPath, entryPath, errorCode);
+        // another run could store the same key first
+        success = !errorCode || name_fs::exists(entryPath / EntryFileName);
+    }
+    if (name_fs::exists(temporaryPath))
+    {
+        name_fs::remove_all(temporaryPath, errorCode);
+    }
+    return success;
+}
+
+void detachCachedOutputs(const std::string &outputPath)
+{
+    std::error_code errorCode;
+    for (name_fs::recursive_directory_iterator iterator(outputPath, errorCode), end; !errorCode && iterator != end;
+         iterator.increment(errorCode))
+    {
+        const name_fs::path &path = iterator->path();
+        if ((path.extension() == ".msh" || path.filename() == "scene.json") &&
+            name_fs::is_regular_file(path, errorCode) && name_fs::hard_link_count(path, errorCode) > 1)
+        {
+            std::error_code removeError;
+            name_fs::remove(path, removeError);
+        }
+    }
+}
+
+CacheEvictionResult evictCacheEntries(const std::string &cacheDirectory, uint64_t maxByteCount, double maxAgeDays)
+{
+    CacheEvictionResult result;
+    std::vector<EntryInfo> entries = scanEntries(cacheDirectory);
+    for (const auto &entryInfo : entries)
+    {
+        result.byteCount += entryInfo.byteCount;
+    }
+    // entries are sorted from least recently used, so both limits remove from the front
+    size_t removedCount = 0;
+    for (; removedCount < entries.size(); ++removedCount)
+    {
+        const auto &entryInfo = entries[removedCount];
+        bool tooOld = maxAgeDays > 0.0 && entryInfo.ageSeconds > maxAgeDays * SecondsPerDay;
+        bool tooLarge = maxByteCount > 0 && result.byteCount > maxByteCount;
+        if (!tooOld && !tooLarge)
+        {
+            break;
+        }
+        std::error_code errorCode;
+        name_fs::remove_all(entryInfo.path, errorCode);
+        result.byteCount -= entryInfo.byteCount;
+        result.removedByteCount += entryInfo.byteCount;
+        ++result.removedEntryCount;
+    }
+    result.entryCount = static_cast<uint32_t>(entries.size() - removedCount);
+    return result;
+}
+
+void logCacheResult(const std::string &cacheDirectory, const std::string &key, bool hit, double seconds,
+                    uint64_t byteCount)
+{
+    // every line is appended with one write, concurrent runs don't mix their lines
+    std::ostringstream line;
+    line << std::time(nullptr) << " " << (hit ? "hit" : "miss") << " " << key << " "
+         << std::fixed << std::setprecision(6) << seconds << " " << byteCount << "\n";
+    std::ofstream ofLog((name_fs::path(cacheDirectory) / LogFileName).u8string(), std::ios::out | std::ios::app);
+    ofLog << line.str();
+}
+
+CacheStats getCacheStats(const std::string &cacheDirectory)
+{
+    CacheStats stats;
+    std::ifstream ifLog((name_fs::path(cacheDirectory) / LogFileName).u8string());
+    std::string line;
+    while (std::getline(ifLog, line))
+    {
+        std::istringstream fields(line);
+        uint64_t time = 0;
+        std::string result;
+        std::string key;
+        double seconds = 0.0;
+        uint64_t byteCount = 0;
+        if (!(fields >> time >> result >> key >> seconds >> byteCount))
+        {
+            continue;
+        }
+        if (result == "hit")
+        {
+            ++stats.hitCount;
+            stats.hitSeconds += seconds;
+            stats.reusedByteCount += byteCount;
+        }
+        else
+        {
+            ++stats.missCount;
+            stats.missSeconds += seconds;
+        }
+    }
+    for (const auto &entryInfo : scanEntries(cacheDirectory))
+    {
+        ++stats.entryCount;
+        stats.byteCount += entryInfo.byteCount;
+    }
+    return stats;
+}
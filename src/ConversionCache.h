@@ -0,0 +1,77 @@
+//-----------------------------------------------------------------------------
+// ConversionCache.h
+// Created at 2026.10.17 20:40
+// License: see LICENSE file
+//
+// content-addressed cache of conversion outputs (--cache): key is hash of
+// input file bytes, output-affecting settings and converter version. On a hit
+// .msh files and scene.json are hard-linked (or copied) from the cache, so
+// FBX file isn't loaded at all
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+
+#include "ImportFBX.h"
+#include "ExportMesh.h"
+
+// bump when output of the same input and settings changes, invalidates all cache entries
+const uint32_t ConverterVersion = 1;
+
+// outputs of one conversion, file paths are relative to the output directory
+struct CacheEntry
+{
+    std::vector<std::string> files;
+    uint64_t byteCount = 0;
+    uint64_t meshCount = 0;
+    uint64_t triangleCount = 0;
+    uint64_t vertexCount = 0;
+};
+
+struct CacheEvictionResult
+{
+    uint32_t removedEntryCount = 0;
+    uint64_t removedByteCount = 0;
+    uint32_t entryCount = 0; // entries left
+    uint64_t byteCount = 0;
+};
+
+// summary of cache log and current entries
+struct CacheStats
+{
+    uint64_t hitCount = 0;
+    uint64_t missCount = 0;
+    uint64_t reusedByteCount = 0; // bytes of outputs restored on hits
+    double hitSeconds = 0.0;      // summed run times of hits and misses
+    double missSeconds = 0.0;
+    uint32_t entryCount = 0;
+    uint64_t byteCount = 0;
+};
+
+// canonical text of settings which change output files. Thread counts,
+// direct I/O and SIMD level don't change them and aren't included
+std::string describeConversionSettings(const ImportSettings &settings, const MeshFileFormat &format,
+                                       const std::string &importerName);
+// 32 hex digits: hash of input file bytes and hash of settings description
+// with converter version. Empty when the input file can't be read
+std::string getCacheKey(const std::string &inputPath, const std::string &settingsDescription);
+
+// links (or copies) entry files into outputPath. Returns false on a miss
+// or when the entry can't be restored completely
+bool restoreFromCache(const std::string &cacheDirectory, const std::string &key, const std::string &outputPath,
+                      CacheEntry &entry);
+// adds entry files from outputPath to the cache. Entry appears atomically,
+// concurrent runs storing the same key keep the first entry
+bool storeInCache(const std::string &cacheDirectory, const std::string &key, const std::string &outputPath,
+                  CacheEntry &entry);
+// output files which share data with cache entries (hard links) are removed
+// before conversion overwrites them, otherwise the cached copy would change too
+void detachCachedOutputs(const std::string &outputPath);
+
+// removes entries not used for maxAgeDays, then least recently used entries
+// until cache size is within maxByteCount. Zero disables a limit
+CacheEvictionResult evictCacheEntries(const std::string &cacheDirectory, uint64_t maxByteCount, double maxAgeDays);
+
+// one line per run in cache.log of the cache directory
+void logCacheResult(const std::string &cacheDirectory, const std::string &key, bool hit, double seconds,
+                    uint64_t byteCount);
+CacheStats getCacheStats(const std::string &cacheDirectory);
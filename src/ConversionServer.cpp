@@ -0,0 +1,442 @@
+//-----------------------------------------------------------------------------
+// ConversionServer.cpp
+// Created at 2026.10.17 22:40
+// License: see LICENSE file
+//
+// server mode (--serve): long-lived process which accepts conversion requests
+// on a local (Unix domain) socket, and the client side of its protocol
+//-----------------------------------------------------------------------------
+#include "ConversionServer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <thread>
+
+#include "Trace.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <afunix.h> // AF_UNIX sockets, Windows 10 1803 and later
+#else
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace name_fs = std::experimental::filesystem;
+
+namespace
+{
+#ifdef _WIN32
+    using SocketHandle = SOCKET;
+    const SocketHandle InvalidSocket = INVALID_SOCKET;
+    const int ShutdownRead = SD_RECEIVE;
+#else
+    using SocketHandle = int;
+    const SocketHandle InvalidSocket = -1;
+    const int ShutdownRead = SHUT_RD;
+#endif
+    // requests are small, longer lines are a protocol error
+    const size_t MaxMessageSize = 16 * 1024 * 1024;
+    const size_t ReceiveChunkSize = 64 * 1024;
+    // failed accept (e.g. out of file descriptors) is retried after a growing pause,
+    // the server stops when it keeps failing
+    const uint32_t MaxAcceptRetryMilliseconds = 1000;
+    const uint32_t MaxConsecutiveAcceptFailures = 100;
+
+    // initializes socket library for the lifetime of the object
+    class SocketLibrary
+    {
+    public:
+        SocketLibrary()
+        {
+#ifdef _WIN32
+            WSADATA data;
+            _initialized = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+#else
+            signal(SIGPIPE, SIG_IGN); // a client can disconnect before its result is sent
+            _initialized = true;
+#endif
+        }
+
+        ~SocketLibrary()
+        {
+#ifdef _WIN32
+            if (_initialized)
+            {
+                WSACleanup();
+            }
+#endif
+        }
+
+        inline bool initialized() const { return _initialized; }
+
+    private:
+        bool _initialized;
+    };
+
+    void closeSocket(SocketHandle socketHandle)
+    {
+#ifdef _WIN32
+        closesocket(socketHandle);
+#else
+        close(socketHandle);
+#endif
+    }
+
+    bool makeAddress(const std::string &socketPath, sockaddr_un &address)
+    {
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path))
+        {
+            return false;
+        }
+        memcpy(address.sun_path, socketPath.c_str(), socketPath.size());
+        return true;
+    }
+
+    SocketHandle connectSocket(const std::string &socketPath)
+    {
+        sockaddr_un address;
+        if (!makeAddress(socketPath, address))
+        {
+            return InvalidSocket;
+        }
+        SocketHandle socketHandle = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (socketHandle == InvalidSocket)
+        {
+            return InvalidSocket;
+        }
+        if (connect(socketHandle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            closeSocket(socketHandle);
+            return InvalidSocket;
+        }
+        return socketHandle;
+    }
+
+    bool sendAll(SocketHandle socketHandle, const std::string &data)
+    {
+        size_t offset = 0;
+        while (offset < data.size())
+        {
+            int chunkSize = static_cast<int>(std::min<size_t>(data.size() - offset, ReceiveChunkSize));
+            auto sentSize = send(socketHandle, data.data() + offset, chunkSize, 0);
+            if (sentSize <= 0)
+            {
+                return false;
+            }
+            offset += static_cast<size_t>(sentSize);
+        }
+        return true;
+    }
+
+    // splits received bytes into newline-terminated messages
+    class LineReader
+    {
+    public:
+        explicit LineReader(SocketHandle socketHandle)
+            : _socket(socketHandle)
+        {
+        }
+
+        // false when the connection is closed or the line is too long
+        bool readLine(std::string &line)
+        {
+            for (;;)
+            {
+                size_t lineEnd = _buffer.find('\n', _scanOffset);
+                if (lineEnd != std::string::npos)
+                {
+                    line.assign(_buffer, 0, lineEnd);
+                    _buffer.erase(0, lineEnd + 1);
+                    _scanOffset = 0;
+                    return true;
+                }
+                _scanOffset = _buffer.size();
+                if (_buffer.size() > MaxMessageSize)
+                {
+                    return false;
+                }
+                char chunk[ReceiveChunkSize];
+                auto receivedSize = recv(_socket, chunk, static_cast<int>(sizeof(chunk)), 0);
+                if (receivedSize <= 0)
+                {
+                    return false;
+                }
+                _buffer.append(chunk, static_cast<size_t>(receivedSize));
+            }
+        }
+
+    private:
+        SocketHandle _socket;
+        std::string _buffer;
+        size_t _scanOffset = 0;
+    };
+
+    std::string toMessage(const Json::Value &value)
+    {
+        Json::StreamWriterBuilder jsonBuilder;
+        jsonBuilder["indentation"] = "";
+        return Json::writeString(jsonBuilder, value) + "\n";
+    }
+
+    bool parseMessage(const std::string &line, Json::Value &value)
+    {
+        Json::CharReaderBuilder jsonBuilder;
+        std::unique_ptr<Json::CharReader> reader(jsonBuilder.newCharReader());
+        std::string errors;
+        return reader->parse(line.data(), line.data() + line.size(), &value, &errors) && value.isObject();
+    }
+
+    struct Connection
+    {
+        std::thread thread;
+        std::atomic<bool> done{ false };
+    };
+}
+
+Json::Value makeServerError(const std::string &error)
+{
+    Json::Value result;
+    result["event"] = "result";
+    result["success"] = false;
+    result["error"] = error;
+    return result;
+}
+
+ServerRunResult runConversionServer(const std::string &socketPath, const ServerRequestHandler &handler)
+{
+    ServerRunResult runResult;
+    SocketLibrary socketLibrary;
+    sockaddr_un address;
+    if (!socketLibrary.initialized() || !makeAddress(socketPath, address))
+    {
+        std::cout << "Invalid server socket path " << socketPath << std::endl;
+        return runResult;
+    }
+    SocketHandle probeSocket = connectSocket(socketPath);
+    if (probeSocket != InvalidSocket)
+    {
+        closeSocket(probeSocket);
+        std::cout << "Another server listens on " << socketPath << std::endl;
+        return runResult;
+    }
+    // socket file of a server which didn't exit cleanly
+    std::error_code errorCode;
+    if (name_fs::is_socket(name_fs::symlink_status(socketPath, errorCode)))
+    {
+        name_fs::remove(socketPath, errorCode);
+    }
+
+    SocketHandle listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenSocket == InvalidSocket)
+    {
+        std::cout << "Failed to create server socket" << std::endl;
+        return runResult;
+    }
+#ifndef _WIN32
+    // requests name any file, only the owner may send them. Socket file is created
+    // with owner-only permissions, chmod after bind would leave a window for others to connect
+    mode_t previousMask = umask(S_IRWXG | S_IRWXO);
+#endif
+    bool listening = bind(listenSocket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0 &&
+                     listen(listenSocket, SOMAXCONN) == 0;
+#ifndef _WIN32
+    umask(previousMask);
+#endif
+    if (!listening)
+    {
+        std::cout << "Failed to listen on " << socketPath << std::endl;
+        closeSocket(listenSocket);
+        return runResult;
+    }
+    std::cout << "Listening on " << socketPath << std::endl;
+
+    std::mutex connectionsMutex;
+    std::list<std::unique_ptr<Connection>> connections;
+    std::vector<SocketHandle> clientSockets;
+    std::atomic<bool> stopping(false);
+    std::atomic<uint64_t> requestCount(0);
+    std::atomic<uint64_t> failedRequestCount(0);
+    auto stop = [&]()
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        stopping = true;
+        // idle connections see end of input, running requests still send their results
+        for (auto clientSocket : clientSockets)
+        {
+            shutdown(clientSocket, ShutdownRead);
+        }
+        // wakes up accept
+        SocketHandle wakeSocket = connectSocket(socketPath);
+        if (wakeSocket != InvalidSocket)
+        {
+            closeSocket(wakeSocket);
+        }
+    };
+    auto serveConnection = [&](SocketHandle clientSocket, Connection *connection)
+    {
+        setTraceThreadName("connection");
+        std::mutex sendMutex;
+        ServerEventSink sendEvent = [clientSocket, &sendMutex](const Json::Value &event)
+        {
+            std::string message = toMessage(event);
+            std::lock_guard<std::mutex> lock(sendMutex);
+            sendAll(clientSocket, message);
+        };
+        LineReader reader(clientSocket);
+        std::string line;
+        while (reader.readLine(line))
+        {
+            Json::Value request;
+            Json::Value result;
+            bool parsed = parseMessage(line, request);
+            std::string command = parsed && request["command"].isString() ? request["command"].asString() : "";
+            if (!parsed)
+            {
+                result = makeServerError("request is not a JSON object");
+            }
+            else if (command == "ping" || command == "shutdown")
+            {
+                result["success"] = true;
+            }
+            else if (!command.empty())
+            {
+                result = makeServerError("unknown command " + command);
+            }
+            else
+            {
+                TraceZone requestZone("serverRequest");
+                try
+                {
+                    result = handler(request, sendEvent);
+                }
+                catch (const std::exception &exception)
+                {
+                    result = makeServerError(exception.what());
+                }
+                ++requestCount;
+                if (!result.get("success", false).asBool())
+                {
+                    ++failedRequestCount;
+                }
+            }
+            result["event"] = "result";
+            sendEvent(result);
+            if (command == "shutdown")
+            {
+                stop();
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            clientSockets.erase(std::find(clientSockets.begin(), clientSockets.end(), clientSocket));
+        }
+        closeSocket(clientSocket);
+        connection->done = true;
+    };
+
+    uint32_t acceptFailureCount = 0;
+    bool acceptFailed = false;
+    while (!stopping)
+    {
+        SocketHandle clientSocket = accept(listenSocket, nullptr, nullptr);
+        // threads of closed connections are joined here, not at exit
+        for (auto connectionIt = connections.begin(); connectionIt != connections.end();)
+        {
+            if ((*connectionIt)->done)
+            {
+                (*connectionIt)->thread.join();
+                connectionIt = connections.erase(connectionIt);
+            }
+            else
+            {
+                ++connectionIt;
+            }
+        }
+        if (clientSocket == InvalidSocket)
+        {
+            if (stopping)
+            {
+                break;
+            }
+            if (++acceptFailureCount >= MaxConsecutiveAcceptFailures)
+            {
+                std::cout << "Server stops, accepting connections keeps failing" << std::endl;
+                acceptFailed = true;
+                stop();
+                break;
+            }
+            uint32_t pause = std::min(MaxAcceptRetryMilliseconds, 10u << std::min(acceptFailureCount, 7u));
+            std::this_thread::sleep_for(std::chrono::milliseconds(pause));
+            continue;
+        }
+        acceptFailureCount = 0;
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        if (stopping)
+        {
+            closeSocket(clientSocket);
+            break;
+        }
+        clientSockets.push_back(clientSocket);
+        connections.push_back(std::unique_ptr<Connection>(new Connection()));
+        Connection *connection = connections.back().get();
+        connection->thread = std::thread(serveConnection, clientSocket, connection);
+    }
+    closeSocket(listenSocket);
+    for (auto &connection : connections)
+    {
+        connection->thread.join();
+    }
+    name_fs::remove(socketPath, errorCode);
+    runResult.success = !acceptFailed;
+    runResult.requestCount = requestCount;
+    runResult.failedRequestCount = failedRequestCount;
+    return runResult;
+}
+
+bool sendServerRequest(const std::string &socketPath, const Json::Value &request,
+                       const ServerEventSink &onEvent, Json::Value &result)
+{
+    SocketLibrary socketLibrary;
+    SocketHandle serverSocket = connectSocket(socketPath);
+    if (serverSocket == InvalidSocket)
+    {
+        return false;
+    }
+    bool received = false;
+    if (sendAll(serverSocket, toMessage(request)))
+    {
+        LineReader reader(serverSocket);
+        std::string line;
+        while (reader.readLine(line))
+        {
+            Json::Value message;
+            if (!parseMessage(line, message))
+            {
+                break;
+            }
+            if (message.get("event", "").asString() == "result")
+            {
+                result = message;
+                received = true;
+                break;
+            }
+            if (onEvent)
+            {
+                onEvent(message);
+            }
+        }
+    }
+    closeSocket(serverSocket);
+    return received;
+}
@@ -0,0 +1,46 @@
+//-----------------------------------------------------------------------------
+// ConversionServer.h
+// Created at 2026.10.17 22:40
+// License: see LICENSE file
+//
+// server mode (--serve): long-lived process which accepts conversion requests
+// on a local (Unix domain) socket, and the client side of its protocol
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+
+#include <functional>
+
+// Protocol: every message is one line of compact JSON. Client sends a request
+// {"input": "a.fbx", "output": "out/a", "options": ["--vertex-cache", "forsyth"]}
+// (options are command line conversion options applied on top of the options
+// server was started with), {"command": "ping"} or {"command": "shutdown"}.
+// Server answers with any number of {"event": "progress", "stage": ...}
+// messages and one {"event": "result", "success": ..., "error": ...} message.
+// A connection can send requests one after another
+
+// sends one message of a request to the client, can be called from any thread
+using ServerEventSink = std::function<void(const Json::Value &event)>;
+
+// handles one conversion request, returns its result message. Called from
+// connection threads at the same time
+using ServerRequestHandler = std::function<Json::Value(const Json::Value &request, const ServerEventSink &sendEvent)>;
+
+struct ServerRunResult
+{
+    bool success = false;
+    uint64_t requestCount = 0;
+    uint64_t failedRequestCount = 0;
+};
+
+// listens on socketPath until a shutdown request, every connection is served
+// on its own thread. Fails if another server listens on socketPath
+ServerRunResult runConversionServer(const std::string &socketPath, const ServerRequestHandler &handler);
+
+// sends request, calls onEvent for every progress message and returns
+// the result message in result. Returns false when server can't be reached
+bool sendServerRequest(const std::string &socketPath, const Json::Value &request,
+                       const ServerEventSink &onEvent, Json::Value &result);
+
+// result message with success false and the error
+Json::Value makeServerError(const std::string &error);
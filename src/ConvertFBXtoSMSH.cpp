@@ -3,76 +3,771 @@
 // Created at 2017.08.26 14:00
 // License: see LICENSE file
 //
-// command line: ConvertFBXtoSMSH importFile exportFile
+// command line: ConvertFBXtoSMSH [options] importFile exportFile
+//               ConvertFBXtoSMSH [options] --batch manifest
+//               ConvertFBXtoSMSH [options] --serve socket
+//               ConvertFBXtoSMSH --connect socket [options] importFile exportFile
+//               ConvertFBXtoSMSH --benchmark <name> [args]
 //-----------------------------------------------------------------------------
 #include "stdafx.h"
 
+#include "BatchConvert.h"
+#include "ConversionCache.h"
+#include "ConversionServer.h"
 #include "ImportFBX.h"
+#include "ImportFBXNative.h"
 #include "ExportMesh.h"
 #include "ExportScene.h"
+#include "PhaseStats.h"
+#include "ThreadPool.h"
 #include "Utils.h"
+#include "VertexPacking.h"
+#include "Benchmark.h"
+#include "Common.h"
+
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+#include <mutex>
 
 namespace name_fs = std::experimental::filesystem;
 
-int main(int argc, char* argv[])
+// write threads of one conversion, a server request can't ask for more
+static const uint32_t MaxIOThreads = 256;
+// padding before every stream of a mesh file, 64 KB covers page and sector sizes
+static const uint32_t MaxStreamAlignment = 65536;
+// padding of every interleaved vertex, larger values only waste memory
+static const uint32_t MaxVertexAlignment = 256;
+
+static void printUsage()
 {
-    // TODO: investigate how to use UTF-8/widechar paths in cross-platform way
-    //std::setlocale(LC_ALL, "en_US.utf8");
-    //std::locale utf8(std::locale(), ::new std::codecvt_utf8<char>);
-    //std::locale::global(utf8);//std::locale("en_US.utf8"));
-    //std::cout.imbue(std::locale());
+    std::cout << "<app_name> [options] importFile exportPath" << std::endl;
+    std::cout << "<app_name> [options] --batch manifest" << std::endl;
+    std::cout << "<app_name> [options] --serve socket" << std::endl;
+    std::cout << "<app_name> --connect socket [options] importFile exportPath" << std::endl;
+    std::cout << "<app_name> --benchmark <name> [args]" << std::endl;
+    std::cout << "options:" << std::endl;
+    std::cout << "    --threads N - mesh conversion threads, 0 - all hardware threads (default 1)" << std::endl;
+    std::cout << "    --io-threads N - max number of mesh files written at the same time, 1..256 (default 4)" << std::endl;
+    std::cout << "    --verbose - print write throughput of every mesh file" << std::endl;
+    std::cout << "    --pipeline - write every mesh as soon as it's converted instead of keeping all meshes in memory" << std::endl;
+    std::cout << "    --mesh-version 1|2|3 - .msh file layout version (default 2), version 3 can compress streams" << std::endl;
+    std::cout << "    --stream-alignment N - alignment of stream data in version 2 and 3 .msh files, power of two up to 65536 (default 64)" << std::endl;
+    std::cout << "    --compress none|lz4 - compress .msh streams, lz4 implies --mesh-version 3 (default none)" << std::endl;
+    std::cout << "    --compress-filter auto|none|shuffle|delta - byte transform before compression," << std::endl;
+    std::cout << "      auto keeps the smallest result for every stream (default auto)" << std::endl;
+    std::cout << "    --compress-min-saving P - streams which get less than P percent smaller stay" << std::endl;
+    std::cout << "      uncompressed and load in place (default 10)" << std::endl;
+    std::cout << "    --vertex-cache none|forsyth|tipsify - reorder triangles for GPU vertex cache (default none)" << std::endl;
+    std::cout << "    --overdraw T - sort triangle clusters front to back, T >= 1 is allowed ACMR ratio (e.g. 1.05)," << std::endl;
+    std::cout << "      T near 1 leaves few clusters; the input order is kept when sorting doesn't reduce overdraw" << std::endl;
+    std::cout << "    --vertex-fetch - sort vertices in order of first use in index stream" << std::endl;
+    std::cout << "    --meshlets - add meshlet streams, 64 vertices and 124 triangles per meshlet" << std::endl;
+    std::cout << "    --meshlet-vertices N, --meshlet-triangles N - meshlet limits, 3..256 vertices, 1..512 triangles" << std::endl;
+    std::cout << "    --position-encoding float|unorm16 - position stream encoding (default float)" << std::endl;
+    std::cout << "    --normal-encoding float32|oct16|oct8 - normal stream encoding (default float32)" << std::endl;
+    std::cout << "    --tangent-encoding float32|oct16|oct8 - tangent and binormal stream encoding (default float32)" << std::endl;
+    std::cout << "    --uv-encoding float32|half - UV stream encoding (default float32)" << std::endl;
+    std::cout << "    --vertex-layout separate|interleaved|split - stream per attribute, one interleaved stream," << std::endl;
+    std::cout << "      or position stream + interleaved other attributes (default separate)" << std::endl;
+    std::cout << "    --vertex-alignment N - interleaved vertex stride alignment, power of two up to 256 (default 4)" << std::endl;
+    std::cout << "    --simd scalar|sse2|avx2 - limit SIMD instructions of vertex conversion (default: best supported)" << std::endl;
+    std::cout << "    --importer sdk|native - read FBX with FBX SDK or with built-in binary FBX reader (default sdk)" << std::endl;
+    std::cout << "    --stats out.json - save wall/CPU time, peak RSS growth and item counts of conversion phases" << std::endl;
+    std::cout << "    --trace out.json - save timeline of conversion threads in Chrome trace format (ui.perfetto.dev)" << std::endl;
+    std::cout << "    --direct-io - write mesh files without OS file cache where supported" << std::endl;
+    std::cout << "    --max-meshes-in-flight N - meshes extracted but not converted/written yet, 0 - 2 * threads (default 0)" << std::endl;
+    std::cout << "    --dedupe-meshes - write identical meshes once, scene nodes share the mesh index" << std::endl;
+    std::cout << "    --dedupe-tolerance T - float stream values of identical meshes can differ by T (default 0)" << std::endl;
+    std::cout << "    --dedupe-transformed - also share meshes with baked rotation, translation and uniform scale" << std::endl;
+    std::cout << "    --cache DIR - reuse outputs of earlier runs with the same input file bytes and settings" << std::endl;
+    std::cout << "    --cache-max-size MB, --cache-max-age DAYS - evict least recently used cache entries (default no limit)" << std::endl;
+    std::cout << "    --cache-stats - print cache hit/miss statistics, works without input and output" << std::endl;
+    std::cout << "    --batch manifest - convert all input/output pairs of JSON or text manifest in one process" << std::endl;
+    std::cout << "    --batch-jobs N - files converted at the same time in batch mode (default 2)" << std::endl;
+    std::cout << "    --batch-summary out.json - save per-file timings and errors of batch mode" << std::endl;
+    std::cout << "    --serve socket - keep FBX SDK and threads warm and convert requests sent to local socket" << std::endl;
+    std::cout << "    --connect socket - send conversion to server, options are applied on top of server options" << std::endl;
+    std::cout << "    --shutdown - with --connect, stop the server after its running requests" << std::endl;
+}
 
-    if (argc < 3)
+static bool createDirectories(const name_fs::path &path)
+{
+    std::error_code errorCode;
+    if (!name_fs::exists(path))
     {
-        std::cout << "<app_name> importFile exportPath" << std::endl;
-        return -1;
+        name_fs::create_directories(path, errorCode);
+        if (errorCode)
+        {
+            std::cout << "Error creating directories at path " << path << ": " << errorCode.message() << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static void printMeshWriteReport(const std::vector<MeshWriteResult> &writeResults, double wallSeconds, bool verbose)
+{
+    const double megabyte = 1024.0 * 1024.0;
+    uint64_t totalBytes = 0;
+    std::vector<double> fileThroughputs;
+    for (const auto &writeResult : writeResults)
+    {
+        double throughput = writeResult.seconds > 0.0 ? writeResult.byteCount / megabyte / writeResult.seconds : 0.0;
+        totalBytes += writeResult.byteCount;
+        fileThroughputs.push_back(throughput);
+        if (verbose)
+        {
+            std::cout << writeResult.fileName << ": " << writeResult.byteCount << " bytes, "
+                      << std::fixed << std::setprecision(3) << writeResult.seconds * 1000.0 << " ms, "
+                      << std::setprecision(1) << throughput << " MB/s" << std::endl;
+        }
+    }
+    if (writeResults.empty())
+    {
+        return;
+    }
+    std::sort(fileThroughputs.begin(), fileThroughputs.end());
+    std::cout << "Mesh files written: " << writeResults.size() << ", "
+              << std::fixed << std::setprecision(1) << totalBytes / megabyte << " MB in "
+              << std::setprecision(3) << wallSeconds << " s, "
+              << std::setprecision(1) << (wallSeconds > 0.0 ? totalBytes / megabyte / wallSeconds : 0.0) << " MB/s total; "
+              << "per file MB/s min " << fileThroughputs.front()
+              << ", median " << fileThroughputs[fileThroughputs.size() / 2]
+              << ", max " << fileThroughputs.back() << std::endl;
+}
+
+static void printMeshOptimizationReport(const std::vector<MeshConvertStats> &meshStats, bool verbose)
+{
+    VertexCacheStats totalBefore;
+    VertexCacheStats totalAfter;
+    VertexFetchStats totalFetchBefore;
+    VertexFetchStats totalFetchAfter;
+    OverdrawStats totalOverdrawBefore;
+    OverdrawStats totalOverdrawAfter;
+    for (size_t meshIndex = 0; meshIndex < meshStats.size(); ++meshIndex)
+    {
+        const auto &before = meshStats[meshIndex].vertexCacheBefore;
+        const auto &after = meshStats[meshIndex].vertexCacheAfter;
+        if (verbose)
+        {
+            std::cout << "mesh " << meshIndex << ": " << before.triangleCount << " triangles, "
+                      << std::fixed << std::setprecision(3)
+                      << "ACMR " << before.acmr() << " -> " << after.acmr() << ", "
+                      << "ATVR " << before.atvr() << " -> " << after.atvr() << ", "
+                      << "overfetch " << meshStats[meshIndex].vertexFetchBefore.overfetch()
+                      << " -> " << meshStats[meshIndex].vertexFetchAfter.overfetch() << ", "
+                      << "overdraw " << meshStats[meshIndex].overdrawBefore.overdraw()
+                      << " -> " << meshStats[meshIndex].overdrawAfter.overdraw() << std::endl;
+        }
+        totalBefore.triangleCount += before.triangleCount;
+        totalBefore.vertexCount += before.vertexCount;
+        totalBefore.transformCount += before.transformCount;
+        totalAfter.triangleCount += after.triangleCount;
+        totalAfter.vertexCount += after.vertexCount;
+        totalAfter.transformCount += after.transformCount;
+        totalFetchBefore.bytesFetched += meshStats[meshIndex].vertexFetchBefore.bytesFetched;
+        totalFetchBefore.vertexBytes += meshStats[meshIndex].vertexFetchBefore.vertexBytes;
+        totalFetchAfter.bytesFetched += meshStats[meshIndex].vertexFetchAfter.bytesFetched;
+        totalFetchAfter.vertexBytes += meshStats[meshIndex].vertexFetchAfter.vertexBytes;
+        totalOverdrawBefore.pixelsCovered += meshStats[meshIndex].overdrawBefore.pixelsCovered;
+        totalOverdrawBefore.pixelsShaded += meshStats[meshIndex].overdrawBefore.pixelsShaded;
+        totalOverdrawAfter.pixelsCovered += meshStats[meshIndex].overdrawAfter.pixelsCovered;
+        totalOverdrawAfter.pixelsShaded += meshStats[meshIndex].overdrawAfter.pixelsShaded;
+    }
+    std::cout << "Vertex cache (FIFO " << DefaultVertexCacheSize << "): "
+              << std::fixed << std::setprecision(3)
+              << "ACMR " << totalBefore.acmr() << " -> " << totalAfter.acmr() << ", "
+              << "ATVR " << totalBefore.atvr() << " -> " << totalAfter.atvr() << ", "
+              << "vertex shader invocations " << totalBefore.transformCount << " -> " << totalAfter.transformCount << std::endl;
+    std::cout << "Vertex fetch (positions, " << VertexFetchCacheSize / 1024 << " KB cache): "
+              << "overfetch " << totalFetchBefore.overfetch() << " -> " << totalFetchAfter.overfetch() << ", "
+              << "MB fetched " << totalFetchBefore.bytesFetched / (1024.0 * 1024.0)
+              << " -> " << totalFetchAfter.bytesFetched / (1024.0 * 1024.0) << std::endl;
+    uint32_t meshletCount = 0;
+    uint64_t meshletVertexCount = 0;
+    for (const auto &stats : meshStats)
+    {
+        meshletCount += stats.meshletCount;
+        meshletVertexCount += stats.meshletVertexCount;
+    }
+    if (meshletCount > 0)
+    {
+        std::cout << "Meshlets: " << meshletCount << ", " << std::setprecision(1)
+                  << double(meshletVertexCount) / meshletCount << " vertices and "
+                  << double(totalAfter.triangleCount) / meshletCount << " triangles per meshlet, "
+                  << std::setprecision(3) << double(meshletVertexCount) / std::max(1u, totalAfter.vertexCount)
+                  << " meshlet vertices per vertex" << std::endl;
+    }
+    if (totalOverdrawBefore.pixelsCovered > 0)
+    {
+        std::cout << "Overdraw (6 views, " << OverdrawViewportSize << "x" << OverdrawViewportSize << "): "
+                  << totalOverdrawBefore.overdraw() << " -> " << totalOverdrawAfter.overdraw() << std::endl;
+    }
+}
+
+static void printEncodingError(const char *name, const EncodingError &error, double unitScale, const char *unit)
+{
+    if (error.valueCount == 0)
+    {
+        return;
+    }
+    std::cout << name << ": max error " << std::setprecision(6) << error.maxError * unitScale << unit
+              << ", max bound " << error.maxBound * unitScale << unit
+              << ", max error/bound " << std::setprecision(3) << error.maxBoundRatio << std::endl;
+    if (!error.withinBounds())
+    {
+        std::cout << "Warning: " << name << " encoding error exceeds its bound" << std::endl;
+    }
+}
+
+static void printEncodingReport(const std::vector<MeshConvertStats> &meshStats)
+{
+    EncodingError positionError;
+    EncodingError normalError;
+    EncodingError tangentError;
+    EncodingError uvError;
+    for (const auto &stats : meshStats)
+    {
+        positionError.merge(stats.positionError);
+        normalError.merge(stats.normalError);
+        tangentError.merge(stats.tangentError);
+        uvError.merge(stats.uvError);
+    }
+    const double degreesPerRadian = 180.0 / Pi;
+    std::cout << std::fixed;
+    printEncodingError("Positions", positionError, 1.0, "");
+    printEncodingError("Normals", normalError, degreesPerRadian, " deg");
+    printEncodingError("Tangents", tangentError, degreesPerRadian, " deg");
+    printEncodingError("UVs", uvError, 1.0, "");
+}
+
+static void printInstancingReport(const InstancingStats &stats, bool transformed,
+                                  const std::vector<MeshWriteResult> &writeResults, double writeSeconds)
+{
+    const double megabyte = 1024.0 * 1024.0;
+    uint64_t writtenBytes = 0;
+    for (const auto &writeResult : writeResults)
+    {
+        writtenBytes += writeResult.byteCount;
     }
+    std::cout << "Instancing: " << stats.meshCount << " meshes -> " << stats.uniqueMeshCount << " mesh files";
+    if (transformed)
+    {
+        std::cout << " (" << stats.transformedCopyCount << " copies placed by node transform, "
+                  << stats.verifiedCandidateCount << " candidates compared per vertex)";
+    }
+    std::cout << ", " << std::fixed << std::setprecision(1) << stats.duplicateBytes / megabyte << " MB of copies not written";
+    if (writtenBytes > 0 && writeSeconds > 0.0)
+    {
+        std::cout << " (" << std::setprecision(3) << stats.duplicateBytes * writeSeconds / writtenBytes
+                  << " s at this run's write speed)";
+    }
+    std::cout << "; " << std::setprecision(3) << stats.duplicateConvertSeconds
+              << " s of conversion thread time spent on copies" << std::endl;
+}
+
+static void printCacheStats(const CacheStats &stats)
+{
+    const double megabyte = 1024.0 * 1024.0;
+    uint64_t runCount = stats.hitCount + stats.missCount;
+    std::cout << "Conversion cache: " << stats.entryCount << " entries, "
+              << std::fixed << std::setprecision(1) << stats.byteCount / megabyte << " MB; "
+              << stats.hitCount << " hits, " << stats.missCount << " misses, hit ratio "
+              << (runCount > 0 ? 100.0 * stats.hitCount / runCount : 0.0) << "%, "
+              << stats.reusedByteCount / megabyte << " MB reused; mean run "
+              << std::setprecision(3) << (stats.hitCount > 0 ? stats.hitSeconds / stats.hitCount : 0.0) << " s on hit, "
+              << (stats.missCount > 0 ? stats.missSeconds / stats.missCount : 0.0) << " s on miss" << std::endl;
+}
+
+static void evictCache(const std::string &cacheDirectory, uint64_t maxByteCount, double maxAgeDays)
+{
+    if (maxByteCount == 0 && maxAgeDays <= 0.0)
+    {
+        return;
+    }
+    CacheEvictionResult result = evictCacheEntries(cacheDirectory, maxByteCount, maxAgeDays);
+    if (result.removedEntryCount > 0)
+    {
+        const double megabyte = 1024.0 * 1024.0;
+        std::cout << "Conversion cache: evicted " << result.removedEntryCount << " entries, "
+                  << std::fixed << std::setprecision(1) << result.removedByteCount / megabyte << " MB; left "
+                  << result.entryCount << " entries, " << result.byteCount / megabyte << " MB" << std::endl;
+    }
+}
+
+// common fields of --stats report
+static Json::Value getRunInfo(const std::string &importPath, const std::string &exportPath, bool success,
+                              const ImportSettings &settings, uint32_t ioThreadCount,
+                              std::chrono::steady_clock::time_point runStart)
+{
+    Json::Value runInfo;
+    runInfo["input"] = importPath;
+    runInfo["output"] = exportPath;
+    runInfo["success"] = success;
+    runInfo["threads"] = ThreadPool::resolveThreadCount(settings.threadCount);
+    runInfo["ioThreads"] = ioThreadCount;
+    runInfo["wallSeconds"] = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+    runInfo["cpuSeconds"] = getProcessCPUSeconds();
+    runInfo["peakRSSBytes"] = Json::UInt64(getPeakRSS());
+    return runInfo;
+}
+
+// saves --stats and --trace files when they are requested, returns exit code
+static int saveReports(const std::string &statsPath, const std::string &tracePath, const Json::Value &runInfo)
+{
+    if (!statsPath.empty() && !exportPhaseStatsToFile(statsPath, runInfo))
+    {
+        std::cout << "Failed to save stats at path " << statsPath << std::endl;
+        return -6;
+    }
+    if (!tracePath.empty() && !exportTraceToFile(tracePath))
+    {
+        std::cout << "Failed to save trace at path " << tracePath << std::endl;
+        return -7;
+    }
+    return 0;
+}
+
+// reports stage of a conversion, value is stage specific (mesh index, mesh count)
+using ConversionProgress = std::function<void(const std::string &stage, uint64_t value)>;
+
+// options shared by all files of a run
+struct ConversionOptions
+{
     ImportSettings settings;
-    settings.mergeNormalThresholdAngle = 45.0f;
-    std::string importPath(argv[1]);
-    auto importData = importFBXFile(importPath, settings);
+    MeshFileFormat meshFileFormat;
+    uint32_t ioThreadCount = 4;
+    bool verbose = false;
+    bool pipeline = false;
+    bool nativeImport = false;
+    bool printReports = true; // off in batch and server modes, where files are converted at the same time
+    std::string cacheDirectory;
+    ConversionProgress progress; // server mode
+};
 
-    if (importData.success)
+struct ConversionResult
+{
+    int exitCode = 0; // main exit code for output errors
+    bool success = false;
+    bool cacheHit = false;
+    std::string error;
+    uint64_t meshCount = 0;
+    uint64_t triangleCount = 0;
+    uint64_t vertexCount = 0;
+    std::vector<std::string> outputFiles; // relative to export path
+};
+
+// parses whole value as a finite number >= 0, returns false for anything else
+static bool parseNonNegativeValue(const std::string &value, double &number)
+{
+    try
     {
-        std::error_code errorCode;
-        std::string exportPath(argv[2]);
-        std::string meshPathPrefix("meshes/");
-        name_fs::path basePath(exportPath);
-        if (!name_fs::exists(basePath))
+        size_t length = 0;
+        number = std::stod(value, &length);
+        return length == value.size() && number >= 0.0 && std::isfinite(number);
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+}
+
+// parses whole value as an integer 0..UINT32_MAX, returns false for anything else
+static bool parseCountValue(const std::string &value, uint32_t &count)
+{
+    double number = 0.0;
+    if (!parseNonNegativeValue(value, number) || number != std::floor(number) || number > UINT32_MAX)
+    {
+        return false;
+    }
+    count = static_cast<uint32_t>(number);
+    return true;
+}
+
+// parses value of option arg as a count in minCount..maxCount, sets error otherwise
+static bool parseCountOption(const std::string &arg, const std::string &value, uint32_t minCount, uint32_t maxCount,
+                             uint32_t &count, std::string &error)
+{
+    uint32_t parsed = 0;
+    if (!parseCountValue(value, parsed) || parsed < minCount || parsed > maxCount)
+    {
+        error = "Invalid value of " + arg + ": " + value + ", expected whole number " + std::to_string(minCount) +
+                (maxCount == UINT32_MAX ? " or more" : ".." + std::to_string(maxCount));
+        return false;
+    }
+    count = parsed;
+    return true;
+}
+
+// parses value of option arg as a finite float >= minValue, sets error otherwise
+static bool parseFloatOption(const std::string &arg, const std::string &value, double minValue, float &number,
+                             std::string &error)
+{
+    double parsed = 0.0;
+    if (!parseNonNegativeValue(value, parsed) || parsed < minValue || parsed > FLT_MAX)
+    {
+        std::ostringstream message;
+        message << "Invalid value of " << arg << ": " << value << ", expected finite number " << minValue << " or more";
+        error = message.str();
+        return false;
+    }
+    number = static_cast<float>(parsed);
+    return true;
+}
+
+static bool isPowerOfTwo(uint32_t value)
+{
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+// parses conversion option at args[argIndex] and its value, these options can
+// also be sent to the server with every request, so numeric values are
+// checked here (whole value, range) for the command line and the server alike.
+// Returns false when the argument isn't a conversion option, sets error when
+// its value is invalid
+static bool parseConversionOption(const std::vector<std::string> &args, size_t &argIndex,
+                                  ConversionOptions &options, std::string &error)
+{
+    const std::string &arg = args[argIndex];
+    bool hasValue = argIndex + 1 < args.size();
+    auto &settings = options.settings;
+    auto &meshFileFormat = options.meshFileFormat;
+    if (arg == "--io-threads" && hasValue)
+    {
+        parseCountOption(arg, args[++argIndex], 1, MaxIOThreads, options.ioThreadCount, error);
+    }
+    else if (arg == "--verbose")
+    {
+        options.verbose = true;
+    }
+    else if (arg == "--pipeline")
+    {
+        options.pipeline = true;
+    }
+    else if (arg == "--mesh-version" && hasValue)
+    {
+        parseCountOption(arg, args[++argIndex], StreamConstants::MeshFileVersion1, StreamConstants::MeshFileVersion3,
+                         meshFileFormat.version, error);
+    }
+    else if (arg == "--stream-alignment" && hasValue)
+    {
+        if (parseCountOption(arg, args[++argIndex], 1, MaxStreamAlignment, meshFileFormat.streamAlignment, error) &&
+            !isPowerOfTwo(meshFileFormat.streamAlignment))
+        {
+            error = "Stream alignment must be a power of two: " + args[argIndex];
+        }
+    }
+    else if (arg == "--compress" && hasValue)
+    {
+        if (!parseStreamCodec(args[++argIndex], meshFileFormat.compression.codec))
+        {
+            error = "Unknown compression: " + args[argIndex];
+        }
+        if (meshFileFormat.compression.codec != StreamCodec::None)
+        {
+            meshFileFormat.version = StreamConstants::MeshFileVersion3;
+        }
+    }
+    else if (arg == "--compress-filter" && hasValue)
+    {
+        const std::string &filter = args[++argIndex];
+        meshFileFormat.compression.autoFilter = filter == "auto";
+        if (!meshFileFormat.compression.autoFilter && !parseStreamFilter(filter, meshFileFormat.compression.filter))
+        {
+            error = "Unknown compression filter: " + filter;
+        }
+    }
+    else if (arg == "--compress-min-saving" && hasValue)
+    {
+        parseCountOption(arg, args[++argIndex], 0, 100, meshFileFormat.compression.minSavingPercent, error);
+    }
+    else if (arg == "--vertex-cache" && hasValue)
+    {
+        if (!parseVertexCacheMethod(args[++argIndex], settings.vertexCacheMethod))
+        {
+            error = "Unknown vertex cache method: " + args[argIndex];
+        }
+    }
+    else if (arg == "--overdraw" && hasValue)
+    {
+        parseFloatOption(arg, args[++argIndex], 1.0, settings.overdrawThreshold, error);
+    }
+    else if (arg == "--vertex-fetch")
+    {
+        settings.optimizeVertexFetch = true;
+    }
+    else if (arg == "--meshlets")
+    {
+        settings.meshletMaxVertices = DefaultMeshletVertices;
+    }
+    else if (arg == "--meshlet-vertices" && hasValue)
+    {
+        parseCountOption(arg, args[++argIndex], 3, MaxMeshletVertices, settings.meshletMaxVertices, error);
+    }
+    else if (arg == "--meshlet-triangles" && hasValue)
+    {
+        parseCountOption(arg, args[++argIndex], 1, MaxMeshletTriangles, settings.meshletMaxTriangles, error);
+        if (settings.meshletMaxVertices == 0)
+        {
+            settings.meshletMaxVertices = DefaultMeshletVertices;
+        }
+    }
+    else if (arg == "--position-encoding" && hasValue)
+    {
+        if (!parsePositionEncoding(args[++argIndex], settings.positionEncoding))
+        {
+            error = "Unknown position encoding: " + args[argIndex];
+        }
+    }
+    else if ((arg == "--normal-encoding" || arg == "--tangent-encoding") && hasValue)
+    {
+        auto &encoding = arg == "--normal-encoding" ? settings.normalEncoding : settings.tangentEncoding;
+        if (!parseDirectionEncoding(args[++argIndex], encoding))
         {
-            name_fs::create_directories(basePath, errorCode);
-            if (errorCode)
+            error = "Unknown direction encoding: " + args[argIndex];
+        }
+    }
+    else if (arg == "--uv-encoding" && hasValue)
+    {
+        if (!parseUVEncoding(args[++argIndex], settings.uvEncoding))
+        {
+            error = "Unknown UV encoding: " + args[argIndex];
+        }
+    }
+    else if (arg == "--vertex-layout" && hasValue)
+    {
+        if (!parseVertexLayout(args[++argIndex], settings.vertexLayout))
+        {
+            error = "Unknown vertex layout: " + args[argIndex];
+        }
+    }
+    else if (arg == "--vertex-alignment" && hasValue)
+    {
+        if (parseCountOption(arg, args[++argIndex], 1, MaxVertexAlignment, settings.vertexStrideAlignment, error) &&
+            !isPowerOfTwo(settings.vertexStrideAlignment))
+        {
+            error = "Vertex alignment must be a power of two: " + args[argIndex];
+        }
+    }
+    else if (arg == "--importer" && hasValue)
+    {
+        const std::string &importer = args[++argIndex];
+        if (importer != "sdk" && importer != "native")
+        {
+            error = "Unknown importer: " + importer;
+        }
+        options.nativeImport = importer == "native";
+    }
+    else if (arg == "--direct-io")
+    {
+        meshFileFormat.directIO = true;
+    }
+    else if (arg == "--max-meshes-in-flight" && hasValue)
+    {
+        parseCountOption(arg, args[++argIndex], 0, UINT32_MAX, settings.maxMeshesInFlight, error);
+    }
+    else if (arg == "--dedupe-meshes")
+    {
+        settings.deduplicateMeshes = true;
+    }
+    else if (arg == "--dedupe-tolerance" && hasValue)
+    {
+        settings.deduplicateMeshes = true;
+        parseFloatOption(arg, args[++argIndex], 0.0, settings.deduplicateTolerance, error);
+    }
+    else if (arg == "--dedupe-transformed")
+    {
+        settings.deduplicateMeshes = true;
+        settings.deduplicateTransformedMeshes = true;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+// returns error message of invalid option combination, empty when options are valid
+static std::string validateConversionOptions(const ConversionOptions &options)
+{
+    const auto &settings = options.settings;
+    const auto &meshFileFormat = options.meshFileFormat;
+    if (meshFileFormat.compression.codec != StreamCodec::None &&
+        meshFileFormat.version != StreamConstants::MeshFileVersion3)
+    {
+        return "Stream compression needs --mesh-version 3";
+    }
+    if (settings.deduplicateMeshes && options.pipeline)
+    {
+        return "Mesh deduplication needs all converted meshes, it can't be used with --pipeline";
+    }
+    return std::string();
+}
+
+// converts one FBX file to exportPath, or restores outputs from the cache
+static ConversionResult convertFile(const std::string &importPath, const std::string &exportPath,
+                                    const ConversionOptions &options, const ImportContext &context)
+{
+    ConversionResult conversion;
+    auto fileStart = std::chrono::steady_clock::now();
+    const auto &settings = options.settings;
+    const auto &meshFileFormat = options.meshFileFormat;
+    std::string meshPathPrefix("meshes/");
+    name_fs::path basePath(exportPath);
+    name_fs::path meshPath = basePath;
+    meshPath.append(meshPathPrefix);
+    auto getMeshFileName = [&meshPath](size_t meshIndex)
+    {
+        name_fs::path resultPath = meshPath;
+        resultPath.append(std::to_string(meshIndex) + ".msh");
+        return resultPath.u8string();
+    };
+    auto fail = [&conversion](int exitCode, const std::string &error)
+    {
+        conversion.exitCode = exitCode;
+        conversion.success = false;
+        conversion.error = error;
+        return conversion;
+    };
+    auto reportProgress = [&options](const char *stage, uint64_t value)
+    {
+        if (options.progress)
+        {
+            options.progress(stage, value);
+        }
+    };
+
+    // on a cache hit outputs of an earlier run are linked, FBX file isn't loaded at all
+    std::string cacheKey;
+    if (!options.cacheDirectory.empty())
+    {
+        PhaseTimer lookupTimer(Phase::CacheLookup);
+        cacheKey = getCacheKey(importPath, describeConversionSettings(settings, meshFileFormat,
+                                                                      options.nativeImport ? "native" : "sdk"));
+        CacheEntry cacheEntry;
+        if (!cacheKey.empty() && restoreFromCache(options.cacheDirectory, cacheKey, exportPath, cacheEntry))
+        {
+            lookupTimer.setItemCount(cacheEntry.byteCount);
+            lookupTimer.stop();
+            double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - fileStart).count();
+            if (options.printReports)
             {
-                std::cout << "Error creating directories at path " << basePath << ": " << errorCode.message() << std::endl;
-                return -2;
+                std::cout << "Conversion cache hit " << cacheKey << ": " << cacheEntry.files.size() << " files, "
+                          << std::fixed << std::setprecision(1) << cacheEntry.byteCount / (1024.0 * 1024.0) << " MB in "
+                          << std::setprecision(3) << runSeconds << " s" << std::endl;
             }
+            logCacheResult(options.cacheDirectory, cacheKey, true, runSeconds, cacheEntry.byteCount);
+            conversion.success = true;
+            conversion.cacheHit = true;
+            conversion.meshCount = cacheEntry.meshCount;
+            conversion.triangleCount = cacheEntry.triangleCount;
+            conversion.vertexCount = cacheEntry.vertexCount;
+            conversion.outputFiles = cacheEntry.files;
+            reportProgress("cacheHit", cacheEntry.byteCount);
+            return conversion;
+        }
+        // files restored earlier are hard links to cache entries, they must not be overwritten in place
+        detachCachedOutputs(exportPath);
+    }
+
+    // in pipeline mode every mesh is written by conversion thread as soon as
+    // it's ready, so directories are created before import
+    MeshSink meshSink;
+    std::vector<MeshWriteResult> writeResults;
+    std::mutex writeResultsMutex;
+    if (options.pipeline)
+    {
+        if (!createDirectories(basePath) || !createDirectories(meshPath))
+        {
+            return fail(-2, "failed to create output directories");
         }
+        meshSink = [&getMeshFileName, &meshFileFormat, &writeResults, &writeResultsMutex, &reportProgress](uint32_t meshIndex, StreamMesh &&mesh)
+        {
+            TraceZone exportZone("exportMesh");
+            exportZone.arg("mesh", meshIndex);
+            auto writeResult = exportMeshToFileTimed(getMeshFileName(meshIndex), mesh, meshFileFormat);
+            if (!writeResult.success)
+            {
+                std::cout << "Failed to export mesh at path " + writeResult.fileName << std::endl;
+            }
+            reportProgress("meshWritten", meshIndex);
+            std::lock_guard<std::mutex> lock(writeResultsMutex);
+            writeResults.push_back(writeResult);
+            return writeResult.success;
+        };
+    }
+    reportProgress("import", 0);
+    auto importStart = std::chrono::steady_clock::now();
+    auto importData = options.nativeImport ? importFBXFileNative(importPath, settings, meshSink, context)
+                                           : importFBXFile(importPath, settings, meshSink, context);
 
-        name_fs::path meshPath = basePath;
+    if (options.printReports && importData.success &&
+        (settings.vertexCacheMethod != VertexCacheMethod::None || settings.overdrawThreshold > 0.0f ||
+         settings.optimizeVertexFetch || settings.meshletMaxVertices > 0 || options.verbose))
+    {
+        printMeshOptimizationReport(importData.meshStats, options.verbose);
+    }
+    if (options.printReports && importData.success)
+    {
+        printEncodingReport(importData.meshStats);
+    }
+    if (options.pipeline)
+    {
+        double importSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - importStart).count();
+        std::sort(writeResults.begin(), writeResults.end(), [](const MeshWriteResult &left, const MeshWriteResult &right)
+        {
+            return left.fileName < right.fileName;
+        });
+        if (options.printReports)
+        {
+            printMeshWriteReport(writeResults, importSeconds, options.verbose);
+        }
+        for (const auto &writeResult : writeResults)
+        {
+            if (!writeResult.success)
+            {
+                return fail(-4, "failed to export mesh at path " + writeResult.fileName);
+            }
+        }
+    }
+    if (importData.success)
+    {
+        reportProgress("export", importData.meshStats.size());
+        if (!createDirectories(basePath))
+        {
+            return fail(-2, "failed to create output directory");
+        }
         if (!importData.sceneMeshes.empty())
         {
-            meshPath.append(meshPathPrefix);
-            if (!name_fs::exists(meshPath))
+            if (!createDirectories(meshPath))
+            {
+                return fail(-3, "failed to create mesh directory");
+            }
+            std::vector<std::string> meshFileNames;
+            for (size_t sceneMeshIndex = 0; sceneMeshIndex < importData.sceneMeshes.size(); ++sceneMeshIndex)
+            {
+                meshFileNames.push_back(getMeshFileName(sceneMeshIndex));
+            }
+            auto writeStart = std::chrono::steady_clock::now();
+            writeResults = exportMeshesToFiles(meshFileNames, importData.sceneMeshes, options.ioThreadCount, meshFileFormat);
+            double writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - writeStart).count();
+            if (options.printReports)
             {
-                name_fs::create_directories(meshPath, errorCode);
-                if (errorCode)
+                printMeshWriteReport(writeResults, writeSeconds, options.verbose);
+                if (settings.deduplicateMeshes)
                 {
-                    std::cout << "Error creating directories at path " << meshPath << ": " << errorCode.message() << std::endl;
-                    return -3;
+                    printInstancingReport(importData.instancingStats, settings.deduplicateTransformedMeshes, writeResults,
+                                          writeSeconds);
                 }
             }
-        }
-
-        uint32_t sceneMeshIndex = 0;
-        for (auto sceneMesh : importData.sceneMeshes)
-        {
-            name_fs::path resultPath = meshPath;
-            resultPath.append(std::to_string(sceneMeshIndex) + ".msh");
-            bool success = exportMeshToFile(resultPath.u8string(), sceneMesh);
-            if (!success)
+            for (const auto &writeResult : writeResults)
             {
-                std::cout << "Failed to export mesh at path " + resultPath.u8string() << std::endl;
-                return -4;
+                if (!writeResult.success)
+                {
+                    std::cout << "Failed to export mesh at path " + writeResult.fileName << std::endl;
+                    return fail(-4, "failed to export mesh at path " + writeResult.fileName);
+                }
             }
         }
         name_fs::path scenePath = basePath;
@@ -80,9 +775,497 @@ int main(int argc, char* argv[])
         if (!exportSceneToFile(scenePath.u8string(), importData, meshPathPrefix, settings.compactSceneJson))
         {
             std::cout << "Failed to save scene json at path " + scenePath.u8string() << std::endl;
-            return -5;
+            return fail(-5, "failed to save scene json at path " + scenePath.u8string());
+        }
+    }
+    else
+    {
+        conversion.error = "import failed";
+    }
+    conversion.success = importData.success;
+    conversion.meshCount = importData.meshStats.size();
+    for (const auto &stats : importData.meshStats)
+    {
+        conversion.triangleCount += stats.vertexCacheAfter.triangleCount;
+        conversion.vertexCount += stats.vertexCacheAfter.vertexCount;
+    }
+    if (importData.success)
+    {
+        size_t meshCount = options.pipeline ? writeResults.size() : importData.sceneMeshes.size();
+        for (size_t meshIndex = 0; meshIndex < meshCount; ++meshIndex)
+        {
+            conversion.outputFiles.push_back(meshPathPrefix + std::to_string(meshIndex) + ".msh");
         }
+        conversion.outputFiles.push_back("scene.json");
+    }
+    if (importData.success && !cacheKey.empty())
+    {
+        reportProgress("cacheStore", 0);
+        CacheEntry cacheEntry;
+        cacheEntry.files = conversion.outputFiles;
+        cacheEntry.meshCount = conversion.meshCount;
+        cacheEntry.triangleCount = conversion.triangleCount;
+        cacheEntry.vertexCount = conversion.vertexCount;
+        PhaseTimer storeTimer(Phase::CacheStore);
+        if (createDirectories(options.cacheDirectory) && storeInCache(options.cacheDirectory, cacheKey, exportPath, cacheEntry))
+        {
+            storeTimer.setItemCount(cacheEntry.byteCount);
+        }
+        else
+        {
+            std::cout << "Warning: failed to store outputs in conversion cache " << options.cacheDirectory << std::endl;
+        }
+        storeTimer.stop();
+        double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - fileStart).count();
+        if (options.printReports)
+        {
+            std::cout << "Conversion cache miss " << cacheKey << std::endl;
+        }
+        logCacheResult(options.cacheDirectory, cacheKey, false, runSeconds, cacheEntry.byteCount);
+    }
+    return conversion;
+}
+
+// converts a request of server mode with the options server was started with
+// and request options on top of them
+static Json::Value handleServerRequest(const Json::Value &request, const ServerEventSink &sendEvent,
+                                       const ConversionOptions &serverOptions, const ImportContext &context)
+{
+    if (!request["input"].isString() || !request["output"].isString())
+    {
+        return makeServerError("request must have input and output strings");
+    }
+    std::string importPath = request["input"].asString();
+    std::string exportPath = request["output"].asString();
+    ConversionOptions options = serverOptions;
+    std::vector<std::string> args;
+    for (const auto &jOption : request["options"])
+    {
+        if (!jOption.isString())
+        {
+            return makeServerError("options must be an array of strings");
+        }
+        args.push_back(jOption.asString());
+    }
+    for (size_t argIndex = 0; argIndex < args.size(); ++argIndex)
+    {
+        std::string error;
+        if (!parseConversionOption(args, argIndex, options, error))
+        {
+            return makeServerError("Unknown option or missing value: " + args[argIndex]);
+        }
+        if (!error.empty())
+        {
+            return makeServerError(error);
+        }
+    }
+    std::string error = validateConversionOptions(options);
+    if (!error.empty())
+    {
+        return makeServerError(error);
+    }
+    options.progress = [&sendEvent](const std::string &stage, uint64_t value)
+    {
+        Json::Value event;
+        event["event"] = "progress";
+        event["stage"] = stage;
+        event["value"] = Json::UInt64(value);
+        sendEvent(event);
+    };
+
+    auto requestStart = std::chrono::steady_clock::now();
+    auto conversion = convertFile(importPath, exportPath, options, context);
+    double requestSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - requestStart).count();
+    Json::Value result;
+    result["success"] = conversion.success;
+    if (!conversion.success)
+    {
+        result["error"] = conversion.error.empty() ? "conversion failed" : conversion.error;
+    }
+    result["cacheHit"] = conversion.cacheHit;
+    result["seconds"] = requestSeconds;
+    result["meshes"] = Json::UInt64(conversion.meshCount);
+    result["triangles"] = Json::UInt64(conversion.triangleCount);
+    result["vertices"] = Json::UInt64(conversion.vertexCount);
+    result["output"] = exportPath;
+    Json::Value jFileArray(Json::arrayValue);
+    for (const auto &outputFile : conversion.outputFiles)
+    {
+        jFileArray.append((name_fs::path(exportPath) / outputFile).u8string());
+    }
+    result["files"] = jFileArray;
+
+    std::ostringstream osLog;
+    osLog << importPath << " -> " << exportPath << ": " << (conversion.success ? "done" : "failed")
+          << (conversion.cacheHit ? " (cache hit)" : "") << " in " << std::fixed << std::setprecision(3)
+          << requestSeconds << " s" << std::endl;
+    std::cout << osLog.str();
+    return result;
+}
+
+// --connect: sends one request to the server and prints its progress and result
+static int runClient(const std::string &socketPath, const std::vector<std::string> &positionalArgs,
+                     const std::vector<std::string> &conversionArgs, bool shutdownServer)
+{
+    Json::Value request;
+    if (shutdownServer)
+    {
+        request["command"] = "shutdown";
+    }
+    else if (positionalArgs.size() < 2)
+    {
+        printUsage();
+        return -1;
+    }
+    else
+    {
+        // server has its own working directory
+        request["input"] = name_fs::absolute(positionalArgs[0]).u8string();
+        request["output"] = name_fs::absolute(positionalArgs[1]).u8string();
+        Json::Value jOptionArray(Json::arrayValue);
+        for (const auto &arg : conversionArgs)
+        {
+            jOptionArray.append(arg);
+        }
+        request["options"] = jOptionArray;
+    }
+    auto requestStart = std::chrono::steady_clock::now();
+    Json::Value result;
+    bool received = sendServerRequest(socketPath, request, [](const Json::Value &event)
+    {
+        std::cout << "Progress: " << event["stage"].asString() << " " << event["value"].asUInt64() << std::endl;
+    }, result);
+    double requestSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - requestStart).count();
+    if (!received)
+    {
+        std::cout << "No answer from server at " << socketPath << std::endl;
+        return -10;
+    }
+    if (!result["success"].asBool())
+    {
+        std::cout << "Server request failed: " << result["error"].asString() << std::endl;
+        return -11;
+    }
+    if (shutdownServer)
+    {
+        std::cout << "Server at " << socketPath << " stops" << std::endl;
+        return 0;
+    }
+    std::cout << "Converted " << result["meshes"].asUInt64() << " meshes" << (result["cacheHit"].asBool() ? " from cache" : "")
+              << " in " << std::fixed << std::setprecision(3) << requestSeconds << " s (server "
+              << result["seconds"].asDouble() << " s):" << std::endl;
+    for (const auto &jFile : result["files"])
+    {
+        std::cout << "    " << jFile.asString() << std::endl;
     }
     return 0;
 }
 
+static int invalidOptionValue(const std::string &arg, const std::string &value)
+{
+    std::cout << "Invalid value of " << arg << ": " << value << std::endl;
+    printUsage();
+    return -1;
+}
+
+int main(int argc, char* argv[])
+{
+    // TODO: investigate how to use UTF-8/widechar paths in cross-platform way
+    //std::setlocale(LC_ALL, "en_US.utf8");
+    //std::locale utf8(std::locale(), ::new std::codecvt_utf8<char>);
+    //std::locale::global(utf8);//std::locale("en_US.utf8"));
+    //std::cout.imbue(std::locale());
+
+    if (argc >= 2 && std::string(argv[1]) == "--benchmark")
+    {
+        std::string benchmarkName = argc >= 3 ? argv[2] : "";
+        std::vector<std::string> benchmarkArgs;
+        for (int argIndex = 3; argIndex < argc; ++argIndex)
+        {
+            benchmarkArgs.push_back(argv[argIndex]);
+        }
+        return runBenchmark(benchmarkName, benchmarkArgs);
+    }
+    std::vector<std::string> args(argv + 1, argv + argc);
+    ConversionOptions options;
+    options.settings.mergeNormalThresholdAngle = 45.0f;
+    std::vector<std::string> conversionArgs; // sent to the server in client mode
+    std::string statsPath;
+    std::string tracePath;
+    uint64_t cacheMaxByteCount = 0;
+    double cacheMaxAgeDays = 0.0;
+    bool showCacheStats = false;
+    std::string batchManifestPath;
+    uint32_t batchJobCount = 2;
+    std::string batchSummaryPath;
+    std::string serverSocketPath;
+    std::string clientSocketPath;
+    bool shutdownServer = false;
+    std::vector<std::string> positionalArgs;
+    for (size_t argIndex = 0; argIndex < args.size(); ++argIndex)
+    {
+        const std::string &arg = args[argIndex];
+        bool hasValue = argIndex + 1 < args.size();
+        size_t optionIndex = argIndex;
+        std::string error;
+        if (parseConversionOption(args, argIndex, options, error))
+        {
+            if (!error.empty())
+            {
+                std::cout << error << std::endl;
+                printUsage();
+                return -1;
+            }
+            conversionArgs.insert(conversionArgs.end(), args.begin() + optionIndex, args.begin() + argIndex + 1);
+        }
+        else if (arg == "--threads" && hasValue)
+        {
+            if (!parseCountValue(args[++argIndex], options.settings.threadCount))
+            {
+                return invalidOptionValue(arg, args[argIndex]);
+            }
+        }
+        else if (arg == "--simd" && hasValue)
+        {
+            SimdLevel simdLevel;
+            if (!parseSimdLevel(args[++argIndex], simdLevel))
+            {
+                std::cout << "Unknown SIMD level: " << args[argIndex] << std::endl;
+                return -1;
+            }
+            setSimdLevel(simdLevel);
+        }
+        else if (arg == "--stats" && hasValue)
+        {
+            statsPath = args[++argIndex];
+        }
+        else if (arg == "--trace" && hasValue)
+        {
+            tracePath = args[++argIndex];
+        }
+        else if (arg == "--cache" && hasValue)
+        {
+            options.cacheDirectory = args[++argIndex];
+        }
+        else if (arg == "--cache-max-size" && hasValue)
+        {
+            double megabytes = 0.0;
+            if (!parseNonNegativeValue(args[++argIndex], megabytes))
+            {
+                return invalidOptionValue(arg, args[argIndex]);
+            }
+            // values above uint64_t range mean no limit in practice
+            cacheMaxByteCount = static_cast<uint64_t>(std::min(megabytes * 1024.0 * 1024.0, 1.8e19));
+        }
+        else if (arg == "--cache-max-age" && hasValue)
+        {
+            if (!parseNonNegativeValue(args[++argIndex], cacheMaxAgeDays))
+            {
+                return invalidOptionValue(arg, args[argIndex]);
+            }
+        }
+        else if (arg == "--cache-stats")
+        {
+            showCacheStats = true;
+        }
+        else if (arg == "--batch" && hasValue)
+        {
+            batchManifestPath = args[++argIndex];
+        }
+        else if (arg == "--batch-jobs" && hasValue)
+        {
+            if (!parseCountValue(args[++argIndex], batchJobCount))
+            {
+                return invalidOptionValue(arg, args[argIndex]);
+            }
+            batchJobCount = std::max(1u, batchJobCount);
+        }
+        else if (arg == "--batch-summary" && hasValue)
+        {
+            batchSummaryPath = args[++argIndex];
+        }
+        else if (arg == "--serve" && hasValue)
+        {
+            serverSocketPath = args[++argIndex];
+        }
+        else if (arg == "--connect" && hasValue)
+        {
+            clientSocketPath = args[++argIndex];
+        }
+        else if (arg == "--shutdown")
+        {
+            shutdownServer = true;
+        }
+        else if (arg.compare(0, 2, "--") == 0)
+        {
+            std::cout << "Unknown option or missing value: " << arg << std::endl;
+            printUsage();
+            return -1;
+        }
+        else
+        {
+            positionalArgs.push_back(arg);
+        }
+    }
+    if (!clientSocketPath.empty())
+    {
+        return runClient(clientSocketPath, positionalArgs, conversionArgs, shutdownServer);
+    }
+    if (showCacheStats && positionalArgs.empty() && batchManifestPath.empty() && serverSocketPath.empty() &&
+        !options.cacheDirectory.empty())
+    {
+        evictCache(options.cacheDirectory, cacheMaxByteCount, cacheMaxAgeDays);
+        printCacheStats(getCacheStats(options.cacheDirectory));
+        return 0;
+    }
+    if (positionalArgs.size() < 2 && batchManifestPath.empty() && serverSocketPath.empty())
+    {
+        printUsage();
+        return -1;
+    }
+    std::string optionsError = validateConversionOptions(options);
+    if (!optionsError.empty())
+    {
+        std::cout << optionsError << std::endl;
+        return -1;
+    }
+    auto runStart = std::chrono::steady_clock::now();
+    enablePhaseStats(!statsPath.empty());
+    enableTrace(!tracePath.empty());
+    setTraceThreadName("main");
+    if (options.verbose)
+    {
+        std::cout << "Vertex conversion SIMD: " << getSimdLevelName(getSimdLevel()) << std::endl;
+    }
+    if (!serverSocketPath.empty())
+    {
+        // kept warm between requests: FBX SDK manager and conversion pool.
+        // Requests can choose the importer, so the manager is always created
+        options.printReports = false;
+        FBXSDKSession sdkSession;
+        ThreadPool threadPool(options.settings.threadCount);
+        ImportContext context;
+        context.sdkSession = &sdkSession;
+        context.threadPool = &threadPool;
+        auto serverResult = runConversionServer(serverSocketPath, [&options, &context](const Json::Value &request, const ServerEventSink &sendEvent)
+        {
+            return handleServerRequest(request, sendEvent, options, context);
+        });
+        if (!serverResult.success)
+        {
+            return -10;
+        }
+        std::cout << "Server stopped: " << serverResult.requestCount << " requests, "
+                  << serverResult.failedRequestCount << " failed" << std::endl;
+        if (!options.cacheDirectory.empty())
+        {
+            evictCache(options.cacheDirectory, cacheMaxByteCount, cacheMaxAgeDays);
+            if (showCacheStats)
+            {
+                printCacheStats(getCacheStats(options.cacheDirectory));
+            }
+        }
+        Json::Value runInfo = getRunInfo(serverSocketPath, "", true, options.settings, options.ioThreadCount, runStart);
+        runInfo["serverRequests"] = Json::UInt64(serverResult.requestCount);
+        runInfo["serverFailedRequests"] = Json::UInt64(serverResult.failedRequestCount);
+        return saveReports(statsPath, tracePath, runInfo);
+    }
+    if (!batchManifestPath.empty())
+    {
+        std::vector<BatchJob> jobs;
+        if (!readBatchManifest(batchManifestPath, jobs))
+        {
+            return -8;
+        }
+        // one FBX SDK manager and one conversion pool for all files
+        options.printReports = false;
+        std::unique_ptr<FBXSDKSession> sdkSession;
+        if (!options.nativeImport)
+        {
+            sdkSession.reset(new FBXSDKSession());
+        }
+        ThreadPool threadPool(options.settings.threadCount);
+        ImportContext context;
+        context.sdkSession = sdkSession.get();
+        context.threadPool = &threadPool;
+        auto results = runBatch(jobs, batchJobCount, [&options, &context](const BatchJob &job)
+        {
+            auto conversion = convertFile(job.inputPath, job.outputPath, options, context);
+            BatchFileResult result;
+            result.success = conversion.success;
+            result.cacheHit = conversion.cacheHit;
+            result.error = conversion.error;
+            result.meshCount = conversion.meshCount;
+            result.triangleCount = conversion.triangleCount;
+            result.vertexCount = conversion.vertexCount;
+            return result;
+        });
+        double batchSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+        printBatchSummary(results, batchSeconds);
+        if (!batchSummaryPath.empty() && !exportBatchSummaryToFile(batchSummaryPath, results, batchSeconds))
+        {
+            std::cout << "Failed to save batch summary at path " << batchSummaryPath << std::endl;
+        }
+        if (!options.cacheDirectory.empty())
+        {
+            evictCache(options.cacheDirectory, cacheMaxByteCount, cacheMaxAgeDays);
+            if (showCacheStats)
+            {
+                printCacheStats(getCacheStats(options.cacheDirectory));
+            }
+        }
+        uint32_t failedCount = 0;
+        uint32_t cacheHitCount = 0;
+        uint64_t meshCount = 0;
+        uint64_t triangleCount = 0;
+        uint64_t vertexCount = 0;
+        for (const auto &result : results)
+        {
+            failedCount += result.success ? 0 : 1;
+            cacheHitCount += result.cacheHit ? 1 : 0;
+            meshCount += result.meshCount;
+            triangleCount += result.triangleCount;
+            vertexCount += result.vertexCount;
+        }
+        Json::Value runInfo = getRunInfo(batchManifestPath, "", failedCount == 0, options.settings,
+                                         options.ioThreadCount, runStart);
+        runInfo["batchFiles"] = Json::UInt64(results.size());
+        runInfo["batchFailed"] = failedCount;
+        runInfo["batchJobs"] = batchJobCount;
+        runInfo["meshes"] = Json::UInt64(meshCount);
+        runInfo["triangles"] = Json::UInt64(triangleCount);
+        runInfo["vertices"] = Json::UInt64(vertexCount);
+        if (!options.cacheDirectory.empty())
+        {
+            runInfo["cacheHits"] = cacheHitCount;
+        }
+        int reportsExitCode = saveReports(statsPath, tracePath, runInfo);
+        return failedCount > 0 ? -9 : reportsExitCode;
+    }
+
+    std::string importPath(positionalArgs[0]);
+    std::string exportPath(positionalArgs[1]);
+    auto conversion = convertFile(importPath, exportPath, options, ImportContext());
+    if (conversion.exitCode != 0)
+    {
+        return conversion.exitCode;
+    }
+    if (!options.cacheDirectory.empty())
+    {
+        evictCache(options.cacheDirectory, cacheMaxByteCount, cacheMaxAgeDays);
+        if (showCacheStats)
+        {
+            printCacheStats(getCacheStats(options.cacheDirectory));
+        }
+    }
+    Json::Value runInfo = getRunInfo(importPath, exportPath, conversion.success, options.settings,
+                                     options.ioThreadCount, runStart);
+    runInfo["meshes"] = Json::UInt64(conversion.meshCount);
+    runInfo["triangles"] = Json::UInt64(conversion.triangleCount);
+    runInfo["vertices"] = Json::UInt64(conversion.vertexCount);
+    if (!options.cacheDirectory.empty())
+    {
+        runInfo["cacheHit"] = conversion.cacheHit;
+    }
+    return saveReports(statsPath, tracePath, runInfo);
+}
@@ -0,0 +1,615 @@
+//-----------------------------------------------------------------------------
+// ConvertMesh.cpp
+// Created at 2026.10.17 11:30
+// License: see LICENSE file
+//
+// converts RawMesh to StreamMesh: triangulation, welding, vertex streams
+//-----------------------------------------------------------------------------
+#include "ConvertMesh.h"
+#include <cstring>
+#include <mutex>
+
+#include "Common.h"
+#include "Meshlet.h"
+#include "Overdraw.h"
+#include "PhaseStats.h"
+#include "ThreadPool.h"
+#include "VertexCache.h"
+#include "VertexEncoding.h"
+#include "VertexPacking.h"
+#include "VertexWeld.h"
+
+VectorStream createFloat3Stream(
+    const std::vector<RawVector4> &srcData,
+    const std::vector<IndexSet> &vertexIndices,
+    uint32_t indexFieldOffset
+)
+{
+    VectorStream meshStream;
+    meshStream.elementType = static_cast<uint32_t>(StreamElementType::Float);
+    meshStream.elementVectorSize = 3;
+    meshStream.elementSize = 4;
+
+    uint32_t dataSize = meshStream.elementSize * meshStream.elementVectorSize * static_cast<uint32_t>(vertexIndices.size());
+    meshStream.streamSize = dataSize + meshStream.headerSize();
+    meshStream.data.resize(dataSize);
+    packFloat3(srcData, vertexIndices, indexFieldOffset, meshStream.data.data());
+    meshStream.elementCount = static_cast<uint32_t>(vertexIndices.size());
+    return meshStream;
+}
+
+static VectorStream createStream(AttributeType attributeType, StreamElementType elementType,
+                                 uint32_t elementSize, uint32_t elementVectorSize,
+                                 uint32_t elementCount, const void *data)
+{
+    VectorStream stream;
+    stream.attributeType = static_cast<uint32_t>(attributeType);
+    stream.elementType = static_cast<uint32_t>(elementType);
+    stream.elementSize = elementSize;
+    stream.elementVectorSize = elementVectorSize;
+    stream.elementCount = elementCount;
+    stream.data.resize(size_t(elementSize) * elementVectorSize * elementCount);
+    if (!stream.data.empty())
+    {
+        memcpy(stream.data.data(), data, stream.data.size());
+    }
+    stream.streamSize = static_cast<uint32_t>(stream.data.size()) + stream.headerSize();
+    return stream;
+}
+
+VectorStream createOctahedralStream(
+    const std::vector<RawVector4> &srcData,
+    const std::vector<IndexSet> &vertexIndices,
+    uint32_t indexFieldOffset,
+    uint32_t bits,
+    EncodingError *error
+)
+{
+    VectorStream meshStream;
+    meshStream.elementType = static_cast<uint32_t>(StreamElementType::OctahedralSNorm);
+    meshStream.elementVectorSize = 2;
+    meshStream.elementSize = bits / 8;
+
+    uint32_t dataSize = meshStream.elementSize * meshStream.elementVectorSize * static_cast<uint32_t>(vertexIndices.size());
+    meshStream.streamSize = dataSize + meshStream.headerSize();
+    meshStream.data.resize(dataSize);
+    double errorBound = getOctahedralErrorBound(bits);
+    uint8_t *data = meshStream.data.data();
+    for (size_t index = 0; index < vertexIndices.size(); ++index)
+    {
+        const auto &indexSet = vertexIndices[index];
+        uint32_t indexValue = *(uint32_t*)(((const uint8_t*)&indexSet) + indexFieldOffset);
+        const auto srcVector = srcData[indexValue].mData;
+        int32_t encoded[2];
+        encodeOctahedral(srcVector, bits, encoded);
+        if (bits == 16)
+        {
+            int16_t values[2] = { static_cast<int16_t>(encoded[0]), static_cast<int16_t>(encoded[1]) };
+            memcpy(data + index * sizeof(values), values, sizeof(values));
+        }
+        else
+        {
+            int8_t values[2] = { static_cast<int8_t>(encoded[0]), static_cast<int8_t>(encoded[1]) };
+            memcpy(data + index * sizeof(values), values, sizeof(values));
+        }
+        double length = std::sqrt(srcVector[0] * srcVector[0] + srcVector[1] * srcVector[1] + srcVector[2] * srcVector[2]);
+        if (error != nullptr && length > 0.0)
+        {
+            double decoded[3];
+            decodeOctahedral(encoded, bits, decoded);
+            double cosAngle = (decoded[0] * srcVector[0] + decoded[1] * srcVector[1] + decoded[2] * srcVector[2]) / length;
+            error->add(std::acos(std::max(-1.0, std::min(1.0, cosAngle))), errorBound);
+        }
+    }
+    meshStream.elementCount = static_cast<uint32_t>(vertexIndices.size());
+    return meshStream;
+}
+
+// normals, tangents and binormals
+static VectorStream createDirectionStream(
+    const std::vector<RawVector4> &srcData,
+    const std::vector<IndexSet> &vertexIndices,
+    uint32_t indexFieldOffset,
+    DirectionEncoding encoding,
+    EncodingError *error
+)
+{
+    switch (encoding)
+    {
+    case DirectionEncoding::Octahedral16:
+        return createOctahedralStream(srcData, vertexIndices, indexFieldOffset, 16, error);
+    case DirectionEncoding::Octahedral8:
+        return createOctahedralStream(srcData, vertexIndices, indexFieldOffset, 8, error);
+    default:
+        return createFloat3Stream(srcData, vertexIndices, indexFieldOffset);
+    }
+}
+
+// 4 x unorm16 positions in mesh bounding box and PositionDequantization stream
+static void addQuantizedPositionStreams(
+    StreamMesh &mesh,
+    const std::vector<RawVector4> &controlPoints,
+    const std::vector<IndexSet> &vertices,
+    EncodingError *error
+)
+{
+    double minPosition[3] = { INFINITY, INFINITY, INFINITY };
+    double maxPosition[3] = { -INFINITY, -INFINITY, -INFINITY };
+    for (const auto &vertex : vertices)
+    {
+        const auto &controlPoint = controlPoints[vertex.controlPoint].mData;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            minPosition[axis] = std::min(minPosition[axis], controlPoint[axis]);
+            maxPosition[axis] = std::max(maxPosition[axis], controlPoint[axis]);
+        }
+    }
+    // float offset and scale are rounded outwards, so the box contains all positions
+    float dequantization[2][3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float offset = static_cast<float>(minPosition[axis]);
+        if (offset > minPosition[axis])
+        {
+            offset = std::nextafter(offset, -INFINITY);
+        }
+        float scale = static_cast<float>(maxPosition[axis] - offset);
+        while (double(offset) + double(scale) < maxPosition[axis])
+        {
+            scale = std::nextafter(scale, INFINITY);
+        }
+        dequantization[0][axis] = offset;
+        dequantization[1][axis] = scale;
+    }
+
+    std::vector<uint16_t> positions(vertices.size() * 4);
+    packUNorm16x4(controlPoints, vertices, offsetof(IndexSet, controlPoint), dequantization[0], dequantization[1], positions.data());
+    if (error != nullptr)
+    {
+        for (size_t vertex = 0; vertex < vertices.size(); ++vertex)
+        {
+            const auto &controlPoint = controlPoints[vertices[vertex].controlPoint].mData;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                float offset = dequantization[0][axis];
+                float scale = dequantization[1][axis];
+                double decoded = dequantizeUNorm16(positions[vertex * 4 + axis], offset, scale);
+                error->add(std::abs(decoded - controlPoint[axis]), getUNorm16ErrorBound(offset, scale));
+            }
+        }
+    }
+    mesh.streams.push_back(createStream(AttributeType::Position, StreamElementType::UNorm, 2, 4,
+                                        static_cast<uint32_t>(vertices.size()), positions.data()));
+    mesh.streams.push_back(createStream(AttributeType::PositionDequantization, StreamElementType::Float, 4, 3,
+                                        2, dequantization));
+}
+
+void triangulatePolygons(const RawMesh &rawMesh, std::vector<IndexSet> &indexSets)
+{
+    size_t triangleCornerCount = 0;
+    for (auto polygonSize : rawMesh.polygonSizes)
+    {
+        if (polygonSize > 2)
+        {
+            triangleCornerCount += (polygonSize - 2) * 3;
+        }
+    }
+    indexSets.clear();
+    indexSets.reserve(triangleCornerCount);
+    size_t polygonStart = 0;
+    for (auto polygonSize : rawMesh.polygonSizes)
+    {
+        const IndexSet *polygonIndexSets = rawMesh.polygonVertices.data() + polygonStart;
+        for (size_t polygonVertexIndex = 2; polygonVertexIndex < polygonSize; ++polygonVertexIndex) // triangulate if needed
+        {
+            indexSets.push_back(polygonIndexSets[0]);
+            indexSets.push_back(polygonIndexSets[polygonVertexIndex - 1]);
+            indexSets.push_back(polygonIndexSets[polygonVertexIndex]);
+        }
+        polygonStart += polygonSize;
+    }
+}
+
+// float xyz for every vertex, used by mesh optimizations
+static std::vector<float> getVertexPositions(const std::vector<RawVector4> &controlPoints,
+                                             const std::vector<IndexSet> &vertices)
+{
+    std::vector<float> positions(vertices.size() * 3);
+    packFloat3(controlPoints, vertices, offsetof(IndexSet, controlPoint), positions.data());
+    return positions;
+}
+
+// meshlet descriptor, vertex, triangle and bounds streams
+static void addMeshletStreams(StreamMesh &mesh, const MeshletData &meshletData)
+{
+    uint32_t meshletCount = static_cast<uint32_t>(meshletData.meshlets.size());
+    mesh.streams.push_back(createStream(AttributeType::MeshletDescriptor, StreamElementType::UInt, 4,
+                                        sizeof(MeshletDescriptor) / 4, meshletCount, meshletData.meshlets.data()));
+    // same index size rule as index stream
+    uint32_t vertexCount = static_cast<uint32_t>(meshletData.vertices.size());
+    uint32_t maxVertexIndex = 0;
+    for (auto vertexIndex : meshletData.vertices)
+    {
+        maxVertexIndex = std::max(maxVertexIndex, vertexIndex);
+    }
+    if (maxVertexIndex < 65535)
+    {
+        std::vector<uint16_t> vertices(meshletData.vertices.begin(), meshletData.vertices.end());
+        mesh.streams.push_back(createStream(AttributeType::MeshletVertex, StreamElementType::UInt, 2, 1,
+                                            vertexCount, vertices.data()));
+    }
+    else
+    {
+        mesh.streams.push_back(createStream(AttributeType::MeshletVertex, StreamElementType::UInt, 4, 1,
+                                            vertexCount, meshletData.vertices.data()));
+    }
+    mesh.streams.push_back(createStream(AttributeType::MeshletTriangle, StreamElementType::UInt, 1, 3,
+                                        static_cast<uint32_t>(meshletData.triangles.size() / 3), meshletData.triangles.data()));
+    mesh.streams.push_back(createStream(AttributeType::MeshletBounds, StreamElementType::Float, 4,
+                                        sizeof(MeshletBounds) / 4, meshletCount, meshletData.bounds.data()));
+}
+
+StreamMesh convertRawMesh(RawMesh &rawMesh, const ImportSettings &settings, MeshConvertStats *stats)
+{
+    StreamMesh mesh;
+    auto &normals = rawMesh.normals;
+    const auto &UVs = rawMesh.UVs;
+    const auto &tangents = rawMesh.tangents;
+    const auto &binormals = rawMesh.binormals;
+    const auto &controlPoints = rawMesh.controlPoints;
+
+    PhaseTimer triangulationTimer(Phase::Triangulation);
+    std::vector<IndexSet> indexSets;
+    triangulatePolygons(rawMesh, indexSets);
+    triangulationTimer.setItemCount(indexSets.size() / 3);
+    triangulationTimer.stop();
+
+    std::vector<uint32_t> indexVector;
+    std::vector<IndexSet> uniqueVertices;
+
+    // TODO: optimize by spatial position/uv
+    PhaseTimer weldingTimer(Phase::Welding, indexSets.size());
+    weldVertices(indexSets, settings.vertexWeldMethod, indexVector, uniqueVertices);
+    weldingTimer.stop();
+
+    // import normals, merge vertices with similar normals
+    if (settings.importNormals && settings.mergeNormalThresholdAngle > 0.0f && !normals.empty())
+    {
+        PhaseTimer normalMergeTimer(Phase::NormalMerge, uniqueVertices.size());
+        double cosThreshold = std::cos(settings.mergeNormalThresholdAngle * Pi / 180.0f);
+        mergeVertexNormals(uniqueVertices, indexVector, normals, cosThreshold);
+    }
+
+    // reorder triangles for post-transform vertex cache, then triangle clusters
+    // for overdraw, then vertices for vertex fetch.
+    // All streams are built from uniqueVertices, so reordering it reorders every stream
+    PhaseTimer optimizationTimer(Phase::Optimization, indexVector.size() / 3);
+    uint32_t vertexCount = static_cast<uint32_t>(uniqueVertices.size());
+    uint32_t positionSize = settings.positionEncoding == PositionEncoding::UNorm16 ? 8 : (settings.convertPositionsToFloat32 ? 4 : 8) * 3;
+    if (stats != nullptr)
+    {
+        stats->vertexCacheBefore = analyzeVertexCache(indexVector, vertexCount);
+        stats->vertexFetchBefore = analyzeVertexFetch(indexVector, vertexCount, positionSize);
+    }
+    if (settings.vertexCacheMethod != VertexCacheMethod::None)
+    {
+        optimizeVertexCache(indexVector, vertexCount, settings.vertexCacheMethod);
+    }
+    if (settings.overdrawThreshold > 0.0f && !controlPoints.empty())
+    {
+        std::vector<float> positions = getVertexPositions(controlPoints, uniqueVertices);
+        if (stats != nullptr)
+        {
+            stats->overdrawBefore = analyzeOverdraw(indexVector, positions);
+        }
+        optimizeOverdraw(indexVector, positions, std::max(1.0f, settings.overdrawThreshold));
+        if (stats != nullptr)
+        {
+            stats->overdrawAfter = analyzeOverdraw(indexVector, positions);
+        }
+    }
+    if (settings.optimizeVertexFetch)
+    {
+        optimizeVertexFetch(indexVector, uniqueVertices);
+    }
+    if (stats != nullptr)
+    {
+        stats->vertexCacheAfter = analyzeVertexCache(indexVector, vertexCount);
+        stats->vertexFetchAfter = analyzeVertexFetch(indexVector, vertexCount, positionSize);
+    }
+    optimizationTimer.stop();
+    PhaseTimer streamBuildingTimer(Phase::StreamBuilding, vertexCount);
+
+    // save indices
+    if (indexVector.size() > 0)
+    {
+        VectorStream indexStream;
+
+        indexStream.elementType = static_cast<uint32_t>(StreamElementType::UInt);
+        indexStream.elementVectorSize = 1;
+        if (uniqueVertices.size() < 65535)
+        {
+            indexStream.elementSize = 2;
+        }
+        else
+        {
+            indexStream.elementSize = 4;
+        }
+        uint32_t dataSize = indexStream.elementSize * indexStream.elementVectorSize * static_cast<uint32_t>(indexVector.size());
+        indexStream.streamSize = dataSize + indexStream.headerSize();
+        indexStream.data.resize(dataSize);
+        uint32_t dataOffset = 0;
+        if (indexStream.elementSize == 2)
+        {
+            for (size_t index = 0; index < indexVector.size(); ++index)
+            {
+                uint16_t indexValue = static_cast<uint16_t>(indexVector[index]);
+                memcpy(indexStream.data.data() + dataOffset, &indexValue, sizeof(indexValue));
+                dataOffset += indexStream.elementSize * indexStream.elementVectorSize;
+            }
+        }
+        else //if (indexStream.elementSize == 4)
+        {
+            memcpy(indexStream.data.data(), indexVector.data(), dataSize);
+        }
+        indexStream.elementCount = static_cast<uint32_t>(indexVector.size());
+        indexStream.attributeType = static_cast<uint32_t>(AttributeType::Index);
+        mesh.streams.push_back(indexStream);
+    }
+
+    // normals
+    if (normals.size() > 0)
+    {
+        uint32_t fieldOffset = offsetof(IndexSet, normal);
+        VectorStream normalStream = createDirectionStream(normals, uniqueVertices, fieldOffset, settings.normalEncoding,
+                                                          stats != nullptr ? &stats->normalError : nullptr);
+        normalStream.attributeType = static_cast<uint32_t>(AttributeType::Normal);
+        mesh.streams.push_back(normalStream);
+    }
+    // texture coordinates
+    if (UVs.size() > 0)
+    {
+        VectorStream uvStream;
+        uvStream.elementType = static_cast<uint32_t>(StreamElementType::Float);
+        uvStream.elementVectorSize = 2;
+        uvStream.elementSize = settings.uvEncoding == UVEncoding::Half ? 2 : 4;
+        uint32_t dataSize = uvStream.elementSize * uvStream.elementVectorSize * static_cast<uint32_t>(uniqueVertices.size());
+        uvStream.streamSize = dataSize + uvStream.headerSize();
+        uvStream.data.resize(dataSize);
+        if (settings.uvEncoding == UVEncoding::Half)
+        {
+            uint32_t dataOffset = 0;
+            for (size_t vertexIndex = 0; vertexIndex < uniqueVertices.size(); ++vertexIndex)
+            {
+                float uv[2];
+                const auto uvData = UVs[uniqueVertices[vertexIndex].uv].mData;
+                uv[0] = static_cast<float>(uvData[0]);
+                uv[1] = static_cast<float>(uvData[1]);
+                uint16_t halfUV[2] = { floatToHalf(uv[0]), floatToHalf(uv[1]) };
+                memcpy(uvStream.data.data() + dataOffset, halfUV, sizeof(halfUV));
+                for (int component = 0; stats != nullptr && component < 2; ++component)
+                {
+                    double error = std::abs(double(halfToFloat(halfUV[component])) - uv[component]);
+                    stats->uvError.add(error, getHalfErrorBound(uv[component]));
+                }
+                dataOffset += uvStream.elementSize * uvStream.elementVectorSize;
+            }
+        }
+        else
+        {
+            packFloat2(UVs, uniqueVertices, offsetof(IndexSet, uv), uvStream.data.data());
+        }
+        uvStream.elementCount = static_cast<uint32_t>(uniqueVertices.size());
+        uvStream.attributeType = static_cast<uint32_t>(AttributeType::UV);
+        mesh.streams.push_back(uvStream);
+    }
+    // tangents
+    if (tangents.size() > 0)
+    {
+        uint32_t fieldOffset = offsetof(IndexSet, tangent);
+        VectorStream tangentStream = createDirectionStream(tangents, uniqueVertices, fieldOffset, settings.tangentEncoding,
+                                                           stats != nullptr ? &stats->tangentError : nullptr);
+        tangentStream.attributeType = static_cast<uint32_t>(AttributeType::Tangent);
+        mesh.streams.push_back(tangentStream);
+    }
+    // binormals
+    if (binormals.size() > 0)
+    {
+        uint32_t fieldOffset = offsetof(IndexSet, binormal);
+        VectorStream binormalStream = createDirectionStream(binormals, uniqueVertices, fieldOffset, settings.tangentEncoding,
+                                                            stats != nullptr ? &stats->tangentError : nullptr);
+        binormalStream.attributeType = static_cast<uint32_t>(AttributeType::Binormal);
+        mesh.streams.push_back(binormalStream);
+    }
+    // import vertices
+    if (settings.positionEncoding == PositionEncoding::UNorm16 && uniqueVertices.size() > 0 && !controlPoints.empty())
+    {
+        addQuantizedPositionStreams(mesh, controlPoints, uniqueVertices, stats != nullptr ? &stats->positionError : nullptr);
+    }
+    else if (uniqueVertices.size() > 0 && !controlPoints.empty()) // remove 4th dimension
+    {
+        VectorStream vertexStream;
+
+        vertexStream.elementType = static_cast<uint32_t>(StreamElementType::Float);
+        vertexStream.elementVectorSize = 3;
+        if (settings.convertPositionsToFloat32)
+        {
+            vertexStream.elementSize = 4;
+        }
+        else
+        {
+            vertexStream.elementSize = 8;
+        }
+        uint32_t dataSize = vertexStream.elementSize * vertexStream.elementVectorSize * static_cast<uint32_t>(uniqueVertices.size());
+        vertexStream.streamSize = dataSize + vertexStream.headerSize();
+        vertexStream.data.resize(dataSize);
+        if (settings.convertPositionsToFloat32)
+        {
+            packFloat3(controlPoints, uniqueVertices, offsetof(IndexSet, controlPoint), vertexStream.data.data());
+        }
+        else
+        {
+            uint32_t dataOffset = 0;
+            for (size_t vertexIndex = 0; vertexIndex < uniqueVertices.size(); ++vertexIndex)
+            {
+                int uniqueIndex = uniqueVertices[vertexIndex].controlPoint;
+                const auto &controlPoint = controlPoints[uniqueIndex];
+                double position[3];
+                position[0] = controlPoint.mData[0];
+                position[1] = controlPoint.mData[1];
+                position[2] = controlPoint.mData[2];
+                memcpy(vertexStream.data.data() + dataOffset, position, sizeof(position));
+                dataOffset += vertexStream.elementSize * vertexStream.elementVectorSize;
+            }
+        }
+        vertexStream.elementCount = static_cast<uint32_t>(uniqueVertices.size());
+        vertexStream.attributeType = static_cast<uint32_t>(AttributeType::Position);
+        mesh.streams.push_back(vertexStream);
+    }
+
+    interleaveVertexStreams(mesh, settings.vertexLayout, settings.vertexStrideAlignment);
+
+    // meshlets of final index order
+    if (settings.meshletMaxVertices > 0 && !indexVector.empty() && !controlPoints.empty())
+    {
+        MeshletData meshletData;
+        buildMeshlets(indexVector, vertexCount, settings.meshletMaxVertices, settings.meshletMaxTriangles, meshletData);
+        computeMeshletBounds(meshletData, getVertexPositions(controlPoints, uniqueVertices));
+        addMeshletStreams(mesh, meshletData);
+        if (stats != nullptr)
+        {
+            stats->meshletCount = static_cast<uint32_t>(meshletData.meshlets.size());
+            stats->meshletVertexCount = static_cast<uint32_t>(meshletData.vertices.size());
+        }
+    }
+
+    mesh.header.streamCount = static_cast<uint32_t>(mesh.streams.size());
+    return mesh;
+}
+
+static uint32_t getIndexCount(const StreamMesh &mesh)
+{
+    uint32_t indexCount = 0;
+    for (const auto &stream : mesh.streams)
+    {
+        if (stream.attributeType == static_cast<uint32_t>(AttributeType::Index))
+        {
+            indexCount = stream.elementCount;
+        }
+    }
+    return indexCount;
+}
+
+bool convertRawMeshes(uint32_t meshCount, const RawMeshSource &rawMeshSource, const ImportSettings &settings,
+                      const MeshSink &meshSink, ImportFBXResult &result, ThreadPool *threadPool,
+                      const std::vector<bool> &transformableMeshes)
+{
+    // each mesh has its own slot so result order doesn't depend on thread timing
+    if (!meshSink)
+    {
+        result.sceneMeshes.resize(meshCount);
+    }
+    result.meshIndexCounts.resize(meshCount);
+    result.meshStats.resize(meshCount);
+    bool sinkFailed = false;
+    std::unique_ptr<ThreadPool> ownThreadPool;
+    if (threadPool == nullptr)
+    {
+        ownThreadPool.reset(new ThreadPool(settings.threadCount));
+        threadPool = ownThreadPool.get();
+    }
+    // the pool can be shared with conversions of other files
+    TaskGroup taskGroup(*threadPool);
+    size_t maxMeshesInFlight = settings.maxMeshesInFlight;
+    if (maxMeshesInFlight == 0)
+    {
+        maxMeshesInFlight = 2 * std::max(1u, threadPool->threadCount());
+    }
+    std::mutex sinkMutex;
+    for (uint32_t meshIndex = 0; meshIndex < meshCount; ++meshIndex)
+    {
+        // don't extract more meshes than the pool can take, raw meshes are big
+        {
+            TraceZone waitZone("waitForConversion");
+            waitZone.arg("mesh", meshIndex);
+            taskGroup.waitForPending(maxMeshesInFlight - 1);
+        }
+        TraceZone extractZone("extractMesh");
+        extractZone.arg("mesh", meshIndex);
+        PhaseTimer polygonWalkTimer(Phase::PolygonWalk);
+        auto rawMesh = std::make_shared<RawMesh>(rawMeshSource(meshIndex));
+        polygonWalkTimer.setItemCount(rawMesh->polygonVertices.size());
+        polygonWalkTimer.stop();
+        extractZone.end();
+        taskGroup.submit([rawMesh, meshIndex, &result, &settings, &meshSink, &sinkFailed, &sinkMutex]()
+        {
+            TraceZone convertZone("convertMesh");
+            convertZone.arg("mesh", meshIndex);
+            convertZone.arg("corners", static_cast<int64_t>(rawMesh->polygonVertices.size()));
+            auto convertStart = std::chrono::steady_clock::now();
+            auto mesh = convertRawMesh(*rawMesh, settings, &result.meshStats[meshIndex]);
+            result.meshStats[meshIndex].convertSeconds =
+                std::chrono::duration<double>(std::chrono::steady_clock::now() - convertStart).count();
+            result.meshIndexCounts[meshIndex] = getIndexCount(mesh);
+            convertZone.arg("triangles", result.meshStats[meshIndex].vertexCacheAfter.triangleCount);
+            convertZone.arg("vertices", result.meshStats[meshIndex].vertexCacheAfter.vertexCount);
+            convertZone.end();
+            if (!meshSink)
+            {
+                result.sceneMeshes[meshIndex] = std::move(mesh);
+            }
+            else if (!meshSink(meshIndex, std::move(mesh)))
+            {
+                std::lock_guard<std::mutex> lock(sinkMutex);
+                sinkFailed = true;
+            }
+        });
+    }
+    TraceZone waitZone("waitForConversion");
+    taskGroup.wait();
+    waitZone.end();
+    // meshes written by the sink can't be removed, deduplication needs all of them
+    if (!meshSink && settings.deduplicateMeshes)
+    {
+        PhaseTimer instancingTimer(Phase::Instancing, meshCount);
+        result.meshRemap = deduplicateMeshes(result.sceneMeshes, settings.deduplicateTolerance, *threadPool,
+                                             result.instancingStats);
+        // exact copies first, they're cheaper to find. A mesh left after it
+        // can become a transformed copy when all its exact copies can
+        if (settings.deduplicateTransformedMeshes)
+        {
+            std::vector<bool> transformableUniqueMeshes(result.sceneMeshes.size(), true);
+            for (uint32_t meshIndex = 0; meshIndex < meshCount; ++meshIndex)
+            {
+                if (meshIndex >= transformableMeshes.size() || !transformableMeshes[meshIndex])
+                {
+                    transformableUniqueMeshes[result.meshRemap[meshIndex]] = false;
+                }
+            }
+            std::vector<InstanceTransform> uniqueMeshTransforms;
+            auto transformedRemap = deduplicateTransformedMeshes(result.sceneMeshes, settings.deduplicateTolerance,
+                                                                 transformableUniqueMeshes, *threadPool,
+                                                                 result.instancingStats, uniqueMeshTransforms);
+            result.meshTransforms.resize(meshCount);
+            for (uint32_t meshIndex = 0; meshIndex < meshCount; ++meshIndex)
+            {
+                result.meshTransforms[meshIndex] = uniqueMeshTransforms[result.meshRemap[meshIndex]];
+                result.meshRemap[meshIndex] = transformedRemap[result.meshRemap[meshIndex]];
+            }
+        }
+        std::vector<uint32_t> meshIndexCounts(result.sceneMeshes.size());
+        std::vector<bool> isFirstCopy(result.sceneMeshes.size(), true);
+        for (uint32_t meshIndex = 0; meshIndex < meshCount; ++meshIndex)
+        {
+            uint32_t sceneMeshIndex = result.meshRemap[meshIndex];
+            meshIndexCounts[sceneMeshIndex] = result.meshIndexCounts[meshIndex];
+            if (!isFirstCopy[sceneMeshIndex])
+            {
+                result.instancingStats.duplicateConvertSeconds += result.meshStats[meshIndex].convertSeconds;
+            }
+            isFirstCopy[sceneMeshIndex] = false;
+        }
+        result.meshIndexCounts = std::move(meshIndexCounts);
+    }
+    return !sinkFailed;
+}
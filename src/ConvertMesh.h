@@ -0,0 +1,52 @@
+//-----------------------------------------------------------------------------
+// ConvertMesh.h
+// Created at 2026.10.17 11:30
+// License: see LICENSE file
+//
+// converts RawMesh to StreamMesh: triangulation, welding, vertex streams
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+
+#include "StreamMeshData.h"
+#include "RawMesh.h"
+#include "ImportFBX.h"
+
+#include <functional>
+
+VectorStream createFloat3Stream(
+    const std::vector<RawVector4> &srcData,
+    const std::vector<IndexSet> &vertexIndices,
+    uint32_t indexFieldOffset
+);
+
+// 2 x snorm16 or 2 x snorm8 octahedral unit vectors, angle errors are added to error when not null
+VectorStream createOctahedralStream(
+    const std::vector<RawVector4> &srcData,
+    const std::vector<IndexSet> &vertexIndices,
+    uint32_t indexFieldOffset,
+    uint32_t bits,
+    EncodingError *error
+);
+
+// fan triangulation of rawMesh polygons, 3 IndexSets per triangle
+void triangulatePolygons(const RawMesh &rawMesh, std::vector<IndexSet> &indexSets);
+
+// doesn't call FBX SDK and can run on any thread.
+// rawMesh.normals are modified when vertices with similar normals are merged.
+// stats are filled when not null
+StreamMesh convertRawMesh(RawMesh &rawMesh, const ImportSettings &settings, MeshConvertStats *stats = nullptr);
+
+// returns RawMesh of scene mesh meshIndex, called on the thread of convertRawMeshes in mesh order
+using RawMeshSource = std::function<RawMesh(uint32_t meshIndex)>;
+
+// extracts meshCount meshes one by one and converts them on threadPool (own pool of
+// settings.threadCount threads when null) while next meshes are extracted, at most
+// settings.maxMeshesInFlight extracted meshes wait for conversion. Fills sceneMeshes
+// (when meshSink isn't set), meshIndexCounts and meshStats of result in mesh order.
+// With deduplication, meshRemap and meshTransforms too; transformableMeshes are
+// meshes whose nodes can take an instance transform (see isUniformScale).
+// Returns false when meshSink failed
+bool convertRawMeshes(uint32_t meshCount, const RawMeshSource &rawMeshSource, const ImportSettings &settings,
+                      const MeshSink &meshSink, ImportFBXResult &result, ThreadPool *threadPool = nullptr,
+                      const std::vector<bool> &transformableMeshes = std::vector<bool>());
@@ -6,38 +6,416 @@
 // saves stream mesh to file
 //-----------------------------------------------------------------------------
 #include "ExportMesh.h"
+#include "PhaseStats.h"
 #include "StreamMeshData.h"
+#include "ThreadPool.h"
 
-template <typename T>
-void writeToStream(std::ostream &ofs, T value)
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // offset and size alignment required for unbuffered writes
+    const uint32_t DirectIOAlignment = 4096;
+    // write buffers up to this size are kept for the next file of the thread, larger
+    // ones are freed so memory of --pipeline stays bounded by meshes in flight
+    const size_t MaxKeptBufferSize = 16u << 20;
+
+    template <typename T>
+    inline uint8_t* writeToBuffer(uint8_t *destination, T value)
+    {
+        memcpy(destination, &value, sizeof(value));
+        return destination + sizeof(value);
+    }
+}
+
+static inline uint64_t alignOffset(uint64_t offset, uint32_t alignment)
+{
+    return (offset + alignment - 1) & ~uint64_t(alignment - 1);
+}
+
+uint64_t layoutMeshFileV2(const StreamMesh &meshData, uint32_t streamAlignment,
+                          StreamMeshFileHeader &header, std::vector<StreamDirectoryEntry> &directory)
+{
+    header = StreamMeshFileHeader();
+    header.streamCount = static_cast<uint32_t>(meshData.streams.size());
+    header.streamAlignment = std::max(1u, streamAlignment);
+    directory.resize(meshData.streams.size());
+    uint64_t offset = header.directoryOffset + sizeof(StreamDirectoryEntry) * directory.size();
+    for (size_t streamIndex = 0; streamIndex < meshData.streams.size(); ++streamIndex)
+    {
+        const auto &streamData = meshData.streams[streamIndex];
+        auto &entry = directory[streamIndex];
+        entry.attributeType = streamData.attributeType;
+        entry.elementType = streamData.elementType;
+        entry.elementSize = streamData.elementSize;
+        entry.elementVectorSize = streamData.elementVectorSize;
+        entry.elementCount = streamData.elementCount;
+        entry.dataOffset = alignOffset(offset, header.streamAlignment);
+        entry.dataSize = streamData.data.size();
+        offset = entry.dataOffset + entry.dataSize;
+    }
+    header.fileSize = offset;
+    return offset;
+}
+
+std::vector<CompressedStream> compressMeshStreams(const StreamMesh &meshData, const StreamCompressionSettings &settings)
+{
+    std::vector<CompressedStream> compressedStreams;
+    compressedStreams.reserve(meshData.streams.size());
+    for (const auto &streamData : meshData.streams)
+    {
+        compressedStreams.push_back(compressStream(streamData, settings));
+    }
+    return compressedStreams;
+}
+
+uint64_t layoutMeshFileV3(const StreamMesh &meshData, const std::vector<CompressedStream> &compressedStreams,
+                          uint32_t streamAlignment, StreamMeshFileHeader &header,
+                          std::vector<StreamDirectoryEntryV3> &directory)
+{
+    assert(compressedStreams.size() == meshData.streams.size());
+    header = StreamMeshFileHeader();
+    header.version = StreamConstants::MeshFileVersion3;
+    header.streamCount = static_cast<uint32_t>(meshData.streams.size());
+    header.streamAlignment = std::max(1u, streamAlignment);
+    directory.resize(meshData.streams.size());
+    uint64_t offset = header.directoryOffset + sizeof(StreamDirectoryEntryV3) * directory.size();
+    for (size_t streamIndex = 0; streamIndex < meshData.streams.size(); ++streamIndex)
+    {
+        const auto &streamData = meshData.streams[streamIndex];
+        const auto &compressedStream = compressedStreams[streamIndex];
+        auto &entry = directory[streamIndex];
+        entry.attributeType = streamData.attributeType;
+        entry.elementType = streamData.elementType;
+        entry.elementSize = streamData.elementSize;
+        entry.elementVectorSize = streamData.elementVectorSize;
+        entry.elementCount = streamData.elementCount;
+        entry.dataOffset = alignOffset(offset, header.streamAlignment);
+        entry.codec = static_cast<uint32_t>(compressedStream.codec);
+        entry.filter = static_cast<uint32_t>(compressedStream.filter);
+        entry.uncompressedSize = streamData.data.size();
+        bool compressed = compressedStream.codec != StreamCodec::None;
+        entry.dataSize = compressed ? compressedStream.data.size() : streamData.data.size();
+        offset = entry.dataOffset + entry.dataSize;
+    }
+    header.fileSize = offset;
+    return offset;
+}
+
+static void serializeMeshV1(const StreamMesh &meshData, uint8_t *destination)
+{
+    destination = writeToBuffer(destination, meshData.header.magicMESH);
+    destination = writeToBuffer(destination, meshData.header.headerSize);
+    destination = writeToBuffer(destination, StreamConstants::MeshFileVersion1);
+    destination = writeToBuffer(destination, meshData.header.streamCount);
+    for (const auto &streamData : meshData.streams)
+    {
+        destination = writeToBuffer(destination, streamData.magicSTRM);
+        destination = writeToBuffer(destination, streamData.streamSize);
+        destination = writeToBuffer(destination, streamData.elementCount);
+        destination = writeToBuffer(destination, streamData.elementType);
+        destination = writeToBuffer(destination, streamData.elementSize);
+        destination = writeToBuffer(destination, streamData.elementVectorSize);
+        destination = writeToBuffer(destination, streamData.attributeType);
+        if (!streamData.data.empty())
+        {
+            memcpy(destination, streamData.data.data(), streamData.data.size());
+        }
+        destination += streamData.data.size();
+    }
+}
+
+static void serializeMeshV2(const StreamMesh &meshData, uint32_t streamAlignment, uint8_t *destination)
+{
+    StreamMeshFileHeader header;
+    std::vector<StreamDirectoryEntry> directory;
+    layoutMeshFileV2(meshData, streamAlignment, header, directory);
+    memcpy(destination, &header, sizeof(header));
+    uint64_t offset = sizeof(header);
+    if (!directory.empty())
+    {
+        memcpy(destination + offset, directory.data(), sizeof(StreamDirectoryEntry) * directory.size());
+    }
+    offset += sizeof(StreamDirectoryEntry) * directory.size();
+    for (size_t streamIndex = 0; streamIndex < directory.size(); ++streamIndex)
+    {
+        const auto &entry = directory[streamIndex];
+        memset(destination + offset, 0, entry.dataOffset - offset);
+        if (entry.dataSize > 0)
+        {
+            memcpy(destination + entry.dataOffset, meshData.streams[streamIndex].data.data(), entry.dataSize);
+        }
+        offset = entry.dataOffset + entry.dataSize;
+    }
+}
+
+static void serializeMeshV3(const StreamMesh &meshData, const std::vector<CompressedStream> &compressedStreams,
+                            uint32_t streamAlignment, uint8_t *destination)
+{
+    StreamMeshFileHeader header;
+    std::vector<StreamDirectoryEntryV3> directory;
+    layoutMeshFileV3(meshData, compressedStreams, streamAlignment, header, directory);
+    memcpy(destination, &header, sizeof(header));
+    uint64_t offset = sizeof(header);
+    if (!directory.empty())
+    {
+        memcpy(destination + offset, directory.data(), sizeof(StreamDirectoryEntryV3) * directory.size());
+    }
+    offset += sizeof(StreamDirectoryEntryV3) * directory.size();
+    for (size_t streamIndex = 0; streamIndex < directory.size(); ++streamIndex)
+    {
+        const auto &entry = directory[streamIndex];
+        const auto &compressedStream = compressedStreams[streamIndex];
+        memset(destination + offset, 0, entry.dataOffset - offset);
+        if (entry.dataSize > 0)
+        {
+            const auto &data = compressedStream.codec != StreamCodec::None ? compressedStream.data
+                                                                            : meshData.streams[streamIndex].data;
+            memcpy(destination + entry.dataOffset, data.data(), entry.dataSize);
+        }
+        offset = entry.dataOffset + entry.dataSize;
+    }
+}
+
+void serializeMesh(const StreamMesh &meshData, const MeshFileFormat &format, uint8_t *destination)
 {
-    ofs.write((char*)&value, sizeof(value));
+    if (format.version == StreamConstants::MeshFileVersion1)
+    {
+        serializeMeshV1(meshData, destination);
+    }
+    else if (format.version == StreamConstants::MeshFileVersion3)
+    {
+        serializeMeshV3(meshData, compressMeshStreams(meshData, format.compression), format.streamAlignment, destination);
+    }
+    else
+    {
+        serializeMeshV2(meshData, format.streamAlignment, destination);
+    }
 }
 
-bool exportMeshToFile(const std::string &fileName, const StreamMesh &meshData)
+#ifdef _WIN32
+static bool writeFile(const std::string &fileName, const uint8_t *data, uint64_t size, bool directIO)
+{
+    DWORD flags = directIO ? FILE_FLAG_NO_BUFFERING : FILE_FLAG_SEQUENTIAL_SCAN;
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | flags, nullptr);
+    if (file == INVALID_HANDLE_VALUE && directIO)
+    {
+        return writeFile(fileName, data, size, false);
+    }
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    // unbuffered writes must have aligned size, data is padded and file is cut to real size below
+    uint64_t writeSize = directIO ? alignOffset(size, DirectIOAlignment) : size;
+    bool success = true;
+    for (uint64_t offset = 0; success && offset < writeSize;)
+    {
+        DWORD chunkSize = static_cast<DWORD>(std::min<uint64_t>(writeSize - offset, 1u << 30));
+        DWORD writtenSize = 0;
+        success = WriteFile(file, data + offset, chunkSize, &writtenSize, nullptr) != FALSE && writtenSize > 0;
+        offset += writtenSize;
+    }
+    success = CloseHandle(file) != FALSE && success;
+    if (success && writeSize != size)
+    {
+        // SetEndOfFile needs a handle without FILE_FLAG_NO_BUFFERING for unaligned size
+        file = CreateFileA(fileName.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER fileSize;
+        fileSize.QuadPart = static_cast<LONGLONG>(size);
+        success = file != INVALID_HANDLE_VALUE &&
+                  SetFilePointerEx(file, fileSize, nullptr, FILE_BEGIN) != FALSE &&
+                  SetEndOfFile(file) != FALSE;
+        if (file != INVALID_HANDLE_VALUE)
+        {
+            success = CloseHandle(file) != FALSE && success;
+        }
+    }
+    return success;
+}
+#else
+static bool writeFile(const std::string &fileName, const uint8_t *data, uint64_t size, bool directIO)
 {
-    using namespace std;
-    ofstream ofs;
-    ofs.open(fileName, ios_base::binary | ios_base::out | ios_base::trunc);//ios_base::beg
-    if (!ofs.is_open())
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+    if (directIO)
+    {
+        flags |= O_DIRECT;
+    }
+#else
+    directIO = false;
+#endif
+    int fileDescriptor = ::open(fileName.c_str(), flags, 0644);
+    if (fileDescriptor < 0 && directIO && errno == EINVAL)
+    {
+        return writeFile(fileName, data, size, false);
+    }
+    if (fileDescriptor < 0)
     {
         return false;
     }
-    writeToStream(ofs, meshData.header.magicMESH);
-    writeToStream(ofs, meshData.header.headerSize);
-    writeToStream(ofs, meshData.header.version);
-    writeToStream(ofs, meshData.header.streamCount);
+    // unbuffered writes must have aligned size, data is padded and file is cut to real size below
+    uint64_t writeSize = directIO ? alignOffset(size, DirectIOAlignment) : size;
+    bool success = true;
+    for (uint64_t offset = 0; success && offset < writeSize;)
+    {
+        ssize_t writtenSize = ::write(fileDescriptor, data + offset, std::min<uint64_t>(writeSize - offset, 1u << 30));
+        if (writtenSize < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        success = writtenSize > 0;
+        offset += success ? writtenSize : 0;
+    }
+    if (!success && directIO && errno == EINVAL)
+    {
+        // file system accepted O_DIRECT in open() but not the write
+        ::close(fileDescriptor);
+        return writeFile(fileName, data, size, false);
+    }
+    if (success && writeSize != size)
+    {
+        success = ftruncate(fileDescriptor, static_cast<off_t>(size)) == 0;
+    }
+    // no fsync/fdatasync: files are flushed by OS like with ofstream
+    success = ::close(fileDescriptor) == 0 && success;
+    return success;
+}
+#endif
+
+static bool writeMeshFile(const std::string &fileName, const StreamMesh &meshData, const MeshFileFormat &format,
+                          uint64_t &fileSize)
+{
+    // whole file is assembled in memory and written with one call.
+    // Buffer is kept for the thread, so writing many small files doesn't allocate
+    thread_local std::vector<uint8_t> buffer;
+    // version 3 streams are compressed once and used for both layout and serialization
+    std::vector<CompressedStream> compressedStreams;
+    bool compressed = format.version == StreamConstants::MeshFileVersion3;
+    if (compressed)
+    {
+        uint64_t streamBytes = 0;
+        for (const auto &streamData : meshData.streams)
+        {
+            streamBytes += streamData.data.size();
+        }
+        PhaseTimer compressionTimer(Phase::StreamCompression, streamBytes);
+        compressedStreams = compressMeshStreams(meshData, format.compression);
+        StreamMeshFileHeader header;
+        std::vector<StreamDirectoryEntryV3> directory;
+        fileSize = layoutMeshFileV3(meshData, compressedStreams, format.streamAlignment, header, directory);
+    }
+    else
+    {
+        fileSize = getMeshFileSize(meshData, format);
+    }
+    PhaseTimer writeTimer(Phase::MeshWrite, fileSize);
+    uint64_t bufferSize = fileSize;
+    if (format.directIO)
+    {
+        // room to align start and to pad the end to DirectIOAlignment
+        bufferSize = alignOffset(fileSize, DirectIOAlignment) + DirectIOAlignment;
+    }
+    if (buffer.size() < bufferSize)
+    {
+        buffer.resize(bufferSize);
+    }
+    uint8_t *data = buffer.data();
+    if (format.directIO)
+    {
+        data += alignOffset(reinterpret_cast<uintptr_t>(data), DirectIOAlignment) - reinterpret_cast<uintptr_t>(data);
+        memset(data + fileSize, 0, alignOffset(fileSize, DirectIOAlignment) - fileSize);
+    }
+    if (compressed)
+    {
+        serializeMeshV3(meshData, compressedStreams, format.streamAlignment, data);
+    }
+    else
+    {
+        serializeMesh(meshData, format, data);
+    }
+    bool success = writeFile(fileName, data, fileSize, format.directIO);
+    if (buffer.capacity() > MaxKeptBufferSize)
+    {
+        std::vector<uint8_t>().swap(buffer);
+    }
+    return success;
+}
+
+bool exportMeshToFile(const std::string &fileName, const StreamMesh &meshData, const MeshFileFormat &format)
+{
+    uint64_t fileSize = 0;
+    return writeMeshFile(fileName, meshData, format, fileSize);
+}
+
+MeshWriteResult exportMeshToFileTimed(const std::string &fileName, const StreamMesh &meshData,
+                                      const MeshFileFormat &format)
+{
+    MeshWriteResult result;
+    auto start = std::chrono::steady_clock::now();
+    result.fileName = fileName;
+    result.success = writeMeshFile(fileName, meshData, format, result.byteCount);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+uint64_t getMeshFileSize(const StreamMesh &meshData, const MeshFileFormat &format)
+{
+    if (format.version == StreamConstants::MeshFileVersion3)
+    {
+        StreamMeshFileHeader header;
+        std::vector<StreamDirectoryEntryV3> directory;
+        return layoutMeshFileV3(meshData, compressMeshStreams(meshData, format.compression),
+                                format.streamAlignment, header, directory);
+    }
+    if (format.version != StreamConstants::MeshFileVersion1)
+    {
+        StreamMeshFileHeader header;
+        std::vector<StreamDirectoryEntry> directory;
+        return layoutMeshFileV2(meshData, format.streamAlignment, header, directory);
+    }
+    uint64_t size = meshData.header.headerSize;
     for (const auto &streamData : meshData.streams)
     {
-        writeToStream(ofs, streamData.magicSTRM);
-        writeToStream(ofs, streamData.streamSize);
-        writeToStream(ofs, streamData.elementCount);
-        writeToStream(ofs, streamData.elementType);
-        writeToStream(ofs, streamData.elementSize);
-        writeToStream(ofs, streamData.elementVectorSize);
-        writeToStream(ofs, streamData.attributeType);
-        ofs.write((char*)streamData.data.data(), streamData.data.size());
-    }
-    ofs.close();
-    return true;
+        size += streamData.headerSize() + streamData.data.size();
+    }
+    return size;
+}
+
+std::vector<MeshWriteResult> exportMeshesToFiles(const std::vector<std::string> &fileNames,
+                                                 const std::vector<StreamMesh> &meshes,
+                                                 uint32_t maxInFlight,
+                                                 const MeshFileFormat &format)
+{
+    assert(fileNames.size() == meshes.size());
+    std::vector<MeshWriteResult> results(meshes.size());
+    // every pool thread writes one file at a time, so pool size limits files in flight.
+    // More threads than meshes would only wait
+    size_t threadCount = std::min<size_t>(maxInFlight, meshes.size());
+    ThreadPool threadPool(static_cast<uint32_t>(std::max<size_t>(1, threadCount)));
+    for (size_t meshIndex = 0; meshIndex < meshes.size(); ++meshIndex)
+    {
+        const auto &fileName = fileNames[meshIndex];
+        const auto &mesh = meshes[meshIndex];
+        auto &result = results[meshIndex];
+        threadPool.submit([&fileName, &mesh, &result, &format, meshIndex]()
+        {
+            TraceZone exportZone("exportMesh");
+            exportZone.arg("mesh", static_cast<int64_t>(meshIndex));
+            result = exportMeshToFileTimed(fileName, mesh, format);
+        });
+    }
+    threadPool.wait();
+    return results;
 }
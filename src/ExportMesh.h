@@ -8,7 +8,57 @@
 #pragma once
 #include "stdafx.h"
 
-struct StreamMesh;
+#include "StreamMeshData.h"
+#include "StreamCompression.h"
 
-bool exportMeshToFile(const std::string &fileName, const StreamMesh &meshData);
+struct MeshFileFormat
+{
+    uint32_t version = StreamConstants::MeshFileVersion2;
+    uint32_t streamAlignment = StreamConstants::DefaultStreamAlignment; // version 2 and 3, power of two
+    StreamCompressionSettings compression; // version 3 only
+    // write without OS file cache (O_DIRECT / FILE_FLAG_NO_BUFFERING).
+    // Falls back to buffered write when file system doesn't support it
+    bool directIO = false;
+};
 
+struct MeshWriteResult
+{
+    std::string fileName;
+    uint64_t byteCount = 0;
+    double seconds = 0.0; // time spent in exportMeshToFile
+    bool success = false;
+};
+
+bool exportMeshToFile(const std::string &fileName, const StreamMesh &meshData,
+                      const MeshFileFormat &format = MeshFileFormat());
+
+// exportMeshToFile which also measures write time and size
+MeshWriteResult exportMeshToFileTimed(const std::string &fileName, const StreamMesh &meshData,
+                                      const MeshFileFormat &format = MeshFileFormat());
+
+// writes whole file contents to destination, which must have getMeshFileSize() bytes
+void serializeMesh(const StreamMesh &meshData, const MeshFileFormat &format, uint8_t *destination);
+
+// size of the file written by exportMeshToFile.
+// Version 3 streams are compressed to find it, which isn't cheap
+uint64_t getMeshFileSize(const StreamMesh &meshData, const MeshFileFormat &format = MeshFileFormat());
+
+// fills version 2 header and stream directory, returns file size
+uint64_t layoutMeshFileV2(const StreamMesh &meshData, uint32_t streamAlignment,
+                          StreamMeshFileHeader &header, std::vector<StreamDirectoryEntry> &directory);
+
+// compresses every stream of meshData with settings, see compressStream
+std::vector<CompressedStream> compressMeshStreams(const StreamMesh &meshData, const StreamCompressionSettings &settings);
+
+// fills version 3 header and stream directory, compressedStreams are results of
+// compressMeshStreams for meshData. Returns file size
+uint64_t layoutMeshFileV3(const StreamMesh &meshData, const std::vector<CompressedStream> &compressedStreams,
+                          uint32_t streamAlignment, StreamMeshFileHeader &header,
+                          std::vector<StreamDirectoryEntryV3> &directory);
+
+// writes meshes[i] to fileNames[i], at most maxInFlight files are written at
+// the same time. Meshes are not copied. Results are in the same order as meshes
+std::vector<MeshWriteResult> exportMeshesToFiles(const std::vector<std::string> &fileNames,
+                                                 const std::vector<StreamMesh> &meshes,
+                                                 uint32_t maxInFlight,
+                                                 const MeshFileFormat &format = MeshFileFormat());
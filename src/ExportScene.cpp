@@ -10,6 +10,7 @@
 #include "ImportFBX.h"
 #include "Utils.h"
 #include "ExportMaterial.h"
+#include "PhaseStats.h"
 
 template <typename FloatType>
 void appendObjectNodes(Json::Value &jObjectArray, const std::vector<ObjectNode<FloatType>> &objects)
@@ -53,6 +54,7 @@ bool exportSceneToFile(const std::string &fileName,
                        const std::string &meshFilePathPrefix,
                        bool compactJson)
 {
+    PhaseTimer sceneWriteTimer(Phase::SceneWrite, importData.objectsFloat.size() + importData.objectsDouble.size());
     Json::Value jObjectArray;
     appendObjectNodes(jObjectArray, importData.objectsFloat);
     appendObjectNodes(jObjectArray, importData.objectsDouble);
@@ -0,0 +1,392 @@
+//-----------------------------------------------------------------------------
+// FBXBinary.cpp
+// Created at 2026.10.17 19:50
+// License: see LICENSE file
+//
+// reader of binary FBX files (version 7.x) without FBX SDK: tree of node
+// records with their properties. The file is memory-mapped, array
+// properties point into the mapping until they are decompressed
+//-----------------------------------------------------------------------------
+#include "FBXBinary.h"
+
+#include <atomic>
+#include <cstring>
+
+#include "Inflate.h"
+#include "ThreadPool.h"
+
+namespace
+{
+    const char FBXMagic[] = "Kaydara FBX Binary  ";
+    const uint64_t FBXHeaderSize = 27; // magic with zero, 0x1A 0x00, uint32 version
+    const uint32_t MaxNodeDepth = 64;
+    const uint64_t MaxDeflateRatio = 1032; // deflate can't expand more than that
+
+    template <typename T>
+    inline T readValue(const uint8_t *data)
+    {
+        T value;
+        memcpy(&value, data, sizeof(T)); // little-endian
+        return value;
+    }
+}
+
+uint32_t FBXProperty::arrayElementSize() const
+{
+    switch (type)
+    {
+    case 'b':
+        return 1;
+    case 'i':
+    case 'f':
+        return 4;
+    case 'l':
+    case 'd':
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+const uint8_t* FBXProperty::arrayData() const
+{
+    if (!isArray())
+    {
+        return nullptr;
+    }
+    if (encoding == 0)
+    {
+        return data;
+    }
+    return decoded.empty() && arrayLength > 0 ? nullptr : decoded.data();
+}
+
+double FBXProperty::getNumber() const
+{
+    return type == 'F' || type == 'D' ? floatValue : static_cast<double>(intValue);
+}
+
+int64_t FBXProperty::getInteger() const
+{
+    return type == 'F' || type == 'D' ? static_cast<int64_t>(floatValue) : intValue;
+}
+
+const FBXNode* FBXNode::findChild(const char *childName) const
+{
+    for (const auto &child : children)
+    {
+        if (child.name == childName)
+        {
+            return &child;
+        }
+    }
+    return nullptr;
+}
+
+FBXNode* FBXNode::findChild(const char *childName)
+{
+    return const_cast<FBXNode*>(static_cast<const FBXNode*>(this)->findChild(childName));
+}
+
+bool FBXDocument::open(const std::string &fileName)
+{
+    if (!_file.open(fileName))
+    {
+        _error = "can't open file " + fileName;
+        return false;
+    }
+    return parse(_file.data(), _file.size());
+}
+
+bool FBXDocument::fail(const std::string &message, uint64_t offset)
+{
+    _error = message + " at offset " + std::to_string(offset);
+    return false;
+}
+
+bool FBXDocument::parse(const uint8_t *data, uint64_t size)
+{
+    _data = data;
+    _size = size;
+    _nodes.clear();
+    _nodeCount = 0;
+    if (size < FBXHeaderSize || memcmp(data, FBXMagic, sizeof(FBXMagic)) != 0)
+    {
+        _error = "not a binary FBX file";
+        return false;
+    }
+    _version = readValue<uint32_t>(data + 23);
+    if (_version < 7000 || _version >= 8000)
+    {
+        _error = "unsupported binary FBX version " + std::to_string(_version);
+        return false;
+    }
+    uint64_t offset = FBXHeaderSize;
+    return parseNodeList(offset, size, _nodes, 0);
+}
+
+bool FBXDocument::parseNodeList(uint64_t &offset, uint64_t end, std::vector<FBXNode> &nodes, uint32_t depth)
+{
+    if (depth > MaxNodeDepth)
+    {
+        return fail("nodes are nested too deep", offset);
+    }
+    // 7.5 files have 64-bit end offset, property count and property list size
+    bool wideHeader = _version >= 7500;
+    uint64_t recordHeaderSize = wideHeader ? 25 : 13;
+    while (offset < end)
+    {
+        if (offset + recordHeaderSize > end)
+        {
+            return fail("truncated node record", offset);
+        }
+        const uint8_t *header = _data + offset;
+        uint64_t endOffset = wideHeader ? readValue<uint64_t>(header) : readValue<uint32_t>(header);
+        uint64_t propertyCount = wideHeader ? readValue<uint64_t>(header + 8) : readValue<uint32_t>(header + 4);
+        uint64_t propertyListSize = wideHeader ? readValue<uint64_t>(header + 16) : readValue<uint32_t>(header + 8);
+        uint8_t nameLength = header[recordHeaderSize - 1];
+        if (endOffset == 0)
+        {
+            // zero record ends the list
+            offset += recordHeaderSize;
+            return true;
+        }
+        uint64_t propertiesOffset = offset + recordHeaderSize + nameLength;
+        if (endOffset > end || endOffset <= offset || propertiesOffset > endOffset ||
+            propertyListSize > endOffset - propertiesOffset || propertyCount > propertyListSize)
+        {
+            return fail("invalid node record", offset);
+        }
+        nodes.emplace_back();
+        FBXNode &node = nodes.back();
+        ++_nodeCount;
+        node.name.assign(reinterpret_cast<const char*>(header + recordHeaderSize), nameLength);
+        node.properties.resize(propertyCount);
+        uint64_t propertyOffset = propertiesOffset;
+        uint64_t propertiesEnd = propertiesOffset + propertyListSize;
+        for (auto &property : node.properties)
+        {
+            if (!parseProperty(propertyOffset, propertiesEnd, property))
+            {
+                return false;
+            }
+        }
+        offset = propertiesEnd;
+        if (offset < endOffset && !parseNodeList(offset, endOffset, node.children, depth + 1))
+        {
+            return false;
+        }
+        offset = endOffset;
+    }
+    return true;
+}
+
+bool FBXDocument::parseProperty(uint64_t &offset, uint64_t end, FBXProperty &property)
+{
+    if (offset >= end)
+    {
+        return fail("truncated property list", offset);
+    }
+    property.type = static_cast<char>(_data[offset++]);
+    const uint8_t *value = _data + offset;
+    uint64_t valueSize = 0;
+    switch (property.type)
+    {
+    case 'C':
+        valueSize = 1;
+        break;
+    case 'Y':
+        valueSize = 2;
+        break;
+    case 'I':
+    case 'F':
+        valueSize = 4;
+        break;
+    case 'L':
+    case 'D':
+        valueSize = 8;
+        break;
+    case 'S':
+    case 'R':
+        valueSize = 4;
+        break;
+    default:
+        if (!property.isArray())
+        {
+            return fail(std::string("unknown property type '") + property.type + "'", offset - 1);
+        }
+        valueSize = 12; // array length, encoding, size of stored data
+        break;
+    }
+    if (valueSize > end - offset)
+    {
+        return fail("truncated property", offset);
+    }
+    offset += valueSize;
+    switch (property.type)
+    {
+    case 'C':
+        property.intValue = value[0];
+        return true;
+    case 'Y':
+        property.intValue = readValue<int16_t>(value);
+        return true;
+    case 'I':
+        property.intValue = readValue<int32_t>(value);
+        return true;
+    case 'L':
+        property.intValue = readValue<int64_t>(value);
+        return true;
+    case 'F':
+        property.floatValue = readValue<float>(value);
+        return true;
+    case 'D':
+        property.floatValue = readValue<double>(value);
+        return true;
+    case 'S':
+    case 'R':
+        property.dataSize = readValue<uint32_t>(value);
+        break;
+    default:
+        property.arrayLength = readValue<uint32_t>(value);
+        property.encoding = readValue<uint32_t>(value + 4);
+        property.dataSize = readValue<uint32_t>(value + 8);
+        if (property.encoding > 1 ||
+            (property.encoding == 0 && property.dataSize != uint64_t(property.arrayLength) * property.arrayElementSize()) ||
+            (property.encoding == 1 && uint64_t(property.arrayLength) * property.arrayElementSize() > (property.dataSize + 1) * MaxDeflateRatio))
+        {
+            return fail("invalid array property", offset - valueSize - 1);
+        }
+        break;
+    }
+    if (property.dataSize > end - offset)
+    {
+        return fail("truncated property data", offset);
+    }
+    property.data = _data + offset;
+    offset += property.dataSize;
+    return true;
+}
+
+uint64_t FBXDocument::decompressArrays(const std::vector<FBXProperty*> &properties, ThreadPool &threadPool)
+{
+    std::vector<FBXProperty*> compressed;
+    uint64_t totalSize = 0;
+    for (auto property : properties)
+    {
+        if (property->isCompressed())
+        {
+            compressed.push_back(property);
+        }
+        totalSize += uint64_t(property->arrayLength) * property->arrayElementSize();
+    }
+    // every array is one zlib stream, so parallelism is between arrays.
+    // Largest arrays go first to balance threads
+    std::sort(compressed.begin(), compressed.end(), [](const FBXProperty *left, const FBXProperty *right)
+    {
+        return left->dataSize > right->dataSize;
+    });
+    std::atomic<bool> failed(false);
+    {
+        TaskGroup taskGroup(threadPool);
+        for (auto property : compressed)
+        {
+            taskGroup.submit([property, &failed]()
+            {
+                std::vector<uint8_t> decoded(size_t(property->arrayLength) * property->arrayElementSize());
+                if (inflateZlib(property->data, property->dataSize, decoded.data(), decoded.size()))
+                {
+                    property->decoded = std::move(decoded);
+                }
+                else
+                {
+                    failed = true;
+                }
+            });
+        }
+        taskGroup.wait();
+    }
+    if (failed)
+    {
+        _error = "corrupted compressed array";
+        return 0;
+    }
+    return totalSize;
+}
+
+const FBXNode* FBXDocument::findNode(const char *name) const
+{
+    for (const auto &node : _nodes)
+    {
+        if (node.name == name)
+        {
+            return &node;
+        }
+    }
+    return nullptr;
+}
+
+FBXNode* FBXDocument::findNode(const char *name)
+{
+    return const_cast<FBXNode*>(static_cast<const FBXDocument*>(this)->findNode(name));
+}
+
+bool getArray(const FBXProperty &property, std::vector<double> &values)
+{
+    const uint8_t *data = property.arrayData();
+    if (data == nullptr && property.arrayLength > 0)
+    {
+        return false;
+    }
+    values.resize(property.arrayLength);
+    if (values.empty())
+    {
+        return property.type == 'd' || property.type == 'f';
+    }
+    if (property.type == 'd')
+    {
+        memcpy(values.data(), data, values.size() * sizeof(double));
+    }
+    else if (property.type == 'f')
+    {
+        for (size_t index = 0; index < values.size(); ++index)
+        {
+            values[index] = readValue<float>(data + index * sizeof(float));
+        }
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+bool getArray(const FBXProperty &property, std::vector<int32_t> &values)
+{
+    const uint8_t *data = property.arrayData();
+    if (data == nullptr && property.arrayLength > 0)
+    {
+        return false;
+    }
+    values.resize(property.arrayLength);
+    if (values.empty())
+    {
+        return property.type == 'i' || property.type == 'l';
+    }
+    if (property.type == 'i')
+    {
+        memcpy(values.data(), data, values.size() * sizeof(int32_t));
+    }
+    else if (property.type == 'l')
+    {
+        for (size_t index = 0; index < values.size(); ++index)
+        {
+            values[index] = static_cast<int32_t>(readValue<int64_t>(data + index * sizeof(int64_t)));
+        }
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,92 @@
+//-----------------------------------------------------------------------------
+// FBXBinary.h
+// Created at 2026.10.17 19:50
+// License: see LICENSE file
+//
+// reader of binary FBX files (version 7.x) without FBX SDK: tree of node
+// records with their properties. The file is memory-mapped, array
+// properties point into the mapping until they are decompressed
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+
+#include "MeshReader.h"
+
+class ThreadPool;
+
+struct FBXProperty
+{
+    // scalars: 'Y' int16, 'C' bool, 'I' int32, 'L' int64, 'F' float, 'D' double;
+    // 'S' string, 'R' raw bytes; arrays: 'b' bool, 'i' int32, 'l' int64, 'f' float, 'd' double
+    char type = 0;
+    int64_t intValue = 0;
+    double floatValue = 0.0;
+    const uint8_t *data = nullptr; // string, raw bytes or array contents (compressed when encoding is 1)
+    uint32_t dataSize = 0;
+    uint32_t arrayLength = 0;
+    uint32_t encoding = 0; // 0 - stored, 1 - zlib
+    std::vector<uint8_t> decoded; // array contents after decompressArrays
+
+    inline bool isArray() const { return type == 'b' || type == 'i' || type == 'l' || type == 'f' || type == 'd'; }
+    inline bool isCompressed() const { return isArray() && encoding == 1 && decoded.empty(); }
+    uint32_t arrayElementSize() const;
+    // uncompressed array contents, nullptr when the array is still compressed
+    const uint8_t* arrayData() const;
+    inline std::string getString() const { return std::string(reinterpret_cast<const char*>(data), dataSize); }
+    // numeric scalar as double/int64 whatever its type is
+    double getNumber() const;
+    int64_t getInteger() const;
+};
+
+struct FBXNode
+{
+    std::string name;
+    std::vector<FBXProperty> properties;
+    std::vector<FBXNode> children;
+
+    const FBXNode* findChild(const char *childName) const;
+    FBXNode* findChild(const char *childName);
+};
+
+class FBXDocument
+{
+public:
+    FBXDocument() : _data(nullptr), _size(0), _version(0), _nodeCount(0) {}
+
+    // maps the file and parses all node records, on failure error() describes the problem
+    bool open(const std::string &fileName);
+    // parses FBX file contents in memory, data must stay valid while the document is used
+    bool parse(const uint8_t *data, uint64_t size);
+
+    // decompresses zlib array properties, arrays are distributed over threads of
+    // threadPool. Returns uncompressed size of the arrays or 0 on error
+    uint64_t decompressArrays(const std::vector<FBXProperty*> &properties, ThreadPool &threadPool);
+
+    inline uint32_t version() const { return _version; } // e.g. 7400
+    inline uint64_t nodeCount() const { return _nodeCount; }
+    inline uint64_t fileSize() const { return _size; }
+    inline std::vector<FBXNode>& nodes() { return _nodes; }
+    inline const std::vector<FBXNode>& nodes() const { return _nodes; }
+    inline const std::string& error() const { return _error; }
+
+    const FBXNode* findNode(const char *name) const;
+    FBXNode* findNode(const char *name);
+
+private:
+    bool parseNodeList(uint64_t &offset, uint64_t end, std::vector<FBXNode> &nodes, uint32_t depth);
+    bool parseProperty(uint64_t &offset, uint64_t end, FBXProperty &property);
+    bool fail(const std::string &message, uint64_t offset);
+
+    MappedFile _file;
+    const uint8_t *_data;
+    uint64_t _size;
+    uint32_t _version;
+    uint64_t _nodeCount;
+    std::vector<FBXNode> _nodes;
+    std::string _error;
+};
+
+// copies array property converting elements: 'd'/'f' arrays to double, 'i'/'l' arrays to int32.
+// Returns false for other types or compressed array
+bool getArray(const FBXProperty &property, std::vector<double> &values);
+bool getArray(const FBXProperty &property, std::vector<int32_t> &values);
@@ -0,0 +1,112 @@
+//-----------------------------------------------------------------------------
+// Hash.cpp
+// Created at 2026.10.17 20:40
+// License: see LICENSE file
+//
+// fast non-cryptographic 64-bit hash of byte ranges (XXH64 algorithm),
+// used for content keys of files and meshes
+//-----------------------------------------------------------------------------
+#include "Hash.h"
+
+#include <cstring>
+
+namespace
+{
+    const uint64_t Prime1 = 11400714785074694791ULL;
+    const uint64_t Prime2 = 14029467366897019727ULL;
+    const uint64_t Prime3 = 1609587929392839161ULL;
+    const uint64_t Prime4 = 9650029242287828579ULL;
+    const uint64_t Prime5 = 2870177450012600261ULL;
+
+    inline uint64_t rotateLeft(uint64_t value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    template <typename T>
+    inline T readValue(const uint8_t *data)
+    {
+        T value;
+        memcpy(&value, data, sizeof(T)); // little-endian
+        return value;
+    }
+
+    inline uint64_t round(uint64_t accumulator, uint64_t input)
+    {
+        accumulator += input * Prime2;
+        return rotateLeft(accumulator, 31) * Prime1;
+    }
+
+    inline uint64_t mergeRound(uint64_t accumulator, uint64_t value)
+    {
+        accumulator ^= round(0, value);
+        return accumulator * Prime1 + Prime4;
+    }
+}
+
+uint64_t hash64(const void *data, size_t size, uint64_t seed)
+{
+    const uint8_t *current = static_cast<const uint8_t*>(data);
+    const uint8_t *end = current + size;
+    uint64_t hash;
+    if (size >= 32)
+    {
+        // four independent lanes of 8 bytes
+        uint64_t lane1 = seed + Prime1 + Prime2;
+        uint64_t lane2 = seed + Prime2;
+        uint64_t lane3 = seed;
+        uint64_t lane4 = seed - Prime1;
+        const uint8_t *limit = end - 32;
+        do
+        {
+            lane1 = round(lane1, readValue<uint64_t>(current));
+            lane2 = round(lane2, readValue<uint64_t>(current + 8));
+            lane3 = round(lane3, readValue<uint64_t>(current + 16));
+            lane4 = round(lane4, readValue<uint64_t>(current + 24));
+            current += 32;
+        } while (current <= limit);
+        hash = rotateLeft(lane1, 1) + rotateLeft(lane2, 7) + rotateLeft(lane3, 12) + rotateLeft(lane4, 18);
+        hash = mergeRound(hash, lane1);
+        hash = mergeRound(hash, lane2);
+        hash = mergeRound(hash, lane3);
+        hash = mergeRound(hash, lane4);
+    }
+    else
+    {
+        hash = seed + Prime5;
+    }
+    hash += size;
+    for (; current + 8 <= end; current += 8)
+    {
+        hash ^= round(0, readValue<uint64_t>(current));
+        hash = rotateLeft(hash, 27) * Prime1 + Prime4;
+    }
+    if (current + 4 <= end)
+    {
+        hash ^= uint64_t(readValue<uint32_t>(current)) * Prime1;
+        hash = rotateLeft(hash, 23) * Prime2 + Prime3;
+        current += 4;
+    }
+    for (; current < end; ++current)
+    {
+        hash ^= *current * Prime5;
+        hash = rotateLeft(hash, 11) * Prime1;
+    }
+    hash ^= hash >> 33;
+    hash *= Prime2;
+    hash ^= hash >> 29;
+    hash *= Prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+std::string hashToHexString(uint64_t hash)
+{
+    const char digits[] = "0123456789abcdef";
+    std::string result(16, '0');
+    for (int digit = 15; digit >= 0; --digit, hash >>= 4)
+    {
+        result[digit] = digits[hash & 15];
+    }
+    return result;
+}
@@ -0,0 +1,16 @@
+//-----------------------------------------------------------------------------
+// Hash.h
+// Created at 2026.10.17 20:40
+// License: see LICENSE file
+//
+// fast non-cryptographic 64-bit hash of byte ranges (XXH64 algorithm),
+// used for content keys of files and meshes
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+
+// result is the same as XXH64(data, size, seed) of the reference implementation
+uint64_t hash64(const void *data, size_t size, uint64_t seed = 0);
+
+// 16 lowercase hex digits
+std::string hashToHexString(uint64_t hash);
@@ -13,485 +13,350 @@
 #include "Utils.h"
 #include "UtilsFBX.h"
 #include "IndexSet.h"
+#include "RawMesh.h"
+#include "ConvertMesh.h"
+#include "PhaseStats.h"
+#include "ThreadPool.h"
 
-ImportFBXResult importFBXFile(const std::string &path, const ImportSettings &settings)
+struct FBXSDKSession::State
 {
-    ImportFBXResult result;
+    FbxManager *manager = nullptr;
+};
 
-    auto sdkManager = FbxManager::Create();
-    auto ioSettings = FbxIOSettings::Create(sdkManager, IOSROOT);
-    sdkManager->SetIOSettings(ioSettings);
+FBXSDKSession::FBXSDKSession()
+    : _state(new State())
+{
+    _state->manager = FbxManager::Create();
+    auto ioSettings = FbxIOSettings::Create(_state->manager, IOSROOT);
     // TODO: Configure the FbxIOSettings object if needed
-    auto fbxImporter = FbxImporter::Create(sdkManager, "");
-    bool importStatus;
-    importStatus = fbxImporter->Initialize(path.c_str(), -1, sdkManager->GetIOSettings());
-    if (!importStatus)
-    {
-        std::cout << "Error loading file " << path << " :" << std::endl << fbxImporter->GetStatus().GetErrorString() << std::endl;
-        return result;
-    }
+    _state->manager->SetIOSettings(ioSettings);
+}
 
-    // get file version
-    int versionMajor, versionMinor, versionRevision;
-    fbxImporter->GetFileVersion(versionMajor, versionMinor, versionRevision);
-    std::cout << "Imported file version: " << versionMajor << "." << versionMinor << "." << versionRevision << std::endl;
+FBXSDKSession::~FBXSDKSession()
+{
+    _state->manager->Destroy();
+}
 
-    // import scene
-    auto scene = FbxScene::Create(sdkManager, "importedScene");
-    importStatus = fbxImporter->Import(scene);
-    if (!importStatus)
+// polygon walk: collects IndexSet of every polygon corner and attribute values.
+// Only this part of mesh import calls FBX SDK, so it runs on the main thread
+static RawMesh extractRawMesh(FbxMesh *fbxMesh, const ImportSettings &settings)
+{
+    RawMesh rawMesh;
+    int vertexCount = fbxMesh->GetControlPointsCount();
+    int polygonCount = fbxMesh->GetPolygonCount();
+
+    auto controlPoints = fbxMesh->GetControlPoints();
+    if (controlPoints != nullptr)
     {
-        std::cout << "Error importing scene for file " << path << " :" << std::endl << fbxImporter->GetStatus().GetErrorString() << std::endl;
-        return result;
+        rawMesh.controlPoints.resize(vertexCount);
+        for (int controlPointIndex = 0; controlPointIndex < vertexCount; ++controlPointIndex)
+        {
+            rawMesh.controlPoints[controlPointIndex] = toRawVector(controlPoints[controlPointIndex]);
+        }
     }
-    fbxImporter->Destroy();
-
-    std::map<FbxMesh*, uint32_t> fbxMeshMap;
-    //in FBX: right handed, Y-Up axis system. 1 unit = 1cm
-    // import all scene geometries
-    for (int32_t geometryIndex = 0; geometryIndex < scene->GetGeometryCount(); ++geometryIndex)
+    rawMesh.polygonSizes.reserve(polygonCount);
+    rawMesh.polygonVertices.reserve(fbxMesh->GetPolygonVertexCount());
+    int vertexId = 0;
+    // process polygons - split vertices
+    for (int polygonIndex = 0; polygonIndex < polygonCount; polygonIndex++)
     {
-        FbxGeometry* geometry = scene->GetGeometry(geometryIndex);
-        if (geometry->GetAttributeType() == FbxNodeAttribute::EType::eMesh)
+        //DisplayInt("        Polygon ", polygonIndex);
+        /*int elementTangentIndex;
+        for (elementTangentIndex = 0; elementTangentIndex < fbxMesh->GetElementPolygonGroupCount(); elementTangentIndex++)
         {
-            StreamMesh mesh;
-
-            FbxMesh* fbxMesh = static_cast<FbxMesh*>(geometry);
-            fbxMeshMap.insert(std::make_pair(fbxMesh, static_cast<uint32_t>(result.sceneMeshes.size())));
-            int vertexCount = fbxMesh->GetControlPointsCount();
-            int polygonCount = fbxMesh->GetPolygonCount();
-
-            auto controlPoints = fbxMesh->GetControlPoints();
-
-            std::vector<IndexSet> indexSets;
-            std::vector<FbxVector4> normals;
-            std::vector<FbxVector2> UVs;
-            std::vector<FbxVector4> tangents;
-            std::vector<FbxVector4> binormals;
-            int vertexId = 0;
-            // process polygons - split vertices
-            for (int polygonIndex = 0; polygonIndex < polygonCount; polygonIndex++)
+            FbxGeometryElementPolygonGroup* elementPolyGroup = fbxMesh->GetElementPolygonGroup(elementTangentIndex);
+            switch (elementPolyGroup->GetMappingMode())
             {
-                //DisplayInt("        Polygon ", polygonIndex);
-                /*int elementTangentIndex;
-                for (elementTangentIndex = 0; elementTangentIndex < fbxMesh->GetElementPolygonGroupCount(); elementTangentIndex++)
-                {
-                    FbxGeometryElementPolygonGroup* elementPolyGroup = fbxMesh->GetElementPolygonGroup(elementTangentIndex);
-                    switch (elementPolyGroup->GetMappingMode())
-                    {
-                    case FbxGeometryElement::eByPolygon:
-                        if (elementPolyGroup->GetReferenceMode() == FbxGeometryElement::eIndex)
-                        {
-                            FBXSDK_sprintf(header, 100, "        Assigned to group: ");
-                            int polyGroupId = elementPolyGroup->GetIndexArray().GetAt(polygonIndex);
-                            DisplayInt(header, polyGroupId);
-                            break;
-                        }
-                    default:
-                        // any other mapping modes don't make sense
-                        //DisplayString("        \"unsupported group assignment\"");
-                        break;
-                    }
-                }*/
-                int polygonSize = fbxMesh->GetPolygonSize(polygonIndex);
-                std::vector<IndexSet> polygonIndexSets;
-                for (int polyVertexIndex = 0; polyVertexIndex < polygonSize; polyVertexIndex++)
+            case FbxGeometryElement::eByPolygon:
+                if (elementPolyGroup->GetReferenceMode() == FbxGeometryElement::eIndex)
                 {
-                    IndexSet indexSet;
-                    int controlPointIndex = fbxMesh->GetPolygonVertex(polygonIndex, polyVertexIndex);
-                    indexSet.controlPoint = controlPointIndex;
-                    if (settings.importVertexColors)
-                    {
-                        for (int vertexColorIndex = 0; vertexColorIndex < fbxMesh->GetElementVertexColorCount(); vertexColorIndex++)
-                        {
-                            FbxGeometryElementVertexColor* elementVertexColor = fbxMesh->GetElementVertexColor(vertexColorIndex);
-                            int directColorIndex = getDirectIndex<FbxColor>(elementVertexColor, controlPointIndex, vertexId); //-1;
-                            if (directColorIndex > 0)
-                            {
-                                indexSet.vertexColor = directColorIndex;
-                            }
-                        }
-                    }
-                    if (settings.importUVs)
-                    {
-                        for (int uvIndex = 0; uvIndex < fbxMesh->GetElementUVCount(); ++uvIndex)
-                        {
-                            FbxGeometryElementUV* elementUV = fbxMesh->GetElementUV(uvIndex);
-                            int directUVIndex = -1;
-                            switch (elementUV->GetMappingMode())
-                            {
-                            default:
-                                break;
-                            case FbxGeometryElement::eByControlPoint:
-                                directUVIndex = getDirectIndexByControlPoint<FbxVector2>(elementUV, controlPointIndex);
-                                break;
-                            case FbxGeometryElement::eByPolygonVertex:
-                            {
-                                int textureUVIndex = fbxMesh->GetTextureUVIndex(polygonIndex, polyVertexIndex);
-                                switch (elementUV->GetReferenceMode())
-                                {
-                                case FbxGeometryElement::eDirect:
-                                case FbxGeometryElement::eIndexToDirect:
-                                {
-                                    directUVIndex = textureUVIndex;
-                                }
-                                break;
-                                default:
-                                    break; // other reference modes not shown here!
-                                }
-                            }
-                            break;
-                            case FbxGeometryElement::eByPolygon: // doesn't make much sense for UVs
-                            case FbxGeometryElement::eAllSame:   // doesn't make much sense for UVs
-                            case FbxGeometryElement::eNone:       // doesn't make much sense for UVs
-                                break;
-                            }
-                            indexSet.uv = directUVIndex;
-                            auto uvValue = elementUV->GetDirectArray().GetAt(directUVIndex);
-                            UVs.push_back(uvValue);
-                        }
-                    }
-                    if (settings.importNormals)
-                    {
-                        for (int elementNormalIndex = 0; elementNormalIndex < fbxMesh->GetElementNormalCount(); ++elementNormalIndex)
-                        {
-                            FbxGeometryElementNormal* elementNormal = fbxMesh->GetElementNormal(elementNormalIndex);
-                            if (elementNormal->GetMappingMode() == FbxGeometryElement::eByPolygonVertex)
-                            {
-                                int directIndex = getDirectIndexByPolygonVertex(elementNormal, vertexId);
-                                indexSet.normal = directIndex;
-                                auto normalValue = elementNormal->GetDirectArray().GetAt(directIndex);
-                                normals.push_back(normalValue);
-                            }
-                        }
-                    }
-                    if (settings.importTangents)
-                    {
-                        for (int elementTangentIndex = 0; elementTangentIndex < fbxMesh->GetElementTangentCount(); ++elementTangentIndex)
-                        {
-                            FbxGeometryElementTangent* elementTangent = fbxMesh->GetElementTangent(elementTangentIndex);
-                            if (elementTangent->GetMappingMode() == FbxGeometryElement::eByPolygonVertex)
-                            {
-                                int directIndex = getDirectIndexByPolygonVertex(elementTangent, vertexId);
-                                indexSet.tangent = directIndex;
-                                auto tangentValue = elementTangent->GetDirectArray().GetAt(directIndex);
-                                tangents.push_back(tangentValue);
-                            }
-                        }
-                    }
-                    if (settings.importBinormals)
-                    {
-                        for (int elementBinormalIndex = 0; elementBinormalIndex < fbxMesh->GetElementBinormalCount(); ++elementBinormalIndex)
-                        {
-                            FbxGeometryElementBinormal* elementBinormal = fbxMesh->GetElementBinormal(elementBinormalIndex);
-                            if (elementBinormal->GetMappingMode() == FbxGeometryElement::eByPolygonVertex)
-                            {
-                                int directIndex = getDirectIndexByPolygonVertex(elementBinormal, vertexId);
-                                indexSet.binormal = directIndex;
-                                auto binormalValue = elementBinormal->GetDirectArray().GetAt(directIndex);
-                                binormals.push_back(binormalValue);
-                            }
-                        }
-                    }
-                    polygonIndexSets.push_back(indexSet);
-                    vertexId++;
-                } // for polygonSize
-                for (size_t polygonVertexIndex = 2; polygonVertexIndex < polygonIndexSets.size(); ++polygonVertexIndex) // triangulate if needed
-                {
-                    indexSets.push_back(polygonIndexSets[0]);
-                    indexSets.push_back(polygonIndexSets[polygonVertexIndex - 1]);
-                    indexSets.push_back(polygonIndexSets[polygonVertexIndex]);
+                    FBXSDK_sprintf(header, 100, "        Assigned to group: ");
+                    int polyGroupId = elementPolyGroup->GetIndexArray().GetAt(polygonIndex);
+                    DisplayInt(header, polyGroupId);
+                    break;
                 }
-            } // for polygonCount
-
-            std::vector<uint32_t> indexVector;
-            std::map<IndexSet, uint32_t> orderedVertices; // vertex stream index set -> index
-            std::vector<IndexSet> uniqueVertices;
-            std::vector<uint32_t> optimizedIndexVector;
-            OrderedIndexMap<uint32_t, uint32_t> orderedIndexMap;
-
-            // TODO: optimize by spatial position/uv
-            uint32_t currentIndex = 0;
-            uint32_t currentPosition = 0;
-            for (const auto &indexSet : indexSets)
+            default:
+                // any other mapping modes don't make sense
+                //DisplayString("        \"unsupported group assignment\"");
+                break;
+            }
+        }*/
+        int polygonSize = fbxMesh->GetPolygonSize(polygonIndex);
+        rawMesh.polygonSizes.push_back(polygonSize);
+        for (int polyVertexIndex = 0; polyVertexIndex < polygonSize; polyVertexIndex++)
+        {
+            IndexSet indexSet;
+            int controlPointIndex = fbxMesh->GetPolygonVertex(polygonIndex, polyVertexIndex);
+            indexSet.controlPoint = controlPointIndex;
+            if (settings.importVertexColors)
             {
-                auto orderedIt = orderedVertices.find(indexSet);
-                if (orderedIt == orderedVertices.end())
+                for (int vertexColorIndex = 0; vertexColorIndex < fbxMesh->GetElementVertexColorCount(); vertexColorIndex++)
                 {
-                    orderedVertices.insert(std::make_pair(indexSet, currentIndex));
-                    uniqueVertices.push_back(indexSet);
-                    indexVector.push_back(currentIndex);
-                    orderedIndexMap.add(currentIndex, currentPosition);
-                    currentIndex++;
-                }
-                else
-                {
-                    indexVector.push_back(orderedIt->second);
-                    orderedIndexMap.add(orderedIt->second, currentPosition);
+                    FbxGeometryElementVertexColor* elementVertexColor = fbxMesh->GetElementVertexColor(vertexColorIndex);
+                    int directColorIndex = getDirectIndex<FbxColor>(elementVertexColor, controlPointIndex, vertexId); //-1;
+                    if (directColorIndex > 0)
+                    {
+                        indexSet.vertexColor = directColorIndex;
+                    }
                 }
-                ++currentPosition;
             }
-            // import normals, merge vertices with similar normals
-            if (settings.importNormals && settings.mergeNormalThresholdAngle > 0.0f)
+            if (settings.importUVs)
             {
-                std::vector<uint32_t> offsetVector(indexVector.size(), 0);
-                double cosThreshold = std::cos(settings.mergeNormalThresholdAngle * Pi / 180.0f);
-                int currentControlPoint = -1;
-                int currentUV = -1;
-                FbxVector4 currentNormalValue(0, 0, 0, 0);
-                std::vector<uint32_t> verticesToMerge;
-                std::map<uint32_t, std::vector<uint32_t>> normalVerticesToMerge;
-                for (const auto &orderedVertexPair : orderedVertices)
+                for (int uvIndex = 0; uvIndex < fbxMesh->GetElementUVCount(); ++uvIndex)
                 {
-                    const auto &vertexNormal = normals[orderedVertexPair.first.normal];
-                    if (currentControlPoint == -1)
+                    FbxGeometryElementUV* elementUV = fbxMesh->GetElementUV(uvIndex);
+                    int directUVIndex = -1;
+                    switch (elementUV->GetMappingMode())
                     {
-                        currentControlPoint = orderedVertexPair.first.controlPoint;
-                        currentUV = orderedVertexPair.first.uv;
-                        currentNormalValue = vertexNormal;
-                        verticesToMerge.clear();
-                        verticesToMerge.push_back(orderedVertexPair.second);
-                    }
-                    else if (currentControlPoint == orderedVertexPair.first.controlPoint)
+                    default:
+                        break;
+                    case FbxGeometryElement::eByControlPoint:
+                        directUVIndex = getDirectIndexByControlPoint<FbxVector2>(elementUV, controlPointIndex);
+                        break;
+                    case FbxGeometryElement::eByPolygonVertex:
                     {
-                        if (currentUV == orderedVertexPair.first.uv) // TODO: also check tangent, binormal and vertexColor
-                        {
-                            double cosAngle = currentNormalValue.DotProduct(vertexNormal);
-                            if (cosAngle > cosThreshold) // merge
-                            {
-                                verticesToMerge.push_back(orderedVertexPair.second);
-                            }
-                        }
-                        else
+                        int textureUVIndex = fbxMesh->GetTextureUVIndex(polygonIndex, polyVertexIndex);
+                        switch (elementUV->GetReferenceMode())
                         {
-                            currentUV = orderedVertexPair.first.uv;
-                            if (verticesToMerge.size() > 1)
-                            {
-                                normalVerticesToMerge.insert(std::make_pair(currentControlPoint, verticesToMerge));
-                            }
-                            verticesToMerge.clear();
-                        }
-                    }
-                    else
-                    {
-                        if (verticesToMerge.size() > 1)
+                        case FbxGeometryElement::eDirect:
+                        case FbxGeometryElement::eIndexToDirect:
                         {
-                            normalVerticesToMerge.insert(std::make_pair(currentControlPoint, verticesToMerge));
+                            directUVIndex = textureUVIndex;
                         }
-                        currentControlPoint = orderedVertexPair.first.controlPoint;
-                        currentUV = orderedVertexPair.first.uv;
-                        currentNormalValue = vertexNormal;
-                        verticesToMerge.clear();
-                        verticesToMerge.push_back(orderedVertexPair.second);// first.normal);
-                    }
-                }
-                if (verticesToMerge.size() > 1)
-                {
-                    normalVerticesToMerge.insert(std::make_pair(currentControlPoint, verticesToMerge));
-                }
-
-                for (const auto &mergePair : normalVerticesToMerge)
-                {
-                    std::vector<std::map<IndexSet, uint32_t>::iterator> vertexIterators;
-                    FbxVector4 normalSum(0, 0, 0, 0);
-                    for (const auto vertexIndex : mergePair.second)
-                    {
-                        auto it = std::find_if(orderedVertices.begin(), orderedVertices.end(),
-                            [vertexIndex](const std::pair<IndexSet, uint32_t> &vertexPair)
-                        {
-                            return vertexPair.second == vertexIndex;
-                        });
-                        assert(it != orderedVertices.end());
-                        if (it != orderedVertices.end())
-                        {
-                            vertexIterators.push_back(it);
-                            const auto& normal = normals[it->first.normal];
-                            normalSum += normal;
+                        break;
+                        default:
+                            break; // other reference modes not shown here!
                         }
                     }
-                    if (vertexIterators.size() > 1)
-                    {
-                        normalSum /= (double)vertexIterators.size();
-                        normalSum.Normalize();
-                        const auto &firstIter = vertexIterators[0];
-                        normals[firstIter->first.normal] = normalSum;
-
-                        std::replace_if(indexVector.begin(), indexVector.end(),
-                            [vertexIterators](const uint32_t &index) {
-                            for (size_t iterIndex = 1; iterIndex < vertexIterators.size(); ++iterIndex)
-                            {
-                                auto currentIter = vertexIterators[iterIndex];
-                                if (index == currentIter->second)
-                                {
-                                    return true;
-                                }
-                            }
-                            return false;
-                        }, vertexIterators[0]->second);
-
-                        uniqueVertices.erase(std::remove_if(uniqueVertices.begin(), uniqueVertices.end(),
-                            [vertexIterators](const IndexSet& vertex) {
-                            for (size_t iterIndex = 1; iterIndex < vertexIterators.size(); ++iterIndex)
-                            {
-                                auto currentIter = vertexIterators[iterIndex];
-                                if (vertex == (*currentIter).first)
-                                {
-                                    return true;
-                                }
-                            }
-                            return false;
-                        }), uniqueVertices.end());
-
-                        orderedIndexMap.merge(mergePair.second);
+                    break;
+                    case FbxGeometryElement::eByPolygon: // doesn't make much sense for UVs
+                    case FbxGeometryElement::eAllSame:   // doesn't make much sense for UVs
+                    case FbxGeometryElement::eNone:       // doesn't make much sense for UVs
+                        break;
                     }
+                    indexSet.uv = directUVIndex;
+                    auto uvValue = elementUV->GetDirectArray().GetAt(directUVIndex);
+                    rawMesh.UVs.push_back(toRawVector(uvValue));
                 }
-                optimizedIndexVector = orderedIndexMap.createVector();
-                indexVector = optimizedIndexVector;
             }
-
-            // save indices
-            if (indexVector.size() > 0)
+            if (settings.importNormals)
             {
-                VectorStream indexStream;
-
-                indexStream.elementType = static_cast<uint32_t>(StreamElementType::UInt);
-                indexStream.elementVectorSize = 1;
-                if (uniqueVertices.size() < 65535)
-                {
-                    indexStream.elementSize = 2;
-                }
-                else
+                for (int elementNormalIndex = 0; elementNormalIndex < fbxMesh->GetElementNormalCount(); ++elementNormalIndex)
                 {
-                    indexStream.elementSize = 4;
-                }
-                uint32_t dataSize = indexStream.elementSize * indexStream.elementVectorSize * static_cast<uint32_t>(indexVector.size());
-                indexStream.streamSize = dataSize + indexStream.headerSize();
-                indexStream.data.resize(dataSize);
-                uint32_t dataOffset = 0;
-                if (indexStream.elementSize == 2)
-                {
-                    for (size_t index = 0; index < indexVector.size(); ++index)
+                    FbxGeometryElementNormal* elementNormal = fbxMesh->GetElementNormal(elementNormalIndex);
+                    if (elementNormal->GetMappingMode() == FbxGeometryElement::eByPolygonVertex)
                     {
-                        uint16_t indexValue = static_cast<uint16_t>(indexVector[index]);
-                        memcpy(indexStream.data.data() + dataOffset, &indexValue, sizeof(indexValue));
-                        dataOffset += indexStream.elementSize * indexStream.elementVectorSize;
+                        int directIndex = getDirectIndexByPolygonVertex(elementNormal, vertexId);
+                        indexSet.normal = directIndex;
+                        auto normalValue = elementNormal->GetDirectArray().GetAt(directIndex);
+                        rawMesh.normals.push_back(toRawVector(normalValue));
                     }
                 }
-                else //if (indexStream.elementSize == 4)
-                {
-                    memcpy(indexStream.data.data(), indexVector.data(), indexStream.streamSize);
-                }
-                indexStream.elementCount = static_cast<uint32_t>(indexVector.size());
-                indexStream.attributeType = static_cast<uint32_t>(AttributeType::Index);
-                mesh.streams.push_back(indexStream);
-            }
-
-            // normals
-            if (normals.size() > 0)
-            {
-                uint32_t fieldOffset = offsetof(IndexSet, normal);
-                VectorStream normalStream = createFloat3Stream(normals, uniqueVertices, fieldOffset);
-                normalStream.attributeType = static_cast<uint32_t>(AttributeType::Normal);
-                mesh.streams.push_back(normalStream);
             }
-            // texture coordinates
-            if (UVs.size() > 0)
+            if (settings.importTangents)
             {
-                VectorStream uvStream;
-                uvStream.elementType = static_cast<uint32_t>(StreamElementType::Float);
-                uvStream.elementVectorSize = 2;
-                uvStream.elementSize = 4;
-                uint32_t dataSize = uvStream.elementSize * uvStream.elementVectorSize * static_cast<uint32_t>(uniqueVertices.size());
-                uvStream.streamSize = dataSize + uvStream.headerSize();
-                uvStream.data.resize(dataSize);
-                uint32_t dataOffset = 0;
-                for (int vertexIndex = 0; vertexIndex < uniqueVertices.size(); ++vertexIndex)
+                for (int elementTangentIndex = 0; elementTangentIndex < fbxMesh->GetElementTangentCount(); ++elementTangentIndex)
                 {
-                    float uv[2];
-                    const auto uvData = UVs[uniqueVertices[vertexIndex].uv].mData;
-                    uv[0] = static_cast<float>(uvData[0]);
-                    uv[1] = static_cast<float>(uvData[1]);
-                    memcpy(uvStream.data.data() + dataOffset, uv, sizeof(uv));
-                    dataOffset += uvStream.elementSize * uvStream.elementVectorSize;
+                    FbxGeometryElementTangent* elementTangent = fbxMesh->GetElementTangent(elementTangentIndex);
+                    if (elementTangent->GetMappingMode() == FbxGeometryElement::eByPolygonVertex)
+                    {
+                        int directIndex = getDirectIndexByPolygonVertex(elementTangent, vertexId);
+                        indexSet.tangent = directIndex;
+                        auto tangentValue = elementTangent->GetDirectArray().GetAt(directIndex);
+                        rawMesh.tangents.push_back(toRawVector(tangentValue));
+                    }
                 }
-                uvStream.elementCount = static_cast<uint32_t>(uniqueVertices.size());
-                uvStream.attributeType = static_cast<uint32_t>(AttributeType::UV);
-                mesh.streams.push_back(uvStream);
-            }
-            // tangents
-            if (tangents.size() > 0)
-            {
-                uint32_t fieldOffset = offsetof(IndexSet, tangent);
-                VectorStream tangentStream = createFloat3Stream(tangents, uniqueVertices, fieldOffset);
-                tangentStream.attributeType = static_cast<uint32_t>(AttributeType::Tangent);
-                mesh.streams.push_back(tangentStream);
-            }
-            // binormals
-            if (binormals.size() > 0)
-            {
-                uint32_t fieldOffset = offsetof(IndexSet, binormal);
-                VectorStream binormalStream = createFloat3Stream(binormals, uniqueVertices, fieldOffset);
-                binormalStream.attributeType = static_cast<uint32_t>(AttributeType::Binormal);
-                mesh.streams.push_back(binormalStream);
             }
-            // import vertices
-            if (uniqueVertices.size() > 0 && controlPoints != nullptr) // remove 4th dimension
+            if (settings.importBinormals)
             {
-                VectorStream vertexStream;
-
-                vertexStream.elementType = static_cast<uint32_t>(StreamElementType::Float);
-                vertexStream.elementVectorSize = 3;
-                if (settings.convertPositionsToFloat32)
+                for (int elementBinormalIndex = 0; elementBinormalIndex < fbxMesh->GetElementBinormalCount(); ++elementBinormalIndex)
                 {
-                    vertexStream.elementSize = 4;
-                }
-                else
-                {
-                    vertexStream.elementSize = 8;
-                }
-                uint32_t dataSize = vertexStream.elementSize * vertexStream.elementVectorSize * static_cast<uint32_t>(uniqueVertices.size());
-                vertexStream.streamSize = dataSize + vertexStream.headerSize();
-                vertexStream.data.resize(dataSize);
-                uint32_t dataOffset = 0;
-                for (int vertexIndex = 0; vertexIndex < uniqueVertices.size(); ++vertexIndex)
-                {
-                    //const auto &controlPoint = controlPoints[vertexIndex];
-                    int uniqueIndex = uniqueVertices[vertexIndex].controlPoint;
-                    const auto &controlPoint = controlPoints[uniqueIndex];
-                    if (settings.convertPositionsToFloat32)
-                    {
-                        float position[3];
-                        position[0] = static_cast<float>(controlPoint.mData[0]);
-                        position[1] = static_cast<float>(controlPoint.mData[1]);
-                        position[2] = static_cast<float>(controlPoint.mData[2]);
-                        memcpy(vertexStream.data.data() + dataOffset, position, sizeof(position));
-                    }
-                    else
+                    FbxGeometryElementBinormal* elementBinormal = fbxMesh->GetElementBinormal(elementBinormalIndex);
+                    if (elementBinormal->GetMappingMode() == FbxGeometryElement::eByPolygonVertex)
                     {
-                        double position[3];
-                        position[0] = controlPoint.mData[0];
-                        position[1] = controlPoint.mData[1];
-                        position[2] = controlPoint.mData[2];
-                        memcpy(vertexStream.data.data() + dataOffset, position, sizeof(position));
+                        int directIndex = getDirectIndexByPolygonVertex(elementBinormal, vertexId);
+                        indexSet.binormal = directIndex;
+                        auto binormalValue = elementBinormal->GetDirectArray().GetAt(directIndex);
+                        rawMesh.binormals.push_back(toRawVector(binormalValue));
                     }
-                    dataOffset += vertexStream.elementSize * vertexStream.elementVectorSize;
                 }
-                vertexStream.elementCount = static_cast<uint32_t>(uniqueVertices.size());
-                vertexStream.attributeType = static_cast<uint32_t>(AttributeType::Position);
-                mesh.streams.push_back(vertexStream);
             }
+            rawMesh.polygonVertices.push_back(indexSet);
+            vertexId++;
+        } // for polygonSize
+    } // for polygonCount
+    return rawMesh;
+}
+
+// creates scene in sdkManager and imports the file into it, nullptr on error
+static FbxScene* importScene(FbxManager *sdkManager, const std::string &path)
+{
+    auto fbxImporter = FbxImporter::Create(sdkManager, "");
+    bool importStatus;
+    PhaseTimer initializeTimer(Phase::SDKInitialize, 1);
+    importStatus = fbxImporter->Initialize(path.c_str(), -1, sdkManager->GetIOSettings());
+    initializeTimer.stop();
+    if (!importStatus)
+    {
+        std::cout << "Error loading file " << path << " :" << std::endl << fbxImporter->GetStatus().GetErrorString() << std::endl;
+        fbxImporter->Destroy();
+        return nullptr;
+    }
 
-            mesh.header.streamCount = static_cast<uint32_t>(mesh.streams.size());
-            result.sceneMeshes.push_back(mesh);
+    // get file version
+    int versionMajor, versionMinor, versionRevision;
+    fbxImporter->GetFileVersion(versionMajor, versionMinor, versionRevision);
+    std::cout << "Imported file version: " << versionMajor << "." << versionMinor << "." << versionRevision << std::endl;
+
+    // import scene
+    auto scene = FbxScene::Create(sdkManager, "importedScene");
+    PhaseTimer importTimer(Phase::SDKImport);
+    importStatus = fbxImporter->Import(scene);
+    importTimer.setItemCount(scene->GetNodeCount());
+    importTimer.stop();
+    if (!importStatus)
+    {
+        std::cout << "Error importing scene for file " << path << " :" << std::endl << fbxImporter->GetStatus().GetErrorString() << std::endl;
+        fbxImporter->Destroy();
+        scene->Destroy();
+        return nullptr;
+    }
+    fbxImporter->Destroy();
+    return scene;
+}
+
+// all scene geometries which are meshes
+static std::vector<FbxMesh*> getSceneMeshes(FbxScene *scene)
+{
+    std::vector<FbxMesh*> fbxMeshes;
+    for (int32_t geometryIndex = 0; geometryIndex < scene->GetGeometryCount(); ++geometryIndex)
+    {
+        FbxGeometry* geometry = scene->GetGeometry(geometryIndex);
+        if (geometry->GetAttributeType() == FbxNodeAttribute::EType::eMesh)
+        {
+            fbxMeshes.push_back(static_cast<FbxMesh*>(geometry));
         }
     }
+    return fbxMeshes;
+}
 
+// meshes of nodes with uniform scale, see convertRawMeshes
+static std::vector<bool> getTransformableMeshes(FbxScene *scene, const std::map<FbxMesh*, uint32_t> &fbxMeshMap)
+{
+    std::vector<bool> transformableMeshes(fbxMeshMap.size(), true);
+    for (int nodeIndex = 0; nodeIndex < scene->GetNodeCount(); ++nodeIndex)
+    {
+        auto fbxNode = scene->GetNode(nodeIndex);
+        auto meshIt = fbxMeshMap.find(fbxNode->GetMesh());
+        if (meshIt != fbxMeshMap.end())
+        {
+            auto fbxScale = fbxNode->EvaluateLocalTransform().GetS();
+            double scale[3] = { fbxScale.mData[0], fbxScale.mData[1], fbxScale.mData[2] };
+            if (!isUniformScale(scale))
+            {
+                transformableMeshes[meshIt->second] = false;
+            }
+        }
+    }
+    return transformableMeshes;
+}
+
+bool loadFBXRawMeshes(const std::string &path, const ImportSettings &settings, std::vector<RawMesh> &rawMeshes)
+{
+    FBXSDKSession session;
+    auto scene = importScene(session.state()->manager, path);
+    if (scene == nullptr)
+    {
+        return false;
+    }
+    for (auto fbxMesh : getSceneMeshes(scene))
+    {
+        PhaseTimer polygonWalkTimer(Phase::PolygonWalk);
+        rawMeshes.push_back(extractRawMesh(fbxMesh, settings));
+        polygonWalkTimer.setItemCount(rawMeshes.back().polygonVertices.size());
+    }
+    return true;
+}
+
+ImportFBXResult importFBXFile(const std::string &path, const ImportSettings &settings,
+                              const MeshSink &meshSink, const ImportContext &context)
+{
+    ImportFBXResult result;
+    TraceZone importZone("importFBXFile");
+
+    std::unique_ptr<FBXSDKSession> ownSession;
+    FBXSDKSession *session = context.sdkSession;
+    if (session == nullptr)
+    {
+        ownSession.reset(new FBXSDKSession());
+        session = ownSession.get();
+    }
+    // the lock is held while meshes are extracted and converted, other imports
+    // of the session can only overlap with writes of this file's outputs
+    std::lock_guard<std::mutex> sessionLock(session->importMutex());
+    auto scene = importScene(session->state()->manager, path);
+    if (scene == nullptr)
+    {
+        return result;
+    }
+    // shared manager keeps every scene until it's destroyed
+    std::unique_ptr<FbxScene, void(*)(FbxScene*)> sceneOwner(scene, [](FbxScene *fbxScene)
+    {
+        fbxScene->Destroy();
+    });
+
+    //in FBX: right handed, Y-Up axis system. 1 unit = 1cm
+    // import all scene geometries
+    std::vector<FbxMesh*> fbxMeshes = getSceneMeshes(scene);
+    std::map<FbxMesh*, uint32_t> fbxMeshMap;
+    for (uint32_t meshIndex = 0; meshIndex < fbxMeshes.size(); ++meshIndex)
+    {
+        fbxMeshMap.insert(std::make_pair(fbxMeshes[meshIndex], meshIndex));
+    }
+    // SDK data is extracted sequentially on this thread, conversion of extracted
+    // meshes runs on the pool while next meshes are extracted
+    bool sinkFailed = !convertRawMeshes(static_cast<uint32_t>(fbxMeshes.size()), [&fbxMeshes, &settings](uint32_t meshIndex)
+    {
+        return extractRawMesh(fbxMeshes[meshIndex], settings);
+    }, settings, meshSink, result, context.threadPool,
+       settings.deduplicateTransformedMeshes ? getTransformableMeshes(scene, fbxMeshMap) : std::vector<bool>());
+    if (sinkFailed)
+    {
+        std::cout << "Error exporting meshes of file " << path << std::endl;
+        return result;
+    }
+    // nodes of identical meshes share the first copy, nodes of transformed
+    // copies take the transform of their copy
+    std::unordered_map<uint64_t, InstanceTransform> nodeTransforms;
+    if (!result.meshTransforms.empty())
+    {
+        for (int nodeIndex = 0; nodeIndex < scene->GetNodeCount(); ++nodeIndex)
+        {
+            auto fbxNode = scene->GetNode(nodeIndex);
+            auto meshIt = fbxMeshMap.find(fbxNode->GetMesh());
+            if (meshIt != fbxMeshMap.end() && !result.meshTransforms[meshIt->second].isIdentity())
+            {
+                nodeTransforms[fbxNode->GetUniqueID()] = result.meshTransforms[meshIt->second];
+            }
+        }
+    }
+    if (!result.meshRemap.empty())
+    {
+        for (auto &meshPair : fbxMeshMap)
+        {
+            meshPair.second = result.meshRemap[meshPair.second];
+        }
+    }
+
+    TraceZone nodesZone("extractNodes");
+    nodesZone.arg("nodes", scene->GetNodeCount());
     uint32_t materialNumber = 0;
     for (int nodeIndex = 0; nodeIndex < scene->GetNodeCount(); ++nodeIndex)
     {
         auto fbxNode = scene->GetNode(nodeIndex);
         // object material
         int materialCount = fbxNode->GetSrcObjectCount<FbxSurfaceMaterial>();
+        PhaseTimer materialTimer(Phase::MaterialExtraction, materialCount);
         std::vector<uint32_t> materialIndices;
         for (int materialIndex = 0; materialIndex < materialCount; ++materialIndex)
         {
@@ -579,25 +444,16 @@ ImportFBXResult importFBXFile(const std::string &path, const ImportSettings &set
             result.sceneMaterials.push_back(resultMtrl);
             materialNumber++;
         }
+        materialTimer.stop();
         // object info
+        PhaseTimer nodeTimer(Phase::NodeExtraction, 1);
         if (settings.convertPositionsToFloat32)
         {
             auto node = getObjectNode<float>(fbxNode, fbxMeshMap);
             // TODO: extract material faces from FBX, sort by materials
             if (node.meshIndex != InvalidID)
             {
-                uint32_t indexCount = 0;
-                for (uint32_t meshStreamIndex = 0;
-                    meshStreamIndex < result.sceneMeshes[node.meshIndex].streams.size();
-                    ++meshStreamIndex)
-                {
-                    auto &stream = result.sceneMeshes[node.meshIndex].streams[meshStreamIndex];
-                    if (stream.attributeType == static_cast<uint32_t>(AttributeType::Index))
-                    {
-                        indexCount = stream.elementCount;
-                    }
-                }
-                MaterialIndex matIndex = { 0, 0, indexCount };
+                MaterialIndex matIndex = { 0, 0, result.meshIndexCounts[node.meshIndex] };
                 node.materialIndices.push_back(matIndex);
             }
             result.objectsFloat.push_back(node);
@@ -609,23 +465,14 @@ ImportFBXResult importFBXFile(const std::string &path, const ImportSettings &set
             // TODO: implement in separate function
             if (node.meshIndex != InvalidID)
             {
-                uint32_t indexCount = 0;
-                for (uint32_t meshStreamIndex = 0;
-                    meshStreamIndex < result.sceneMeshes[node.meshIndex].streams.size();
-                    ++meshStreamIndex)
-                {
-                    auto &stream = result.sceneMeshes[node.meshIndex].streams[meshStreamIndex];
-                    if (stream.attributeType == static_cast<uint32_t>(AttributeType::Index))
-                    {
-                        indexCount = stream.elementCount;
-                    }
-                }
-                MaterialIndex matIndex = { 0, 0, indexCount };
+                MaterialIndex matIndex = { 0, 0, result.meshIndexCounts[node.meshIndex] };
                 node.materialIndices.push_back(matIndex);
             }
             result.objectsDouble.push_back(node);
         }
     }
+    applyInstanceTransforms(result.objectsFloat, nodeTransforms);
+    applyInstanceTransforms(result.objectsDouble, nodeTransforms);
     result.success = true;
     return result;
 }
@@ -9,11 +9,49 @@
 #include "StreamMeshData.h"
 #include "StreamMaterialData.h"
 #include "ObjectNode.h"
+#include "VertexWeld.h"
+#include "VertexCache.h"
+#include "Overdraw.h"
+#include "Meshlet.h"
+#include "VertexEncoding.h"
+#include "VertexLayout.h"
+#include "RawMesh.h"
+#include "MeshInstancing.h"
+
+#include <functional>
+#include <mutex>
+
+class ThreadPool;
+
+// statistics of one converted mesh
+struct MeshConvertStats
+{
+    VertexCacheStats vertexCacheBefore; // triangle order of FBX polygons
+    VertexCacheStats vertexCacheAfter;  // triangle order written to file
+    VertexFetchStats vertexFetchBefore; // for position stream, vertex order after welding
+    VertexFetchStats vertexFetchAfter;  // for position stream, vertex order written to file
+    OverdrawStats overdrawBefore;       // only when overdraw optimization is enabled
+    OverdrawStats overdrawAfter;
+    uint32_t meshletCount = 0;
+    uint32_t meshletVertexCount = 0; // vertices of all meshlets, shared vertices are counted in every meshlet
+    // errors of compact encodings, filled only for encoded attributes
+    EncodingError positionError; // distance in mesh units
+    EncodingError normalError;   // angle in radians
+    EncodingError tangentError;  // angle in radians, tangents and binormals
+    EncodingError uvError;
+    double convertSeconds = 0.0; // wall time of conversion on its thread
+};
 
 struct ImportFBXResult
 {
     bool success = false;
-    std::vector<StreamMesh> sceneMeshes;
+    std::vector<StreamMesh> sceneMeshes; // empty when meshes are passed to MeshSink
+    std::vector<uint32_t> meshIndexCounts; // index count of every scene mesh
+    std::vector<MeshConvertStats> meshStats; // of every converted mesh, before deduplication
+    std::vector<uint32_t> meshRemap; // converted mesh index -> scene mesh index, empty without deduplication
+    std::vector<InstanceTransform> meshTransforms; // converted mesh index -> placement relative to scene mesh,
+                                                   // empty without deduplicateTransformedMeshes
+    InstancingStats instancingStats;
     std::vector<Material> sceneMaterials;
     std::vector<ObjectNode<double>> objectsDouble;
     std::vector<ObjectNode<float>> objectsFloat;
@@ -22,15 +60,72 @@ struct ImportFBXResult
 struct ImportSettings
 {
     bool convertPositionsToFloat32 = true;
+    PositionEncoding positionEncoding = PositionEncoding::Float;
+    DirectionEncoding normalEncoding = DirectionEncoding::Float32;
+    DirectionEncoding tangentEncoding = DirectionEncoding::Float32; // tangents and binormals
+    UVEncoding uvEncoding = UVEncoding::Float32;
+    VertexLayout vertexLayout = VertexLayout::Separate;
+    uint32_t vertexStrideAlignment = DefaultVertexStrideAlignment; // interleaved vertex stride alignment, power of two
     bool importVertexColors = false;// not implemented yet
     bool importUVs = true;
     bool importNormals = true;
     float mergeNormalThresholdAngle = 0.0f; // angle is in degrees
     bool importTangents = false;
     bool importBinormals = false;
+    VertexWeldMethod vertexWeldMethod = VertexWeldMethod::HashTable;
+    VertexCacheMethod vertexCacheMethod = VertexCacheMethod::None; // triangle reordering after welding
+    float overdrawThreshold = 0.0f; // sort triangle clusters front to back, allowed ACMR ratio (>= 1), 0 - disabled
+    bool optimizeVertexFetch = false; // sort vertices in order of first use in index stream
+    uint32_t meshletMaxVertices = 0; // max vertices in a meshlet (<= 256), 0 - no meshlet streams
+    uint32_t meshletMaxTriangles = DefaultMeshletTriangles;
+    bool deduplicateMeshes = false; // identical converted meshes are kept once, nodes share the mesh index
+    float deduplicateTolerance = 0.0f; // max difference of float stream values of identical meshes, 0 - bitwise equal
+    bool deduplicateTransformedMeshes = false; // also meshes which differ by rotation, translation and uniform scale
+    uint32_t threadCount = 1; // mesh conversion threads, 0 - use all hardware threads
+    uint32_t maxMeshesInFlight = 0; // meshes extracted but not converted (and written) yet, 0 - 2 * threadCount
     bool compactSceneJson = true;
     std::string textureRelativePath = "/textures/";
 };
 
-ImportFBXResult importFBXFile(const std::string &path, const ImportSettings &settings);
+// receives every mesh as soon as its streams are built, mesh is freed when
+// the sink returns. Called from conversion threads, returns false on error
+using MeshSink = std::function<bool(uint32_t meshIndex, StreamMesh &&mesh)>;
+
+// FBX SDK manager shared by imports of many files (batch mode). Scene of every
+// import is destroyed after the import. FBX SDK objects aren't thread-safe, so
+// imports of one session run one at a time
+class FBXSDKSession
+{
+public:
+    FBXSDKSession();
+    ~FBXSDKSession();
+
+    FBXSDKSession(const FBXSDKSession&) = delete;
+    FBXSDKSession& operator=(const FBXSDKSession&) = delete;
+
+    struct State; // FBX SDK objects, defined in ImportFBX.cpp
+    inline State* state() const { return _state.get(); }
+    inline std::mutex& importMutex() { return _importMutex; }
+
+private:
+    std::unique_ptr<State> _state;
+    std::mutex _importMutex;
+};
+
+// resources shared by imports of many files (batch mode). When a member is
+// null, the import creates its own one and destroys it at return
+struct ImportContext
+{
+    FBXSDKSession *sdkSession = nullptr;
+    ThreadPool *threadPool = nullptr; // mesh conversion (and array decompression of native import)
+};
+
+// when meshSink is set, converted meshes go to the sink instead of
+// ImportFBXResult::sceneMeshes, so only maxMeshesInFlight meshes are in memory
+ImportFBXResult importFBXFile(const std::string &path, const ImportSettings &settings,
+                              const MeshSink &meshSink = MeshSink(), const ImportContext &context = ImportContext());
+
 
+// FBX SDK import and polygon walk of all meshes without conversion,
+// used to compare FBX SDK with native binary FBX reader
+bool loadFBXRawMeshes(const std::string &path, const ImportSettings &settings, std::vector<RawMesh> &rawMeshes);
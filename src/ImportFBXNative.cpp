@@ -0,0 +1,800 @@
+//-----------------------------------------------------------------------------
+// ImportFBXNative.cpp
+// Created at 2026.10.17 19:50
+// License: see LICENSE file
+//
+// import of binary FBX files without FBX SDK: meshes, scene nodes, materials
+//-----------------------------------------------------------------------------
+#include "ImportFBXNative.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+#include "Common.h"
+#include "ConvertMesh.h"
+#include "FBXBinary.h"
+#include "PhaseStats.h"
+#include "ThreadPool.h"
+#include "Utils.h"
+
+namespace
+{
+    const int64_t RootNodeId = 0; // parent id of top level models in connections
+
+    // objects of the document used by import, pointers to document nodes
+    struct FBXSceneObjects
+    {
+        std::vector<FBXNode*> meshGeometries; // index is mesh index
+        std::vector<const FBXNode*> models;
+        std::map<int64_t, uint32_t> geometryMeshIndices;
+        std::map<int64_t, const FBXNode*> materials;
+        std::map<int64_t, const FBXNode*> textures;
+        std::map<int64_t, int64_t> modelParents;
+        std::map<int64_t, uint32_t> modelMeshIndices;
+        std::map<int64_t, std::vector<int64_t>> modelMaterials;
+        std::map<int64_t, std::vector<std::pair<std::string, int64_t>>> materialTextures; // material property, texture
+    };
+
+    // one LayerElement* child of a geometry: direct values and mapping to polygon corners
+    struct LayerElement
+    {
+        enum class Mapping
+        {
+            None,
+            ByPolygonVertex,
+            ByControlPoint,
+            ByPolygon,
+            AllSame,
+        };
+
+        Mapping mapping = Mapping::None;
+        bool indexToDirect = false;
+        FBXProperty *values = nullptr;
+        FBXProperty *indices = nullptr;
+    };
+
+    inline const std::string* getStringProperty(const FBXNode &node, size_t index, std::string &storage)
+    {
+        if (index >= node.properties.size() || node.properties[index].type != 'S')
+        {
+            return nullptr;
+        }
+        storage = node.properties[index].getString();
+        return &storage;
+    }
+
+    inline int64_t getObjectId(const FBXNode &node)
+    {
+        return !node.properties.empty() ? node.properties[0].getInteger() : RootNodeId;
+    }
+
+    // object names are stored as "name\x00\x01Class"
+    std::string getObjectName(const FBXNode &node)
+    {
+        std::string name;
+        if (getStringProperty(node, 1, name) == nullptr)
+        {
+            return std::string();
+        }
+        size_t separator = name.find(std::string("\x00\x01", 2));
+        return separator != std::string::npos ? name.substr(0, separator) : name;
+    }
+
+    // child node value like MappingInformationType: "ByPolygonVertex"
+    std::string getChildString(const FBXNode &node, const char *childName)
+    {
+        auto child = node.findChild(childName);
+        std::string value;
+        if (child != nullptr)
+        {
+            getStringProperty(*child, 0, value);
+        }
+        return value;
+    }
+
+    // Properties70 entry: P: name, type, label, flags, values...
+    const FBXNode* findObjectProperty(const FBXNode &object, const char *propertyName)
+    {
+        auto properties = object.findChild("Properties70");
+        if (properties == nullptr)
+        {
+            return nullptr;
+        }
+        for (const auto &property : properties->children)
+        {
+            if (property.name == "P" && !property.properties.empty() && property.properties[0].type == 'S' &&
+                property.properties[0].dataSize == strlen(propertyName) &&
+                memcmp(property.properties[0].data, propertyName, property.properties[0].dataSize) == 0)
+            {
+                return &property;
+            }
+        }
+        return nullptr;
+    }
+
+    // fills count values of Properties70 entry, keeps values when there is no entry
+    void getObjectPropertyValues(const FBXNode &object, const char *propertyName, double *values, uint32_t count)
+    {
+        auto property = findObjectProperty(object, propertyName);
+        if (property == nullptr || property->properties.size() < 4 + count)
+        {
+            return;
+        }
+        for (uint32_t index = 0; index < count; ++index)
+        {
+            values[index] = property->properties[4 + index].getNumber();
+        }
+    }
+
+    void collectSceneObjects(FBXDocument &document, FBXSceneObjects &scene)
+    {
+        auto objects = document.findNode("Objects");
+        if (objects != nullptr)
+        {
+            std::string objectClass;
+            for (auto &object : objects->children)
+            {
+                int64_t objectId = getObjectId(object);
+                if (object.name == "Geometry")
+                {
+                    if (getStringProperty(object, 2, objectClass) != nullptr && objectClass == "Mesh")
+                    {
+                        scene.geometryMeshIndices[objectId] = static_cast<uint32_t>(scene.meshGeometries.size());
+                        scene.meshGeometries.push_back(&object);
+                    }
+                }
+                else if (object.name == "Model")
+                {
+                    scene.models.push_back(&object);
+                    scene.modelParents[objectId] = RootNodeId;
+                }
+                else if (object.name == "Material")
+                {
+                    scene.materials[objectId] = &object;
+                }
+                else if (object.name == "Texture")
+                {
+                    scene.textures[objectId] = &object;
+                }
+            }
+        }
+        auto connections = document.findNode("Connections");
+        if (connections == nullptr)
+        {
+            return;
+        }
+        std::string connectionType;
+        std::string propertyName;
+        for (const auto &connection : connections->children)
+        {
+            if (connection.name != "C" || connection.properties.size() < 3 ||
+                getStringProperty(connection, 0, connectionType) == nullptr)
+            {
+                continue;
+            }
+            int64_t childId = connection.properties[1].getInteger();
+            int64_t parentId = connection.properties[2].getInteger();
+            bool parentIsModel = scene.modelParents.count(parentId) != 0;
+            if (connectionType == "OO")
+            {
+                if (scene.modelParents.count(childId) != 0 && (parentIsModel || parentId == RootNodeId))
+                {
+                    scene.modelParents[childId] = parentId;
+                }
+                else if (scene.geometryMeshIndices.count(childId) != 0 && parentIsModel)
+                {
+                    scene.modelMeshIndices[parentId] = scene.geometryMeshIndices[childId];
+                }
+                else if (scene.materials.count(childId) != 0 && parentIsModel)
+                {
+                    scene.modelMaterials[parentId].push_back(childId);
+                }
+            }
+            else if (connectionType == "OP" && scene.textures.count(childId) != 0 && scene.materials.count(parentId) != 0 &&
+                     getStringProperty(connection, 3, propertyName) != nullptr)
+            {
+                scene.materialTextures[parentId].push_back(std::make_pair(propertyName, childId));
+            }
+        }
+    }
+
+    FBXProperty* getArrayProperty(FBXNode *node, const char *childName)
+    {
+        auto child = node != nullptr ? node->findChild(childName) : nullptr;
+        if (child == nullptr || child->properties.empty() || !child->properties[0].isArray())
+        {
+            return nullptr;
+        }
+        return &child->properties[0];
+    }
+
+    // first layer element of the geometry, like FBX SDK path uses
+    LayerElement getLayerElement(FBXNode &geometry, const char *elementName, const char *valuesName, const char *indicesName)
+    {
+        LayerElement element;
+        auto elementNode = geometry.findChild(elementName);
+        if (elementNode == nullptr)
+        {
+            return element;
+        }
+        std::string mapping = getChildString(*elementNode, "MappingInformationType");
+        std::string reference = getChildString(*elementNode, "ReferenceInformationType");
+        if (mapping == "ByPolygonVertex")
+        {
+            element.mapping = LayerElement::Mapping::ByPolygonVertex;
+        }
+        else if (mapping == "ByVertice" || mapping == "ByVertex" || mapping == "ByControlPoint")
+        {
+            element.mapping = LayerElement::Mapping::ByControlPoint;
+        }
+        else if (mapping == "ByPolygon")
+        {
+            element.mapping = LayerElement::Mapping::ByPolygon;
+        }
+        else if (mapping == "AllSame")
+        {
+            element.mapping = LayerElement::Mapping::AllSame;
+        }
+        element.indexToDirect = reference == "IndexToDirect" || reference == "Index";
+        element.values = getArrayProperty(elementNode, valuesName);
+        element.indices = element.indexToDirect ? getArrayProperty(elementNode, indicesName) : nullptr;
+        if (element.values == nullptr || (element.indexToDirect && element.indices == nullptr))
+        {
+            element.mapping = LayerElement::Mapping::None;
+        }
+        return element;
+    }
+
+    std::vector<LayerElement> getLayerElements(FBXNode &geometry, const ImportSettings &settings)
+    {
+        // normal, UV, tangent, binormal; elements which aren't imported have no mapping
+        std::vector<LayerElement> elements(4);
+        if (settings.importNormals)
+        {
+            elements[0] = getLayerElement(geometry, "LayerElementNormal", "Normals", "NormalsIndex");
+        }
+        if (settings.importUVs)
+        {
+            elements[1] = getLayerElement(geometry, "LayerElementUV", "UV", "UVIndex");
+        }
+        if (settings.importTangents)
+        {
+            elements[2] = getLayerElement(geometry, "LayerElementTangent", "Tangents", "TangentsIndex");
+        }
+        if (settings.importBinormals)
+        {
+            elements[3] = getLayerElement(geometry, "LayerElementBinormal", "Binormals", "BinormalsIndex");
+        }
+        return elements;
+    }
+
+    std::vector<FBXProperty*> getGeometryArrays(FBXNode &geometry, const ImportSettings &settings)
+    {
+        std::vector<FBXProperty*> arrays = { getArrayProperty(&geometry, "Vertices"), getArrayProperty(&geometry, "PolygonVertexIndex") };
+        for (const auto &element : getLayerElements(geometry, settings))
+        {
+            arrays.push_back(element.values);
+            arrays.push_back(element.indices);
+        }
+        arrays.erase(std::remove(arrays.begin(), arrays.end(), nullptr), arrays.end());
+        return arrays;
+    }
+
+    // 'd' or 'f' array of vectors with componentCount components
+    template <typename VectorType>
+    std::vector<VectorType> readVectors(const FBXProperty &property, uint32_t componentCount)
+    {
+        std::vector<VectorType> vectors;
+        std::vector<double> values;
+        if (!getArray(property, values))
+        {
+            return vectors;
+        }
+        vectors.resize(values.size() / componentCount);
+        for (size_t index = 0; index < vectors.size(); ++index)
+        {
+            VectorType vector = {};
+            for (uint32_t component = 0; component < componentCount; ++component)
+            {
+                vector.mData[component] = values[index * componentCount + component];
+            }
+            vectors[index] = vector;
+        }
+        return vectors;
+    }
+
+    // polygon and corner numbers in the file of every RawMesh corner
+    struct CornerOrigins
+    {
+        std::vector<uint32_t> polygons;
+        std::vector<uint32_t> corners;
+    };
+
+    // direct value index for every polygon corner, invalid indices become directCount
+    std::vector<uint32_t> getDirectIndices(const LayerElement &element, const std::vector<IndexSet> &corners,
+                                           const CornerOrigins &origins, size_t directCount)
+    {
+        std::vector<int32_t> indices;
+        if (element.indexToDirect)
+        {
+            getArray(*element.indices, indices);
+        }
+        std::vector<uint32_t> directIndices(corners.size());
+        for (size_t corner = 0; corner < corners.size(); ++corner)
+        {
+            size_t mappedIndex = 0;
+            switch (element.mapping)
+            {
+            case LayerElement::Mapping::ByPolygonVertex:
+                mappedIndex = origins.corners[corner];
+                break;
+            case LayerElement::Mapping::ByControlPoint:
+                mappedIndex = corners[corner].controlPoint;
+                break;
+            case LayerElement::Mapping::ByPolygon:
+                mappedIndex = origins.polygons[corner];
+                break;
+            default:
+                break;
+            }
+            size_t directIndex = mappedIndex;
+            if (element.indexToDirect)
+            {
+                directIndex = mappedIndex < indices.size() && indices[mappedIndex] >= 0 ? indices[mappedIndex] : directCount;
+            }
+            directIndices[corner] = static_cast<uint32_t>(std::min(directIndex, directCount));
+        }
+        return directIndices;
+    }
+
+    template <typename VectorType>
+    void addLayerElement(const LayerElement &element, uint32_t componentCount, const CornerOrigins &origins,
+                         uint32_t IndexSet::*indexField, RawMesh &rawMesh, std::vector<VectorType> &values)
+    {
+        if (element.mapping == LayerElement::Mapping::None)
+        {
+            return;
+        }
+        values = readVectors<VectorType>(*element.values, componentCount);
+        size_t directCount = values.size();
+        auto directIndices = getDirectIndices(element, rawMesh.polygonVertices, origins, directCount);
+        bool hasInvalidIndex = false;
+        for (size_t corner = 0; corner < directIndices.size(); ++corner)
+        {
+            rawMesh.polygonVertices[corner].*indexField = directIndices[corner];
+            hasInvalidIndex |= directIndices[corner] == directCount;
+        }
+        // corners without value get zero vector
+        if (hasInvalidIndex)
+        {
+            values.push_back(VectorType());
+        }
+    }
+
+    // polygon walk on document arrays, geometry arrays must be decompressed
+    RawMesh extractRawMesh(FBXNode &geometry, const ImportSettings &settings)
+    {
+        RawMesh rawMesh;
+        auto verticesProperty = getArrayProperty(&geometry, "Vertices");
+        auto polygonsProperty = getArrayProperty(&geometry, "PolygonVertexIndex");
+        std::vector<int32_t> polygonVertexIndex;
+        if (verticesProperty == nullptr || polygonsProperty == nullptr || !getArray(*polygonsProperty, polygonVertexIndex))
+        {
+            return rawMesh;
+        }
+        rawMesh.controlPoints = readVectors<RawVector4>(*verticesProperty, 3);
+
+        // last corner of every polygon has negative index: ~controlPoint.
+        // Polygons with invalid control point are skipped, but they are still
+        // counted by ByPolygonVertex and ByPolygon elements
+        CornerOrigins origins;
+        rawMesh.polygonVertices.reserve(polygonVertexIndex.size());
+        origins.polygons.reserve(polygonVertexIndex.size());
+        origins.corners.reserve(polygonVertexIndex.size());
+        size_t polygonStart = 0;
+        uint32_t polygonIndex = 0;
+        bool polygonValid = true;
+        for (size_t corner = 0; corner < polygonVertexIndex.size(); ++corner)
+        {
+            int32_t value = polygonVertexIndex[corner];
+            bool lastCorner = value < 0 || corner + 1 == polygonVertexIndex.size();
+            uint32_t controlPoint = static_cast<uint32_t>(value < 0 ? ~value : value);
+            polygonValid &= controlPoint < rawMesh.controlPoints.size();
+            IndexSet indexSet;
+            indexSet.controlPoint = controlPoint;
+            rawMesh.polygonVertices.push_back(indexSet);
+            origins.polygons.push_back(polygonIndex);
+            origins.corners.push_back(static_cast<uint32_t>(corner));
+            if (!lastCorner)
+            {
+                continue;
+            }
+            size_t polygonSize = corner + 1 - polygonStart;
+            if (polygonValid)
+            {
+                rawMesh.polygonSizes.push_back(static_cast<uint32_t>(polygonSize));
+            }
+            else
+            {
+                rawMesh.polygonVertices.resize(rawMesh.polygonVertices.size() - polygonSize);
+                origins.polygons.resize(origins.polygons.size() - polygonSize);
+                origins.corners.resize(origins.corners.size() - polygonSize);
+            }
+            polygonStart = corner + 1;
+            ++polygonIndex;
+            polygonValid = true;
+        }
+
+        auto elements = getLayerElements(geometry, settings);
+        addLayerElement(elements[0], 3, origins, &IndexSet::normal, rawMesh, rawMesh.normals);
+        addLayerElement(elements[1], 2, origins, &IndexSet::uv, rawMesh, rawMesh.UVs);
+        addLayerElement(elements[2], 3, origins, &IndexSet::tangent, rawMesh, rawMesh.tangents);
+        addLayerElement(elements[3], 3, origins, &IndexSet::binormal, rawMesh, rawMesh.binormals);
+        return rawMesh;
+    }
+
+    void releaseGeometryArrays(FBXNode &geometry, const ImportSettings &settings)
+    {
+        for (auto property : getGeometryArrays(geometry, settings))
+        {
+            std::vector<uint8_t>().swap(property->decoded);
+        }
+    }
+
+    // parses the file, collects objects and decompresses geometry arrays
+    bool loadDocument(const std::string &path, const ImportSettings &settings, ThreadPool &threadPool,
+                      FBXDocument &document, FBXSceneObjects &scene)
+    {
+        PhaseTimer parseTimer(Phase::FileParse);
+        bool parsed = document.open(path);
+        parseTimer.setItemCount(document.nodeCount());
+        parseTimer.stop();
+        if (!parsed)
+        {
+            std::cout << "Error loading file " << path << " :" << std::endl << document.error() << std::endl;
+            return false;
+        }
+        uint32_t version = document.version();
+        std::cout << "Imported file version: " << version / 1000 << "." << version % 1000 / 100 << "." << version % 100 << std::endl;
+        collectSceneObjects(document, scene);
+
+        PhaseTimer decompressionTimer(Phase::Decompression);
+        std::vector<FBXProperty*> arrays;
+        for (auto geometry : scene.meshGeometries)
+        {
+            auto geometryArrays = getGeometryArrays(*geometry, settings);
+            arrays.insert(arrays.end(), geometryArrays.begin(), geometryArrays.end());
+        }
+        uint64_t arraysSize = document.decompressArrays(arrays, threadPool);
+        decompressionTimer.setItemCount(arraysSize);
+        if (arraysSize == 0 && !document.error().empty())
+        {
+            std::cout << "Error loading file " << path << " :" << std::endl << document.error() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    struct Quaternion
+    {
+        double x = 0.0;
+        double y = 0.0;
+        double z = 0.0;
+        double w = 1.0;
+    };
+
+    Quaternion multiply(const Quaternion &left, const Quaternion &right)
+    {
+        Quaternion result;
+        result.w = left.w * right.w - left.x * right.x - left.y * right.y - left.z * right.z;
+        result.x = left.w * right.x + left.x * right.w + left.y * right.z - left.z * right.y;
+        result.y = left.w * right.y - left.x * right.z + left.y * right.w + left.z * right.x;
+        result.z = left.w * right.z + left.x * right.y - left.y * right.x + left.z * right.w;
+        return result;
+    }
+
+    // FBX Euler angles in degrees; rotationOrder is FbxEuler::EOrder: 0 - XYZ (X is applied first),
+    // 1 - XZY, 2 - YZX, 3 - YXZ, 4 - ZXY, 5 - ZYX, 6 - spheric XYZ
+    Quaternion eulerToQuaternion(const double degrees[3], int64_t rotationOrder)
+    {
+        static const int axisOrders[6][3] = { { 0, 1, 2 }, { 0, 2, 1 }, { 1, 2, 0 }, { 1, 0, 2 }, { 2, 0, 1 }, { 2, 1, 0 } };
+        const int *axes = axisOrders[rotationOrder >= 0 && rotationOrder < 6 ? rotationOrder : 0];
+        Quaternion result;
+        for (int step = 0; step < 3; ++step)
+        {
+            int axis = axes[step];
+            double halfAngle = degrees[axis] * Pi / 360.0;
+            Quaternion axisRotation;
+            double *components[3] = { &axisRotation.x, &axisRotation.y, &axisRotation.z };
+            *components[axis] = std::sin(halfAngle);
+            axisRotation.w = std::cos(halfAngle);
+            result = multiply(axisRotation, result);
+        }
+        return result;
+    }
+
+    template <typename FloatType>
+    ObjectNode<FloatType> getObjectNode(const FBXNode *model, const FBXSceneObjects &scene)
+    {
+        ObjectNode<FloatType> objectNode;
+        double translation[3] = { 0.0, 0.0, 0.0 };
+        double scale[3] = { 1.0, 1.0, 1.0 };
+        Quaternion rotation;
+        if (model == nullptr)
+        {
+            objectNode.uid = RootNodeId;
+            objectNode.name = "RootNode";
+        }
+        else
+        {
+            objectNode.uid = getObjectId(*model);
+            objectNode.name = getObjectName(*model);
+            objectNode.parentUid = scene.modelParents.at(objectNode.uid);
+            auto meshIt = scene.modelMeshIndices.find(objectNode.uid);
+            if (meshIt != scene.modelMeshIndices.end())
+            {
+                objectNode.meshIndex = meshIt->second;
+            }
+            getObjectPropertyValues(*model, "Lcl Translation", translation, 3);
+            getObjectPropertyValues(*model, "Lcl Scaling", scale, 3);
+            double localRotation[3] = { 0.0, 0.0, 0.0 };
+            getObjectPropertyValues(*model, "Lcl Rotation", localRotation, 3);
+            // rotation order, pre and post rotation are used only when RotationActive is set
+            double rotationActive = 0.0;
+            getObjectPropertyValues(*model, "RotationActive", &rotationActive, 1);
+            if (rotationActive != 0.0)
+            {
+                double rotationOrder = 0.0;
+                double preRotation[3] = { 0.0, 0.0, 0.0 };
+                double postRotation[3] = { 0.0, 0.0, 0.0 };
+                getObjectPropertyValues(*model, "RotationOrder", &rotationOrder, 1);
+                getObjectPropertyValues(*model, "PreRotation", preRotation, 3);
+                getObjectPropertyValues(*model, "PostRotation", postRotation, 3);
+                Quaternion postInverse = eulerToQuaternion(postRotation, 0);
+                postInverse.x = -postInverse.x;
+                postInverse.y = -postInverse.y;
+                postInverse.z = -postInverse.z;
+                rotation = multiply(multiply(eulerToQuaternion(preRotation, 0),
+                                             eulerToQuaternion(localRotation, static_cast<int64_t>(rotationOrder))),
+                                    postInverse);
+            }
+            else
+            {
+                rotation = eulerToQuaternion(localRotation, 0);
+            }
+        }
+        const double rotationValues[4] = { rotation.x, rotation.y, rotation.z, rotation.w };
+        for (int component = 0; component < 3; ++component)
+        {
+            objectNode.translation[component] = static_cast<FloatType>(translation[component]);
+            objectNode.scale[component] = static_cast<FloatType>(scale[component]);
+        }
+        for (int component = 0; component < 4; ++component)
+        {
+            objectNode.rotation[component] = static_cast<FloatType>(rotationValues[component]);
+        }
+        return objectNode;
+    }
+
+    struct MaterialParamInfo
+    {
+        const char *name;     // name in Material, like FBX SDK path uses
+        const char *fbxName;  // Properties70 entry
+        uint32_t componentCount;
+        double defaultValue[3]; // FBX SDK defaults
+        bool phongOnly;
+    };
+
+    // same parameters in the same order as FBX SDK path
+    const MaterialParamInfo MaterialParams[] = {
+        { "Ambient", "AmbientColor", 3, { 0.2, 0.2, 0.2 }, false },
+        { "Diffuse", "DiffuseColor", 3, { 0.8, 0.8, 0.8 }, false },
+        { "Emissive", "EmissiveColor", 3, { 0.0, 0.0, 0.0 }, false },
+        { "EmissiveFactor", "EmissiveFactor", 1, { 1.0 }, false },
+        { "Reflection", "ReflectionColor", 3, { 0.0, 0.0, 0.0 }, true },
+        { "ReflectionFactor", "ReflectionFactor", 1, { 1.0 }, true },
+        { "Shininess", "ShininessExponent", 1, { 20.0 }, true },
+        { "Specular", "SpecularColor", 3, { 0.2, 0.2, 0.2 }, true },
+        { "TransparencyFactor", "TransparencyFactor", 1, { 0.0 }, false },
+        { "TransparentColor", "TransparentColor", 3, { 0.0, 0.0, 0.0 }, false },
+    };
+
+    Material getMaterial(int64_t materialId, const FBXSceneObjects &scene, const ImportSettings &settings)
+    {
+        const FBXNode &materialNode = *scene.materials.at(materialId);
+        Material material;
+        material.materialName = getObjectName(materialNode);
+        std::string shadingModel = getChildString(materialNode, "ShadingModel");
+        std::transform(shadingModel.begin(), shadingModel.end(), shadingModel.begin(), ::tolower);
+        bool phong = shadingModel == "phong";
+        if (phong || shadingModel == "lambert")
+        {
+            for (const auto &paramInfo : MaterialParams)
+            {
+                if (paramInfo.phongOnly && !phong)
+                {
+                    continue;
+                }
+                double value[3] = { paramInfo.defaultValue[0], paramInfo.defaultValue[1], paramInfo.defaultValue[2] };
+                getObjectPropertyValues(materialNode, paramInfo.fbxName, value, paramInfo.componentCount);
+                if (paramInfo.componentCount == 1)
+                {
+                    MaterialParam<float> param;
+                    param.paramName = paramInfo.name;
+                    param.value = static_cast<float>(value[0]);
+                    material.floatParams.push_back(param);
+                }
+                else
+                {
+                    MaterialParam<float[3]> param;
+                    param.paramName = paramInfo.name;
+                    for (int component = 0; component < 3; ++component)
+                    {
+                        param.value[component] = static_cast<float>(value[component]);
+                    }
+                    material.float3Params.push_back(param);
+                }
+            }
+        }
+        auto texturesIt = scene.materialTextures.find(materialId);
+        if (texturesIt == scene.materialTextures.end())
+        {
+            return material;
+        }
+        for (const auto &propertyTexture : texturesIt->second)
+        {
+            const FBXNode &textureNode = *scene.textures.at(propertyTexture.second);
+            std::string fileName = getChildString(textureNode, "FileName");
+            if (fileName.empty())
+            {
+                fileName = getChildString(textureNode, "RelativeFilename");
+            }
+            if (!settings.textureRelativePath.empty())
+            {
+                fileName = setRelativePath(fileName, settings.textureRelativePath);
+            }
+            MaterialParam<std::vector<StringPair>> textureNames;
+            textureNames.paramName = propertyTexture.first;
+            textureNames.value.push_back(std::make_pair(getObjectName(textureNode), fileName));
+            material.mapNameVectorParams.push_back(textureNames);
+            MaterialParam<std::string> singleMapParam;
+            singleMapParam.paramName = textureNames.value[0].first;
+            singleMapParam.value = textureNames.value[0].second;
+            material.mapNameParams.push_back(singleMapParam);
+        }
+        return material;
+    }
+
+    // meshes of models with uniform scale, see convertRawMeshes
+    std::vector<bool> getTransformableMeshes(const FBXSceneObjects &scene)
+    {
+        std::vector<bool> transformableMeshes(scene.meshGeometries.size(), true);
+        for (auto model : scene.models)
+        {
+            auto meshIt = scene.modelMeshIndices.find(getObjectId(*model));
+            if (meshIt != scene.modelMeshIndices.end())
+            {
+                double scale[3] = { 1.0, 1.0, 1.0 };
+                getObjectPropertyValues(*model, "Lcl Scaling", scale, 3);
+                if (!isUniformScale(scale))
+                {
+                    transformableMeshes[meshIt->second] = false;
+                }
+            }
+        }
+        return transformableMeshes;
+    }
+}
+
+ImportFBXResult importFBXFileNative(const std::string &path, const ImportSettings &settings,
+                                    const MeshSink &meshSink, const ImportContext &context)
+{
+    ImportFBXResult result;
+    TraceZone importZone("importFBXFile");
+    std::unique_ptr<ThreadPool> ownThreadPool;
+    ThreadPool *threadPool = context.threadPool;
+    if (threadPool == nullptr)
+    {
+        ownThreadPool.reset(new ThreadPool(settings.threadCount));
+        threadPool = ownThreadPool.get();
+    }
+    FBXDocument document;
+    FBXSceneObjects scene;
+    if (!loadDocument(path, settings, *threadPool, document, scene))
+    {
+        return result;
+    }
+    bool sinkFailed = !convertRawMeshes(static_cast<uint32_t>(scene.meshGeometries.size()), [&scene, &settings](uint32_t meshIndex)
+    {
+        auto &geometry = *scene.meshGeometries[meshIndex];
+        RawMesh rawMesh = extractRawMesh(geometry, settings);
+        releaseGeometryArrays(geometry, settings);
+        return rawMesh;
+    }, settings, meshSink, result, threadPool,
+       settings.deduplicateTransformedMeshes ? getTransformableMeshes(scene) : std::vector<bool>());
+    if (sinkFailed)
+    {
+        std::cout << "Error exporting meshes of file " << path << std::endl;
+        return result;
+    }
+    // nodes of identical meshes share the first copy, nodes of transformed
+    // copies take the transform of their copy
+    std::unordered_map<uint64_t, InstanceTransform> nodeTransforms;
+    if (!result.meshRemap.empty())
+    {
+        for (auto &meshPair : scene.modelMeshIndices)
+        {
+            if (!result.meshTransforms.empty() && !result.meshTransforms[meshPair.second].isIdentity())
+            {
+                nodeTransforms[static_cast<uint64_t>(meshPair.first)] = result.meshTransforms[meshPair.second];
+            }
+            meshPair.second = result.meshRemap[meshPair.second];
+        }
+    }
+
+    // root node first, then models in file order like FBX SDK scene nodes
+    std::vector<const FBXNode*> models = { nullptr };
+    models.insert(models.end(), scene.models.begin(), scene.models.end());
+    TraceZone nodesZone("extractNodes");
+    nodesZone.arg("nodes", static_cast<int64_t>(models.size()));
+    uint32_t materialNumber = 0;
+    for (auto model : models)
+    {
+        auto materialsIt = model != nullptr ? scene.modelMaterials.find(getObjectId(*model)) : scene.modelMaterials.end();
+        size_t materialCount = materialsIt != scene.modelMaterials.end() ? materialsIt->second.size() : 0;
+        PhaseTimer materialTimer(Phase::MaterialExtraction, materialCount);
+        for (size_t materialIndex = 0; materialIndex < materialCount; ++materialIndex)
+        {
+            Material material = getMaterial(materialsIt->second[materialIndex], scene, settings);
+            material.materialId = materialNumber++;
+            result.sceneMaterials.push_back(material);
+        }
+        materialTimer.stop();
+        PhaseTimer nodeTimer(Phase::NodeExtraction, 1);
+        // TODO: extract material faces from FBX, sort by materials
+        if (settings.convertPositionsToFloat32)
+        {
+            auto node = getObjectNode<float>(model, scene);
+            if (node.meshIndex != InvalidID)
+            {
+                MaterialIndex matIndex = { 0, 0, result.meshIndexCounts[node.meshIndex] };
+                node.materialIndices.push_back(matIndex);
+            }
+            result.objectsFloat.push_back(node);
+        }
+        else
+        {
+            auto node = getObjectNode<double>(model, scene);
+            if (node.meshIndex != InvalidID)
+            {
+                MaterialIndex matIndex = { 0, 0, result.meshIndexCounts[node.meshIndex] };
+                node.materialIndices.push_back(matIndex);
+            }
+            result.objectsDouble.push_back(node);
+        }
+    }
+    applyInstanceTransforms(result.objectsFloat, nodeTransforms);
+    applyInstanceTransforms(result.objectsDouble, nodeTransforms);
+    result.success = true;
+    return result;
+}
+
+bool loadFBXRawMeshesNative(const std::string &path, const ImportSettings &settings, std::vector<RawMesh> &rawMeshes)
+{
+    ThreadPool threadPool(settings.threadCount);
+    FBXDocument document;
+    FBXSceneObjects scene;
+    if (!loadDocument(path, settings, threadPool, document, scene))
+    {
+        return false;
+    }
+    for (auto geometry : scene.meshGeometries)
+    {
+        PhaseTimer polygonWalkTimer(Phase::PolygonWalk);
+        rawMeshes.push_back(extractRawMesh(*geometry, settings));
+        polygonWalkTimer.setItemCount(rawMeshes.back().polygonVertices.size());
+        releaseGeometryArrays(*geometry, settings);
+    }
+    return true;
+}
@@ -0,0 +1,24 @@
+//-----------------------------------------------------------------------------
+// ImportFBXNative.h
+// Created at 2026.10.17 19:50
+// License: see LICENSE file
+//
+// import of binary FBX files without FBX SDK: meshes, scene nodes, materials
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+
+#include "ImportFBX.h"
+#include "RawMesh.h"
+
+// same result as importFBXFile for binary FBX 7.x files, ASCII FBX files need FBX SDK.
+// Compressed geometry arrays are decompressed on the conversion pool of the context.
+// Node transforms use translation, rotation (with order, pre/post rotation) and
+// scaling, pivots and offsets are ignored
+ImportFBXResult importFBXFileNative(const std::string &path, const ImportSettings &settings,
+                                    const MeshSink &meshSink = MeshSink(),
+                                    const ImportContext &context = ImportContext());
+
+// parse, decompression and polygon walk of all meshes without conversion,
+// used to compare native reader with FBX SDK
+bool loadFBXRawMeshesNative(const std::string &path, const ImportSettings &settings, std::vector<RawMesh> &rawMeshes);
@@ -39,4 +39,17 @@ struct IndexSet
                     (controlPoint == rhs.controlPoint && normal == rhs.normal && uv == rhs.uv &&
                         tangent == rhs.tangent && binormal == rhs.binormal && vertexColor < rhs.vertexColor);
     }
-};
\ No newline at end of file
+};
+
+// fast hash of all six stream indices, used by open addressing vertex tables
+inline uint64_t hashIndexSet(const IndexSet& indexSet)
+{
+    const uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+    uint64_t hash = (uint64_t(indexSet.controlPoint) << 32) | indexSet.normal;
+    hash *= multiplier;
+    hash ^= (uint64_t(indexSet.uv) << 32) | indexSet.tangent;
+    hash *= multiplier;
+    hash ^= (uint64_t(indexSet.binormal) << 32) | indexSet.vertexColor;
+    hash *= multiplier;
+    return hash ^ (hash >> 29);
+}
@@ -0,0 +1,439 @@
+//-----------------------------------------------------------------------------
+// Inflate.cpp
+// Created at 2026.10.17 19:50
+// License: see LICENSE file
+//
+// DEFLATE (RFC 1951) and zlib (RFC 1950) decompression, used for compressed
+// array properties of binary FBX files
+//-----------------------------------------------------------------------------
+#include "Inflate.h"
+
+#include <cstring>
+
+namespace
+{
+    const uint32_t MaxCodeLength = 15;
+    const uint32_t FastBits = 10; // codes up to this length are decoded with one table lookup
+    const uint32_t MaxLiteralCodes = 288;
+    const uint32_t MaxDistanceCodes = 32;
+
+    const uint16_t LengthBase[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+    };
+    const uint8_t LengthExtraBits[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+    };
+    const uint16_t DistanceBase[30] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+    };
+    const uint8_t DistanceExtraBits[30] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+    };
+    // order of code length code lengths in dynamic block header
+    const uint8_t CodeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    // reads bits LSB first. Reads past the end return zero bits,
+    // overrun() tells whether any of them were consumed
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t *data, size_t size)
+            : _data(data), _size(size), _position(0), _bits(0), _bitCount(0)
+        {
+        }
+
+        // after refill at least 56 bits are available
+        inline void refill()
+        {
+            if (_position + 8 <= _size)
+            {
+                uint64_t value;
+                memcpy(&value, _data + _position, 8); // little-endian
+                _bits |= value << _bitCount;
+                _position += (63 - _bitCount) >> 3;
+                _bitCount |= 56;
+                return;
+            }
+            while (_bitCount <= 56)
+            {
+                uint64_t value = _position < _size ? _data[_position] : 0;
+                _bits |= value << _bitCount;
+                ++_position;
+                _bitCount += 8;
+            }
+        }
+        inline uint32_t peek(uint32_t count) const { return static_cast<uint32_t>(_bits & ((uint64_t(1) << count) - 1)); }
+        inline void consume(uint32_t count)
+        {
+            _bits >>= count;
+            _bitCount -= count;
+        }
+        // count <= 32, available bits must be enough (see refill)
+        inline uint32_t read(uint32_t count)
+        {
+            uint32_t value = peek(count);
+            consume(count);
+            return value;
+        }
+        inline uint64_t bits() const { return _bits; }
+
+        // drops bits up to byte boundary and returns position of the next unread byte
+        size_t alignToByte()
+        {
+            consume(_bitCount & 7);
+            size_t bytePosition = _position - _bitCount / 8;
+            _position = bytePosition;
+            _bits = 0;
+            _bitCount = 0;
+            return bytePosition;
+        }
+        inline void skipBytes(size_t count) { _position += count; }
+
+        inline size_t bytesUsed() const { return _position - _bitCount / 8; }
+        inline bool overrun() const { return _position * 8 - _bitCount > _size * 8; }
+
+    private:
+        const uint8_t *_data;
+        size_t _size;
+        size_t _position;
+        uint64_t _bits;
+        uint32_t _bitCount;
+    };
+
+    // canonical Huffman code: lookup table for short codes and
+    // counts/sorted symbols for bit by bit decoding of longer codes
+    struct HuffmanTable
+    {
+        uint16_t fast[1 << FastBits]; // (code length << 9) | symbol, 0 - code is longer than FastBits
+        uint16_t counts[MaxCodeLength + 1];
+        uint16_t symbols[MaxLiteralCodes];
+
+        // returns false for over-subscribed code, incomplete codes are allowed
+        bool build(const uint8_t *lengths, uint32_t symbolCount)
+        {
+            memset(counts, 0, sizeof(counts));
+            for (uint32_t symbol = 0; symbol < symbolCount; ++symbol)
+            {
+                ++counts[lengths[symbol]];
+            }
+            counts[0] = 0;
+            int32_t left = 1;
+            for (uint32_t length = 1; length <= MaxCodeLength; ++length)
+            {
+                left = (left << 1) - counts[length];
+                if (left < 0)
+                {
+                    return false;
+                }
+            }
+            uint16_t offsets[MaxCodeLength + 2];
+            uint32_t nextCode[MaxCodeLength + 1];
+            offsets[1] = 0;
+            uint32_t code = 0;
+            for (uint32_t length = 1; length <= MaxCodeLength; ++length)
+            {
+                offsets[length + 1] = offsets[length] + counts[length];
+                code = (code + counts[length - 1]) << 1;
+                nextCode[length] = code;
+            }
+            memset(fast, 0, sizeof(fast));
+            for (uint32_t symbol = 0; symbol < symbolCount; ++symbol)
+            {
+                uint32_t length = lengths[symbol];
+                if (length == 0)
+                {
+                    continue;
+                }
+                symbols[offsets[length]++] = static_cast<uint16_t>(symbol);
+                uint32_t symbolCode = nextCode[length]++;
+                if (length <= FastBits)
+                {
+                    // codes are stored MSB first, the table is indexed by stream bits
+                    uint32_t reversed = 0;
+                    for (uint32_t bit = 0; bit < length; ++bit)
+                    {
+                        reversed |= ((symbolCode >> bit) & 1) << (length - 1 - bit);
+                    }
+                    for (uint32_t index = reversed; index < (1u << FastBits); index += 1u << length)
+                    {
+                        fast[index] = static_cast<uint16_t>((length << 9) | symbol);
+                    }
+                }
+            }
+            return true;
+        }
+
+        // reader must have at least MaxCodeLength bits, returns -1 for invalid code
+        inline int32_t decode(BitReader &reader) const
+        {
+            uint32_t entry = fast[reader.peek(FastBits)];
+            if (entry != 0)
+            {
+                reader.consume(entry >> 9);
+                return entry & 511;
+            }
+            uint64_t bits = reader.bits();
+            int32_t code = 0;
+            int32_t first = 0;
+            int32_t index = 0;
+            for (uint32_t length = 1; length <= MaxCodeLength; ++length)
+            {
+                code |= static_cast<int32_t>((bits >> (length - 1)) & 1);
+                int32_t count = counts[length];
+                if (code - first < count)
+                {
+                    reader.consume(length);
+                    return symbols[index + code - first];
+                }
+                index += count;
+                first = (first + count) << 1;
+                code <<= 1;
+            }
+            return -1;
+        }
+    };
+
+    bool buildFixedTables(HuffmanTable &literals, HuffmanTable &distances)
+    {
+        uint8_t lengths[MaxLiteralCodes];
+        memset(lengths, 8, 144);
+        memset(lengths + 144, 9, 112);
+        memset(lengths + 256, 7, 24);
+        memset(lengths + 280, 8, 8);
+        uint8_t distanceLengths[30];
+        memset(distanceLengths, 5, sizeof(distanceLengths));
+        return literals.build(lengths, MaxLiteralCodes) && distances.build(distanceLengths, 30);
+    }
+
+    bool readDynamicTables(BitReader &reader, HuffmanTable &literals, HuffmanTable &distances)
+    {
+        reader.refill();
+        uint32_t literalCount = reader.read(5) + 257;
+        uint32_t distanceCount = reader.read(5) + 1;
+        uint32_t codeLengthCount = reader.read(4) + 4;
+        if (literalCount > 286 || distanceCount > 30)
+        {
+            return false;
+        }
+        uint8_t codeLengthLengths[19] = {};
+        for (uint32_t index = 0; index < codeLengthCount; ++index)
+        {
+            reader.refill();
+            codeLengthLengths[CodeLengthOrder[index]] = static_cast<uint8_t>(reader.read(3));
+        }
+        HuffmanTable codeLengths;
+        if (!codeLengths.build(codeLengthLengths, 19))
+        {
+            return false;
+        }
+        uint8_t lengths[MaxLiteralCodes + MaxDistanceCodes] = {};
+        uint32_t index = 0;
+        while (index < literalCount + distanceCount)
+        {
+            reader.refill();
+            int32_t symbol = codeLengths.decode(reader);
+            if (symbol < 0)
+            {
+                return false;
+            }
+            if (symbol < 16)
+            {
+                lengths[index++] = static_cast<uint8_t>(symbol);
+                continue;
+            }
+            uint8_t value = 0;
+            uint32_t repeat;
+            if (symbol == 16)
+            {
+                if (index == 0)
+                {
+                    return false;
+                }
+                value = lengths[index - 1];
+                repeat = 3 + reader.read(2);
+            }
+            else if (symbol == 17)
+            {
+                repeat = 3 + reader.read(3);
+            }
+            else
+            {
+                repeat = 11 + reader.read(7);
+            }
+            if (index + repeat > literalCount + distanceCount)
+            {
+                return false;
+            }
+            memset(lengths + index, value, repeat);
+            index += repeat;
+        }
+        // end of block code is required
+        return lengths[256] != 0 &&
+               literals.build(lengths, literalCount) &&
+               distances.build(lengths + literalCount, distanceCount);
+    }
+
+    bool inflateBlock(BitReader &reader, const HuffmanTable &literals, const HuffmanTable &distances,
+                      uint8_t *destination, size_t destinationSize, size_t &outputPosition)
+    {
+        for (;;)
+        {
+            // one refill is enough for literal/length code, its extra bits, distance code and its extra bits
+            reader.refill();
+            int32_t symbol = literals.decode(reader);
+            if (symbol < 256)
+            {
+                if (symbol < 0 || outputPosition >= destinationSize)
+                {
+                    return false;
+                }
+                destination[outputPosition++] = static_cast<uint8_t>(symbol);
+                continue;
+            }
+            if (symbol == 256)
+            {
+                return true;
+            }
+            symbol -= 257;
+            if (symbol >= 29)
+            {
+                return false;
+            }
+            size_t length = LengthBase[symbol] + reader.read(LengthExtraBits[symbol]);
+            int32_t distanceSymbol = distances.decode(reader);
+            if (distanceSymbol < 0 || distanceSymbol >= 30)
+            {
+                return false;
+            }
+            size_t distance = DistanceBase[distanceSymbol] + reader.read(DistanceExtraBits[distanceSymbol]);
+            if (distance > outputPosition || length > destinationSize - outputPosition)
+            {
+                return false;
+            }
+            uint8_t *target = destination + outputPosition;
+            const uint8_t *match = target - distance;
+            if (distance >= length)
+            {
+                memcpy(target, match, length);
+            }
+            else
+            {
+                // overlapping copy repeats the last distance bytes
+                for (size_t index = 0; index < length; ++index)
+                {
+                    target[index] = match[index];
+                }
+            }
+            outputPosition += length;
+        }
+    }
+}
+
+bool inflateRaw(const uint8_t *source, size_t sourceSize,
+                uint8_t *destination, size_t destinationSize, size_t *sourceUsed)
+{
+    BitReader reader(source, sourceSize);
+    HuffmanTable literals;
+    HuffmanTable distances;
+    size_t outputPosition = 0;
+    bool lastBlock = false;
+    while (!lastBlock)
+    {
+        reader.refill();
+        lastBlock = reader.read(1) != 0;
+        uint32_t blockType = reader.read(2);
+        if (blockType == 0)
+        {
+            size_t position = reader.alignToByte();
+            if (position + 4 > sourceSize)
+            {
+                return false;
+            }
+            uint32_t length = source[position] | (source[position + 1] << 8);
+            uint32_t lengthComplement = source[position + 2] | (source[position + 3] << 8);
+            position += 4;
+            if ((length ^ 0xFFFF) != lengthComplement ||
+                length > sourceSize - position || length > destinationSize - outputPosition)
+            {
+                return false;
+            }
+            if (length > 0)
+            {
+                memcpy(destination + outputPosition, source + position, length);
+                outputPosition += length;
+            }
+            reader.skipBytes(4 + length);
+        }
+        else if (blockType == 1 || blockType == 2)
+        {
+            bool tablesRead = blockType == 1 ? buildFixedTables(literals, distances)
+                                             : readDynamicTables(reader, literals, distances);
+            if (!tablesRead || !inflateBlock(reader, literals, distances, destination, destinationSize, outputPosition))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+        if (reader.overrun())
+        {
+            return false;
+        }
+    }
+    if (sourceUsed != nullptr)
+    {
+        *sourceUsed = reader.bytesUsed();
+    }
+    return outputPosition == destinationSize;
+}
+
+bool inflateZlib(const uint8_t *source, size_t sourceSize, uint8_t *destination, size_t destinationSize)
+{
+    // compression method 8 (deflate), no preset dictionary
+    if (sourceSize < 6 || (source[0] & 0x0F) != 8 || (source[0] >> 4) > 7 ||
+        ((source[0] << 8) | source[1]) % 31 != 0 || (source[1] & 0x20) != 0)
+    {
+        return false;
+    }
+    size_t deflateSize = 0;
+    if (!inflateRaw(source + 2, sourceSize - 2, destination, destinationSize, &deflateSize))
+    {
+        return false;
+    }
+    size_t checksumPosition = 2 + deflateSize;
+    if (checksumPosition + 4 > sourceSize)
+    {
+        return false;
+    }
+    const uint8_t *checksum = source + checksumPosition;
+    uint32_t expected = (uint32_t(checksum[0]) << 24) | (uint32_t(checksum[1]) << 16) | (uint32_t(checksum[2]) << 8) | checksum[3];
+    return adler32(destination, destinationSize) == expected;
+}
+
+uint32_t adler32(const uint8_t *data, size_t size)
+{
+    const uint32_t modulus = 65521;
+    const size_t maxBlock = 5552; // largest block for which sums don't overflow 32 bits
+    uint32_t a = 1;
+    uint32_t b = 0;
+    while (size > 0)
+    {
+        size_t blockSize = size < maxBlock ? size : maxBlock;
+        size -= blockSize;
+        for (size_t index = 0; index < blockSize; ++index)
+        {
+            a += data[index];
+            b += a;
+        }
+        data += blockSize;
+        a %= modulus;
+        b %= modulus;
+    }
+    return (b << 16) | a;
+}
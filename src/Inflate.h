@@ -0,0 +1,22 @@
+//-----------------------------------------------------------------------------
+// Inflate.h
+// Created at 2026.10.17 19:50
+// License: see LICENSE file
+//
+// DEFLATE (RFC 1951) and zlib (RFC 1950) decompression, used for compressed
+// array properties of binary FBX files
+//-----------------------------------------------------------------------------
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// decompresses raw DEFLATE data, output must be exactly destinationSize bytes.
+// Returns false on corrupted data or other output size.
+// sourceUsed receives the number of bytes up to the end of the last block
+bool inflateRaw(const uint8_t *source, size_t sourceSize,
+                uint8_t *destination, size_t destinationSize, size_t *sourceUsed = nullptr);
+
+// zlib stream: 2 byte header, DEFLATE data and Adler-32 of output, which is checked
+bool inflateZlib(const uint8_t *source, size_t sourceSize, uint8_t *destination, size_t destinationSize);
+
+uint32_t adler32(const uint8_t *data, size_t size);
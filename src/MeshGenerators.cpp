@@ -0,0 +1,201 @@
+//-----------------------------------------------------------------------------
+// MeshGenerators.cpp
+// Created at 2026.10.17 19:20
+// License: see LICENSE file
+//
+// synthetic RawMesh generators, so mesh processing can be benchmarked
+// without FBX SDK and real assets
+//-----------------------------------------------------------------------------
+#include "MeshGenerators.h"
+
+#include <cmath>
+
+#include "Common.h"
+
+namespace
+{
+    inline uint32_t addVector(std::vector<RawVector4> &vectors, double x, double y, double z)
+    {
+        RawVector4 vector = { { x, y, z, 0.0 } };
+        vectors.push_back(vector);
+        return static_cast<uint32_t>(vectors.size() - 1);
+    }
+
+    inline uint32_t addUV(std::vector<RawVector2> &UVs, double u, double v)
+    {
+        RawVector2 uv = { { u, v } };
+        UVs.push_back(uv);
+        return static_cast<uint32_t>(UVs.size() - 1);
+    }
+}
+
+RawMesh generateGridRawMesh(uint32_t quadsX, uint32_t quadsY)
+{
+    RawMesh rawMesh;
+    rawMesh.controlPoints.reserve(size_t(quadsX + 1) * (quadsY + 1));
+    rawMesh.polygonSizes.reserve(size_t(quadsX) * quadsY);
+    rawMesh.polygonVertices.reserve(size_t(quadsX) * quadsY * 4);
+    rawMesh.normals.reserve(size_t(quadsX) * quadsY * 4);
+    rawMesh.UVs.reserve(size_t(quadsX) * quadsY * 4);
+    for (uint32_t y = 0; y <= quadsY; ++y)
+    {
+        for (uint32_t x = 0; x <= quadsX; ++x)
+        {
+            addVector(rawMesh.controlPoints, double(x), double(y), 0.0);
+        }
+    }
+    for (uint32_t y = 0; y < quadsY; ++y)
+    {
+        for (uint32_t x = 0; x < quadsX; ++x)
+        {
+            uint32_t quadPoints[4] = {
+                y * (quadsX + 1) + x,
+                y * (quadsX + 1) + x + 1,
+                (y + 1) * (quadsX + 1) + x + 1,
+                (y + 1) * (quadsX + 1) + x
+            };
+            rawMesh.polygonSizes.push_back(4);
+            for (auto controlPoint : quadPoints)
+            {
+                IndexSet indexSet;
+                indexSet.controlPoint = controlPoint;
+                indexSet.normal = addVector(rawMesh.normals, 0.0, 0.0, 1.0);
+                const auto &position = rawMesh.controlPoints[controlPoint].mData;
+                indexSet.uv = addUV(rawMesh.UVs, position[0] / quadsX, position[1] / quadsY);
+                rawMesh.polygonVertices.push_back(indexSet);
+            }
+        }
+    }
+    return rawMesh;
+}
+
+RawMesh generateSphereRawMesh(uint64_t cornerCount)
+{
+    // segments x rings quads, segments = 2 * rings
+    uint32_t rings = std::max<uint32_t>(2, static_cast<uint32_t>(std::sqrt(cornerCount / 8.0)));
+    uint32_t segments = 2 * rings;
+    RawMesh rawMesh;
+    size_t pointCount = size_t(segments + 1) * (rings + 1);
+    rawMesh.controlPoints.reserve(pointCount);
+    rawMesh.normals.reserve(pointCount);
+    rawMesh.UVs.reserve(pointCount);
+    for (uint32_t ring = 0; ring <= rings; ++ring)
+    {
+        double theta = Pi * ring / rings;
+        for (uint32_t segment = 0; segment <= segments; ++segment)
+        {
+            double phi = 2.0 * Pi * segment / segments;
+            double x = std::sin(theta) * std::cos(phi);
+            double y = std::cos(theta);
+            double z = std::sin(theta) * std::sin(phi);
+            addVector(rawMesh.controlPoints, x, y, z);
+            addVector(rawMesh.normals, x, y, z);
+            addUV(rawMesh.UVs, double(segment) / segments, double(ring) / rings);
+        }
+    }
+    rawMesh.polygonSizes.reserve(size_t(segments) * rings);
+    rawMesh.polygonVertices.reserve(size_t(segments) * rings * 4);
+    for (uint32_t ring = 0; ring < rings; ++ring)
+    {
+        for (uint32_t segment = 0; segment < segments; ++segment)
+        {
+            uint32_t quadPoints[4] = {
+                ring * (segments + 1) + segment,
+                ring * (segments + 1) + segment + 1,
+                (ring + 1) * (segments + 1) + segment + 1,
+                (ring + 1) * (segments + 1) + segment
+            };
+            // quads touching a pole degenerate to triangles
+            uint32_t skipCorner = ring == 0 ? 1 : (ring == rings - 1 ? 3 : 4);
+            rawMesh.polygonSizes.push_back(skipCorner < 4 ? 3 : 4);
+            for (uint32_t corner = 0; corner < 4; ++corner)
+            {
+                if (corner == skipCorner)
+                {
+                    continue;
+                }
+                IndexSet indexSet;
+                indexSet.controlPoint = indexSet.normal = indexSet.uv = quadPoints[corner];
+                rawMesh.polygonVertices.push_back(indexSet);
+            }
+        }
+    }
+    return rawMesh;
+}
+
+RawMesh generateHardEdgeRawMesh(uint64_t cornerCount)
+{
+    // 6 quad faces = 24 corners per box
+    uint32_t boxesX = std::max<uint32_t>(1, static_cast<uint32_t>(std::sqrt(cornerCount / 24.0)));
+    uint32_t boxesY = std::max<uint32_t>(1, static_cast<uint32_t>(cornerCount / 24 / boxesX));
+    RawMesh rawMesh;
+    size_t boxCount = size_t(boxesX) * boxesY;
+    rawMesh.controlPoints.reserve(boxCount * 8);
+    rawMesh.polygonSizes.reserve(boxCount * 6);
+    rawMesh.polygonVertices.reserve(boxCount * 24);
+    const double faceNormals[6][3] = { { 0, 0, -1 }, { 0, 0, 1 }, { 0, -1, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { -1, 0, 0 } };
+    for (const auto &normal : faceNormals)
+    {
+        addVector(rawMesh.normals, normal[0], normal[1], normal[2]);
+    }
+    const double faceUVs[4][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+    for (const auto &uv : faceUVs)
+    {
+        addUV(rawMesh.UVs, uv[0], uv[1]);
+    }
+    // box corner bits: x = 1, y = 2, z = 4; faces are counter-clockwise seen from outside
+    const uint32_t faceCorners[6][4] = {
+        { 0, 2, 3, 1 }, { 4, 5, 7, 6 }, { 0, 1, 5, 4 }, { 1, 3, 7, 5 }, { 3, 2, 6, 7 }, { 2, 0, 4, 6 }
+    };
+    for (uint32_t y = 0; y < boxesY; ++y)
+    {
+        for (uint32_t x = 0; x < boxesX; ++x)
+        {
+            uint32_t firstPoint = static_cast<uint32_t>(rawMesh.controlPoints.size());
+            double height = 0.5 + ((x * 7 + y * 13) % 10) * 0.1;
+            for (uint32_t corner = 0; corner < 8; ++corner)
+            {
+                addVector(rawMesh.controlPoints,
+                          x * 1.5 + ((corner & 1) != 0 ? 1.0 : 0.0),
+                          y * 1.5 + ((corner & 2) != 0 ? 1.0 : 0.0),
+                          (corner & 4) != 0 ? height : 0.0);
+            }
+            for (uint32_t face = 0; face < 6; ++face)
+            {
+                rawMesh.polygonSizes.push_back(4);
+                for (uint32_t faceCorner = 0; faceCorner < 4; ++faceCorner)
+                {
+                    IndexSet indexSet;
+                    indexSet.controlPoint = firstPoint + faceCorners[face][faceCorner];
+                    indexSet.normal = face;
+                    indexSet.uv = faceCorner;
+                    rawMesh.polygonVertices.push_back(indexSet);
+                }
+            }
+        }
+    }
+    return rawMesh;
+}
+
+bool generateRawMesh(const std::string &name, uint64_t cornerCount, RawMesh &rawMesh)
+{
+    if (name == "grid")
+    {
+        uint32_t quadsX = std::max<uint32_t>(1, static_cast<uint32_t>(std::sqrt(cornerCount / 4.0)));
+        uint32_t quadsY = std::max<uint32_t>(1, static_cast<uint32_t>(cornerCount / 4 / quadsX));
+        rawMesh = generateGridRawMesh(quadsX, quadsY);
+    }
+    else if (name == "sphere")
+    {
+        rawMesh = generateSphereRawMesh(cornerCount);
+    }
+    else if (name == "cad")
+    {
+        rawMesh = generateHardEdgeRawMesh(cornerCount);
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,29 @@
+//-----------------------------------------------------------------------------
+// MeshGenerators.h
+// Created at 2026.10.17 19:20
+// License: see LICENSE file
+//
+// synthetic RawMesh generators, so mesh processing can be benchmarked
+// without FBX SDK and real assets
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+
+#include "RawMesh.h"
+
+// quad grid in XY plane as it comes from FBX: quads, normal and uv for each
+// polygon corner (eByPolygonVertex), so every corner is unique before merge
+RawMesh generateGridRawMesh(uint32_t quadsX, uint32_t quadsY);
+
+// UV sphere of ~cornerCount polygon corners: quads, triangles at the poles.
+// Smooth: normal and uv are shared by all corners of a control point,
+// the seam has separate control points
+RawMesh generateSphereRawMesh(uint64_t cornerCount);
+
+// CAD-like mesh of ~cornerCount polygon corners: grid of boxes, every box face
+// has its own normal (hard edges) and uv per face corner, control points are
+// shared by the faces of a box
+RawMesh generateHardEdgeRawMesh(uint64_t cornerCount);
+
+// "grid", "sphere", "cad"; returns false for unknown name
+bool generateRawMesh(const std::string &name, uint64_t cornerCount, RawMesh &rawMesh);
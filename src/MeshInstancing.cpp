@@ -0,0 +1,806 @@
+//-----------------------------------------------------------------------------
+// MeshInstancing.cpp
+// Created at 2026.10.17 23:30
+// License: see LICENSE file
+//
+// detection of identical converted meshes (--dedupe-meshes): scene nodes
+// of all copies share one mesh file. With --dedupe-transformed also copies
+// placed by baked rotation, translation and uniform scale, the transform
+// moves to the nodes
+//-----------------------------------------------------------------------------
+#include "MeshInstancing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <map>
+#include <unordered_map>
+
+#include "Hash.h"
+#include "ThreadPool.h"
+
+namespace
+{
+    inline bool isToleranceStream(const VectorStream &stream, float tolerance)
+    {
+        return tolerance > 0.0f && stream.elementType == static_cast<uint32_t>(StreamElementType::Float) &&
+               (stream.elementSize == sizeof(float) || stream.elementSize == sizeof(double));
+    }
+
+    // number of components of the tolerance key, one per vector component
+    // x, y, z (w and further components go with x, y, z again)
+    const int ToleranceKeySize = 3;
+    const double MaxCell = 4.0e18; // below 2^63
+
+    struct ToleranceKey
+    {
+        double values[ToleranceKeySize] = { 0.0, 0.0, 0.0 };
+        double rounding = 0.0; // max rounding error of values
+        bool finite = true;
+    };
+
+    template <typename T>
+    void sumAbsoluteValues(const VectorStream &stream, double sums[ToleranceKeySize], size_t counts[ToleranceKeySize])
+    {
+        size_t valueCount = stream.data.size() / sizeof(T);
+        uint32_t vectorSize = std::max(1u, stream.elementVectorSize);
+        for (size_t valueIndex = 0; valueIndex < valueCount; ++valueIndex)
+        {
+            T value;
+            memcpy(&value, stream.data.data() + valueIndex * sizeof(T), sizeof(T));
+            int component = (valueIndex % vectorSize) % ToleranceKeySize;
+            sums[component] += std::abs(static_cast<double>(value));
+            ++counts[component];
+        }
+    }
+
+    template <typename T>
+    bool valuesWithinTolerance(const std::vector<uint8_t> &left, const std::vector<uint8_t> &right, double tolerance)
+    {
+        size_t valueCount = left.size() / sizeof(T);
+        for (size_t valueIndex = 0; valueIndex < valueCount; ++valueIndex)
+        {
+            T leftValue;
+            T rightValue;
+            memcpy(&leftValue, left.data() + valueIndex * sizeof(T), sizeof(T));
+            memcpy(&rightValue, right.data() + valueIndex * sizeof(T), sizeof(T));
+            if (!(std::abs(static_cast<double>(leftValue) - static_cast<double>(rightValue)) <= tolerance))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint64_t hashStreamHeader(const VectorStream &stream)
+    {
+        const uint32_t header[] = { stream.attributeType, stream.elementCount, stream.elementType,
+                                    stream.elementSize, stream.elementVectorSize };
+        return hash64(header, sizeof(header));
+    }
+
+    // float values compared with tolerance aren't hashed: any rounding of them
+    // puts some values within tolerance into different cells, and one such
+    // value of a large mesh splits its copies
+    uint64_t hashStreamData(const VectorStream &stream, float tolerance)
+    {
+        return isToleranceStream(stream, tolerance) ? 0 : hash64(stream.data.data(), stream.data.size());
+    }
+
+    // mean absolute values of x, y and z components of the floats compared
+    // with tolerance. Every mean of meshes within tolerance differs by at most
+    // tolerance plus rounding of the sums, so the key sorts meshes into cells
+    // of that size and copies are in the same or a neighbour cell. A mesh with
+    // values which aren't finite is never within tolerance of another
+    ToleranceKey getToleranceKey(const StreamMesh &mesh, float tolerance)
+    {
+        ToleranceKey key;
+        double sums[ToleranceKeySize] = { 0.0, 0.0, 0.0 };
+        size_t counts[ToleranceKeySize] = { 0, 0, 0 };
+        for (const auto &stream : mesh.streams)
+        {
+            if (!isToleranceStream(stream, tolerance))
+            {
+                continue;
+            }
+            if (stream.elementSize == sizeof(float))
+            {
+                sumAbsoluteValues<float>(stream, sums, counts);
+            }
+            else
+            {
+                sumAbsoluteValues<double>(stream, sums, counts);
+            }
+        }
+        for (int component = 0; component < ToleranceKeySize; ++component)
+        {
+            key.finite &= std::isfinite(sums[component]);
+            key.rounding = std::max(key.rounding, 2.0 * std::numeric_limits<double>::epsilon() * sums[component]);
+            key.values[component] = counts[component] > 0 ? sums[component] / counts[component] : 0.0;
+        }
+        return key;
+    }
+
+    inline int64_t getKeyCell(double value, double cellSize)
+    {
+        // values above the range share the last cell
+        double cell = std::floor(value / cellSize);
+        return cell < MaxCell ? static_cast<int64_t>(cell) : static_cast<int64_t>(MaxCell);
+    }
+
+    bool streamHeadersEqual(const VectorStream &left, const VectorStream &right)
+    {
+        return left.attributeType == right.attributeType && left.elementCount == right.elementCount &&
+               left.elementType == right.elementType && left.elementSize == right.elementSize &&
+               left.elementVectorSize == right.elementVectorSize && left.data.size() == right.data.size();
+    }
+
+    bool streamDataEqual(const VectorStream &left, const VectorStream &right, float tolerance)
+    {
+        if (!isToleranceStream(left, tolerance))
+        {
+            return left.data.empty() || memcmp(left.data.data(), right.data.data(), left.data.size()) == 0;
+        }
+        if (left.elementSize == sizeof(float))
+        {
+            return valuesWithinTolerance<float>(left.data, right.data, tolerance);
+        }
+        return valuesWithinTolerance<double>(left.data, right.data, tolerance);
+    }
+
+    // first copies move to the front in input order. New index of a mesh is
+    // never above its input index, so no mesh is overwritten before its move
+    void compactMeshes(std::vector<StreamMesh> &meshes, const std::vector<uint32_t> &meshRemap, uint32_t uniqueMeshCount)
+    {
+        uint32_t movedCount = 0;
+        for (uint32_t meshIndex = 0; meshIndex < meshes.size(); ++meshIndex)
+        {
+            if (meshRemap[meshIndex] == movedCount)
+            {
+                if (movedCount != meshIndex)
+                {
+                    meshes[movedCount] = std::move(meshes[meshIndex]);
+                }
+                ++movedCount;
+            }
+        }
+        meshes.resize(uniqueMeshCount);
+    }
+
+    // transformed copies: float32 rounding of baked coordinates, relative to
+    // the largest coordinate, is far below this
+    const double RelativePositionTolerance = 1.0e-5;
+    const double DirectionTolerance = 1.0e-4;
+    // max difference of normalized spread of a copy (sum of spread is 1)
+    const double SpreadTolerance = 1.0e-4;
+    // meshes with close signatures which aren't copies cost a full comparison
+    // each, limit keeps groups of similar meshes from becoming quadratic
+    const uint32_t MaxVerifiedCandidates = 16;
+
+    inline bool isDirectionAttribute(uint32_t attributeType)
+    {
+        return attributeType == static_cast<uint32_t>(AttributeType::Normal) ||
+               attributeType == static_cast<uint32_t>(AttributeType::Tangent) ||
+               attributeType == static_cast<uint32_t>(AttributeType::Binormal);
+    }
+
+    // data of position and direction streams changes with transform, meshlet
+    // bounds are computed from positions
+    inline bool isTransformedAttribute(uint32_t attributeType)
+    {
+        return attributeType == static_cast<uint32_t>(AttributeType::Position) || isDirectionAttribute(attributeType) ||
+               attributeType == static_cast<uint32_t>(AttributeType::MeshletBounds);
+    }
+
+    inline bool isFloat3Stream(const VectorStream &stream)
+    {
+        return stream.elementType == static_cast<uint32_t>(StreamElementType::Float) && stream.elementVectorSize == 3 &&
+               (stream.elementSize == sizeof(float) || stream.elementSize == sizeof(double));
+    }
+
+    // separate float positions and directions can be transformed, encoded
+    // (UNorm positions, octahedral directions) and interleaved ones can't
+    bool canTransformStreams(const StreamMesh &mesh)
+    {
+        bool hasPositions = false;
+        for (const auto &stream : mesh.streams)
+        {
+            auto attributeType = stream.attributeType;
+            if (attributeType == static_cast<uint32_t>(AttributeType::Position) || isDirectionAttribute(attributeType))
+            {
+                if (!isFloat3Stream(stream))
+                {
+                    return false;
+                }
+                hasPositions |= attributeType == static_cast<uint32_t>(AttributeType::Position) && stream.elementCount > 0;
+            }
+            else if (attributeType == static_cast<uint32_t>(AttributeType::PositionDequantization))
+            {
+                return false;
+            }
+            else if (attributeType == static_cast<uint32_t>(AttributeType::InterleavedLayout))
+            {
+                size_t attributeCount = stream.data.size() / sizeof(InterleavedAttribute);
+                for (size_t attributeIndex = 0; attributeIndex < attributeCount; ++attributeIndex)
+                {
+                    InterleavedAttribute attribute;
+                    memcpy(&attribute, stream.data.data() + attributeIndex * sizeof(attribute), sizeof(attribute));
+                    if (isTransformedAttribute(attribute.attributeType))
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+        return hasPositions;
+    }
+
+    inline void readVector3(const VectorStream &stream, size_t elementIndex, double vector[3])
+    {
+        if (stream.elementSize == sizeof(float))
+        {
+            float values[3];
+            memcpy(values, stream.data.data() + elementIndex * sizeof(values), sizeof(values));
+            vector[0] = values[0];
+            vector[1] = values[1];
+            vector[2] = values[2];
+        }
+        else
+        {
+            memcpy(vector, stream.data.data() + elementIndex * 3 * sizeof(double), 3 * sizeof(double));
+        }
+    }
+
+    const VectorStream* findStream(const StreamMesh &mesh, AttributeType attributeType)
+    {
+        for (const auto &stream : mesh.streams)
+        {
+            if (stream.attributeType == static_cast<uint32_t>(attributeType))
+            {
+                return &stream;
+            }
+        }
+        return nullptr;
+    }
+
+    // eigenvalues and eigenvectors (columns of vectors) of symmetric matrix by
+    // cyclic Jacobi rotations, matrix is destroyed
+    template <int N>
+    void symmetricEigen(double (&matrix)[N][N], double (&values)[N], double (&vectors)[N][N])
+    {
+        for (int row = 0; row < N; ++row)
+        {
+            for (int column = 0; column < N; ++column)
+            {
+                vectors[row][column] = row == column ? 1.0 : 0.0;
+            }
+        }
+        for (int sweep = 0; sweep < 50; ++sweep)
+        {
+            double offDiagonal = 0.0;
+            double diagonal = 0.0;
+            for (int row = 0; row < N; ++row)
+            {
+                diagonal += matrix[row][row] * matrix[row][row];
+                for (int column = row + 1; column < N; ++column)
+                {
+                    offDiagonal += matrix[row][column] * matrix[row][column];
+                }
+            }
+            if (offDiagonal <= 1.0e-30 * diagonal)
+            {
+                break;
+            }
+            for (int p = 0; p < N; ++p)
+            {
+                for (int q = p + 1; q < N; ++q)
+                {
+                    if (matrix[p][q] == 0.0)
+                    {
+                        continue;
+                    }
+                    double theta = (matrix[q][q] - matrix[p][p]) / (2.0 * matrix[p][q]);
+                    double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                    double c = 1.0 / std::sqrt(t * t + 1.0);
+                    double s = t * c;
+                    for (int k = 0; k < N; ++k)
+                    {
+                        double kp = matrix[k][p];
+                        double kq = matrix[k][q];
+                        matrix[k][p] = c * kp - s * kq;
+                        matrix[k][q] = s * kp + c * kq;
+                    }
+                    for (int k = 0; k < N; ++k)
+                    {
+                        double pk = matrix[p][k];
+                        double qk = matrix[q][k];
+                        matrix[p][k] = c * pk - s * qk;
+                        matrix[q][k] = s * pk + c * qk;
+                    }
+                    for (int k = 0; k < N; ++k)
+                    {
+                        double kp = vectors[k][p];
+                        double kq = vectors[k][q];
+                        vectors[k][p] = c * kp - s * kq;
+                        vectors[k][q] = s * kp + c * kq;
+                    }
+                }
+            }
+        }
+        for (int index = 0; index < N; ++index)
+        {
+            values[index] = matrix[index][index];
+        }
+    }
+
+    // quaternions are x, y, z, w
+    void multiplyQuaternions(const double left[4], const double right[4], double result[4])
+    {
+        double product[4] = {
+            left[3] * right[0] + left[0] * right[3] + left[1] * right[2] - left[2] * right[1],
+            left[3] * right[1] - left[0] * right[2] + left[1] * right[3] + left[2] * right[0],
+            left[3] * right[2] + left[0] * right[1] - left[1] * right[0] + left[2] * right[3],
+            left[3] * right[3] - left[0] * right[0] - left[1] * right[1] - left[2] * right[2] };
+        memcpy(result, product, sizeof(product));
+    }
+
+    void quaternionToMatrix(const double quaternion[4], double matrix[3][3])
+    {
+        double x = quaternion[0];
+        double y = quaternion[1];
+        double z = quaternion[2];
+        double w = quaternion[3];
+        matrix[0][0] = 1.0 - 2.0 * (y * y + z * z);
+        matrix[0][1] = 2.0 * (x * y - z * w);
+        matrix[0][2] = 2.0 * (x * z + y * w);
+        matrix[1][0] = 2.0 * (x * y + z * w);
+        matrix[1][1] = 1.0 - 2.0 * (x * x + z * z);
+        matrix[1][2] = 2.0 * (y * z - x * w);
+        matrix[2][0] = 2.0 * (x * z - y * w);
+        matrix[2][1] = 2.0 * (y * z + x * w);
+        matrix[2][2] = 1.0 - 2.0 * (x * x + y * y);
+    }
+
+    inline void rotateVector(const double matrix[3][3], const double vector[3], double result[3])
+    {
+        for (int row = 0; row < 3; ++row)
+        {
+            result[row] = matrix[row][0] * vector[0] + matrix[row][1] * vector[1] + matrix[row][2] * vector[2];
+        }
+    }
+
+    // transform invariant description of a mesh
+    struct MeshSignature
+    {
+        bool transformable = false; // streams can be transformed, mesh isn't degenerate
+        uint64_t invariantHash = 0; // stream headers, data of streams not changed by transform
+        double centroid[3] = { 0.0, 0.0, 0.0 };
+        double radius = 0.0;        // root mean square distance of vertices from centroid
+        double maxCoordinate = 0.0; // largest absolute vertex coordinate
+        double spread[3] = { 0.0, 0.0, 0.0 }; // PCA eigenvalues / radius^2, descending
+    };
+
+    MeshSignature computeSignature(const StreamMesh &mesh, float tolerance)
+    {
+        MeshSignature signature;
+        if (!canTransformStreams(mesh))
+        {
+            return signature;
+        }
+        std::vector<uint64_t> streamHashes;
+        for (const auto &stream : mesh.streams)
+        {
+            streamHashes.push_back(hashStreamHeader(stream));
+            if (!isTransformedAttribute(stream.attributeType))
+            {
+                streamHashes.push_back(hashStreamData(stream, tolerance));
+            }
+        }
+        signature.invariantHash = hash64(streamHashes.data(), streamHashes.size() * sizeof(uint64_t));
+
+        const VectorStream &positions = *findStream(mesh, AttributeType::Position);
+        double position[3];
+        for (size_t vertexIndex = 0; vertexIndex < positions.elementCount; ++vertexIndex)
+        {
+            readVector3(positions, vertexIndex, position);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                signature.centroid[axis] += position[axis];
+                signature.maxCoordinate = std::max(signature.maxCoordinate, std::abs(position[axis]));
+            }
+        }
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            signature.centroid[axis] /= positions.elementCount;
+        }
+        double covariance[3][3] = {};
+        for (size_t vertexIndex = 0; vertexIndex < positions.elementCount; ++vertexIndex)
+        {
+            readVector3(positions, vertexIndex, position);
+            double offset[3] = { position[0] - signature.centroid[0], position[1] - signature.centroid[1],
+                                 position[2] - signature.centroid[2] };
+            for (int row = 0; row < 3; ++row)
+            {
+                for (int column = 0; column < 3; ++column)
+                {
+                    covariance[row][column] += offset[row] * offset[column];
+                }
+            }
+        }
+        double variance = (covariance[0][0] + covariance[1][1] + covariance[2][2]) / positions.elementCount;
+        signature.radius = std::sqrt(variance);
+        // all vertices at one point: any rotation fits
+        if (!(signature.radius > RelativePositionTolerance * signature.maxCoordinate) || !std::isfinite(variance))
+        {
+            return signature;
+        }
+        double eigenvectors[3][3];
+        symmetricEigen(covariance, signature.spread, eigenvectors);
+        double spreadSum = signature.spread[0] + signature.spread[1] + signature.spread[2];
+        std::sort(signature.spread, signature.spread + 3, std::greater<double>());
+        for (auto &spread : signature.spread)
+        {
+            spread /= spreadSum;
+        }
+        signature.transformable = true;
+        return signature;
+    }
+
+    // transform of kept mesh to copy which fits corresponding vertices best in
+    // least squares sense (Horn's closed-form quaternion solution), then checks
+    // every vertex and direction. False when copy isn't the transformed kept mesh
+    bool matchTransformedMesh(const StreamMesh &kept, const MeshSignature &keptSignature,
+                              const StreamMesh &copy, const MeshSignature &copySignature,
+                              float tolerance, InstanceTransform &transform)
+    {
+        // equal hashes are only candidates
+        if (kept.streams.size() != copy.streams.size())
+        {
+            return false;
+        }
+        for (size_t streamIndex = 0; streamIndex < kept.streams.size(); ++streamIndex)
+        {
+            const auto &keptStream = kept.streams[streamIndex];
+            const auto &copyStream = copy.streams[streamIndex];
+            if (!streamHeadersEqual(keptStream, copyStream) ||
+                (!isTransformedAttribute(keptStream.attributeType) && !streamDataEqual(keptStream, copyStream, tolerance)))
+            {
+                return false;
+            }
+        }
+        const VectorStream &keptPositions = *findStream(kept, AttributeType::Position);
+        const VectorStream &copyPositions = *findStream(copy, AttributeType::Position);
+        double correlation[3][3] = {};
+        double keptPosition[3];
+        double copyPosition[3];
+        for (size_t vertexIndex = 0; vertexIndex < keptPositions.elementCount; ++vertexIndex)
+        {
+            readVector3(keptPositions, vertexIndex, keptPosition);
+            readVector3(copyPositions, vertexIndex, copyPosition);
+            for (int row = 0; row < 3; ++row)
+            {
+                for (int column = 0; column < 3; ++column)
+                {
+                    correlation[row][column] += (keptPosition[row] - keptSignature.centroid[row]) *
+                                                (copyPosition[column] - copySignature.centroid[column]);
+                }
+            }
+        }
+        const auto &S = correlation;
+        double horn[4][4] = {
+            { S[0][0] + S[1][1] + S[2][2], S[1][2] - S[2][1], S[2][0] - S[0][2], S[0][1] - S[1][0] },
+            { S[1][2] - S[2][1], S[0][0] - S[1][1] - S[2][2], S[0][1] + S[1][0], S[2][0] + S[0][2] },
+            { S[2][0] - S[0][2], S[0][1] + S[1][0], -S[0][0] + S[1][1] - S[2][2], S[1][2] + S[2][1] },
+            { S[0][1] - S[1][0], S[2][0] + S[0][2], S[1][2] + S[2][1], -S[0][0] - S[1][1] + S[2][2] } };
+        double values[4];
+        double vectors[4][4];
+        symmetricEigen(horn, values, vectors);
+        int largest = static_cast<int>(std::max_element(values, values + 4) - values);
+        // eigenvector is w, x, y, z
+        double rotation[4] = { vectors[1][largest], vectors[2][largest], vectors[3][largest], vectors[0][largest] };
+        double length = std::sqrt(rotation[0] * rotation[0] + rotation[1] * rotation[1] +
+                                  rotation[2] * rotation[2] + rotation[3] * rotation[3]);
+        if (!(length > 0.0))
+        {
+            return false;
+        }
+        for (auto &component : rotation)
+        {
+            component /= length;
+        }
+        double rotationMatrix[3][3];
+        quaternionToMatrix(rotation, rotationMatrix);
+        double scale = copySignature.radius / keptSignature.radius;
+        double rotatedCentroid[3];
+        rotateVector(rotationMatrix, keptSignature.centroid, rotatedCentroid);
+        double translation[3];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            translation[axis] = copySignature.centroid[axis] - scale * rotatedCentroid[axis];
+        }
+
+        // exact check of every vertex and direction
+        double positionTolerance = std::max<double>(tolerance, RelativePositionTolerance * copySignature.maxCoordinate);
+        double directionTolerance = std::max<double>(tolerance, DirectionTolerance);
+        double rotated[3];
+        for (size_t streamIndex = 0; streamIndex < kept.streams.size(); ++streamIndex)
+        {
+            const auto &keptStream = kept.streams[streamIndex];
+            const auto &copyStream = copy.streams[streamIndex];
+            bool isPosition = keptStream.attributeType == static_cast<uint32_t>(AttributeType::Position);
+            if (!isPosition && !isDirectionAttribute(keptStream.attributeType))
+            {
+                continue;
+            }
+            double streamTolerance = isPosition ? positionTolerance : directionTolerance;
+            for (size_t elementIndex = 0; elementIndex < keptStream.elementCount; ++elementIndex)
+            {
+                readVector3(keptStream, elementIndex, keptPosition);
+                readVector3(copyStream, elementIndex, copyPosition);
+                rotateVector(rotationMatrix, keptPosition, rotated);
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    double expected = isPosition ? translation[axis] + scale * rotated[axis] : rotated[axis];
+                    if (!(std::abs(expected - copyPosition[axis]) <= streamTolerance))
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+        memcpy(transform.translation, translation, sizeof(translation));
+        memcpy(transform.rotation, rotation, sizeof(rotation));
+        transform.scale = scale;
+        return true;
+    }
+}
+
+uint64_t hashStreamMesh(const StreamMesh &mesh, float tolerance)
+{
+    // hash of every stream header and data, then hash of these hashes
+    std::vector<uint64_t> streamHashes;
+    for (const auto &stream : mesh.streams)
+    {
+        streamHashes.push_back(hashStreamHeader(stream));
+        streamHashes.push_back(hashStreamData(stream, tolerance));
+    }
+    return hash64(streamHashes.data(), streamHashes.size() * sizeof(uint64_t));
+}
+
+bool streamMeshesEqual(const StreamMesh &left, const StreamMesh &right, float tolerance)
+{
+    if (left.streams.size() != right.streams.size())
+    {
+        return false;
+    }
+    for (size_t streamIndex = 0; streamIndex < left.streams.size(); ++streamIndex)
+    {
+        if (!streamHeadersEqual(left.streams[streamIndex], right.streams[streamIndex]) ||
+            !streamDataEqual(left.streams[streamIndex], right.streams[streamIndex], tolerance))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<uint32_t> deduplicateMeshes(std::vector<StreamMesh> &meshes, float tolerance,
+                                        ThreadPool &threadPool, InstancingStats &stats)
+{
+    std::vector<uint64_t> meshHashes(meshes.size());
+    std::vector<ToleranceKey> meshKeys(meshes.size());
+    {
+        TaskGroup taskGroup(threadPool);
+        for (size_t meshIndex = 0; meshIndex < meshes.size(); ++meshIndex)
+        {
+            taskGroup.submit([&meshes, &meshHashes, &meshKeys, meshIndex, tolerance]()
+            {
+                meshHashes[meshIndex] = hashStreamMesh(meshes[meshIndex], tolerance);
+                if (tolerance > 0.0f)
+                {
+                    meshKeys[meshIndex] = getToleranceKey(meshes[meshIndex], tolerance);
+                }
+            });
+        }
+        taskGroup.wait();
+    }
+    // keys of copies differ by at most one cell
+    double cellSize = tolerance > 0.0f ? tolerance : 1.0;
+    for (const auto &key : meshKeys)
+    {
+        cellSize = std::max<double>(cellSize, tolerance + 2.0 * key.rounding);
+    }
+    int neighbourRange = tolerance > 0.0f ? 1 : 0;
+
+    // equal hashes in the same or neighbour key cells are only candidates,
+    // meshes are compared in full. Every mesh is compared with first copies
+    // only and the earliest equal one is taken, so the first copy of a group
+    // is always kept and the result doesn't depend on thread timing
+    std::vector<uint32_t> meshRemap(meshes.size());
+    std::unordered_map<uint64_t, std::vector<uint32_t>> firstCopies; // hash of hash and cell -> input indices
+    uint32_t uniqueMeshCount = 0;
+    stats = InstancingStats();
+    stats.meshCount = static_cast<uint32_t>(meshes.size());
+    for (uint32_t meshIndex = 0; meshIndex < meshes.size(); ++meshIndex)
+    {
+        const auto &key = meshKeys[meshIndex];
+        if (!key.finite)
+        {
+            meshRemap[meshIndex] = uniqueMeshCount++;
+            continue;
+        }
+        int64_t cell[ToleranceKeySize];
+        for (int component = 0; component < ToleranceKeySize; ++component)
+        {
+            cell[component] = getKeyCell(key.values[component], cellSize);
+        }
+        uint32_t firstCopy = meshIndex;
+        for (int x = -neighbourRange; x <= neighbourRange; ++x)
+        {
+            for (int y = -neighbourRange; y <= neighbourRange; ++y)
+            {
+                for (int z = -neighbourRange; z <= neighbourRange; ++z)
+                {
+                    const int64_t cellKey[] = { static_cast<int64_t>(meshHashes[meshIndex]), cell[0] + x, cell[1] + y, cell[2] + z };
+                    auto candidatesIt = firstCopies.find(hash64(cellKey, sizeof(cellKey)));
+                    if (candidatesIt == firstCopies.end())
+                    {
+                        continue;
+                    }
+                    for (uint32_t candidate : candidatesIt->second)
+                    {
+                        if (candidate < firstCopy && streamMeshesEqual(meshes[candidate], meshes[meshIndex], tolerance))
+                        {
+                            firstCopy = candidate;
+                        }
+                    }
+                }
+            }
+        }
+        if (firstCopy != meshIndex)
+        {
+            meshRemap[meshIndex] = meshRemap[firstCopy];
+            for (const auto &stream : meshes[meshIndex].streams)
+            {
+                stats.duplicateBytes += stream.data.size();
+            }
+            continue;
+        }
+        const int64_t cellKey[] = { static_cast<int64_t>(meshHashes[meshIndex]), cell[0], cell[1], cell[2] };
+        firstCopies[hash64(cellKey, sizeof(cellKey))].push_back(meshIndex);
+        meshRemap[meshIndex] = uniqueMeshCount++;
+    }
+    compactMeshes(meshes, meshRemap, uniqueMeshCount);
+    stats.uniqueMeshCount = uniqueMeshCount;
+    return meshRemap;
+}
+
+bool InstanceTransform::isIdentity() const
+{
+    return translation[0] == 0.0 && translation[1] == 0.0 && translation[2] == 0.0 &&
+           rotation[0] == 0.0 && rotation[1] == 0.0 && rotation[2] == 0.0 && rotation[3] == 1.0 && scale == 1.0;
+}
+
+std::vector<uint32_t> deduplicateTransformedMeshes(std::vector<StreamMesh> &meshes, float tolerance,
+                                                   const std::vector<bool> &transformableMeshes,
+                                                   ThreadPool &threadPool, InstancingStats &stats,
+                                                   std::vector<InstanceTransform> &transforms)
+{
+    std::vector<MeshSignature> signatures(meshes.size());
+    {
+        TaskGroup taskGroup(threadPool);
+        for (size_t meshIndex = 0; meshIndex < meshes.size(); ++meshIndex)
+        {
+            taskGroup.submit([&meshes, &signatures, meshIndex, tolerance]()
+            {
+                signatures[meshIndex] = computeSignature(meshes[meshIndex], tolerance);
+            });
+        }
+        taskGroup.wait();
+    }
+
+    // signature index: invariant hash -> largest spread -> kept mesh. A mesh
+    // is compared only with kept meshes of its hash within spread tolerance,
+    // in input order, so the result doesn't depend on thread timing
+    std::unordered_map<uint64_t, std::multimap<double, uint32_t>> keptMeshes;
+    std::vector<uint32_t> meshRemap(meshes.size());
+    transforms.assign(meshes.size(), InstanceTransform());
+    uint32_t uniqueMeshCount = 0;
+    for (uint32_t meshIndex = 0; meshIndex < meshes.size(); ++meshIndex)
+    {
+        const auto &signature = signatures[meshIndex];
+        if (!signature.transformable)
+        {
+            meshRemap[meshIndex] = uniqueMeshCount++;
+            continue;
+        }
+        auto &candidates = keptMeshes[signature.invariantHash];
+        bool isCopy = false;
+        if (meshIndex < transformableMeshes.size() && transformableMeshes[meshIndex])
+        {
+            // differences within tolerance change spread too
+            double spreadTolerance = SpreadTolerance + 4.0 * tolerance / signature.radius;
+            auto candidateIt = candidates.lower_bound(signature.spread[0] - spreadTolerance);
+            auto candidateEnd = candidates.upper_bound(signature.spread[0] + spreadTolerance);
+            for (uint32_t verifiedCount = 0; candidateIt != candidateEnd && verifiedCount < MaxVerifiedCandidates; ++candidateIt)
+            {
+                uint32_t candidate = candidateIt->second;
+                const auto &candidateSignature = signatures[candidate];
+                if (std::abs(candidateSignature.spread[1] - signature.spread[1]) > spreadTolerance ||
+                    std::abs(candidateSignature.spread[2] - signature.spread[2]) > spreadTolerance)
+                {
+                    continue;
+                }
+                ++verifiedCount;
+                ++stats.verifiedCandidateCount;
+                if (matchTransformedMesh(meshes[candidate], candidateSignature, meshes[meshIndex], signature,
+                                         tolerance, transforms[meshIndex]))
+                {
+                    meshRemap[meshIndex] = meshRemap[candidate];
+                    isCopy = true;
+                    break;
+                }
+            }
+        }
+        if (isCopy)
+        {
+            ++stats.transformedCopyCount;
+            for (const auto &stream : meshes[meshIndex].streams)
+            {
+                stats.duplicateBytes += stream.data.size();
+            }
+            continue;
+        }
+        candidates.insert(std::make_pair(signature.spread[0], meshIndex));
+        meshRemap[meshIndex] = uniqueMeshCount++;
+    }
+    compactMeshes(meshes, meshRemap, uniqueMeshCount);
+    stats.uniqueMeshCount = uniqueMeshCount;
+    return meshRemap;
+}
+
+bool isUniformScale(const double scale[3])
+{
+    double largest = std::max(std::abs(scale[0]), std::max(std::abs(scale[1]), std::abs(scale[2])));
+    double tolerance = RelativePositionTolerance * largest;
+    return std::abs(scale[0] - scale[1]) <= tolerance && std::abs(scale[0] - scale[2]) <= tolerance;
+}
+
+void appendInstanceTransform(const InstanceTransform &transform, double translation[3], double rotation[4],
+                             double scale[3])
+{
+    // T * R * S * T(t) * R(r) * s = T(T + R * S * t) * (R * r) * (S * s) for uniform S
+    double scaled[3] = { scale[0] * transform.translation[0], scale[1] * transform.translation[1],
+                         scale[2] * transform.translation[2] };
+    double rotationMatrix[3][3];
+    quaternionToMatrix(rotation, rotationMatrix);
+    double rotated[3];
+    rotateVector(rotationMatrix, scaled, rotated);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        translation[axis] += rotated[axis];
+        scale[axis] *= transform.scale;
+    }
+    multiplyQuaternions(rotation, transform.rotation, rotation);
+}
+
+void prependInverseInstanceTransform(const InstanceTransform &transform, double translation[3], double rotation[4],
+                                     double scale[3])
+{
+    // (1 / s) * R(r)^-1 * T(-t) * T * R * S = T(R(r)^-1 * (T - t) / s) * (r^-1 * R) * (S / s)
+    double inverseRotation[4] = { -transform.rotation[0], -transform.rotation[1], -transform.rotation[2],
+                                  transform.rotation[3] };
+    double rotationMatrix[3][3];
+    quaternionToMatrix(inverseRotation, rotationMatrix);
+    double offset[3] = { translation[0] - transform.translation[0], translation[1] - transform.translation[1],
+                         translation[2] - transform.translation[2] };
+    rotateVector(rotationMatrix, offset, translation);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        translation[axis] /= transform.scale;
+        scale[axis] /= transform.scale;
+    }
+    multiplyQuaternions(inverseRotation, rotation, rotation);
+}
@@ -0,0 +1,123 @@
+//-----------------------------------------------------------------------------
+// MeshInstancing.h
+// Created at 2026.10.17 23:30
+// License: see LICENSE file
+//
+// detection of identical converted meshes (--dedupe-meshes): scene nodes
+// of all copies share one mesh file. With --dedupe-transformed also copies
+// placed by baked rotation, translation and uniform scale, the transform
+// moves to the nodes
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+
+#include "StreamMeshData.h"
+#include "ObjectNode.h"
+
+#include <unordered_map>
+
+class ThreadPool;
+
+struct InstancingStats
+{
+    uint32_t meshCount = 0;               // converted meshes
+    uint32_t uniqueMeshCount = 0;         // meshes left after deduplication
+    uint64_t duplicateBytes = 0;          // stream data of removed meshes
+    double duplicateConvertSeconds = 0.0; // conversion time of removed meshes
+    uint32_t transformedCopyCount = 0;    // removed meshes placed by a transform
+    uint32_t verifiedCandidateCount = 0;  // mesh pairs with close signatures compared per vertex
+};
+
+// placement of a removed copy relative to the kept mesh:
+// copyPosition = translation + scale * rotate(rotation, keptPosition)
+struct InstanceTransform
+{
+    double translation[3] = { 0.0, 0.0, 0.0 };
+    double rotation[4] = { 0.0, 0.0, 0.0, 1.0 }; // quaternion x, y, z, w like ObjectNode::rotation
+    double scale = 1.0;
+
+    bool isIdentity() const;
+};
+
+// hash of stream types and data. With tolerance > 0, 32/64-bit float values
+// are left out, so meshes within tolerance always hash equal
+uint64_t hashStreamMesh(const StreamMesh &mesh, float tolerance);
+
+// same stream types and element counts, float (32/64-bit) values differ by at
+// most tolerance, all other data (indices, encoded and interleaved streams)
+// is bitwise equal
+bool streamMeshesEqual(const StreamMesh &left, const StreamMesh &right, float tolerance);
+
+// removes meshes equal to an earlier mesh, keeps the first copy. Returns new
+// index of every input mesh, so copies get the index of their first copy
+std::vector<uint32_t> deduplicateMeshes(std::vector<StreamMesh> &meshes, float tolerance,
+                                        ThreadPool &threadPool, InstancingStats &stats);
+
+// removes meshes which are an earlier mesh rotated, translated and uniformly
+// scaled: the same topology and vertex order, positions, normals, tangents
+// and binormals within tolerance of the transformed earlier mesh (at least
+// float32 precision of the coordinates), other streams equal like in
+// deduplicateMeshes. Only separate float positions and directions can be
+// transformed. A signature (centroid, PCA spread normalized by scale) indexes
+// candidates, so meshes aren't compared pairwise. Only meshes with
+// transformableMeshes set can become copies (transformableMeshes empty - none).
+// Returns new index of every input mesh, transforms gets the placement of
+// every input mesh relative to its new mesh (identity for kept meshes)
+std::vector<uint32_t> deduplicateTransformedMeshes(std::vector<StreamMesh> &meshes, float tolerance,
+                                                   const std::vector<bool> &transformableMeshes,
+                                                   ThreadPool &threadPool, InstancingStats &stats,
+                                                   std::vector<InstanceTransform> &transforms);
+
+// a rotation of the mesh doesn't commute with non-uniform node scale, such
+// nodes can't take an instance transform
+bool isUniformScale(const double scale[3]);
+
+// node transform translation * rotation * scale becomes node * transform
+void appendInstanceTransform(const InstanceTransform &transform, double translation[3], double rotation[4],
+                             double scale[3]);
+
+// node transform translation * rotation * scale becomes inverse(transform) * node
+void prependInverseInstanceTransform(const InstanceTransform &transform, double translation[3], double rotation[4],
+                                     double scale[3]);
+
+// nodeTransforms: uid of a node of a removed copy -> transform of the copy.
+// Transform of the copy is added to its nodes and removed from their
+// children, so world transforms of all nodes and vertices don't change
+template <typename FloatType>
+void applyInstanceTransforms(std::vector<ObjectNode<FloatType>> &nodes,
+                             const std::unordered_map<uint64_t, InstanceTransform> &nodeTransforms)
+{
+    if (nodeTransforms.empty())
+    {
+        return;
+    }
+    for (auto &node : nodes)
+    {
+        auto parentIt = nodeTransforms.find(node.parentUid);
+        auto nodeIt = nodeTransforms.find(node.uid);
+        if (parentIt == nodeTransforms.end() && nodeIt == nodeTransforms.end())
+        {
+            continue;
+        }
+        double translation[3] = { node.translation[0], node.translation[1], node.translation[2] };
+        double rotation[4] = { node.rotation[0], node.rotation[1], node.rotation[2], node.rotation[3] };
+        double scale[3] = { node.scale[0], node.scale[1], node.scale[2] };
+        if (parentIt != nodeTransforms.end())
+        {
+            prependInverseInstanceTransform(parentIt->second, translation, rotation, scale);
+        }
+        if (nodeIt != nodeTransforms.end())
+        {
+            appendInstanceTransform(nodeIt->second, translation, rotation, scale);
+        }
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            node.translation[axis] = static_cast<FloatType>(translation[axis]);
+            node.scale[axis] = static_cast<FloatType>(scale[axis]);
+        }
+        for (int component = 0; component < 4; ++component)
+        {
+            node.rotation[component] = static_cast<FloatType>(rotation[component]);
+        }
+    }
+}
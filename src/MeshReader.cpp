@@ -0,0 +1,442 @@
+//-----------------------------------------------------------------------------
+// MeshReader.cpp
+// Created at 2026.10.17 13:05
+// License: see LICENSE file
+//
+// reads .msh files without copying: memory-maps the file, validates
+// headers and returns pointers to stream data inside the mapping
+//-----------------------------------------------------------------------------
+#include "MeshReader.h"
+#include "StreamCompression.h"
+
+#include <cstddef>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // size of stream header in version 1 files
+    const uint32_t StreamHeaderSizeV1 = 7 * sizeof(uint32_t);
+
+    template <typename T>
+    inline T readValue(const uint8_t *data, uint64_t offset)
+    {
+        T value;
+        memcpy(&value, data + offset, sizeof(T));
+        return value;
+    }
+}
+
+MappedFile::MappedFile()
+    : _data(nullptr)
+    , _size(0)
+#ifdef _WIN32
+    , _fileHandle(INVALID_HANDLE_VALUE)
+    , _mappingHandle(nullptr)
+#else
+    , _fileDescriptor(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const std::string &fileName)
+{
+    close();
+    _fileHandle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (_fileHandle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(_fileHandle, &fileSize))
+    {
+        close();
+        return false;
+    }
+    _size = static_cast<uint64_t>(fileSize.QuadPart);
+    if (_size == 0)
+    {
+        return true; // empty files can't be mapped
+    }
+    _mappingHandle = CreateFileMappingA(_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (_mappingHandle == nullptr)
+    {
+        close();
+        return false;
+    }
+    _data = static_cast<const uint8_t*>(MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (_data == nullptr)
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (_data != nullptr)
+    {
+        UnmapViewOfFile(_data);
+    }
+    if (_mappingHandle != nullptr)
+    {
+        CloseHandle(_mappingHandle);
+    }
+    if (_fileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(_fileHandle);
+    }
+    _data = nullptr;
+    _size = 0;
+    _mappingHandle = nullptr;
+    _fileHandle = INVALID_HANDLE_VALUE;
+}
+#else
+bool MappedFile::open(const std::string &fileName)
+{
+    close();
+    _fileDescriptor = ::open(fileName.c_str(), O_RDONLY);
+    if (_fileDescriptor < 0)
+    {
+        return false;
+    }
+    struct stat fileStat;
+    if (fstat(_fileDescriptor, &fileStat) != 0)
+    {
+        close();
+        return false;
+    }
+    _size = static_cast<uint64_t>(fileStat.st_size);
+    if (_size == 0)
+    {
+        return true; // empty files can't be mapped
+    }
+    void *mapping = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fileDescriptor, 0);
+    if (mapping == MAP_FAILED)
+    {
+        close();
+        return false;
+    }
+    _data = static_cast<const uint8_t*>(mapping);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (_data != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(_data), _size);
+    }
+    if (_fileDescriptor >= 0)
+    {
+        ::close(_fileDescriptor);
+    }
+    _data = nullptr;
+    _size = 0;
+    _fileDescriptor = -1;
+}
+#endif
+
+bool MeshFileReader::open(const std::string &fileName)
+{
+    close();
+    if (!_file.open(fileName))
+    {
+        return fail("can't open file " + fileName);
+    }
+    return openMemory(_file.data(), _file.size());
+}
+
+bool MeshFileReader::openMemory(const uint8_t *data, uint64_t size)
+{
+    _streams.clear();
+    _error.clear();
+    _version = 0;
+    _decodedStreamCount = 0;
+    if (data == nullptr || size < sizeof(StreamMeshHeader))
+    {
+        return fail("file is too small for mesh header");
+    }
+    if (readValue<uint32_t>(data, offsetof(StreamMeshHeader, magicMESH)) != StreamConstants::MagicMESH)
+    {
+        return fail("wrong MESH magic");
+    }
+    uint32_t version = readValue<uint32_t>(data, offsetof(StreamMeshHeader, version));
+    bool success = false;
+    if (version == StreamConstants::MeshFileVersion1)
+    {
+        success = parseV1(data, size);
+    }
+    else if (version == StreamConstants::MeshFileVersion2)
+    {
+        success = parseV2(data, size);
+    }
+    else if (version == StreamConstants::MeshFileVersion3)
+    {
+        success = parseV3(data, size);
+    }
+    else
+    {
+        return fail("unsupported version " + std::to_string(version));
+    }
+    if (!success)
+    {
+        _streams.clear();
+        return false;
+    }
+    _version = version;
+    return true;
+}
+
+void MeshFileReader::close()
+{
+    _streams.clear();
+    _error.clear();
+    _version = 0;
+    _decodedStreamCount = 0;
+    _file.close();
+}
+
+const MeshStreamView* MeshFileReader::findStream(AttributeType attributeType) const
+{
+    for (const auto &stream : _streams)
+    {
+        if (stream.attributeType == static_cast<uint32_t>(attributeType))
+        {
+            return &stream;
+        }
+    }
+    return nullptr;
+}
+
+bool MeshFileReader::fail(const std::string &error)
+{
+    _error = error;
+    return false;
+}
+
+bool MeshFileReader::addStream(const MeshStreamView &stream, uint64_t offset, uint64_t fileSize)
+{
+    std::string streamName = "stream " + std::to_string(_streams.size());
+    if (offset > fileSize || stream.storedSize > fileSize - offset)
+    {
+        return fail(streamName + ": data is out of file bounds");
+    }
+    if (stream.elementSize == 0 || stream.elementSize > 8 || stream.elementVectorSize == 0)
+    {
+        return fail(streamName + ": wrong element size");
+    }
+    uint64_t expectedSize = uint64_t(stream.elementCount) * stream.elementSize * stream.elementVectorSize;
+    if (expectedSize != stream.dataSize)
+    {
+        return fail(streamName + ": data size doesn't match element count and size");
+    }
+    _streams.push_back(stream);
+    return true;
+}
+
+bool MeshFileReader::parseV1(const uint8_t *data, uint64_t size)
+{
+    uint32_t headerSize = readValue<uint32_t>(data, offsetof(StreamMeshHeader, headerSize));
+    uint32_t streamCount = readValue<uint32_t>(data, offsetof(StreamMeshHeader, streamCount));
+    if (headerSize < sizeof(StreamMeshHeader) || headerSize > size)
+    {
+        return fail("wrong header size");
+    }
+    if (streamCount > (size - headerSize) / StreamHeaderSizeV1)
+    {
+        return fail("stream count doesn't fit in file");
+    }
+    _streams.reserve(streamCount);
+    uint64_t offset = headerSize;
+    for (uint32_t streamIndex = 0; streamIndex < streamCount; ++streamIndex)
+    {
+        if (size - offset < StreamHeaderSizeV1)
+        {
+            return fail("stream " + std::to_string(streamIndex) + ": header is out of file bounds");
+        }
+        // field order in version 1 files differs from VectorStream
+        if (readValue<uint32_t>(data, offset) != StreamConstants::MagicSTRM)
+        {
+            return fail("stream " + std::to_string(streamIndex) + ": wrong STRM magic");
+        }
+        uint32_t streamSize = readValue<uint32_t>(data, offset + 4);
+        MeshStreamView stream;
+        stream.elementCount = readValue<uint32_t>(data, offset + 8);
+        stream.elementType = readValue<uint32_t>(data, offset + 12);
+        stream.elementSize = readValue<uint32_t>(data, offset + 16);
+        stream.elementVectorSize = readValue<uint32_t>(data, offset + 20);
+        stream.attributeType = readValue<uint32_t>(data, offset + 24);
+        if (streamSize < StreamHeaderSizeV1)
+        {
+            return fail("stream " + std::to_string(streamIndex) + ": wrong stream size");
+        }
+        offset += StreamHeaderSizeV1;
+        stream.data = data + offset;
+        stream.dataSize = streamSize - StreamHeaderSizeV1;
+        stream.storedSize = stream.dataSize;
+        if (!addStream(stream, offset, size))
+        {
+            return false;
+        }
+        offset += stream.dataSize;
+    }
+    return true;
+}
+
+bool MeshFileReader::parseFileHeader(const uint8_t *data, uint64_t size, uint32_t entrySize, StreamMeshFileHeader &header)
+{
+    if (size < sizeof(StreamMeshFileHeader))
+    {
+        return fail("file is too small for StreamMeshFileHeader");
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.headerSize < sizeof(StreamMeshFileHeader) || header.headerSize > size)
+    {
+        return fail("wrong header size");
+    }
+    if (header.fileSize != size)
+    {
+        return fail("file size " + std::to_string(size) + " doesn't match header " + std::to_string(header.fileSize));
+    }
+    if (header.streamAlignment == 0 || (header.streamAlignment & (header.streamAlignment - 1)) != 0)
+    {
+        return fail("stream alignment is not a power of two");
+    }
+    if (header.directoryOffset < header.headerSize || header.directoryOffset > size ||
+        header.streamCount > (size - header.directoryOffset) / entrySize)
+    {
+        return fail("stream directory is out of file bounds");
+    }
+    return true;
+}
+
+bool MeshFileReader::parseV2(const uint8_t *data, uint64_t size)
+{
+    StreamMeshFileHeader header;
+    if (!parseFileHeader(data, size, sizeof(StreamDirectoryEntry), header))
+    {
+        return false;
+    }
+    _streams.reserve(header.streamCount);
+    for (uint32_t streamIndex = 0; streamIndex < header.streamCount; ++streamIndex)
+    {
+        StreamDirectoryEntry entry;
+        memcpy(&entry, data + header.directoryOffset + streamIndex * sizeof(StreamDirectoryEntry), sizeof(entry));
+        if (entry.magicSTRM != StreamConstants::MagicSTRM)
+        {
+            return fail("stream " + std::to_string(streamIndex) + ": wrong STRM magic");
+        }
+        if (entry.dataOffset % header.streamAlignment != 0)
+        {
+            return fail("stream " + std::to_string(streamIndex) + ": data is not aligned");
+        }
+        MeshStreamView stream;
+        stream.attributeType = entry.attributeType;
+        stream.elementType = entry.elementType;
+        stream.elementSize = entry.elementSize;
+        stream.elementVectorSize = entry.elementVectorSize;
+        stream.elementCount = entry.elementCount;
+        stream.dataSize = entry.dataSize;
+        stream.storedSize = entry.dataSize;
+        stream.data = entry.dataOffset <= size ? data + entry.dataOffset : nullptr;
+        if (!addStream(stream, entry.dataOffset, size))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MeshFileReader::parseV3(const uint8_t *data, uint64_t size)
+{
+    StreamMeshFileHeader header;
+    if (!parseFileHeader(data, size, sizeof(StreamDirectoryEntryV3), header))
+    {
+        return false;
+    }
+    _streams.reserve(header.streamCount);
+    for (uint32_t streamIndex = 0; streamIndex < header.streamCount; ++streamIndex)
+    {
+        StreamDirectoryEntryV3 entry;
+        memcpy(&entry, data + header.directoryOffset + streamIndex * sizeof(StreamDirectoryEntryV3), sizeof(entry));
+        std::string streamName = "stream " + std::to_string(streamIndex);
+        if (entry.magicSTRM != StreamConstants::MagicSTRM)
+        {
+            return fail(streamName + ": wrong STRM magic");
+        }
+        if (entry.dataOffset % header.streamAlignment != 0)
+        {
+            return fail(streamName + ": data is not aligned");
+        }
+        auto codec = static_cast<StreamCodec>(entry.codec);
+        auto filter = static_cast<StreamFilter>(entry.filter);
+        if (codec != StreamCodec::None && codec != StreamCodec::LZ4)
+        {
+            return fail(streamName + ": unknown codec " + std::to_string(entry.codec));
+        }
+        if (filter != StreamFilter::None && (codec == StreamCodec::None ||
+            (filter != StreamFilter::Shuffle && filter != StreamFilter::Delta)))
+        {
+            return fail(streamName + ": wrong filter " + std::to_string(entry.filter));
+        }
+        bool compressed = codec != StreamCodec::None;
+        // LZ4 output is at most 255 times larger than input, this also limits allocation for broken files
+        if (compressed ? entry.uncompressedSize / 255 > entry.dataSize : entry.uncompressedSize != entry.dataSize)
+        {
+            return fail(streamName + ": uncompressed size doesn't match data size");
+        }
+        MeshStreamView stream;
+        stream.attributeType = entry.attributeType;
+        stream.elementType = entry.elementType;
+        stream.elementSize = entry.elementSize;
+        stream.elementVectorSize = entry.elementVectorSize;
+        stream.elementCount = entry.elementCount;
+        stream.dataSize = entry.uncompressedSize;
+        stream.codec = entry.codec;
+        stream.filter = entry.filter;
+        stream.storedSize = entry.dataSize;
+        const uint8_t *storedData = entry.dataOffset <= size ? data + entry.dataOffset : nullptr;
+        stream.data = compressed ? nullptr : storedData;
+        if (!addStream(stream, entry.dataOffset, size))
+        {
+            return false;
+        }
+        if (!compressed)
+        {
+            continue;
+        }
+        // moving inner buffers when _decodedStreams grows keeps data of previous streams in place
+        if (_decodedStreamCount == _decodedStreams.size())
+        {
+            _decodedStreams.emplace_back();
+        }
+        auto &decodedData = _decodedStreams[_decodedStreamCount++];
+        decodedData.resize(entry.uncompressedSize);
+        if (!decompressStream(codec, filter, storedData, entry.dataSize, entry.elementSize, entry.elementVectorSize,
+                              decodedData.data(), entry.uncompressedSize, _filterScratch))
+        {
+            return fail(streamName + ": corrupted compressed data");
+        }
+        _streams.back().data = decodedData.data();
+    }
+    return true;
+}
@@ -0,0 +1,99 @@
+//-----------------------------------------------------------------------------
+// MeshReader.h
+// Created at 2026.10.17 13:05
+// License: see LICENSE file
+//
+// reads .msh files without copying: memory-maps the file, validates
+// headers and returns pointers to stream data inside the mapping
+//-----------------------------------------------------------------------------
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "StreamMeshData.h"
+
+// read-only memory mapping of a whole file
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string &fileName);
+    void close();
+
+    inline const uint8_t* data() const { return _data; }
+    inline uint64_t size() const { return _size; }
+
+private:
+    const uint8_t *_data;
+    uint64_t _size;
+#ifdef _WIN32
+    void *_fileHandle;
+    void *_mappingHandle;
+#else
+    int _fileDescriptor;
+#endif
+};
+
+// stream description and pointer to its data in the mapped file,
+// or to decompressed data owned by the reader
+struct MeshStreamView
+{
+    uint32_t attributeType = 0; //see enum AttributeType
+    uint32_t elementType = 0; //see enum StreamElementType
+    uint32_t elementSize = 0;
+    uint32_t elementVectorSize = 0;
+    uint32_t elementCount = 0;
+    const uint8_t *data = nullptr;
+    uint64_t dataSize = 0;
+    uint32_t codec = 0; //see enum StreamCodec, version 3 only
+    uint32_t filter = 0; //see enum StreamFilter, version 3 only
+    uint64_t storedSize = 0; // size in the file, less than dataSize for compressed streams
+
+    template <typename T>
+    inline const T* dataAs() const { return reinterpret_cast<const T*>(data); }
+};
+
+// reads version 1, 2 and 3 .msh files. Compressed version 3 streams are
+// decompressed into buffers of the reader, which are reused by next opens.
+// Stream views are valid while the reader is open
+class MeshFileReader
+{
+public:
+    MeshFileReader() : _version(0), _decodedStreamCount(0) {}
+
+    // maps the file and validates it, on failure error() describes the problem
+    bool open(const std::string &fileName);
+    // validates mesh file contents already in memory, data isn't copied
+    bool openMemory(const uint8_t *data, uint64_t size);
+    void close();
+
+    inline uint32_t version() const { return _version; }
+    inline const std::vector<MeshStreamView>& streams() const { return _streams; }
+    inline const std::string& error() const { return _error; }
+
+    // first stream with the attribute type or nullptr
+    const MeshStreamView* findStream(AttributeType attributeType) const;
+
+private:
+    bool parseV1(const uint8_t *data, uint64_t size);
+    bool parseV2(const uint8_t *data, uint64_t size);
+    bool parseV3(const uint8_t *data, uint64_t size);
+    // validates version 2 and 3 header for directory of entrySize bytes per stream
+    bool parseFileHeader(const uint8_t *data, uint64_t size, uint32_t entrySize, StreamMeshFileHeader &header);
+    bool addStream(const MeshStreamView &stream, uint64_t offset, uint64_t fileSize);
+    bool fail(const std::string &error);
+
+    MappedFile _file;
+    uint32_t _version;
+    std::vector<MeshStreamView> _streams;
+    std::string _error;
+    std::vector<std::vector<uint8_t>> _decodedStreams;
+    size_t _decodedStreamCount;
+    std::vector<uint8_t> _filterScratch;
+};
@@ -0,0 +1,163 @@
+//-----------------------------------------------------------------------------
+// Meshlet.cpp
+// Created at 2026.10.17 15:50
+// License: see LICENSE file
+//
+// splits index buffer into meshlets, computes meshlet bounds
+//-----------------------------------------------------------------------------
+#include "Meshlet.h"
+
+#include <cmath>
+
+namespace
+{
+    const uint32_t NotInMeshlet = static_cast<uint32_t>(-1);
+
+    // normal cones wider than this (min dot of normal and axis) can't be used for culling
+    const float MinConeDot = 0.1f;
+
+    inline void normalize(float vector[3])
+    {
+        float length = std::sqrt(vector[0] * vector[0] + vector[1] * vector[1] + vector[2] * vector[2]);
+        if (length > 0.0f)
+        {
+            vector[0] /= length;
+            vector[1] /= length;
+            vector[2] /= length;
+        }
+    }
+}
+
+void buildMeshlets(const std::vector<uint32_t> &indices, uint32_t vertexCount,
+                   uint32_t maxVertices, uint32_t maxTriangles, MeshletData &meshletData)
+{
+    maxVertices = std::max(3u, std::min(maxVertices, MaxMeshletVertices));
+    maxTriangles = std::max(1u, std::min(maxTriangles, MaxMeshletTriangles));
+    meshletData = MeshletData();
+    meshletData.triangles.reserve(indices.size());
+    meshletData.vertices.reserve(vertexCount + vertexCount / 4);
+
+    // index of mesh vertex in current meshlet
+    std::vector<uint32_t> localIndices(vertexCount, NotInMeshlet);
+    MeshletDescriptor meshlet;
+    auto closeMeshlet = [&meshletData, &meshlet, &localIndices]()
+    {
+        for (uint32_t vertex = 0; vertex < meshlet.vertexCount; ++vertex)
+        {
+            localIndices[meshletData.vertices[meshlet.vertexOffset + vertex]] = NotInMeshlet;
+        }
+        meshletData.meshlets.push_back(meshlet);
+        meshlet.vertexOffset += meshlet.vertexCount;
+        meshlet.triangleOffset += meshlet.triangleCount;
+        meshlet.vertexCount = 0;
+        meshlet.triangleCount = 0;
+    };
+
+    for (size_t corner = 0; corner + 2 < indices.size(); corner += 3)
+    {
+        const uint32_t *triangle = &indices[corner];
+        uint32_t newVertexCount = (localIndices[triangle[0]] == NotInMeshlet ? 1 : 0)
+                                + (localIndices[triangle[1]] == NotInMeshlet && triangle[1] != triangle[0] ? 1 : 0)
+                                + (localIndices[triangle[2]] == NotInMeshlet && triangle[2] != triangle[0] && triangle[2] != triangle[1] ? 1 : 0);
+        if (meshlet.vertexCount + newVertexCount > maxVertices || meshlet.triangleCount + 1 > maxTriangles)
+        {
+            closeMeshlet();
+        }
+        for (int triangleCorner = 0; triangleCorner < 3; ++triangleCorner)
+        {
+            uint32_t &localIndex = localIndices[triangle[triangleCorner]];
+            if (localIndex == NotInMeshlet)
+            {
+                localIndex = meshlet.vertexCount++;
+                meshletData.vertices.push_back(triangle[triangleCorner]);
+            }
+            meshletData.triangles.push_back(static_cast<uint8_t>(localIndex));
+        }
+        ++meshlet.triangleCount;
+    }
+    if (meshlet.triangleCount > 0)
+    {
+        closeMeshlet();
+    }
+}
+
+void computeMeshletBounds(MeshletData &meshletData, const std::vector<float> &positions)
+{
+    meshletData.bounds.resize(meshletData.meshlets.size());
+    std::vector<float> triangleNormals;
+    for (size_t meshletIndex = 0; meshletIndex < meshletData.meshlets.size(); ++meshletIndex)
+    {
+        const auto &meshlet = meshletData.meshlets[meshletIndex];
+        auto &bounds = meshletData.bounds[meshletIndex];
+        bounds = MeshletBounds();
+        auto getPosition = [&meshletData, &meshlet, &positions](uint32_t localIndex)
+        {
+            return &positions[meshletData.vertices[meshlet.vertexOffset + localIndex] * 3];
+        };
+
+        // sphere around bounding box center
+        float minPosition[3] = { INFINITY, INFINITY, INFINITY };
+        float maxPosition[3] = { -INFINITY, -INFINITY, -INFINITY };
+        for (uint32_t vertex = 0; vertex < meshlet.vertexCount; ++vertex)
+        {
+            const float *position = getPosition(vertex);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                minPosition[axis] = std::min(minPosition[axis], position[axis]);
+                maxPosition[axis] = std::max(maxPosition[axis], position[axis]);
+            }
+        }
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            bounds.center[axis] = (minPosition[axis] + maxPosition[axis]) * 0.5f;
+        }
+        float radiusSquared = 0.0f;
+        for (uint32_t vertex = 0; vertex < meshlet.vertexCount; ++vertex)
+        {
+            const float *position = getPosition(vertex);
+            float dx = position[0] - bounds.center[0];
+            float dy = position[1] - bounds.center[1];
+            float dz = position[2] - bounds.center[2];
+            radiusSquared = std::max(radiusSquared, dx * dx + dy * dy + dz * dz);
+        }
+        bounds.radius = std::sqrt(radiusSquared);
+
+        // normal cone: axis is average triangle normal, cutoff is sine of the widest angle to axis
+        triangleNormals.clear();
+        float axis[3] = { 0.0f, 0.0f, 0.0f };
+        for (uint32_t triangle = 0; triangle < meshlet.triangleCount; ++triangle)
+        {
+            const uint8_t *corners = &meshletData.triangles[(meshlet.triangleOffset + triangle) * 3];
+            const float *p0 = getPosition(corners[0]);
+            const float *p1 = getPosition(corners[1]);
+            const float *p2 = getPosition(corners[2]);
+            float edge1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            float edge2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            float normal[3] = {
+                edge1[1] * edge2[2] - edge1[2] * edge2[1],
+                edge1[2] * edge2[0] - edge1[0] * edge2[2],
+                edge1[0] * edge2[1] - edge1[1] * edge2[0]
+            };
+            if (normal[0] == 0.0f && normal[1] == 0.0f && normal[2] == 0.0f)
+            {
+                continue; // degenerate triangle doesn't affect culling
+            }
+            normalize(normal);
+            triangleNormals.insert(triangleNormals.end(), normal, normal + 3);
+            axis[0] += normal[0];
+            axis[1] += normal[1];
+            axis[2] += normal[2];
+        }
+        normalize(axis);
+        float minDot = 1.0f;
+        for (size_t normal = 0; normal < triangleNormals.size(); normal += 3)
+        {
+            float dot = triangleNormals[normal] * axis[0] + triangleNormals[normal + 1] * axis[1] + triangleNormals[normal + 2] * axis[2];
+            minDot = std::min(minDot, dot);
+        }
+        bounds.coneAxis[0] = axis[0];
+        bounds.coneAxis[1] = axis[1];
+        bounds.coneAxis[2] = axis[2];
+        bounds.coneCutoff = triangleNormals.empty() || minDot <= MinConeDot ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+    }
+}
@@ -0,0 +1,33 @@
+//-----------------------------------------------------------------------------
+// Meshlet.h
+// Created at 2026.10.17 15:50
+// License: see LICENSE file
+//
+// splits index buffer into meshlets, computes meshlet bounds
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+
+#include "StreamMeshData.h"
+
+const uint32_t MaxMeshletVertices = 256; // local indices are uint8
+const uint32_t MaxMeshletTriangles = 512; // mesh shader output limit of common APIs
+const uint32_t DefaultMeshletVertices = 64;
+const uint32_t DefaultMeshletTriangles = 124;
+
+struct MeshletData
+{
+    std::vector<MeshletDescriptor> meshlets;
+    std::vector<uint32_t> vertices;  // mesh vertex indices, referenced by MeshletDescriptor::vertexOffset
+    std::vector<uint8_t> triangles;  // 3 meshlet vertex indices per triangle
+    std::vector<MeshletBounds> bounds;
+};
+
+// greedy split of triangles in index order: meshlet is closed when next triangle
+// would exceed maxVertices (<= MaxMeshletVertices) or maxTriangles (<= MaxMeshletTriangles).
+// Triangle order is kept, so run it after vertex cache/overdraw optimization
+void buildMeshlets(const std::vector<uint32_t> &indices, uint32_t vertexCount,
+                   uint32_t maxVertices, uint32_t maxTriangles, MeshletData &meshletData);
+
+// fills meshletData.bounds, positions: xyz for every vertex
+void computeMeshletBounds(MeshletData &meshletData, const std::vector<float> &positions);
@@ -0,0 +1,330 @@
+//-----------------------------------------------------------------------------
+// Overdraw.cpp
+// Created at 2026.10.17 15:10
+// License: see LICENSE file
+//
+// overdraw reduction: triangle clusters are sorted front to back,
+// overdraw estimation with software rasterizer
+//-----------------------------------------------------------------------------
+#include "Overdraw.h"
+
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    struct Float3
+    {
+        float x, y, z;
+    };
+
+    inline Float3 getPosition(const std::vector<float> &positions, uint32_t vertexIndex)
+    {
+        const float *position = &positions[vertexIndex * 3];
+        return { position[0], position[1], position[2] };
+    }
+
+    inline Float3 operator-(const Float3 &left, const Float3 &right)
+    {
+        return { left.x - right.x, left.y - right.y, left.z - right.z };
+    }
+
+    inline Float3 cross(const Float3 &left, const Float3 &right)
+    {
+        return { left.y * right.z - left.z * right.y, left.z * right.x - left.x * right.z, left.x * right.y - left.y * right.x };
+    }
+
+    inline float dot(const Float3 &left, const Float3 &right)
+    {
+        return left.x * right.x + left.y * right.y + left.z * right.z;
+    }
+
+    // depth and fragment counters for both view directions along an axis
+    class OverdrawRasterizer
+    {
+    public:
+        OverdrawRasterizer()
+            : _depth(2 * OverdrawViewportSize * OverdrawViewportSize)
+            , _fragments(2 * OverdrawViewportSize * OverdrawViewportSize)
+        {
+        }
+
+        void clear()
+        {
+            std::fill(_depth.begin(), _depth.end(), std::numeric_limits<float>::max());
+            std::fill(_fragments.begin(), _fragments.end(), 0);
+        }
+
+        // vertices are in viewport coordinates, z is depth
+        void drawTriangle(Float3 v0, Float3 v1, Float3 v2)
+        {
+            float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+            if (area == 0.0f)
+            {
+                return;
+            }
+            // counter-clockwise triangles face the camera at +z, they are drawn with
+            // reversed depth. Clockwise triangles face the camera at -z and go to second buffer
+            uint32_t face = area > 0.0f ? 0 : 1;
+            if (area > 0.0f)
+            {
+                v0.z = -v0.z;
+                v1.z = -v1.z;
+                v2.z = -v2.z;
+            }
+            else
+            {
+                std::swap(v1, v2);
+                area = -area;
+            }
+            int minX = std::max(0, static_cast<int>(std::floor(std::min({ v0.x, v1.x, v2.x }))));
+            int minY = std::max(0, static_cast<int>(std::floor(std::min({ v0.y, v1.y, v2.y }))));
+            int maxX = std::min(int(OverdrawViewportSize) - 1, static_cast<int>(std::ceil(std::max({ v0.x, v1.x, v2.x }))));
+            int maxY = std::min(int(OverdrawViewportSize) - 1, static_cast<int>(std::ceil(std::max({ v0.y, v1.y, v2.y }))));
+            float *depth = &_depth[face * OverdrawViewportSize * OverdrawViewportSize];
+            uint32_t *fragments = &_fragments[face * OverdrawViewportSize * OverdrawViewportSize];
+            for (int y = minY; y <= maxY; ++y)
+            {
+                for (int x = minX; x <= maxX; ++x)
+                {
+                    // pixel centers, edge functions are positive inside
+                    float px = x + 0.5f;
+                    float py = y + 0.5f;
+                    float w0 = (v2.x - v1.x) * (py - v1.y) - (v2.y - v1.y) * (px - v1.x);
+                    float w1 = (v0.x - v2.x) * (py - v2.y) - (v0.y - v2.y) * (px - v2.x);
+                    float w2 = (v1.x - v0.x) * (py - v0.y) - (v1.y - v0.y) * (px - v0.x);
+                    if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+                    {
+                        continue;
+                    }
+                    float z = (w0 * v0.z + w1 * v1.z + w2 * v2.z) / area;
+                    size_t pixel = size_t(y) * OverdrawViewportSize + x;
+                    if (z < depth[pixel])
+                    {
+                        depth[pixel] = z;
+                        ++fragments[pixel];
+                    }
+                }
+            }
+        }
+
+        void addStats(OverdrawStats &stats) const
+        {
+            for (auto fragmentCount : _fragments)
+            {
+                stats.pixelsCovered += fragmentCount > 0 ? 1 : 0;
+                stats.pixelsShaded += fragmentCount;
+            }
+        }
+
+    private:
+        std::vector<float> _depth;
+        std::vector<uint32_t> _fragments;
+    };
+
+    // FIFO cache misses of every triangle in index order
+    void getTriangleMisses(const std::vector<uint32_t> &indices, uint32_t vertexCount, uint32_t cacheSize,
+                           std::vector<uint32_t> &triangleMisses)
+    {
+        std::vector<uint32_t> cacheTime(vertexCount, 0);
+        uint32_t time = cacheSize + 1;
+        triangleMisses.resize(indices.size() / 3);
+        for (size_t triangle = 0; triangle < triangleMisses.size(); ++triangle)
+        {
+            uint32_t misses = 0;
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                uint32_t vertexIndex = indices[triangle * 3 + corner];
+                if (time - cacheTime[vertexIndex] > cacheSize)
+                {
+                    cacheTime[vertexIndex] = time++;
+                    ++misses;
+                }
+            }
+            triangleMisses[triangle] = misses;
+        }
+    }
+}
+
+OverdrawStats analyzeOverdraw(const std::vector<uint32_t> &indices, const std::vector<float> &positions)
+{
+    OverdrawStats stats;
+    uint32_t vertexCount = static_cast<uint32_t>(positions.size() / 3);
+    if (indices.empty() || vertexCount == 0)
+    {
+        return stats;
+    }
+    // mesh is scaled uniformly to fit the viewport
+    Float3 minPosition = getPosition(positions, 0);
+    Float3 maxPosition = minPosition;
+    for (uint32_t vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex)
+    {
+        Float3 position = getPosition(positions, vertexIndex);
+        minPosition = { std::min(minPosition.x, position.x), std::min(minPosition.y, position.y), std::min(minPosition.z, position.z) };
+        maxPosition = { std::max(maxPosition.x, position.x), std::max(maxPosition.y, position.y), std::max(maxPosition.z, position.z) };
+    }
+    Float3 extent = maxPosition - minPosition;
+    float maxExtent = std::max({ extent.x, extent.y, extent.z });
+    float scale = maxExtent > 0.0f ? (OverdrawViewportSize - 1) / maxExtent : 0.0f;
+
+    OverdrawRasterizer rasterizer;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        rasterizer.clear();
+        for (size_t corner = 0; corner + 2 < indices.size(); corner += 3)
+        {
+            Float3 viewVertices[3];
+            for (int vertex = 0; vertex < 3; ++vertex)
+            {
+                Float3 position = getPosition(positions, indices[corner + vertex]) - minPosition;
+                float coordinates[3] = { position.x * scale, position.y * scale, position.z * scale };
+                viewVertices[vertex] = { coordinates[(axis + 1) % 3], coordinates[(axis + 2) % 3], coordinates[axis] };
+            }
+            rasterizer.drawTriangle(viewVertices[0], viewVertices[1], viewVertices[2]);
+        }
+        rasterizer.addStats(stats);
+    }
+    return stats;
+}
+
+bool optimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<float> &positions, float threshold,
+                      uint32_t cacheSize)
+{
+    uint32_t vertexCount = static_cast<uint32_t>(positions.size() / 3);
+    uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    if (triangleCount == 0)
+    {
+        return false;
+    }
+    std::vector<uint32_t> triangleMisses;
+    getTriangleMisses(indices, vertexCount, cacheSize, triangleMisses);
+
+    // hard boundaries: triangles with all vertices missing the cache start a new patch,
+    // so moving patches doesn't change cache hits
+    std::vector<uint32_t> hardBoundaries;
+    for (uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        if (triangle == 0 || triangleMisses[triangle] == 3)
+        {
+            hardBoundaries.push_back(triangle);
+        }
+    }
+    hardBoundaries.push_back(triangleCount);
+
+    // soft boundaries: patch is split where ACMR of the current cluster isn't worse than
+    // threshold * patch ACMR. Cache is reset at every boundary, so a cluster moved to
+    // any place in the index stream keeps its ACMR
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    auto drawTriangle = [&indices, &cacheTime, &time, cacheSize](uint32_t triangle)
+    {
+        uint32_t misses = 0;
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            uint32_t vertexIndex = indices[triangle * 3 + corner];
+            if (time - cacheTime[vertexIndex] > cacheSize)
+            {
+                cacheTime[vertexIndex] = time++;
+                ++misses;
+            }
+        }
+        return misses;
+    };
+    std::vector<uint32_t> clusterStarts;
+    for (size_t patch = 0; patch + 1 < hardBoundaries.size(); ++patch)
+    {
+        uint32_t patchStart = hardBoundaries[patch];
+        uint32_t patchEnd = hardBoundaries[patch + 1];
+        uint32_t patchMisses = 0;
+        time += cacheSize + 1;
+        for (uint32_t triangle = patchStart; triangle < patchEnd; ++triangle)
+        {
+            patchMisses += drawTriangle(triangle);
+        }
+        double missThreshold = threshold * double(patchMisses) / (patchEnd - patchStart);
+        clusterStarts.push_back(patchStart);
+        uint32_t runningMisses = 0;
+        uint32_t runningTriangles = 0;
+        time += cacheSize + 1;
+        for (uint32_t triangle = patchStart; triangle < patchEnd; ++triangle)
+        {
+            runningMisses += drawTriangle(triangle);
+            ++runningTriangles;
+            if (runningMisses <= missThreshold * runningTriangles && triangle + 1 < patchEnd)
+            {
+                clusterStarts.push_back(triangle + 1);
+                runningMisses = 0;
+                runningTriangles = 0;
+                time += cacheSize + 1;
+            }
+        }
+    }
+    clusterStarts.push_back(triangleCount);
+    if (clusterStarts.size() < 3)
+    {
+        return false; // one cluster, nothing to sort
+    }
+
+    // sort key of a cluster: distance of its centroid from mesh centroid along cluster normal
+    Float3 meshCentroid = { 0.0f, 0.0f, 0.0f };
+    for (auto index : indices)
+    {
+        Float3 position = getPosition(positions, index);
+        meshCentroid = { meshCentroid.x + position.x, meshCentroid.y + position.y, meshCentroid.z + position.z };
+    }
+    float cornerScale = 1.0f / indices.size();
+    meshCentroid = { meshCentroid.x * cornerScale, meshCentroid.y * cornerScale, meshCentroid.z * cornerScale };
+
+    size_t clusterCount = clusterStarts.size() - 1;
+    std::vector<float> clusterKeys(clusterCount);
+    for (size_t cluster = 0; cluster < clusterCount; ++cluster)
+    {
+        Float3 centroid = { 0.0f, 0.0f, 0.0f };
+        Float3 normal = { 0.0f, 0.0f, 0.0f };
+        float clusterArea = 0.0f;
+        for (uint32_t triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; ++triangle)
+        {
+            Float3 p0 = getPosition(positions, indices[triangle * 3 + 0]);
+            Float3 p1 = getPosition(positions, indices[triangle * 3 + 1]);
+            Float3 p2 = getPosition(positions, indices[triangle * 3 + 2]);
+            Float3 areaNormal = cross(p1 - p0, p2 - p0);
+            float area = std::sqrt(dot(areaNormal, areaNormal));
+            centroid.x += (p0.x + p1.x + p2.x) * area;
+            centroid.y += (p0.y + p1.y + p2.y) * area;
+            centroid.z += (p0.z + p1.z + p2.z) * area;
+            normal = { normal.x + areaNormal.x, normal.y + areaNormal.y, normal.z + areaNormal.z };
+            clusterArea += area;
+        }
+        float centroidScale = clusterArea > 0.0f ? 1.0f / (3.0f * clusterArea) : 0.0f;
+        centroid = { centroid.x * centroidScale, centroid.y * centroidScale, centroid.z * centroidScale };
+        float normalLength = std::sqrt(dot(normal, normal));
+        float normalScale = normalLength > 0.0f ? 1.0f / normalLength : 0.0f;
+        normal = { normal.x * normalScale, normal.y * normalScale, normal.z * normalScale };
+        clusterKeys[cluster] = dot(centroid - meshCentroid, normal);
+    }
+
+    std::vector<uint32_t> clusterOrder(clusterCount);
+    for (uint32_t cluster = 0; cluster < clusterCount; ++cluster)
+    {
+        clusterOrder[cluster] = cluster;
+    }
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&clusterKeys](uint32_t left, uint32_t right)
+    {
+        return clusterKeys[left] > clusterKeys[right];
+    });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (auto cluster : clusterOrder)
+    {
+        result.insert(result.end(), indices.begin() + clusterStarts[cluster] * 3, indices.begin() + clusterStarts[cluster + 1] * 3);
+    }
+    // cluster keys only approximate the draw order effect, on thin or concave
+    // meshes sorting can raise overdraw, the input order is kept then
+    if (analyzeOverdraw(result, positions).pixelsShaded >= analyzeOverdraw(indices, positions).pixelsShaded)
+    {
+        return false;
+    }
+    indices.swap(result);
+    return true;
+}
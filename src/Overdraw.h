@@ -0,0 +1,40 @@
+//-----------------------------------------------------------------------------
+// Overdraw.h
+// Created at 2026.10.17 15:10
+// License: see LICENSE file
+//
+// overdraw reduction: triangle clusters are sorted front to back,
+// overdraw estimation with software rasterizer
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+
+#include "VertexCache.h"
+
+// resolution of software rasterizer used by analyzeOverdraw
+const uint32_t OverdrawViewportSize = 256;
+
+struct OverdrawStats
+{
+    uint64_t pixelsCovered = 0; // pixels with at least one triangle, summed for all views
+    uint64_t pixelsShaded = 0;  // fragments which passed depth test in draw order
+
+    // shaded fragments per covered pixel: 1.0 is no overdraw
+    inline double overdraw() const { return pixelsCovered > 0 ? double(pixelsShaded) / pixelsCovered : 0.0; }
+};
+
+// rasterizes the mesh in index order with depth test from 6 axis-aligned
+// orthographic views: for every axis, triangles are drawn from the side they
+// face (backface culling). positions: xyz for every vertex
+OverdrawStats analyzeOverdraw(const std::vector<uint32_t> &indices, const std::vector<float> &positions);
+
+// splits triangles in cache-friendly order to clusters and sorts clusters so
+// outer clusters facing away from mesh centroid are drawn first.
+// threshold >= 1 is allowed ACMR ratio of the result to the input: clusters are
+// split where cache misses so far don't exceed threshold * cluster ACMR, so
+// bigger threshold gives more clusters and less overdraw. Threshold near 1.0
+// leaves almost no clusters to sort. The result is compared with the input by
+// analyzeOverdraw and kept only when it has less overdraw.
+// Returns true when indices were reordered
+bool optimizeOverdraw(std::vector<uint32_t> &indices, const std::vector<float> &positions, float threshold,
+                      uint32_t cacheSize = DefaultVertexCacheSize);
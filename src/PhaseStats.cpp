@@ -0,0 +1,231 @@
+//-----------------------------------------------------------------------------
+// PhaseStats.cpp
+// Created at 2026.10.17 18:20
+// License: see LICENSE file
+//
+// per-phase wall time, CPU time, peak RSS growth and item counts of
+// conversion, saved as JSON report (--stats)
+//-----------------------------------------------------------------------------
+#include "PhaseStats.h"
+
+#include <atomic>
+#include <mutex>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <ctime>
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    const uint32_t PhaseCount = static_cast<uint32_t>(Phase::Count);
+
+    const char* const PhaseNames[PhaseCount][2] = {
+        { "cacheLookup", "bytes" },
+        { "sdkInitialize", "files" },
+        { "sdkImport", "nodes" },
+        { "fileParse", "nodes" },
+        { "decompression", "bytes" },
+        { "polygonWalk", "corners" },
+        { "triangulation", "triangles" },
+        { "welding", "corners" },
+        { "normalMerge", "vertices" },
+        { "optimization", "triangles" },
+        { "streamBuilding", "vertices" },
+        { "instancing", "meshes" },
+        { "materialExtraction", "materials" },
+        { "nodeExtraction", "nodes" },
+        { "streamCompression", "bytes" },
+        { "meshWrite", "bytes" },
+        { "sceneWrite", "objects" },
+        { "cacheStore", "bytes" },
+    };
+
+    std::atomic<bool> phaseStatsEnabled(false);
+    std::mutex phaseRecordsMutex;
+    PhaseRecord phaseRecords[PhaseCount];
+
+#ifdef _WIN32
+    inline double fileTimeToSeconds(const FILETIME &fileTime)
+    {
+        return ((uint64_t(fileTime.dwHighDateTime) << 32) | fileTime.dwLowDateTime) * 1e-7;
+    }
+#endif
+}
+
+void enablePhaseStats(bool enabled)
+{
+    phaseStatsEnabled.store(enabled);
+}
+
+bool isPhaseStatsEnabled()
+{
+    return phaseStatsEnabled.load(std::memory_order_relaxed);
+}
+
+void resetPhaseStats()
+{
+    std::lock_guard<std::mutex> lock(phaseRecordsMutex);
+    for (auto &record : phaseRecords)
+    {
+        record = PhaseRecord();
+    }
+}
+
+std::vector<PhaseRecord> getPhaseRecords()
+{
+    std::lock_guard<std::mutex> lock(phaseRecordsMutex);
+    return std::vector<PhaseRecord>(phaseRecords, phaseRecords + PhaseCount);
+}
+
+const char* getPhaseName(Phase phase)
+{
+    return PhaseNames[static_cast<uint32_t>(phase)][0];
+}
+
+const char* getPhaseItemName(Phase phase)
+{
+    return PhaseNames[static_cast<uint32_t>(phase)][1];
+}
+
+double getThreadCPUSeconds()
+{
+#ifdef _WIN32
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+    {
+        return 0.0;
+    }
+    return fileTimeToSeconds(kernelTime) + fileTimeToSeconds(userTime);
+#else
+    timespec time;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0)
+    {
+        return 0.0;
+    }
+    return time.tv_sec + time.tv_nsec * 1e-9;
+#endif
+}
+
+double getProcessCPUSeconds()
+{
+#ifdef _WIN32
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+    {
+        return 0.0;
+    }
+    return fileTimeToSeconds(kernelTime) + fileTimeToSeconds(userTime);
+#else
+    timespec time;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0)
+    {
+        return 0.0;
+    }
+    return time.tv_sec + time.tv_nsec * 1e-9;
+#endif
+}
+
+uint64_t getPeakRSS()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss); // bytes
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024; // kilobytes
+#endif
+#endif
+}
+
+PhaseTimer::PhaseTimer(Phase phase, uint64_t itemCount)
+    : _phase(phase)
+    , _running(isPhaseStatsEnabled())
+    , _itemCount(itemCount)
+    , _cpuStart(0.0)
+    , _peakRSSStart(0)
+    , _traceZone(getPhaseName(phase))
+{
+    if (_running)
+    {
+        _peakRSSStart = getPeakRSS();
+        _cpuStart = getThreadCPUSeconds();
+        _wallStart = std::chrono::steady_clock::now();
+    }
+}
+
+PhaseTimer::~PhaseTimer()
+{
+    stop();
+}
+
+void PhaseTimer::stop()
+{
+    _traceZone.arg(getPhaseItemName(_phase), static_cast<int64_t>(_itemCount));
+    _traceZone.end();
+    if (!_running)
+    {
+        return;
+    }
+    _running = false;
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - _wallStart).count();
+    double cpuSeconds = getThreadCPUSeconds() - _cpuStart;
+    uint64_t peakRSS = getPeakRSS();
+
+    std::lock_guard<std::mutex> lock(phaseRecordsMutex);
+    auto &record = phaseRecords[static_cast<uint32_t>(_phase)];
+    ++record.callCount;
+    record.itemCount += _itemCount;
+    record.wallSeconds += wallSeconds;
+    record.cpuSeconds += cpuSeconds;
+    record.peakRSSGrowth += peakRSS > _peakRSSStart ? peakRSS - _peakRSSStart : 0;
+}
+
+bool exportPhaseStatsToFile(const std::string &fileName, const Json::Value &runInfo)
+{
+    Json::Value jsonRoot = runInfo;
+    Json::Value jPhaseArray(Json::arrayValue);
+    auto records = getPhaseRecords();
+    for (uint32_t phaseIndex = 0; phaseIndex < PhaseCount; ++phaseIndex)
+    {
+        const auto &record = records[phaseIndex];
+        Json::Value jPhase;
+        jPhase["name"] = getPhaseName(static_cast<Phase>(phaseIndex));
+        jPhase["calls"] = Json::UInt64(record.callCount);
+        jPhase["wallSeconds"] = record.wallSeconds;
+        jPhase["cpuSeconds"] = record.cpuSeconds;
+        jPhase["peakRSSGrowthBytes"] = Json::UInt64(record.peakRSSGrowth);
+        jPhase["items"] = Json::UInt64(record.itemCount);
+        jPhase["itemName"] = getPhaseItemName(static_cast<Phase>(phaseIndex));
+        jPhaseArray.append(jPhase);
+    }
+    jsonRoot["phases"] = jPhaseArray;
+
+    std::ofstream ofStats(fileName, std::ios::out | std::ios::trunc);
+    if (!ofStats.is_open())
+    {
+        return false;
+    }
+    Json::StreamWriterBuilder jsonBuilder;
+    std::unique_ptr<Json::StreamWriter> writer(jsonBuilder.newStreamWriter());
+    writer->write(jsonRoot, &ofStats);
+    ofStats << std::endl;
+    return ofStats.good();
+}
@@ -0,0 +1,85 @@
+//-----------------------------------------------------------------------------
+// PhaseStats.h
+// Created at 2026.10.17 18:20
+// License: see LICENSE file
+//
+// per-phase wall time, CPU time, peak RSS growth and item counts of
+// conversion, saved as JSON report (--stats)
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+
+#include <chrono>
+
+#include "Trace.h"
+
+enum class Phase
+{
+    CacheLookup,   // hash of input file and restore of cached outputs (--cache)
+    SDKInitialize,
+    SDKImport,
+    FileParse,     // native binary FBX reader: node records
+    Decompression, // native binary FBX reader: zlib arrays
+    PolygonWalk,
+    Triangulation,
+    Welding,
+    NormalMerge,
+    Optimization, // vertex cache, overdraw, vertex fetch reordering and their statistics
+    StreamBuilding,
+    Instancing,    // hash and comparison of converted meshes (--dedupe-meshes)
+    MaterialExtraction,
+    NodeExtraction,
+    StreamCompression, // filters and LZ4 of .msh version 3 stream data (--compress)
+    MeshWrite,
+    SceneWrite,
+    CacheStore,    // link or copy of outputs into the cache (--cache)
+    Count
+};
+
+// sums of all calls of a phase. Phases of different meshes run in parallel,
+// so wall and CPU times of mesh phases can exceed run time
+struct PhaseRecord
+{
+    uint64_t callCount = 0;
+    uint64_t itemCount = 0;
+    double wallSeconds = 0.0;
+    double cpuSeconds = 0.0;      // CPU time of the thread which ran the phase
+    uint64_t peakRSSGrowth = 0;   // growth of process peak RSS in bytes while the phase ran
+};
+
+// collection is disabled by default, PhaseTimer does nothing then
+void enablePhaseStats(bool enabled);
+bool isPhaseStatsEnabled();
+void resetPhaseStats();
+std::vector<PhaseRecord> getPhaseRecords();
+const char* getPhaseName(Phase phase);
+// what itemCount of the phase counts, e.g. "triangles"
+const char* getPhaseItemName(Phase phase);
+
+double getThreadCPUSeconds();
+double getProcessCPUSeconds();
+uint64_t getPeakRSS(); // bytes, 0 when unknown
+
+// measures from construction to stop() or destruction, also recorded as
+// trace zone named after the phase when tracing is enabled
+class PhaseTimer
+{
+public:
+    explicit PhaseTimer(Phase phase, uint64_t itemCount = 0);
+    ~PhaseTimer();
+
+    inline void setItemCount(uint64_t itemCount) { _itemCount = itemCount; }
+    void stop();
+
+private:
+    Phase _phase;
+    bool _running;
+    uint64_t _itemCount;
+    std::chrono::steady_clock::time_point _wallStart;
+    double _cpuStart;
+    uint64_t _peakRSSStart;
+    TraceZone _traceZone;
+};
+
+// report: run info (input file, wall/CPU seconds, peak RSS...) and every phase
+bool exportPhaseStatsToFile(const std::string &fileName, const Json::Value &runInfo);
@@ -0,0 +1,35 @@
+//-----------------------------------------------------------------------------
+// RawMesh.h
+// Created at 2026.10.17 11:30
+// License: see LICENSE file
+//
+// mesh data extracted from FBX SDK into plain arrays, so it can be
+// converted to StreamMesh without SDK calls (in parallel)
+//-----------------------------------------------------------------------------
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "IndexSet.h"
+
+// same memory layout as FbxVector4/FbxVector2
+struct RawVector4
+{
+    double mData[4];
+};
+
+struct RawVector2
+{
+    double mData[2];
+};
+
+struct RawMesh
+{
+    std::vector<RawVector4> controlPoints;
+    std::vector<uint32_t> polygonSizes;
+    std::vector<IndexSet> polygonVertices; // IndexSet for each polygon corner, polygons are stored one after another
+    std::vector<RawVector4> normals;
+    std::vector<RawVector2> UVs;
+    std::vector<RawVector4> tangents;
+    std::vector<RawVector4> binormals;
+};
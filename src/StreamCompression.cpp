@@ -0,0 +1,639 @@
+//-----------------------------------------------------------------------------
+// StreamCompression.cpp
+// Created at 2026.10.17 23:10
+// License: see LICENSE file
+//
+// compression of .msh version 3 stream data: LZ4 block format codec and
+// byte shuffle / delta filters for float and index streams
+//-----------------------------------------------------------------------------
+#include "StreamCompression.h"
+
+#include <algorithm>
+#include <cstring>
+
+// SSE2 is part of x64, so only x64 builds have the SIMD unshuffle
+#if defined(_M_X64) || defined(__x86_64__)
+#define STREAM_COMPRESSION_X64 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // LZ4 block format rules: matches are at least 4 bytes, the last 5 bytes are
+    // literals and the last match starts at least 12 bytes before the end
+    const size_t MinMatch = 4;
+    const size_t LastLiterals = 5;
+    const size_t MatchFindLimit = 12;
+    const size_t MaxDistance = 65535;
+    const uint32_t MaxHashBits = 16;
+    // search step grows by one every 2^SkipStrength misses, incompressible data is skipped faster
+    const uint32_t SkipStrength = 6;
+    // thread buffers grown above this by a huge stream are freed after use
+    const size_t MaxKeptBufferSize = 16u << 20;
+
+    template <typename T>
+    inline T readValue(const uint8_t *data)
+    {
+        T value;
+        memcpy(&value, data, sizeof(T)); // little-endian
+        return value;
+    }
+
+    template <typename T>
+    inline void writeValue(uint8_t *data, T value)
+    {
+        memcpy(data, &value, sizeof(T));
+    }
+
+    inline uint32_t hashSequence(uint32_t sequence, uint32_t hashBits)
+    {
+        return (sequence * 2654435761u) >> (32 - hashBits);
+    }
+
+    // lengths from 15 are continued with bytes of 255 and a last byte below 255
+    inline uint8_t* writeLength(uint8_t *destination, size_t length)
+    {
+        for (; length >= 255; length -= 255)
+        {
+            *destination++ = 255;
+        }
+        *destination++ = static_cast<uint8_t>(length);
+        return destination;
+    }
+
+    inline bool readLength(const uint8_t *&input, const uint8_t *inputEnd, size_t &length)
+    {
+        uint8_t value = 0;
+        do
+        {
+            if (input == inputEnd)
+            {
+                return false;
+            }
+            value = *input++;
+            length += value;
+        } while (value == 255);
+        return true;
+    }
+
+    inline uint8_t* writeSequence(uint8_t *destination, const uint8_t *literals, size_t literalLength,
+                                  size_t offset, size_t matchLength)
+    {
+        uint8_t *token = destination++;
+        size_t matchCode = matchLength - MinMatch;
+        *token = static_cast<uint8_t>((std::min<size_t>(literalLength, 15) << 4) | std::min<size_t>(matchCode, 15));
+        if (literalLength >= 15)
+        {
+            destination = writeLength(destination, literalLength - 15);
+        }
+        memcpy(destination, literals, literalLength);
+        destination += literalLength;
+        *destination++ = static_cast<uint8_t>(offset);
+        *destination++ = static_cast<uint8_t>(offset >> 8);
+        if (matchCode >= 15)
+        {
+            destination = writeLength(destination, matchCode - 15);
+        }
+        return destination;
+    }
+
+    // number of equal bytes at a and b, up to limit
+    inline size_t countEqualBytes(const uint8_t *a, const uint8_t *b, size_t limit)
+    {
+        size_t count = 0;
+        while (count + 8 <= limit)
+        {
+            uint64_t difference = readValue<uint64_t>(a + count) ^ readValue<uint64_t>(b + count);
+            if (difference != 0)
+            {
+                for (; (difference & 0xFF) == 0; difference >>= 8)
+                {
+                    ++count;
+                }
+                return count;
+            }
+            count += 8;
+        }
+        while (count < limit && a[count] == b[count])
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    // copies length bytes from output - offset, the ranges can overlap
+    inline void copyMatch(uint8_t *output, size_t offset, size_t length, size_t outputLeft)
+    {
+        const uint8_t *match = output - offset;
+        // whole chunks may write up to 15 bytes past the match, which are overwritten later
+        if (offset >= 16 && outputLeft >= length + 15)
+        {
+            for (size_t i = 0; i < length; i += 16)
+            {
+                memcpy(output + i, match + i, 16);
+            }
+        }
+        else if (offset >= 8 && outputLeft >= length + 7)
+        {
+            for (size_t i = 0; i < length; i += 8)
+            {
+                memcpy(output + i, match + i, 8);
+            }
+        }
+        else if (length >= 16 && outputLeft >= length + 15)
+        {
+            // long runs of short patterns (constant byte planes after shuffle) are written
+            // from a 16 byte copy of the pattern, step is the largest multiple of offset <= 16
+            uint8_t pattern[16];
+            for (size_t i = 0; i < 16; ++i)
+            {
+                pattern[i] = i < offset ? match[i] : pattern[i - offset];
+            }
+            size_t step = 16 - 16 % offset;
+            for (size_t i = 0; i < length; i += step)
+            {
+                memcpy(output + i, pattern, 16);
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < length; ++i)
+            {
+                output[i] = match[i];
+            }
+        }
+    }
+
+    template <typename T, bool Delta>
+    void encodeValues(const uint8_t *source, size_t valueCount, uint32_t vectorSize, uint8_t *destination)
+    {
+        for (size_t valueIndex = 0; valueIndex < valueCount; ++valueIndex)
+        {
+            T value = readValue<T>(source + valueIndex * sizeof(T));
+            if (Delta && valueIndex >= vectorSize)
+            {
+                value = static_cast<T>(value - readValue<T>(source + (valueIndex - vectorSize) * sizeof(T)));
+            }
+            for (size_t byteIndex = 0; byteIndex < sizeof(T); ++byteIndex)
+            {
+                destination[byteIndex * valueCount + valueIndex] = static_cast<uint8_t>(value >> (byteIndex * 8));
+            }
+        }
+    }
+
+    // inverse of the byte transpose, interleaves 16 values of 2 and 4 byte planes at once on x64
+    template <typename T>
+    void unshuffleValues(const uint8_t *source, size_t valueCount, uint8_t *destination)
+    {
+        size_t valueIndex = 0;
+#if STREAM_COMPRESSION_X64
+        if (sizeof(T) == 2)
+        {
+            for (; valueIndex + 16 <= valueCount; valueIndex += 16)
+            {
+                __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + valueIndex));
+                __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + valueCount + valueIndex));
+                uint8_t *output = destination + valueIndex * 2;
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_unpacklo_epi8(low, high));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 16), _mm_unpackhi_epi8(low, high));
+            }
+        }
+        else if (sizeof(T) == 4)
+        {
+            for (; valueIndex + 16 <= valueCount; valueIndex += 16)
+            {
+                __m128i byte0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + valueIndex));
+                __m128i byte1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + valueCount + valueIndex));
+                __m128i byte2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 2 * valueCount + valueIndex));
+                __m128i byte3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 3 * valueCount + valueIndex));
+                __m128i low01 = _mm_unpacklo_epi8(byte0, byte1);
+                __m128i high01 = _mm_unpackhi_epi8(byte0, byte1);
+                __m128i low23 = _mm_unpacklo_epi8(byte2, byte3);
+                __m128i high23 = _mm_unpackhi_epi8(byte2, byte3);
+                uint8_t *output = destination + valueIndex * 4;
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_unpacklo_epi16(low01, low23));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 16), _mm_unpackhi_epi16(low01, low23));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 32), _mm_unpacklo_epi16(high01, high23));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 48), _mm_unpackhi_epi16(high01, high23));
+            }
+        }
+#endif
+        for (; valueIndex < valueCount; ++valueIndex)
+        {
+            T value = 0;
+            for (size_t byteIndex = 0; byteIndex < sizeof(T); ++byteIndex)
+            {
+                value |= static_cast<T>(static_cast<T>(source[byteIndex * valueCount + valueIndex]) << (byteIndex * 8));
+            }
+            writeValue(destination + valueIndex * sizeof(T), value);
+        }
+    }
+
+    // undoes delta in place: running sum of every component over elements
+    template <typename T>
+    void accumulateValues(uint8_t *data, size_t valueCount, uint32_t vectorSize)
+    {
+        if (vectorSize <= 4)
+        {
+            // sums stay in registers, no store to load dependency
+            T sums[4] = {};
+            for (size_t valueIndex = 0; valueIndex < valueCount; valueIndex += vectorSize)
+            {
+                for (uint32_t component = 0; component < vectorSize; ++component)
+                {
+                    uint8_t *value = data + (valueIndex + component) * sizeof(T);
+                    sums[component] = static_cast<T>(sums[component] + readValue<T>(value));
+                    writeValue(value, sums[component]);
+                }
+            }
+            return;
+        }
+        for (size_t valueIndex = vectorSize; valueIndex < valueCount; ++valueIndex)
+        {
+            uint8_t *value = data + valueIndex * sizeof(T);
+            writeValue(value, static_cast<T>(readValue<T>(value) + readValue<T>(value - vectorSize * sizeof(T))));
+        }
+    }
+
+    template <typename T, bool Delta>
+    void decodeValues(const uint8_t *source, size_t valueCount, uint32_t vectorSize, uint8_t *destination)
+    {
+        unshuffleValues<T>(source, valueCount, destination);
+        if (Delta)
+        {
+            accumulateValues<T>(destination, valueCount, vectorSize);
+        }
+    }
+
+    template <bool Delta>
+    void encodeValues(const uint8_t *source, size_t valueCount, uint32_t elementSize, uint32_t vectorSize,
+                      uint8_t *destination)
+    {
+        switch (elementSize)
+        {
+        case 1: encodeValues<uint8_t, Delta>(source, valueCount, vectorSize, destination); break;
+        case 2: encodeValues<uint16_t, Delta>(source, valueCount, vectorSize, destination); break;
+        case 4: encodeValues<uint32_t, Delta>(source, valueCount, vectorSize, destination); break;
+        case 8: encodeValues<uint64_t, Delta>(source, valueCount, vectorSize, destination); break;
+        default:
+            // other sizes have no integer type, Delta works like Shuffle for them
+            for (size_t valueIndex = 0; valueIndex < valueCount; ++valueIndex)
+            {
+                for (size_t byteIndex = 0; byteIndex < elementSize; ++byteIndex)
+                {
+                    destination[byteIndex * valueCount + valueIndex] = source[valueIndex * elementSize + byteIndex];
+                }
+            }
+            break;
+        }
+    }
+
+    template <bool Delta>
+    void decodeValues(const uint8_t *source, size_t valueCount, uint32_t elementSize, uint32_t vectorSize,
+                      uint8_t *destination)
+    {
+        switch (elementSize)
+        {
+        case 1: decodeValues<uint8_t, Delta>(source, valueCount, vectorSize, destination); break;
+        case 2: decodeValues<uint16_t, Delta>(source, valueCount, vectorSize, destination); break;
+        case 4: decodeValues<uint32_t, Delta>(source, valueCount, vectorSize, destination); break;
+        case 8: decodeValues<uint64_t, Delta>(source, valueCount, vectorSize, destination); break;
+        default:
+            for (size_t valueIndex = 0; valueIndex < valueCount; ++valueIndex)
+            {
+                for (size_t byteIndex = 0; byteIndex < elementSize; ++byteIndex)
+                {
+                    destination[valueIndex * elementSize + byteIndex] = source[byteIndex * valueCount + valueIndex];
+                }
+            }
+            break;
+        }
+    }
+
+    // values of whole elements, the rest of the data isn't filtered
+    inline size_t filteredValueCount(size_t size, uint32_t elementSize, uint32_t elementVectorSize)
+    {
+        if (elementSize == 0 || elementVectorSize == 0)
+        {
+            return 0;
+        }
+        return size / (size_t(elementSize) * elementVectorSize) * elementVectorSize;
+    }
+}
+
+size_t lz4CompressBound(size_t sourceSize)
+{
+    return sourceSize + sourceSize / 255 + 16;
+}
+
+size_t lz4Compress(const uint8_t *source, size_t sourceSize, uint8_t *destination, size_t destinationCapacity)
+{
+    if (destinationCapacity < lz4CompressBound(sourceSize))
+    {
+        return 0;
+    }
+    uint8_t *output = destination;
+    size_t anchor = 0;
+    if (sourceSize > MatchFindLimit)
+    {
+        // small streams get a small table, clearing 256 KB for every small mesh would dominate
+        uint32_t hashBits = 8;
+        while (hashBits < MaxHashBits && (size_t(1) << hashBits) < sourceSize)
+        {
+            ++hashBits;
+        }
+        thread_local std::vector<uint32_t> hashTable;
+        hashTable.assign(size_t(1) << hashBits, 0);
+        const size_t matchStartLimit = sourceSize - MatchFindLimit;
+        const size_t matchEndLimit = sourceSize - LastLiterals;
+        size_t position = 0;
+        uint32_t searchCount = 1u << SkipStrength;
+        while (position <= matchStartLimit)
+        {
+            uint32_t sequence = readValue<uint32_t>(source + position);
+            uint32_t &slot = hashTable[hashSequence(sequence, hashBits)];
+            size_t candidate = slot;
+            slot = static_cast<uint32_t>(position);
+            if (candidate >= position || position - candidate > MaxDistance ||
+                readValue<uint32_t>(source + candidate) != sequence)
+            {
+                position += searchCount++ >> SkipStrength;
+                continue;
+            }
+            while (position > anchor && candidate > 0 && source[position - 1] == source[candidate - 1])
+            {
+                --position;
+                --candidate;
+            }
+            size_t matchLength = MinMatch + countEqualBytes(source + position + MinMatch, source + candidate + MinMatch,
+                                                            matchEndLimit - position - MinMatch);
+            output = writeSequence(output, source + anchor, position - anchor, position - candidate, matchLength);
+            position += matchLength;
+            anchor = position;
+            searchCount = 1u << SkipStrength;
+            if (position <= matchStartLimit)
+            {
+                hashTable[hashSequence(readValue<uint32_t>(source + position - 2), hashBits)] = static_cast<uint32_t>(position - 2);
+            }
+        }
+    }
+    size_t literalLength = sourceSize - anchor;
+    *output++ = static_cast<uint8_t>(std::min<size_t>(literalLength, 15) << 4);
+    if (literalLength >= 15)
+    {
+        output = writeLength(output, literalLength - 15);
+    }
+    if (literalLength > 0)
+    {
+        memcpy(output, source + anchor, literalLength);
+    }
+    output += literalLength;
+    return output - destination;
+}
+
+bool lz4Decompress(const uint8_t *source, size_t sourceSize, uint8_t *destination, size_t destinationSize)
+{
+    const uint8_t *input = source;
+    const uint8_t *inputEnd = source + sourceSize;
+    uint8_t *output = destination;
+    uint8_t *outputEnd = destination + destinationSize;
+    for (;;)
+    {
+        if (input == inputEnd)
+        {
+            return false;
+        }
+        uint32_t token = *input++;
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(input, inputEnd, literalLength))
+        {
+            return false;
+        }
+        size_t inputLeft = inputEnd - input;
+        size_t outputLeft = outputEnd - output;
+        if (literalLength > inputLeft || literalLength > outputLeft)
+        {
+            return false;
+        }
+        // short literal runs are copied with one fixed-size copy when there's room
+        if (literalLength <= 16 && inputLeft >= 16 && outputLeft >= 16)
+        {
+            memcpy(output, input, 16);
+        }
+        else if (literalLength > 0)
+        {
+            memcpy(output, input, literalLength);
+        }
+        input += literalLength;
+        output += literalLength;
+        if (input == inputEnd)
+        {
+            break; // last sequence has no match
+        }
+        if (inputEnd - input < 2)
+        {
+            return false;
+        }
+        size_t offset = input[0] | (size_t(input[1]) << 8);
+        input += 2;
+        if (offset == 0 || offset > size_t(output - destination))
+        {
+            return false;
+        }
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !readLength(input, inputEnd, matchLength))
+        {
+            return false;
+        }
+        matchLength += MinMatch;
+        outputLeft = outputEnd - output;
+        if (matchLength > outputLeft)
+        {
+            return false;
+        }
+        copyMatch(output, offset, matchLength, outputLeft);
+        output += matchLength;
+    }
+    return output == outputEnd;
+}
+
+void applyStreamFilter(StreamFilter filter, const uint8_t *source, size_t size,
+                       uint32_t elementSize, uint32_t elementVectorSize, uint8_t *destination)
+{
+    size_t valueCount = filter == StreamFilter::None ? 0 : filteredValueCount(size, elementSize, elementVectorSize);
+    if (filter == StreamFilter::Delta)
+    {
+        encodeValues<true>(source, valueCount, elementSize, elementVectorSize, destination);
+    }
+    else if (filter == StreamFilter::Shuffle)
+    {
+        encodeValues<false>(source, valueCount, elementSize, elementVectorSize, destination);
+    }
+    size_t filteredSize = valueCount * elementSize;
+    if (filteredSize < size)
+    {
+        memcpy(destination + filteredSize, source + filteredSize, size - filteredSize);
+    }
+}
+
+void reverseStreamFilter(StreamFilter filter, const uint8_t *source, size_t size,
+                         uint32_t elementSize, uint32_t elementVectorSize, uint8_t *destination)
+{
+    size_t valueCount = filter == StreamFilter::None ? 0 : filteredValueCount(size, elementSize, elementVectorSize);
+    if (filter == StreamFilter::Delta)
+    {
+        decodeValues<true>(source, valueCount, elementSize, elementVectorSize, destination);
+    }
+    else if (filter == StreamFilter::Shuffle)
+    {
+        decodeValues<false>(source, valueCount, elementSize, elementVectorSize, destination);
+    }
+    size_t filteredSize = valueCount * elementSize;
+    if (filteredSize < size)
+    {
+        memcpy(destination + filteredSize, source + filteredSize, size - filteredSize);
+    }
+}
+
+CompressedStream compressStream(const VectorStream &stream, const StreamCompressionSettings &settings)
+{
+    CompressedStream result;
+    const auto &data = stream.data;
+    if (settings.codec != StreamCodec::LZ4 || data.empty())
+    {
+        return result;
+    }
+    std::vector<StreamFilter> filters;
+    if (settings.autoFilter)
+    {
+        filters = { StreamFilter::None, StreamFilter::Shuffle, StreamFilter::Delta };
+    }
+    else
+    {
+        filters = { settings.filter };
+    }
+    uint64_t sizeLimit = uint64_t(data.size()) * (100 - std::min(settings.minSavingPercent, 100u)) / 100;
+    thread_local std::vector<uint8_t> filtered;
+    thread_local std::vector<uint8_t> compressed;
+    compressed.resize(lz4CompressBound(data.size()));
+    for (auto filter : filters)
+    {
+        const uint8_t *input = data.data();
+        if (filter != StreamFilter::None)
+        {
+            filtered.resize(data.size());
+            applyStreamFilter(filter, data.data(), data.size(), stream.elementSize, stream.elementVectorSize, filtered.data());
+            input = filtered.data();
+        }
+        size_t compressedSize = lz4Compress(input, data.size(), compressed.data(), compressed.size());
+        if (compressedSize <= sizeLimit && compressedSize < data.size() &&
+            (result.data.empty() || compressedSize < result.data.size()))
+        {
+            result.codec = StreamCodec::LZ4;
+            result.filter = filter;
+            result.data.assign(compressed.begin(), compressed.begin() + compressedSize);
+        }
+    }
+    if (compressed.capacity() > MaxKeptBufferSize)
+    {
+        std::vector<uint8_t>().swap(compressed);
+        std::vector<uint8_t>().swap(filtered);
+    }
+    return result;
+}
+
+bool decompressStream(StreamCodec codec, StreamFilter filter, const uint8_t *data, uint64_t dataSize,
+                      uint32_t elementSize, uint32_t elementVectorSize,
+                      uint8_t *destination, uint64_t uncompressedSize, std::vector<uint8_t> &scratch)
+{
+    if (codec == StreamCodec::None)
+    {
+        if (filter != StreamFilter::None || dataSize != uncompressedSize)
+        {
+            return false;
+        }
+        if (dataSize > 0)
+        {
+            memcpy(destination, data, dataSize);
+        }
+        return true;
+    }
+    if (codec != StreamCodec::LZ4)
+    {
+        return false;
+    }
+    if (filter == StreamFilter::None)
+    {
+        return lz4Decompress(data, dataSize, destination, uncompressedSize);
+    }
+    if (filter != StreamFilter::Shuffle && filter != StreamFilter::Delta)
+    {
+        return false;
+    }
+    scratch.resize(uncompressedSize);
+    if (!lz4Decompress(data, dataSize, scratch.data(), uncompressedSize))
+    {
+        return false;
+    }
+    reverseStreamFilter(filter, scratch.data(), uncompressedSize, elementSize, elementVectorSize, destination);
+    return true;
+}
+
+const char* getStreamCodecName(StreamCodec codec)
+{
+    switch (codec)
+    {
+    case StreamCodec::None: return "none";
+    case StreamCodec::LZ4: return "lz4";
+    }
+    return "unknown";
+}
+
+const char* getStreamFilterName(StreamFilter filter)
+{
+    switch (filter)
+    {
+    case StreamFilter::None: return "none";
+    case StreamFilter::Shuffle: return "shuffle";
+    case StreamFilter::Delta: return "delta";
+    }
+    return "unknown";
+}
+
+bool parseStreamCodec(const std::string &name, StreamCodec &codec)
+{
+    if (name == "none")
+    {
+        codec = StreamCodec::None;
+    }
+    else if (name == "lz4")
+    {
+        codec = StreamCodec::LZ4;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+bool parseStreamFilter(const std::string &name, StreamFilter &filter)
+{
+    if (name == "none")
+    {
+        filter = StreamFilter::None;
+    }
+    else if (name == "shuffle")
+    {
+        filter = StreamFilter::Shuffle;
+    }
+    else if (name == "delta")
+    {
+        filter = StreamFilter::Delta;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,69 @@
+//-----------------------------------------------------------------------------
+// StreamCompression.h
+// Created at 2026.10.17 23:10
+// License: see LICENSE file
+//
+// compression of .msh version 3 stream data: LZ4 block format codec and
+// byte shuffle / delta filters for float and index streams
+//-----------------------------------------------------------------------------
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "StreamMeshData.h"
+
+struct StreamCompressionSettings
+{
+    StreamCodec codec = StreamCodec::None;
+    // try every filter and keep the smallest result, otherwise use filter
+    bool autoFilter = true;
+    StreamFilter filter = StreamFilter::Shuffle;
+    // streams which get less than this percent smaller are stored uncompressed
+    // and can be used in place of the mapped file
+    uint32_t minSavingPercent = 10;
+};
+
+// stream data as it's stored in the file, data is empty when stream isn't compressed
+struct CompressedStream
+{
+    StreamCodec codec = StreamCodec::None;
+    StreamFilter filter = StreamFilter::None;
+    std::vector<uint8_t> data;
+};
+
+// max LZ4 block size of sourceSize bytes
+size_t lz4CompressBound(size_t sourceSize);
+
+// LZ4 block format, greedy matching with 64 KB window. Returns compressed size,
+// 0 when destinationCapacity is less than lz4CompressBound(sourceSize)
+size_t lz4Compress(const uint8_t *source, size_t sourceSize, uint8_t *destination, size_t destinationCapacity);
+
+// decompresses LZ4 block, output must be exactly destinationSize bytes.
+// Returns false on corrupted data or other output size
+bool lz4Decompress(const uint8_t *source, size_t sourceSize, uint8_t *destination, size_t destinationSize);
+
+// filters size bytes of elementSize-byte values, elementVectorSize values per element.
+// Trailing bytes which don't make a whole element are copied as is
+void applyStreamFilter(StreamFilter filter, const uint8_t *source, size_t size,
+                       uint32_t elementSize, uint32_t elementVectorSize, uint8_t *destination);
+void reverseStreamFilter(StreamFilter filter, const uint8_t *source, size_t size,
+                         uint32_t elementSize, uint32_t elementVectorSize, uint8_t *destination);
+
+// compresses stream data with settings.codec, see StreamCompressionSettings
+CompressedStream compressStream(const VectorStream &stream, const StreamCompressionSettings &settings);
+
+// decodes stored data of compressed stream into destination of uncompressedSize bytes,
+// scratch holds filtered data between decompression and reverse filter
+bool decompressStream(StreamCodec codec, StreamFilter filter, const uint8_t *data, uint64_t dataSize,
+                      uint32_t elementSize, uint32_t elementVectorSize,
+                      uint8_t *destination, uint64_t uncompressedSize, std::vector<uint8_t> &scratch);
+
+const char* getStreamCodecName(StreamCodec codec);
+const char* getStreamFilterName(StreamFilter filter);
+
+// "none", "lz4"; returns false for unknown name
+bool parseStreamCodec(const std::string &name, StreamCodec &codec);
+// "none", "shuffle", "delta"; returns false for unknown name
+bool parseStreamFilter(const std::string &name, StreamFilter &filter);
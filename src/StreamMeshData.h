@@ -12,9 +12,12 @@
 
 enum class StreamElementType
 {
-    Float,
+    Float,           // elementSize 4 or 8, elementSize 2 is half float
     Int,
     UInt,
+    SNorm,           // signed normalized integer: value / (2^(bits - 1) - 1), clamped to -1
+    UNorm,           // unsigned normalized integer: value / (2^bits - 1)
+    OctahedralSNorm, // unit vector in octahedral encoding, 2 SNorm components
 };
 
 enum class AttributeType
@@ -24,13 +27,40 @@ enum class AttributeType
     Normal,
     UV,
     Tangent,
-    Binormal
+    Binormal,
+    MeshletDescriptor, // MeshletDescriptor for every meshlet
+    MeshletVertex,     // vertex indices of all meshlets, uint16 or uint32 like Index stream
+    MeshletTriangle,   // 3 uint8 indices into meshlet vertices for every triangle
+    MeshletBounds,     // MeshletBounds for every meshlet
+    PositionDequantization, // 2 float3 for UNorm positions: offset, scale; position = offset + scale * unorm
+    InterleavedVertex, // several attributes per vertex, 1 byte elements, elementVectorSize is vertex stride
+    InterleavedLayout, // InterleavedAttribute for every attribute of InterleavedVertex stream
+};
+
+// compression of stream data in version 3 files
+enum class StreamCodec
+{
+    None, // data is stored as is and can be used in place
+    LZ4,  // LZ4 block format without frame, decompresses to uncompressedSize bytes
+};
+
+// reversible transform of stream data before compression, only used with a codec
+enum class StreamFilter
+{
+    None,
+    Shuffle, // byte transpose: byte 0 of every elementSize-byte value, then byte 1 of every value...
+    Delta,   // every value minus the same component of the previous element (wrapping
+             // elementSize-byte integer subtraction, also for floats), then Shuffle
 };
 
 namespace StreamConstants
 {
     const uint32_t MagicMESH = 0x4853454D;//0x4D455348;
     const uint32_t MagicSTRM = 0x4D525453;//0x5354524D;
+    const uint32_t MeshFileVersion1 = 1; // header, then each stream header followed by its data, no padding
+    const uint32_t MeshFileVersion2 = 2; // header, stream directory, aligned stream data
+    const uint32_t MeshFileVersion3 = 3; // version 2 with StreamDirectoryEntryV3, stream data can be compressed
+    const uint32_t DefaultStreamAlignment = 64;
 }
 
 struct StreamMeshHeader
@@ -41,6 +71,97 @@ struct StreamMeshHeader
     uint32_t streamCount = 0;
 };
 
+// .msh version 2 file layout:
+//   StreamMeshFileHeader
+//   StreamDirectoryEntry[streamCount], starts at directoryOffset
+//   stream data, each starts at its dataOffset which is a multiple of
+//   streamAlignment, gaps are zero-filled
+// The file can be memory-mapped and stream data used in place.
+// All values are little-endian
+struct StreamMeshFileHeader
+{
+    uint32_t magicMESH = StreamConstants::MagicMESH;
+    uint32_t headerSize = sizeof(StreamMeshFileHeader);
+    uint32_t version = StreamConstants::MeshFileVersion2;
+    uint32_t streamCount = 0;
+    uint32_t streamAlignment = StreamConstants::DefaultStreamAlignment;
+    uint32_t directoryOffset = sizeof(StreamMeshFileHeader);
+    uint64_t fileSize = 0;
+};
+
+struct StreamDirectoryEntry
+{
+    uint32_t magicSTRM = StreamConstants::MagicSTRM;
+    uint32_t attributeType = 0; //see enum AttributeType
+    uint32_t elementType = 0; //see enum StreamElementType
+    uint32_t elementSize = 0;
+    uint32_t elementVectorSize = 0;
+    uint32_t elementCount = 0;
+    uint64_t dataOffset = 0; // from the beginning of the file
+    uint64_t dataSize = 0;
+};
+
+// .msh version 3 uses the version 2 layout with StreamDirectoryEntryV3.
+// Uncompressed streams (codec None) can be used in place like in version 2,
+// compressed streams take dataSize bytes at dataOffset and decompress to
+// uncompressedSize = elementCount * elementSize * elementVectorSize bytes
+struct StreamDirectoryEntryV3
+{
+    uint32_t magicSTRM = StreamConstants::MagicSTRM;
+    uint32_t attributeType = 0; //see enum AttributeType
+    uint32_t elementType = 0; //see enum StreamElementType
+    uint32_t elementSize = 0;
+    uint32_t elementVectorSize = 0;
+    uint32_t elementCount = 0;
+    uint64_t dataOffset = 0; // from the beginning of the file
+    uint64_t dataSize = 0; // stored size
+    uint32_t codec = 0; //see enum StreamCodec
+    uint32_t filter = 0; //see enum StreamFilter
+    uint64_t uncompressedSize = 0;
+};
+
+static_assert(sizeof(StreamMeshFileHeader) == 32, "StreamMeshFileHeader layout is part of .msh format");
+static_assert(sizeof(StreamDirectoryEntry) == 40, "StreamDirectoryEntry layout is part of .msh format");
+static_assert(sizeof(StreamDirectoryEntryV3) == 56, "StreamDirectoryEntryV3 layout is part of .msh format");
+
+// meshlet = cluster of up to 256 vertices for mesh shaders and cluster culling.
+// Meshlet vertex v is meshletVertices[vertexOffset + v], triangle t consists of
+// meshlet vertices meshletTriangles[(triangleOffset + t) * 3 + 0..2]
+struct MeshletDescriptor
+{
+    uint32_t vertexOffset = 0;
+    uint32_t triangleOffset = 0;
+    uint32_t vertexCount = 0;
+    uint32_t triangleCount = 0;
+};
+
+// bounding sphere and normal cone of meshlet triangles.
+// Meshlet is back-facing for camera at C when
+//   dot(center - C, coneAxis) >= coneCutoff * length(center - C) + radius
+// coneCutoff is 1 when triangle normals are too spread out for cone culling
+struct MeshletBounds
+{
+    float center[3] = {};
+    float radius = 0.0f;
+    float coneAxis[3] = {};
+    float coneCutoff = 1.0f;
+};
+
+// attribute of InterleavedVertex stream: attribute is at offset bytes from the
+// start of every vertex, other fields are the same as in its separate stream
+struct InterleavedAttribute
+{
+    uint32_t attributeType = 0;
+    uint32_t elementType = 0;
+    uint32_t elementSize = 0;
+    uint32_t elementVectorSize = 0;
+    uint32_t offset = 0;
+};
+
+static_assert(sizeof(MeshletDescriptor) == 16, "MeshletDescriptor layout is part of .msh format");
+static_assert(sizeof(MeshletBounds) == 32, "MeshletBounds layout is part of .msh format");
+static_assert(sizeof(InterleavedAttribute) == 20, "InterleavedAttribute layout is part of .msh format");
+
 struct VectorStream
 {
     uint32_t magicSTRM = StreamConstants::MagicSTRM;
@@ -0,0 +1,237 @@
+//-----------------------------------------------------------------------------
+// ThreadPool.cpp
+// Created at 2026.10.17 11:45
+// License: see LICENSE file
+//
+// work-stealing thread pool
+//-----------------------------------------------------------------------------
+#include "ThreadPool.h"
+
+#include "Trace.h"
+
+namespace
+{
+    // pool and worker index of the current thread, used to push nested tasks to own queue
+    thread_local const ThreadPool *currentPool = nullptr;
+    thread_local uint32_t currentWorkerIndex = 0;
+}
+
+ThreadPool::ThreadPool(uint32_t threadCount)
+    : _queuedCount(0)
+    , _pendingCount(0)
+    , _nextQueue(0)
+    , _stopping(false)
+{
+    threadCount = resolveThreadCount(threadCount);
+    if (threadCount <= 1)
+    {
+        return;
+    }
+    for (uint32_t workerIndex = 0; workerIndex < threadCount; ++workerIndex)
+    {
+        _queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+    for (uint32_t workerIndex = 0; workerIndex < threadCount; ++workerIndex)
+    {
+        _threads.push_back(std::thread(&ThreadPool::workerLoop, this, workerIndex));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_stateMutex);
+        _stopping = true;
+    }
+    _taskAvailable.notify_all();
+    for (auto &thread : _threads)
+    {
+        thread.join();
+    }
+}
+
+uint32_t ThreadPool::resolveThreadCount(uint32_t threadCount)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return threadCount;
+}
+
+void ThreadPool::submit(Task task)
+{
+    if (_threads.empty())
+    {
+        runTask(task);
+        return;
+    }
+    uint32_t queueIndex;
+    {
+        std::lock_guard<std::mutex> lock(_stateMutex);
+        ++_pendingCount;
+        ++_queuedCount;
+        queueIndex = currentPool == this ? currentWorkerIndex : _nextQueue++ % _queues.size();
+    }
+    {
+        std::lock_guard<std::mutex> lock(_queues[queueIndex]->mutex);
+        _queues[queueIndex]->tasks.push_back(std::move(task));
+    }
+    _taskAvailable.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::exception_ptr exception;
+    {
+        std::unique_lock<std::mutex> lock(_stateMutex);
+        _taskDone.wait(lock, [this] { return _pendingCount == 0; });
+        std::swap(exception, _firstException);
+    }
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+void ThreadPool::waitForPending(size_t maxPending)
+{
+    std::unique_lock<std::mutex> lock(_stateMutex);
+    _taskDone.wait(lock, [this, maxPending] { return _pendingCount <= maxPending; });
+}
+
+bool ThreadPool::popTask(uint32_t workerIndex, Task &task)
+{
+    for (size_t offset = 0; offset < _queues.size(); ++offset)
+    {
+        auto &queue = *_queues[(workerIndex + offset) % _queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+        {
+            continue;
+        }
+        if (offset == 0)
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::runTask(Task &task)
+{
+    try
+    {
+        task();
+    }
+    catch (...)
+    {
+        if (_threads.empty())
+        {
+            throw;
+        }
+        std::lock_guard<std::mutex> lock(_stateMutex);
+        if (!_firstException)
+        {
+            _firstException = std::current_exception();
+        }
+    }
+}
+
+void ThreadPool::workerLoop(uint32_t workerIndex)
+{
+    currentPool = this;
+    currentWorkerIndex = workerIndex;
+    setTraceThreadName("worker " + std::to_string(workerIndex));
+    for (;;)
+    {
+        Task task;
+        if (popTask(workerIndex, task))
+        {
+            {
+                std::lock_guard<std::mutex> lock(_stateMutex);
+                --_queuedCount;
+            }
+            runTask(task);
+            task = Task(); // release captured data before the task is counted as done
+            {
+                std::lock_guard<std::mutex> lock(_stateMutex);
+                --_pendingCount;
+            }
+            _taskDone.notify_all();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_stateMutex);
+        _taskAvailable.wait(lock, [this] { return _stopping || _queuedCount > 0; });
+        if (_stopping && _queuedCount == 0)
+        {
+            return;
+        }
+    }
+}
+
+TaskGroup::TaskGroup(ThreadPool &threadPool)
+    : _threadPool(threadPool)
+    , _pendingCount(0)
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _taskDone.wait(lock, [this] { return _pendingCount == 0; });
+}
+
+void TaskGroup::submit(ThreadPool::Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_pendingCount;
+    }
+    _threadPool.submit([this, task = std::move(task)]() mutable
+    {
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_firstException)
+            {
+                _firstException = std::current_exception();
+            }
+        }
+        task = ThreadPool::Task(); // release captured data before the task is counted as done
+        std::lock_guard<std::mutex> lock(_mutex);
+        --_pendingCount;
+        _taskDone.notify_all();
+    });
+}
+
+void TaskGroup::wait()
+{
+    std::exception_ptr exception;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _taskDone.wait(lock, [this] { return _pendingCount == 0; });
+        std::swap(exception, _firstException);
+    }
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+void TaskGroup::waitForPending(size_t maxPending)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _taskDone.wait(lock, [this, maxPending] { return _pendingCount <= maxPending; });
+}
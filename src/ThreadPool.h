@@ -0,0 +1,91 @@
+//-----------------------------------------------------------------------------
+// ThreadPool.h
+// Created at 2026.10.17 11:45
+// License: see LICENSE file
+//
+// work-stealing thread pool
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <exception>
+
+// each worker has own task queue: it takes newest tasks from its own queue
+// and steals oldest tasks from other queues when own queue is empty.
+// Pool with threadCount <= 1 has no worker threads and runs tasks in submit()
+class ThreadPool
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(uint32_t threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(Task task);
+    // waits until all submitted tasks are finished,
+    // rethrows first exception thrown by a task
+    void wait();
+    // waits until at most maxPending submitted tasks are queued or running,
+    // used to limit memory held by tasks in flight
+    void waitForPending(size_t maxPending);
+
+    inline uint32_t threadCount() const { return static_cast<uint32_t>(_threads.size()); }
+
+    // converts thread count setting to actual number: 0 means all hardware threads
+    static uint32_t resolveThreadCount(uint32_t threadCount);
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool popTask(uint32_t workerIndex, Task &task);
+    void workerLoop(uint32_t workerIndex);
+    void runTask(Task &task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> _queues;
+    std::vector<std::thread> _threads;
+    std::mutex _stateMutex;
+    std::condition_variable _taskAvailable;
+    std::condition_variable _taskDone;
+    size_t _queuedCount;
+    size_t _pendingCount;
+    uint32_t _nextQueue;
+    bool _stopping;
+    std::exception_ptr _firstException;
+};
+
+// tasks of one caller in a pool shared by several callers (batch mode): waits
+// only for own tasks, so callers don't wait for each other. Destructor waits
+class TaskGroup
+{
+public:
+    explicit TaskGroup(ThreadPool &threadPool);
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void submit(ThreadPool::Task task);
+    // rethrows first exception thrown by a task of the group
+    void wait();
+    void waitForPending(size_t maxPending);
+    inline ThreadPool& threadPool() const { return _threadPool; }
+
+private:
+    ThreadPool &_threadPool;
+    std::mutex _mutex;
+    std::condition_variable _taskDone;
+    size_t _pendingCount;
+    std::exception_ptr _firstException;
+};
@@ -0,0 +1,184 @@
+//-----------------------------------------------------------------------------
+// Trace.cpp
+// Created at 2026.10.17 18:50
+// License: see LICENSE file
+//
+// timeline of conversion as Chrome trace event JSON (chrome://tracing,
+// ui.perfetto.dev): scoped zones with integer arguments for every thread
+//-----------------------------------------------------------------------------
+#include "Trace.h"
+
+#include <atomic>
+#include <mutex>
+
+namespace
+{
+    struct TraceEvent
+    {
+        const char *name;
+        int64_t startNanoseconds;
+        int64_t durationNanoseconds;
+        uint32_t argCount;
+        const char *argNames[MaxTraceZoneArgs];
+        int64_t argValues[MaxTraceZoneArgs];
+    };
+
+    // events of one thread. Owned by the registry, so events survive pool threads
+    struct ThreadEvents
+    {
+        uint32_t threadId = 0;
+        std::string threadName;
+        std::mutex mutex; // taken by the owner thread and by export only
+        std::vector<TraceEvent> events;
+    };
+
+    std::atomic<bool> traceEnabled(false);
+    std::mutex registryMutex;
+    std::vector<std::shared_ptr<ThreadEvents>> threadRegistry;
+    std::chrono::steady_clock::time_point traceOrigin = std::chrono::steady_clock::now();
+
+    ThreadEvents& getThreadEvents()
+    {
+        thread_local std::shared_ptr<ThreadEvents> threadEvents;
+        if (!threadEvents)
+        {
+            threadEvents = std::make_shared<ThreadEvents>();
+            std::lock_guard<std::mutex> lock(registryMutex);
+            threadEvents->threadId = static_cast<uint32_t>(threadRegistry.size()) + 1;
+            threadRegistry.push_back(threadEvents);
+        }
+        return *threadEvents;
+    }
+
+    void writeJsonString(std::ostream &out, const char *text)
+    {
+        out << '"';
+        for (const char *character = text; *character != 0; ++character)
+        {
+            if (*character == '"' || *character == '\\')
+            {
+                out << '\\';
+            }
+            out << *character;
+        }
+        out << '"';
+    }
+
+    // microseconds with nanosecond precision
+    void writeMicroseconds(std::ostream &out, int64_t nanoseconds)
+    {
+        out << nanoseconds / 1000 << '.' << std::setw(3) << std::setfill('0') << nanoseconds % 1000 << std::setfill(' ');
+    }
+}
+
+void enableTrace(bool enabled)
+{
+    if (enabled)
+    {
+        traceOrigin = std::chrono::steady_clock::now();
+    }
+    traceEnabled.store(enabled);
+}
+
+bool isTraceEnabled()
+{
+    return traceEnabled.load(std::memory_order_relaxed);
+}
+
+void setTraceThreadName(const std::string &name)
+{
+    if (!isTraceEnabled())
+    {
+        return;
+    }
+    auto &threadEvents = getThreadEvents();
+    std::lock_guard<std::mutex> lock(threadEvents.mutex);
+    threadEvents.threadName = name;
+}
+
+TraceZone::TraceZone(const char *name)
+    : _name(name)
+    , _active(isTraceEnabled())
+    , _argCount(0)
+{
+    if (_active)
+    {
+        _start = std::chrono::steady_clock::now();
+    }
+}
+
+TraceZone::~TraceZone()
+{
+    end();
+}
+
+void TraceZone::end()
+{
+    if (!_active)
+    {
+        return;
+    }
+    _active = false;
+    auto end = std::chrono::steady_clock::now();
+    TraceEvent event;
+    event.name = _name;
+    event.startNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(_start - traceOrigin).count();
+    event.durationNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(end - _start).count();
+    event.argCount = _argCount;
+    for (uint32_t argIndex = 0; argIndex < _argCount; ++argIndex)
+    {
+        event.argNames[argIndex] = _argNames[argIndex];
+        event.argValues[argIndex] = _argValues[argIndex];
+    }
+    auto &threadEvents = getThreadEvents();
+    std::lock_guard<std::mutex> lock(threadEvents.mutex);
+    threadEvents.events.push_back(event);
+}
+
+bool exportTraceToFile(const std::string &fileName)
+{
+    std::ofstream ofTrace(fileName, std::ios::out | std::ios::trunc);
+    if (!ofTrace.is_open())
+    {
+        return false;
+    }
+    std::vector<std::shared_ptr<ThreadEvents>> threads;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        threads = threadRegistry;
+    }
+    ofTrace << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+    ofTrace << "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"ConvertFBXtoSMSH\"}}";
+    for (const auto &thread : threads)
+    {
+        std::lock_guard<std::mutex> lock(thread->mutex);
+        std::string threadName = thread->threadName.empty() ? "thread " + std::to_string(thread->threadId) : thread->threadName;
+        ofTrace << "," << std::endl << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->threadId
+                << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+        writeJsonString(ofTrace, threadName.c_str());
+        ofTrace << "}}";
+        for (const auto &event : thread->events)
+        {
+            ofTrace << "," << std::endl << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->threadId << ",\"name\":";
+            writeJsonString(ofTrace, event.name);
+            ofTrace << ",\"ts\":";
+            writeMicroseconds(ofTrace, event.startNanoseconds);
+            ofTrace << ",\"dur\":";
+            writeMicroseconds(ofTrace, event.durationNanoseconds);
+            if (event.argCount > 0)
+            {
+                ofTrace << ",\"args\":{";
+                for (uint32_t argIndex = 0; argIndex < event.argCount; ++argIndex)
+                {
+                    ofTrace << (argIndex > 0 ? "," : "");
+                    writeJsonString(ofTrace, event.argNames[argIndex]);
+                    ofTrace << ":" << event.argValues[argIndex];
+                }
+                ofTrace << "}";
+            }
+            ofTrace << "}";
+        }
+    }
+    ofTrace << std::endl << "]}" << std::endl;
+    return ofTrace.good();
+}
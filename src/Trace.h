@@ -0,0 +1,54 @@
+//-----------------------------------------------------------------------------
+// Trace.h
+// Created at 2026.10.17 18:50
+// License: see LICENSE file
+//
+// timeline of conversion as Chrome trace event JSON (chrome://tracing,
+// ui.perfetto.dev): scoped zones with integer arguments for every thread
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+
+#include <chrono>
+
+// tracing is disabled by default, TraceZone only checks a flag then.
+// Enabling sets time origin of the trace
+void enableTrace(bool enabled);
+bool isTraceEnabled();
+// name of the current thread in trace viewer
+void setTraceThreadName(const std::string &name);
+
+const uint32_t MaxTraceZoneArgs = 4;
+
+// complete event ('X') from construction to destruction or end().
+// name and argument names must be string literals (they're stored as pointers)
+class TraceZone
+{
+public:
+    explicit TraceZone(const char *name);
+    ~TraceZone();
+
+    // records the zone now instead of at destruction
+    void end();
+
+    inline void arg(const char *name, int64_t value)
+    {
+        if (_active && _argCount < MaxTraceZoneArgs)
+        {
+            _argNames[_argCount] = name;
+            _argValues[_argCount] = value;
+            ++_argCount;
+        }
+    }
+
+private:
+    const char *_name;
+    bool _active;
+    uint32_t _argCount;
+    std::chrono::steady_clock::time_point _start;
+    const char *_argNames[MaxTraceZoneArgs];
+    int64_t _argValues[MaxTraceZoneArgs];
+};
+
+// writes all events recorded so far, threads which already exited included
+bool exportTraceToFile(const std::string &fileName);
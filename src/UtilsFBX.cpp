@@ -127,34 +127,3 @@ void addTextureProperty(
         }
     }
 }
-
-VectorStream createFloat3Stream(
-    const std::vector<FbxVector4> &srcData,
-    const std::vector<IndexSet> &vertexIndices,
-    uint32_t indexFieldOffset
-)
-{
-    VectorStream meshStream;
-    meshStream.elementType = static_cast<uint32_t>(StreamElementType::Float);
-    meshStream.elementVectorSize = 3;
-    meshStream.elementSize = 4;
-
-    uint32_t dataSize = meshStream.elementSize * meshStream.elementVectorSize * static_cast<uint32_t>(vertexIndices.size());
-    meshStream.streamSize = dataSize + meshStream.headerSize();
-    meshStream.data.resize(dataSize);
-    uint32_t dataOffset = 0;
-    for (int index = 0; index < vertexIndices.size(); ++index)
-    {
-        float floatData[3];
-        const auto &indexSet = vertexIndices[index];
-        uint32_t indexValue = *(uint32_t*)(((const uint8_t*)&indexSet) + indexFieldOffset);
-        const auto floatSrcData = srcData[indexValue].mData;
-        floatData[0] = static_cast<float>(floatSrcData[0]);
-        floatData[1] = static_cast<float>(floatSrcData[1]);
-        floatData[2] = static_cast<float>(floatSrcData[2]);
-        memcpy(meshStream.data.data() + dataOffset, floatData, sizeof(floatData));
-        dataOffset += meshStream.elementSize * meshStream.elementVectorSize;
-    }
-    meshStream.elementCount = static_cast<uint32_t>(vertexIndices.size());
-    return meshStream;
-}
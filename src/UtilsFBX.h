@@ -15,6 +15,19 @@
 #include "Utils.h"
 #include "ObjectNode.h"
 #include "IndexSet.h"
+#include "RawMesh.h"
+
+inline RawVector4 toRawVector(const FbxVector4 &vector)
+{
+    RawVector4 result = { { vector.mData[0], vector.mData[1], vector.mData[2], vector.mData[3] } };
+    return result;
+}
+
+inline RawVector2 toRawVector(const FbxVector2 &vector)
+{
+    RawVector2 result = { { vector.mData[0], vector.mData[1] } };
+    return result;
+}
 
 template <typename ValueType>
 int getDirectIndexByControlPoint(FbxLayerElementTemplate<ValueType>* element, int controlPointIndex)
@@ -128,9 +141,3 @@ void addTextureProperty(
     FbxSurfaceMaterial* material,
     const char* propertyName
 );
-
-VectorStream createFloat3Stream(
-    const std::vector<FbxVector4> &srcData,
-    const std::vector<IndexSet> &vertexIndices,
-    uint32_t indexFieldOffset
-);
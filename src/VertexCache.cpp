@@ -0,0 +1,412 @@
+//-----------------------------------------------------------------------------
+// VertexCache.cpp
+// Created at 2026.10.17 14:20
+// License: see LICENSE file
+//
+// triangle reordering for GPU post-transform vertex cache, vertex reordering
+// for vertex fetch and cache efficiency statistics (ACMR/ATVR, overfetch)
+//-----------------------------------------------------------------------------
+#include "VertexCache.h"
+
+#include <cmath>
+
+namespace
+{
+    // Forsyth algorithm parameters from the original article
+    const uint32_t ForsythCacheSize = 32;
+    const float CacheDecayPower = 1.5f;
+    const float LastTriangleScore = 0.75f;
+    const float ValenceBoostScale = 2.0f;
+    const float ValenceBoostPower = 0.5f;
+    const uint32_t MaxValenceScore = 64; // vertices with more triangles use score of this valence
+
+    // triangles of every vertex: triangles[offsets[v]..offsets[v + 1])
+    struct VertexTriangles
+    {
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> triangles;
+    };
+
+    void buildVertexTriangles(const std::vector<uint32_t> &indices, uint32_t vertexCount, VertexTriangles &adjacency)
+    {
+        adjacency.offsets.assign(vertexCount + 1, 0);
+        for (auto index : indices)
+        {
+            ++adjacency.offsets[index + 1];
+        }
+        for (uint32_t vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex)
+        {
+            adjacency.offsets[vertexIndex + 1] += adjacency.offsets[vertexIndex];
+        }
+        adjacency.triangles.resize(indices.size());
+        std::vector<uint32_t> fillOffsets(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+        for (size_t corner = 0; corner < indices.size(); ++corner)
+        {
+            adjacency.triangles[fillOffsets[indices[corner]]++] = static_cast<uint32_t>(corner / 3);
+        }
+    }
+
+    class ForsythScoreTable
+    {
+    public:
+        ForsythScoreTable()
+        {
+            for (uint32_t cachePosition = 0; cachePosition < ForsythCacheSize; ++cachePosition)
+            {
+                if (cachePosition < 3)
+                {
+                    // vertices of the last triangle get fixed score, so the algorithm
+                    // doesn't prefer triangles sharing an edge with it
+                    _cacheScores[cachePosition] = LastTriangleScore;
+                }
+                else
+                {
+                    float scaler = 1.0f / (ForsythCacheSize - 3);
+                    _cacheScores[cachePosition] = std::pow(1.0f - (cachePosition - 3) * scaler, CacheDecayPower);
+                }
+            }
+            _valenceScores[0] = 0.0f;
+            for (uint32_t valence = 1; valence <= MaxValenceScore; ++valence)
+            {
+                _valenceScores[valence] = ValenceBoostScale * std::pow(float(valence), -ValenceBoostPower);
+            }
+        }
+
+        // vertices without remaining triangles have score -1
+        inline float vertexScore(int32_t cachePosition, uint32_t remainingTriangles) const
+        {
+            if (remainingTriangles == 0)
+            {
+                return -1.0f;
+            }
+            float score = cachePosition >= 0 ? _cacheScores[cachePosition] : 0.0f;
+            return score + _valenceScores[std::min(remainingTriangles, MaxValenceScore)];
+        }
+
+    private:
+        float _cacheScores[ForsythCacheSize];
+        float _valenceScores[MaxValenceScore + 1];
+    };
+}
+
+VertexCacheStats analyzeVertexCache(const std::vector<uint32_t> &indices, uint32_t vertexCount, uint32_t cacheSize)
+{
+    VertexCacheStats stats;
+    stats.triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    // cacheTime 0 - never transformed, time starts after cacheSize so first access is a miss
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    for (auto index : indices)
+    {
+        if (cacheTime[index] == 0)
+        {
+            ++stats.vertexCount;
+        }
+        if (time - cacheTime[index] > cacheSize)
+        {
+            cacheTime[index] = time++;
+            ++stats.transformCount;
+        }
+    }
+    return stats;
+}
+
+VertexFetchStats analyzeVertexFetch(const std::vector<uint32_t> &indices, uint32_t vertexCount, uint32_t vertexSize,
+                                    uint32_t cacheSize)
+{
+    VertexFetchStats stats;
+    stats.vertexBytes = uint64_t(vertexCount) * vertexSize;
+    const uint64_t lineCount = VertexFetchCacheSize / VertexFetchLineSize;
+    // line address + 1 stored for every cache line, 0 - empty line
+    std::vector<uint64_t> cacheLines(lineCount, 0);
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    for (auto index : indices)
+    {
+        if (time - cacheTime[index] <= cacheSize)
+        {
+            continue; // post-transform cache hit, vertex isn't fetched
+        }
+        cacheTime[index] = time++;
+        uint64_t firstLine = uint64_t(index) * vertexSize / VertexFetchLineSize;
+        uint64_t lastLine = (uint64_t(index) * vertexSize + vertexSize - 1) / VertexFetchLineSize;
+        for (uint64_t line = firstLine; line <= lastLine; ++line)
+        {
+            uint64_t &cacheLine = cacheLines[line % lineCount];
+            if (cacheLine != line + 1)
+            {
+                cacheLine = line + 1;
+                stats.bytesFetched += VertexFetchLineSize;
+            }
+        }
+    }
+    return stats;
+}
+
+void buildVertexFetchRemap(std::vector<uint32_t> &indices, uint32_t vertexCount, std::vector<uint32_t> &newToOld)
+{
+    const uint32_t Unused = static_cast<uint32_t>(-1);
+    std::vector<uint32_t> oldToNew(vertexCount, Unused);
+    newToOld.clear();
+    newToOld.reserve(vertexCount);
+    for (auto &index : indices)
+    {
+        uint32_t &newIndex = oldToNew[index];
+        if (newIndex == Unused)
+        {
+            newIndex = static_cast<uint32_t>(newToOld.size());
+            newToOld.push_back(index);
+        }
+        index = newIndex;
+    }
+    for (uint32_t oldIndex = 0; oldIndex < vertexCount; ++oldIndex)
+    {
+        if (oldToNew[oldIndex] == Unused)
+        {
+            newToOld.push_back(oldIndex);
+        }
+    }
+}
+
+void optimizeVertexCacheForsyth(std::vector<uint32_t> &indices, uint32_t vertexCount)
+{
+    static const ForsythScoreTable scoreTable;
+    uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    if (triangleCount == 0)
+    {
+        return;
+    }
+    VertexTriangles adjacency;
+    buildVertexTriangles(indices, vertexCount, adjacency);
+
+    // triangles of vertex v which are not emitted yet are adjacency.triangles[offsets[v]..offsets[v] + remaining[v])
+    std::vector<uint32_t> remaining(vertexCount);
+    std::vector<int32_t> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (uint32_t vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex)
+    {
+        remaining[vertexIndex] = adjacency.offsets[vertexIndex + 1] - adjacency.offsets[vertexIndex];
+        vertexScores[vertexIndex] = scoreTable.vertexScore(-1, remaining[vertexIndex]);
+    }
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    int64_t bestTriangle = 0;
+    for (uint32_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        const uint32_t *corners = &indices[triangle * 3];
+        triangleScores[triangle] = vertexScores[corners[0]] + vertexScores[corners[1]] + vertexScores[corners[2]];
+        if (triangleScores[triangle] > triangleScores[bestTriangle])
+        {
+            bestTriangle = triangle;
+        }
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> newCache;
+    cache.reserve(ForsythCacheSize + 3);
+    newCache.reserve(ForsythCacheSize + 3);
+    uint32_t scanTriangle = 0;
+    for (uint32_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+    {
+        if (bestTriangle < 0)
+        {
+            // no triangles near cached vertices: take next one in original order
+            while (emitted[scanTriangle])
+            {
+                ++scanTriangle;
+            }
+            bestTriangle = scanTriangle;
+        }
+        const uint32_t *corners = &indices[bestTriangle * 3];
+        emitted[bestTriangle] = 1;
+        newCache.clear();
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            uint32_t vertexIndex = corners[corner];
+            result.push_back(vertexIndex);
+            newCache.push_back(vertexIndex);
+            uint32_t *vertexTriangles = &adjacency.triangles[adjacency.offsets[vertexIndex]];
+            uint32_t &remainingCount = remaining[vertexIndex];
+            for (uint32_t position = 0; position < remainingCount; ++position)
+            {
+                if (vertexTriangles[position] == bestTriangle)
+                {
+                    std::swap(vertexTriangles[position], vertexTriangles[remainingCount - 1]);
+                    --remainingCount;
+                    break;
+                }
+            }
+        }
+        for (auto vertexIndex : cache)
+        {
+            if (vertexIndex != corners[0] && vertexIndex != corners[1] && vertexIndex != corners[2])
+            {
+                newCache.push_back(vertexIndex);
+            }
+        }
+        std::swap(cache, newCache);
+        for (size_t position = 0; position < cache.size(); ++position)
+        {
+            uint32_t vertexIndex = cache[position];
+            int32_t cachePosition = position < ForsythCacheSize ? static_cast<int32_t>(position) : -1;
+            cachePositions[vertexIndex] = cachePosition;
+            vertexScores[vertexIndex] = scoreTable.vertexScore(cachePosition, remaining[vertexIndex]);
+        }
+
+        // only triangles of cached and just evicted vertices have changed scores
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+        for (auto vertexIndex : cache)
+        {
+            const uint32_t *vertexTriangles = &adjacency.triangles[adjacency.offsets[vertexIndex]];
+            for (uint32_t position = 0; position < remaining[vertexIndex]; ++position)
+            {
+                uint32_t triangle = vertexTriangles[position];
+                const uint32_t *triangleCorners = &indices[triangle * 3];
+                float score = vertexScores[triangleCorners[0]] + vertexScores[triangleCorners[1]] + vertexScores[triangleCorners[2]];
+                triangleScores[triangle] = score;
+                if (score > bestScore && cachePositions[vertexIndex] >= 0)
+                {
+                    bestScore = score;
+                    bestTriangle = triangle;
+                }
+            }
+        }
+        if (cache.size() > ForsythCacheSize)
+        {
+            cache.resize(ForsythCacheSize);
+        }
+    }
+    indices.swap(result);
+}
+
+void optimizeVertexCacheTipsify(std::vector<uint32_t> &indices, uint32_t vertexCount, uint32_t cacheSize)
+{
+    uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    if (triangleCount == 0)
+    {
+        return;
+    }
+    VertexTriangles adjacency;
+    buildVertexTriangles(indices, vertexCount, adjacency);
+
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for (uint32_t vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex)
+    {
+        liveTriangles[vertexIndex] = adjacency.offsets[vertexIndex + 1] - adjacency.offsets[vertexIndex];
+    }
+    std::vector<uint32_t> cacheTime(vertexCount, 0);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEndStack;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    uint32_t time = cacheSize + 1;
+    uint32_t scanVertex = 0;
+    int64_t fanningVertex = indices[0];
+    while (fanningVertex >= 0)
+    {
+        // emit all remaining triangles around fanning vertex
+        candidates.clear();
+        for (uint32_t position = adjacency.offsets[fanningVertex]; position < adjacency.offsets[fanningVertex + 1]; ++position)
+        {
+            uint32_t triangle = adjacency.triangles[position];
+            if (emitted[triangle])
+            {
+                continue;
+            }
+            emitted[triangle] = 1;
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                uint32_t vertexIndex = indices[triangle * 3 + corner];
+                result.push_back(vertexIndex);
+                deadEndStack.push_back(vertexIndex);
+                candidates.push_back(vertexIndex);
+                --liveTriangles[vertexIndex];
+                if (time - cacheTime[vertexIndex] > cacheSize)
+                {
+                    cacheTime[vertexIndex] = time++;
+                }
+            }
+        }
+
+        // next fanning vertex: candidate which stays in cache while its triangles are emitted,
+        // the oldest of them is preferred
+        fanningVertex = -1;
+        int64_t bestPriority = -1;
+        for (auto vertexIndex : candidates)
+        {
+            if (liveTriangles[vertexIndex] == 0)
+            {
+                continue;
+            }
+            int64_t priority = 0;
+            if (time - cacheTime[vertexIndex] + 2 * liveTriangles[vertexIndex] <= cacheSize)
+            {
+                priority = time - cacheTime[vertexIndex];
+            }
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                fanningVertex = vertexIndex;
+            }
+        }
+        // dead end: recently used vertex with triangles left, otherwise next one in input order
+        while (fanningVertex < 0 && !deadEndStack.empty())
+        {
+            uint32_t vertexIndex = deadEndStack.back();
+            deadEndStack.pop_back();
+            if (liveTriangles[vertexIndex] > 0)
+            {
+                fanningVertex = vertexIndex;
+            }
+        }
+        while (fanningVertex < 0 && scanVertex < vertexCount)
+        {
+            if (liveTriangles[scanVertex] > 0)
+            {
+                fanningVertex = scanVertex;
+            }
+            ++scanVertex;
+        }
+    }
+    indices.swap(result);
+}
+
+void optimizeVertexCache(std::vector<uint32_t> &indices, uint32_t vertexCount, VertexCacheMethod method)
+{
+    switch (method)
+    {
+    case VertexCacheMethod::Forsyth:
+        optimizeVertexCacheForsyth(indices, vertexCount);
+        break;
+    case VertexCacheMethod::Tipsify:
+        optimizeVertexCacheTipsify(indices, vertexCount);
+        break;
+    default:
+        break;
+    }
+}
+
+bool parseVertexCacheMethod(const std::string &name, VertexCacheMethod &method)
+{
+    if (name == "none")
+    {
+        method = VertexCacheMethod::None;
+    }
+    else if (name == "forsyth")
+    {
+        method = VertexCacheMethod::Forsyth;
+    }
+    else if (name == "tipsify")
+    {
+        method = VertexCacheMethod::Tipsify;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
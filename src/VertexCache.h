@@ -0,0 +1,83 @@
+//-----------------------------------------------------------------------------
+// VertexCache.h
+// Created at 2026.10.17 14:20
+// License: see LICENSE file
+//
+// triangle reordering for GPU post-transform vertex cache, vertex reordering
+// for vertex fetch and cache efficiency statistics (ACMR/ATVR, overfetch)
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+
+enum class VertexCacheMethod
+{
+    None,    // keep triangle order of FBX polygons
+    Forsyth, // Tom Forsyth, "Linear-Speed Vertex Cache Optimisation", LRU cache model
+    Tipsify, // Sander, Nehab, Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", FIFO cache model
+};
+
+// FIFO cache size used for statistics and Tipsify
+const uint32_t DefaultVertexCacheSize = 16;
+
+struct VertexCacheStats
+{
+    uint32_t triangleCount = 0;
+    uint32_t vertexCount = 0;    // vertices referenced by indices
+    uint32_t transformCount = 0; // cache misses = vertex shader invocations
+
+    // average cache miss ratio: transformed vertices per triangle, 0.5 is the best possible
+    inline double acmr() const { return triangleCount > 0 ? double(transformCount) / triangleCount : 0.0; }
+    // average transform to vertex ratio: 1.0 is the best possible
+    inline double atvr() const { return vertexCount > 0 ? double(transformCount) / vertexCount : 0.0; }
+};
+
+// vertex fetch model: direct-mapped cache of VertexFetchCacheSize bytes in 64 byte lines
+const uint32_t VertexFetchCacheSize = 16 * 1024;
+const uint32_t VertexFetchLineSize = 64;
+
+struct VertexFetchStats
+{
+    uint64_t bytesFetched = 0; // memory traffic of vertex fetch
+    uint64_t vertexBytes = 0;  // size of vertex buffer
+
+    // fetched bytes per vertex buffer byte: 1.0 is every line fetched once
+    inline double overfetch() const { return vertexBytes > 0 ? double(bytesFetched) / vertexBytes : 0.0; }
+};
+
+// simulates FIFO post-transform cache of cacheSize entries
+VertexCacheStats analyzeVertexCache(const std::vector<uint32_t> &indices, uint32_t vertexCount,
+                                    uint32_t cacheSize = DefaultVertexCacheSize);
+
+// fetch of vertexSize byte vertices for post-transform cache misses
+VertexFetchStats analyzeVertexFetch(const std::vector<uint32_t> &indices, uint32_t vertexCount, uint32_t vertexSize,
+                                    uint32_t cacheSize = DefaultVertexCacheSize);
+
+// reorders triangles in indices (3 per triangle), vertices and winding aren't changed
+void optimizeVertexCacheForsyth(std::vector<uint32_t> &indices, uint32_t vertexCount);
+void optimizeVertexCacheTipsify(std::vector<uint32_t> &indices, uint32_t vertexCount,
+                                uint32_t cacheSize = DefaultVertexCacheSize);
+
+void optimizeVertexCache(std::vector<uint32_t> &indices, uint32_t vertexCount, VertexCacheMethod method);
+
+// renumbers vertices in order of their first use in indices, indices are updated.
+// newToOld[newIndex] = oldIndex, vertices not used by indices are moved to the end
+void buildVertexFetchRemap(std::vector<uint32_t> &indices, uint32_t vertexCount, std::vector<uint32_t> &newToOld);
+
+// vertex fetch optimization: vertices are sorted in order of first use,
+// so GPU reads vertex data almost sequentially
+template <typename VertexType>
+void optimizeVertexFetch(std::vector<uint32_t> &indices, std::vector<VertexType> &vertices)
+{
+    std::vector<uint32_t> newToOld;
+    buildVertexFetchRemap(indices, static_cast<uint32_t>(vertices.size()), newToOld);
+    std::vector<VertexType> sortedVertices;
+    sortedVertices.reserve(vertices.size());
+    for (auto oldIndex : newToOld)
+    {
+        sortedVertices.push_back(vertices[oldIndex]);
+    }
+    vertices.swap(sortedVertices);
+}
+
+// "none", "forsyth", "tipsify", returns false for unknown name
+bool parseVertexCacheMethod(const std::string &name, VertexCacheMethod &method);
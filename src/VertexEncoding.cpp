@@ -0,0 +1,223 @@
+//-----------------------------------------------------------------------------
+// VertexEncoding.cpp
+// Created at 2026.10.17 16:30
+// License: see LICENSE file
+//
+// compact vertex attribute encodings: half floats, octahedral unit vectors,
+// quantized positions, and measurement of their error
+//-----------------------------------------------------------------------------
+#include "VertexEncoding.h"
+
+#include <cstring>
+
+namespace
+{
+    const double FloatEpsilon = 1.0 / (1 << 23);
+
+    inline double signNotZero(double value)
+    {
+        return value >= 0.0 ? 1.0 : -1.0;
+    }
+}
+
+uint16_t floatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t exponent = (bits >> 23) & 0xff;
+    uint32_t mantissa = bits & 0x7fffff;
+    if (exponent == 0xff)
+    {
+        return static_cast<uint16_t>(sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0)); // inf, nan
+    }
+    int32_t halfExponent = int32_t(exponent) - 127 + 15;
+    if (halfExponent >= 31)
+    {
+        return static_cast<uint16_t>(sign | 0x7c00); // too big, inf
+    }
+    if (halfExponent <= 0)
+    {
+        // subnormal half
+        if (halfExponent < -10)
+        {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000;
+        uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1) != 0))
+        {
+            ++half;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+    uint32_t half = (uint32_t(halfExponent) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1fff;
+    // round to nearest even, carry to exponent gives correct result up to inf
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1) != 0))
+    {
+        ++half;
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+
+float halfToFloat(uint16_t value)
+{
+    uint32_t sign = uint32_t(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1f;
+    uint32_t mantissa = value & 0x3ff;
+    if (exponent == 0)
+    {
+        float result = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign != 0 ? -result : result;
+    }
+    uint32_t bits;
+    if (exponent == 31)
+    {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+double getHalfErrorBound(double value)
+{
+    // half has 11 significant bits, subnormal step is 2^-24
+    return std::abs(value) * std::ldexp(1.0, -11) + std::ldexp(1.0, -25);
+}
+
+void encodeOctahedral(const double vector[3], uint32_t bits, int32_t encoded[2])
+{
+    double maxValue = double((1 << (bits - 1)) - 1);
+    double l1Norm = std::abs(vector[0]) + std::abs(vector[1]) + std::abs(vector[2]);
+    if (l1Norm == 0.0)
+    {
+        encoded[0] = 0;
+        encoded[1] = 0;
+        return;
+    }
+    // project to octahedron, lower half is folded over the diagonals
+    double u = vector[0] / l1Norm;
+    double v = vector[1] / l1Norm;
+    if (vector[2] < 0.0)
+    {
+        double foldedU = (1.0 - std::abs(v)) * signNotZero(u);
+        double foldedV = (1.0 - std::abs(u)) * signNotZero(v);
+        u = foldedU;
+        v = foldedV;
+    }
+    encoded[0] = static_cast<int32_t>(std::round(std::max(-1.0, std::min(1.0, u)) * maxValue));
+    encoded[1] = static_cast<int32_t>(std::round(std::max(-1.0, std::min(1.0, v)) * maxValue));
+}
+
+void decodeOctahedral(const int32_t encoded[2], uint32_t bits, double vector[3])
+{
+    double maxValue = double((1 << (bits - 1)) - 1);
+    double u = std::max(-1.0, encoded[0] / maxValue);
+    double v = std::max(-1.0, encoded[1] / maxValue);
+    double z = 1.0 - std::abs(u) - std::abs(v);
+    if (z < 0.0)
+    {
+        double unfoldedU = (1.0 - std::abs(v)) * signNotZero(u);
+        double unfoldedV = (1.0 - std::abs(u)) * signNotZero(v);
+        u = unfoldedU;
+        v = unfoldedV;
+    }
+    double length = std::sqrt(u * u + v * v + z * z);
+    vector[0] = u / length;
+    vector[1] = v / length;
+    vector[2] = z / length;
+}
+
+double getOctahedralErrorBound(uint32_t bits)
+{
+    // rounding moves the point on octahedron by up to step / 2 in u and v and step in z,
+    // octahedron is at least 1 / sqrt(3) from the center
+    double step = 1.0 / double((1 << (bits - 1)) - 1);
+    return std::sqrt(3.0) * std::sqrt(0.25 + 0.25 + 1.0) * step;
+}
+
+uint16_t quantizeUNorm16(double value, float offset, float scale)
+{
+    if (scale <= 0.0f)
+    {
+        return 0;
+    }
+    double normalized = (value - offset) / scale;
+    return static_cast<uint16_t>(std::round(std::max(0.0, std::min(1.0, normalized)) * 65535.0));
+}
+
+float dequantizeUNorm16(uint16_t value, float offset, float scale)
+{
+    return offset + scale * (value / 65535.0f);
+}
+
+double getUNorm16ErrorBound(float offset, float scale)
+{
+    // half of quantization step, float rounding of offset/scale and of dequantization
+    double maxAbs = std::max(std::abs(double(offset)), std::abs(double(offset) + scale));
+    return 0.5 * scale / 65535.0 + 4.0 * FloatEpsilon * maxAbs;
+}
+
+bool parseUVEncoding(const std::string &name, UVEncoding &encoding)
+{
+    if (name == "float32")
+    {
+        encoding = UVEncoding::Float32;
+    }
+    else if (name == "half")
+    {
+        encoding = UVEncoding::Half;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+bool parseDirectionEncoding(const std::string &name, DirectionEncoding &encoding)
+{
+    if (name == "float32")
+    {
+        encoding = DirectionEncoding::Float32;
+    }
+    else if (name == "oct16")
+    {
+        encoding = DirectionEncoding::Octahedral16;
+    }
+    else if (name == "oct8")
+    {
+        encoding = DirectionEncoding::Octahedral8;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+bool parsePositionEncoding(const std::string &name, PositionEncoding &encoding)
+{
+    if (name == "float")
+    {
+        encoding = PositionEncoding::Float;
+    }
+    else if (name == "unorm16")
+    {
+        encoding = PositionEncoding::UNorm16;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,80 @@
+//-----------------------------------------------------------------------------
+// VertexEncoding.h
+// Created at 2026.10.17 16:30
+// License: see LICENSE file
+//
+// compact vertex attribute encodings: half floats, octahedral unit vectors,
+// quantized positions, and measurement of their error
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+#include <cmath>
+
+enum class UVEncoding
+{
+    Float32,
+    Half, // 2 x half float
+};
+
+// normals, tangents and binormals
+enum class DirectionEncoding
+{
+    Float32,
+    Octahedral16, // 2 x snorm16
+    Octahedral8,  // 2 x snorm8
+};
+
+enum class PositionEncoding
+{
+    Float,   // float32 or float64, see ImportSettings::convertPositionsToFloat32
+    UNorm16, // 4 x unorm16 (w is 0) in mesh bounding box, PositionDequantization stream has offset and scale
+};
+
+// max error of encoded values compared to float source.
+// Every value has its own error bound, boundRatio > 1 means a bound is exceeded
+struct EncodingError
+{
+    uint64_t valueCount = 0;
+    double maxError = 0.0;
+    double maxBound = 0.0;
+    double maxBoundRatio = 0.0;
+
+    inline void add(double error, double bound)
+    {
+        ++valueCount;
+        maxError = std::max(maxError, error);
+        maxBound = std::max(maxBound, bound);
+        maxBoundRatio = std::max(maxBoundRatio, bound > 0.0 ? error / bound : (error > 0.0 ? INFINITY : 0.0));
+    }
+    inline void merge(const EncodingError &other)
+    {
+        valueCount += other.valueCount;
+        maxError = std::max(maxError, other.maxError);
+        maxBound = std::max(maxBound, other.maxBound);
+        maxBoundRatio = std::max(maxBoundRatio, other.maxBoundRatio);
+    }
+    inline bool withinBounds() const { return maxBoundRatio <= 1.0; }
+};
+
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
+// largest error of floatToHalf for value with round to nearest (normal and subnormal halfs)
+double getHalfErrorBound(double value);
+
+// unit vector to 2 snorm values with bits per component, vector is normalized first
+void encodeOctahedral(const double vector[3], uint32_t bits, int32_t encoded[2]);
+void decodeOctahedral(const int32_t encoded[2], uint32_t bits, double vector[3]);
+// largest angle in radians between a unit vector and its decoded octahedral encoding
+double getOctahedralErrorBound(uint32_t bits);
+
+// unorm16 position quantization in [offset, offset + scale] range for every axis.
+// Dequantization is done in float like on GPU
+uint16_t quantizeUNorm16(double value, float offset, float scale);
+float dequantizeUNorm16(uint16_t value, float offset, float scale);
+// largest error of quantizeUNorm16/dequantizeUNorm16 for values in the range
+double getUNorm16ErrorBound(float offset, float scale);
+
+// "float32", "half", "oct16", "oct8", "unorm16"; return false for unknown name
+bool parseUVEncoding(const std::string &name, UVEncoding &encoding);
+bool parseDirectionEncoding(const std::string &name, DirectionEncoding &encoding);
+bool parsePositionEncoding(const std::string &name, PositionEncoding &encoding);
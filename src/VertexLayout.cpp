@@ -0,0 +1,146 @@
+//-----------------------------------------------------------------------------
+// VertexLayout.cpp
+// Created at 2026.10.17 17:10
+// License: see LICENSE file
+//
+// interleaving of separate vertex attribute streams (SoA) into one stream
+// of vertex structures (AoS)
+//-----------------------------------------------------------------------------
+#include "VertexLayout.h"
+
+#include <cstring>
+
+namespace
+{
+    inline uint32_t alignUp(uint32_t value, uint32_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    // order of attributes inside interleaved vertex
+    const AttributeType InterleavedAttributeOrder[] = {
+        AttributeType::Position,
+        AttributeType::Normal,
+        AttributeType::UV,
+        AttributeType::Tangent,
+        AttributeType::Binormal,
+    };
+}
+
+void interleaveVertexStreams(StreamMesh &mesh, VertexLayout layout, uint32_t strideAlignment)
+{
+    if (layout == VertexLayout::Separate)
+    {
+        return;
+    }
+    std::vector<size_t> sourceStreams;
+    std::vector<InterleavedAttribute> attributes;
+    uint32_t stride = 0;
+    uint32_t maxElementSize = 1;
+    uint32_t vertexCount = 0;
+    for (auto attributeType : InterleavedAttributeOrder)
+    {
+        if (attributeType == AttributeType::Position && layout == VertexLayout::PositionSplit)
+        {
+            continue;
+        }
+        for (size_t streamIndex = 0; streamIndex < mesh.streams.size(); ++streamIndex)
+        {
+            const auto &stream = mesh.streams[streamIndex];
+            if (stream.attributeType != static_cast<uint32_t>(attributeType) ||
+                (!sourceStreams.empty() && stream.elementCount != vertexCount))
+            {
+                continue;
+            }
+            vertexCount = stream.elementCount;
+            InterleavedAttribute attribute;
+            attribute.attributeType = stream.attributeType;
+            attribute.elementType = stream.elementType;
+            attribute.elementSize = stream.elementSize;
+            attribute.elementVectorSize = stream.elementVectorSize;
+            attribute.offset = alignUp(stride, stream.elementSize);
+            stride = attribute.offset + stream.elementSize * stream.elementVectorSize;
+            maxElementSize = std::max(maxElementSize, stream.elementSize);
+            attributes.push_back(attribute);
+            sourceStreams.push_back(streamIndex);
+            break;
+        }
+    }
+    if (attributes.empty())
+    {
+        return;
+    }
+    stride = alignUp(stride, std::max(strideAlignment, maxElementSize));
+
+    VectorStream vertexStream;
+    vertexStream.attributeType = static_cast<uint32_t>(AttributeType::InterleavedVertex);
+    vertexStream.elementType = static_cast<uint32_t>(StreamElementType::UInt);
+    vertexStream.elementSize = 1;
+    vertexStream.elementVectorSize = stride;
+    vertexStream.elementCount = vertexCount;
+    vertexStream.data.resize(size_t(stride) * vertexCount); // padding is zero-filled
+    for (size_t attributeIndex = 0; attributeIndex < attributes.size(); ++attributeIndex)
+    {
+        const auto &attribute = attributes[attributeIndex];
+        const uint8_t *source = mesh.streams[sourceStreams[attributeIndex]].data.data();
+        uint32_t attributeSize = attribute.elementSize * attribute.elementVectorSize;
+        uint8_t *destination = vertexStream.data.data() + attribute.offset;
+        for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+        {
+            memcpy(destination, source, attributeSize);
+            source += attributeSize;
+            destination += stride;
+        }
+    }
+    vertexStream.streamSize = static_cast<uint32_t>(vertexStream.data.size()) + vertexStream.headerSize();
+
+    VectorStream layoutStream;
+    layoutStream.attributeType = static_cast<uint32_t>(AttributeType::InterleavedLayout);
+    layoutStream.elementType = static_cast<uint32_t>(StreamElementType::UInt);
+    layoutStream.elementSize = 4;
+    layoutStream.elementVectorSize = sizeof(InterleavedAttribute) / 4;
+    layoutStream.elementCount = static_cast<uint32_t>(attributes.size());
+    layoutStream.data.resize(attributes.size() * sizeof(InterleavedAttribute));
+    memcpy(layoutStream.data.data(), attributes.data(), layoutStream.data.size());
+    layoutStream.streamSize = static_cast<uint32_t>(layoutStream.data.size()) + layoutStream.headerSize();
+
+    // interleaved streams take the place of the first replaced stream
+    size_t insertIndex = *std::min_element(sourceStreams.begin(), sourceStreams.end());
+    std::vector<VectorStream> streams;
+    streams.reserve(mesh.streams.size() - sourceStreams.size() + 2);
+    for (size_t streamIndex = 0; streamIndex < mesh.streams.size(); ++streamIndex)
+    {
+        if (streamIndex == insertIndex)
+        {
+            streams.push_back(std::move(vertexStream));
+            streams.push_back(std::move(layoutStream));
+        }
+        if (std::find(sourceStreams.begin(), sourceStreams.end(), streamIndex) == sourceStreams.end())
+        {
+            streams.push_back(std::move(mesh.streams[streamIndex]));
+        }
+    }
+    mesh.streams = std::move(streams);
+    mesh.header.streamCount = static_cast<uint32_t>(mesh.streams.size());
+}
+
+bool parseVertexLayout(const std::string &name, VertexLayout &layout)
+{
+    if (name == "separate")
+    {
+        layout = VertexLayout::Separate;
+    }
+    else if (name == "interleaved")
+    {
+        layout = VertexLayout::Interleaved;
+    }
+    else if (name == "split")
+    {
+        layout = VertexLayout::PositionSplit;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,30 @@
+//-----------------------------------------------------------------------------
+// VertexLayout.h
+// Created at 2026.10.17 17:10
+// License: see LICENSE file
+//
+// interleaving of separate vertex attribute streams (SoA) into one stream
+// of vertex structures (AoS)
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+
+#include "StreamMeshData.h"
+
+enum class VertexLayout
+{
+    Separate,      // stream per attribute
+    Interleaved,   // position, normal, UV, tangent, binormal in one stream
+    PositionSplit, // position stream (depth prepass) + interleaved other attributes
+};
+
+const uint32_t DefaultVertexStrideAlignment = 4;
+
+// replaces per-vertex attribute streams with InterleavedVertex stream and its
+// InterleavedLayout. Every attribute offset is aligned to its element size,
+// vertex stride is aligned to strideAlignment (power of two).
+// Does nothing for VertexLayout::Separate or when there is nothing to interleave
+void interleaveVertexStreams(StreamMesh &mesh, VertexLayout layout, uint32_t strideAlignment);
+
+// "separate", "interleaved", "split"; returns false for unknown name
+bool parseVertexLayout(const std::string &name, VertexLayout &layout);
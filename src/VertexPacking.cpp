@@ -0,0 +1,374 @@
+//-----------------------------------------------------------------------------
+// VertexPacking.cpp
+// Created at 2026.10.17 17:40
+// License: see LICENSE file
+//
+// gather of raw vertex attributes through IndexSet and conversion of double
+// values to stream formats: scalar, SSE2 and AVX2 kernels chosen at runtime
+//-----------------------------------------------------------------------------
+#include "VertexPacking.h"
+
+#include <atomic>
+#include <cstring>
+
+#include "VertexEncoding.h"
+
+// SSE2 is part of x64, so only x64 builds have SIMD kernels
+#if defined(_M_X64) || defined(__x86_64__)
+#define VERTEX_PACKING_X64 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SIMD_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+    inline uint32_t getIndex(const IndexSet &indexSet, uint32_t indexFieldOffset)
+    {
+        uint32_t index;
+        memcpy(&index, reinterpret_cast<const uint8_t*>(&indexSet) + indexFieldOffset, sizeof(index));
+        return index;
+    }
+
+    void packFloat3Scalar(const RawVector4 *srcData, const IndexSet *vertices, size_t count,
+                          uint32_t indexFieldOffset, uint8_t *destination)
+    {
+        for (size_t vertex = 0; vertex < count; ++vertex)
+        {
+            const double *values = srcData[getIndex(vertices[vertex], indexFieldOffset)].mData;
+            float result[3] = { static_cast<float>(values[0]), static_cast<float>(values[1]), static_cast<float>(values[2]) };
+            memcpy(destination + vertex * sizeof(result), result, sizeof(result));
+        }
+    }
+
+    void packFloat2Scalar(const RawVector2 *srcData, const IndexSet *vertices, size_t count,
+                          uint32_t indexFieldOffset, uint8_t *destination)
+    {
+        for (size_t vertex = 0; vertex < count; ++vertex)
+        {
+            const double *values = srcData[getIndex(vertices[vertex], indexFieldOffset)].mData;
+            float result[2] = { static_cast<float>(values[0]), static_cast<float>(values[1]) };
+            memcpy(destination + vertex * sizeof(result), result, sizeof(result));
+        }
+    }
+
+    void packUNorm16x4Scalar(const RawVector4 *srcData, const IndexSet *vertices, size_t count,
+                             uint32_t indexFieldOffset, const float offset[3], const float scale[3], uint8_t *destination)
+    {
+        for (size_t vertex = 0; vertex < count; ++vertex)
+        {
+            const double *values = srcData[getIndex(vertices[vertex], indexFieldOffset)].mData;
+            uint16_t result[4] = {
+                quantizeUNorm16(values[0], offset[0], scale[0]),
+                quantizeUNorm16(values[1], offset[1], scale[1]),
+                quantizeUNorm16(values[2], offset[2], scale[2]),
+                0
+            };
+            memcpy(destination + vertex * sizeof(result), result, sizeof(result));
+        }
+    }
+
+#if VERTEX_PACKING_X64
+    // 4 vertices xyz_ to 12 floats
+    inline void storeFloat3x4(uint8_t *destination, __m128 a, __m128 b, __m128 c, __m128 d)
+    {
+        __m128 a2b0 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 2, 2));
+        __m128 c2d0 = _mm_shuffle_ps(c, d, _MM_SHUFFLE(0, 0, 2, 2));
+        _mm_storeu_ps(reinterpret_cast<float*>(destination), _mm_shuffle_ps(a, a2b0, _MM_SHUFFLE(2, 0, 1, 0)));
+        _mm_storeu_ps(reinterpret_cast<float*>(destination + 16), _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 0, 2, 1)));
+        _mm_storeu_ps(reinterpret_cast<float*>(destination + 32), _mm_shuffle_ps(c2d0, d, _MM_SHUFFLE(2, 1, 2, 0)));
+    }
+
+    inline __m128 loadFloat4SSE2(const double *values)
+    {
+        return _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(values)), _mm_cvtpd_ps(_mm_loadu_pd(values + 2)));
+    }
+
+    void packFloat3SSE2(const RawVector4 *srcData, const IndexSet *vertices, size_t count,
+                        uint32_t indexFieldOffset, uint8_t *destination)
+    {
+        size_t vertex = 0;
+        for (; vertex + 4 <= count; vertex += 4)
+        {
+            __m128 a = loadFloat4SSE2(srcData[getIndex(vertices[vertex], indexFieldOffset)].mData);
+            __m128 b = loadFloat4SSE2(srcData[getIndex(vertices[vertex + 1], indexFieldOffset)].mData);
+            __m128 c = loadFloat4SSE2(srcData[getIndex(vertices[vertex + 2], indexFieldOffset)].mData);
+            __m128 d = loadFloat4SSE2(srcData[getIndex(vertices[vertex + 3], indexFieldOffset)].mData);
+            storeFloat3x4(destination + vertex * 12, a, b, c, d);
+        }
+        packFloat3Scalar(srcData, vertices + vertex, count - vertex, indexFieldOffset, destination + vertex * 12);
+    }
+
+    void packFloat2SSE2(const RawVector2 *srcData, const IndexSet *vertices, size_t count,
+                        uint32_t indexFieldOffset, uint8_t *destination)
+    {
+        size_t vertex = 0;
+        for (; vertex + 2 <= count; vertex += 2)
+        {
+            __m128 a = _mm_cvtpd_ps(_mm_loadu_pd(srcData[getIndex(vertices[vertex], indexFieldOffset)].mData));
+            __m128 b = _mm_cvtpd_ps(_mm_loadu_pd(srcData[getIndex(vertices[vertex + 1], indexFieldOffset)].mData));
+            _mm_storeu_ps(reinterpret_cast<float*>(destination + vertex * 8), _mm_movelh_ps(a, b));
+        }
+        packFloat2Scalar(srcData, vertices + vertex, count - vertex, indexFieldOffset, destination + vertex * 8);
+    }
+
+    // same rounding as quantizeUNorm16: clamp to [0, 1], round half away from zero
+    inline __m128i quantizeUNorm16SSE2(__m128d values, __m128d offset, __m128d scale)
+    {
+        const __m128d zero = _mm_setzero_pd();
+        const __m128d one = _mm_set1_pd(1.0);
+        __m128d normalized = _mm_div_pd(_mm_sub_pd(values, offset), scale);
+        normalized = _mm_max_pd(_mm_min_pd(normalized, one), zero); // NaN gives 1 like std::min(1.0, NaN)
+        __m128d scaled = _mm_mul_pd(normalized, _mm_set1_pd(65535.0));
+        __m128d truncated = _mm_cvtepi32_pd(_mm_cvttpd_epi32(scaled));
+        __m128d roundUp = _mm_and_pd(_mm_cmpge_pd(_mm_sub_pd(scaled, truncated), _mm_set1_pd(0.5)), one);
+        __m128d rounded = _mm_and_pd(_mm_add_pd(truncated, roundUp), _mm_cmpnle_pd(scale, zero));
+        return _mm_cvttpd_epi32(rounded);
+    }
+
+    void packUNorm16x4SSE2(const RawVector4 *srcData, const IndexSet *vertices, size_t count,
+                           uint32_t indexFieldOffset, const float offset[3], const float scale[3], uint8_t *destination)
+    {
+        const __m128d offsetXY = _mm_set_pd(offset[1], offset[0]);
+        const __m128d offsetZW = _mm_set_pd(0.0, offset[2]);
+        const __m128d scaleXY = _mm_set_pd(scale[1], scale[0]);
+        const __m128d scaleZW = _mm_set_pd(0.0, scale[2]); // w is masked to 0
+        const __m128i signBias = _mm_set1_epi32(32768);
+        const __m128i signFlip = _mm_set1_epi16(-32768);
+        for (size_t vertex = 0; vertex < count; ++vertex)
+        {
+            const double *values = srcData[getIndex(vertices[vertex], indexFieldOffset)].mData;
+            __m128i xy = quantizeUNorm16SSE2(_mm_loadu_pd(values), offsetXY, scaleXY);
+            __m128i zw = quantizeUNorm16SSE2(_mm_loadu_pd(values + 2), offsetZW, scaleZW);
+            // SSE2 has only signed saturation pack
+            __m128i xyzw = _mm_sub_epi32(_mm_unpacklo_epi64(xy, zw), signBias);
+            __m128i packed = _mm_xor_si128(_mm_packs_epi32(xyzw, xyzw), signFlip);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(destination + vertex * 8), packed);
+        }
+    }
+
+    SIMD_TARGET_AVX2 void packFloat3AVX2(const RawVector4 *srcData, const IndexSet *vertices, size_t count,
+                                         uint32_t indexFieldOffset, uint8_t *destination)
+    {
+        size_t vertex = 0;
+        for (; vertex + 4 <= count; vertex += 4)
+        {
+            __m128 a = _mm256_cvtpd_ps(_mm256_loadu_pd(srcData[getIndex(vertices[vertex], indexFieldOffset)].mData));
+            __m128 b = _mm256_cvtpd_ps(_mm256_loadu_pd(srcData[getIndex(vertices[vertex + 1], indexFieldOffset)].mData));
+            __m128 c = _mm256_cvtpd_ps(_mm256_loadu_pd(srcData[getIndex(vertices[vertex + 2], indexFieldOffset)].mData));
+            __m128 d = _mm256_cvtpd_ps(_mm256_loadu_pd(srcData[getIndex(vertices[vertex + 3], indexFieldOffset)].mData));
+            storeFloat3x4(destination + vertex * 12, a, b, c, d);
+        }
+        packFloat3Scalar(srcData, vertices + vertex, count - vertex, indexFieldOffset, destination + vertex * 12);
+    }
+
+    SIMD_TARGET_AVX2 void packFloat2AVX2(const RawVector2 *srcData, const IndexSet *vertices, size_t count,
+                                         uint32_t indexFieldOffset, uint8_t *destination)
+    {
+        size_t vertex = 0;
+        for (; vertex + 4 <= count; vertex += 4)
+        {
+            __m256d ab = _mm256_insertf128_pd(_mm256_castpd128_pd256(
+                _mm_loadu_pd(srcData[getIndex(vertices[vertex], indexFieldOffset)].mData)),
+                _mm_loadu_pd(srcData[getIndex(vertices[vertex + 1], indexFieldOffset)].mData), 1);
+            __m256d cd = _mm256_insertf128_pd(_mm256_castpd128_pd256(
+                _mm_loadu_pd(srcData[getIndex(vertices[vertex + 2], indexFieldOffset)].mData)),
+                _mm_loadu_pd(srcData[getIndex(vertices[vertex + 3], indexFieldOffset)].mData), 1);
+            _mm_storeu_ps(reinterpret_cast<float*>(destination + vertex * 8), _mm256_cvtpd_ps(ab));
+            _mm_storeu_ps(reinterpret_cast<float*>(destination + vertex * 8 + 16), _mm256_cvtpd_ps(cd));
+        }
+        packFloat2Scalar(srcData, vertices + vertex, count - vertex, indexFieldOffset, destination + vertex * 8);
+    }
+
+    SIMD_TARGET_AVX2 inline __m128i quantizeUNorm16AVX2(__m256d values, __m256d offset, __m256d scale)
+    {
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d one = _mm256_set1_pd(1.0);
+        __m256d normalized = _mm256_div_pd(_mm256_sub_pd(values, offset), scale);
+        normalized = _mm256_max_pd(_mm256_min_pd(normalized, one), zero);
+        __m256d scaled = _mm256_mul_pd(normalized, _mm256_set1_pd(65535.0));
+        __m256d truncated = _mm256_round_pd(scaled, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        __m256d roundUp = _mm256_and_pd(_mm256_cmp_pd(_mm256_sub_pd(scaled, truncated), _mm256_set1_pd(0.5), _CMP_GE_OQ), one);
+        __m256d rounded = _mm256_and_pd(_mm256_add_pd(truncated, roundUp), _mm256_cmp_pd(scale, zero, _CMP_NLE_UQ));
+        return _mm256_cvttpd_epi32(rounded);
+    }
+
+    SIMD_TARGET_AVX2 void packUNorm16x4AVX2(const RawVector4 *srcData, const IndexSet *vertices, size_t count,
+                                            uint32_t indexFieldOffset, const float offset[3], const float scale[3],
+                                            uint8_t *destination)
+    {
+        const __m256d offsetXYZW = _mm256_set_pd(0.0, offset[2], offset[1], offset[0]);
+        const __m256d scaleXYZW = _mm256_set_pd(0.0, scale[2], scale[1], scale[0]); // w is masked to 0
+        size_t vertex = 0;
+        for (; vertex + 2 <= count; vertex += 2)
+        {
+            __m128i a = quantizeUNorm16AVX2(_mm256_loadu_pd(srcData[getIndex(vertices[vertex], indexFieldOffset)].mData),
+                                            offsetXYZW, scaleXYZW);
+            __m128i b = quantizeUNorm16AVX2(_mm256_loadu_pd(srcData[getIndex(vertices[vertex + 1], indexFieldOffset)].mData),
+                                            offsetXYZW, scaleXYZW);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + vertex * 8), _mm_packus_epi32(a, b));
+        }
+        packUNorm16x4Scalar(srcData, vertices + vertex, count - vertex, indexFieldOffset, offset, scale, destination + vertex * 8);
+    }
+
+    SimdLevel detectSimdLevel()
+    {
+        uint32_t registers[4] = {}; // eax, ebx, ecx, edx
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuidex(info, 7, 0);
+        memcpy(registers, info, sizeof(registers));
+        uint32_t leaf7Ebx = registers[1];
+        __cpuid(info, 1);
+        memcpy(registers, info, sizeof(registers));
+#else
+        __cpuid_count(7, 0, registers[0], registers[1], registers[2], registers[3]);
+        uint32_t leaf7Ebx = registers[1];
+        __cpuid(1, registers[0], registers[1], registers[2], registers[3]);
+#endif
+        bool hasSSE41 = (registers[2] & (1u << 19)) != 0;
+        bool hasOSXSAVE = (registers[2] & (1u << 27)) != 0;
+        bool hasAVX = (registers[2] & (1u << 28)) != 0;
+        bool hasAVX2 = (leaf7Ebx & (1u << 5)) != 0;
+        if (hasSSE41 && hasOSXSAVE && hasAVX && hasAVX2)
+        {
+            // OS must save XMM and YMM registers
+#if defined(_MSC_VER)
+            uint64_t xcr0 = _xgetbv(0);
+#else
+            uint32_t xcr0Low;
+            uint32_t xcr0High;
+            __asm__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+            uint64_t xcr0 = (uint64_t(xcr0High) << 32) | xcr0Low;
+#endif
+            if ((xcr0 & 6) == 6)
+            {
+                return SimdLevel::AVX2;
+            }
+        }
+        return SimdLevel::SSE2;
+    }
+#else
+    SimdLevel detectSimdLevel()
+    {
+        return SimdLevel::Scalar;
+    }
+#endif
+
+    std::atomic<int> activeSimdLevel(-1); // -1 - not detected yet
+}
+
+SimdLevel getSupportedSimdLevel()
+{
+    static const SimdLevel supportedLevel = detectSimdLevel();
+    return supportedLevel;
+}
+
+SimdLevel getSimdLevel()
+{
+    int level = activeSimdLevel.load(std::memory_order_relaxed);
+    if (level < 0)
+    {
+        level = static_cast<int>(getSupportedSimdLevel());
+        activeSimdLevel.store(level, std::memory_order_relaxed);
+    }
+    return static_cast<SimdLevel>(level);
+}
+
+SimdLevel setSimdLevel(SimdLevel level)
+{
+    level = std::min(level, getSupportedSimdLevel());
+    activeSimdLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+    return level;
+}
+
+const char* getSimdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::SSE2:
+        return "sse2";
+    case SimdLevel::AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+bool parseSimdLevel(const std::string &name, SimdLevel &level)
+{
+    for (auto candidate : { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 })
+    {
+        if (name == getSimdLevelName(candidate))
+        {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void packFloat3(const std::vector<RawVector4> &srcData, const std::vector<IndexSet> &vertices,
+                uint32_t indexFieldOffset, void *destination)
+{
+    uint8_t *output = static_cast<uint8_t*>(destination);
+    switch (getSimdLevel())
+    {
+#if VERTEX_PACKING_X64
+    case SimdLevel::AVX2:
+        packFloat3AVX2(srcData.data(), vertices.data(), vertices.size(), indexFieldOffset, output);
+        break;
+    case SimdLevel::SSE2:
+        packFloat3SSE2(srcData.data(), vertices.data(), vertices.size(), indexFieldOffset, output);
+        break;
+#endif
+    default:
+        packFloat3Scalar(srcData.data(), vertices.data(), vertices.size(), indexFieldOffset, output);
+        break;
+    }
+}
+
+void packFloat2(const std::vector<RawVector2> &srcData, const std::vector<IndexSet> &vertices,
+                uint32_t indexFieldOffset, void *destination)
+{
+    uint8_t *output = static_cast<uint8_t*>(destination);
+    switch (getSimdLevel())
+    {
+#if VERTEX_PACKING_X64
+    case SimdLevel::AVX2:
+        packFloat2AVX2(srcData.data(), vertices.data(), vertices.size(), indexFieldOffset, output);
+        break;
+    case SimdLevel::SSE2:
+        packFloat2SSE2(srcData.data(), vertices.data(), vertices.size(), indexFieldOffset, output);
+        break;
+#endif
+    default:
+        packFloat2Scalar(srcData.data(), vertices.data(), vertices.size(), indexFieldOffset, output);
+        break;
+    }
+}
+
+void packUNorm16x4(const std::vector<RawVector4> &srcData, const std::vector<IndexSet> &vertices,
+                   uint32_t indexFieldOffset, const float offset[3], const float scale[3], void *destination)
+{
+    uint8_t *output = static_cast<uint8_t*>(destination);
+    switch (getSimdLevel())
+    {
+#if VERTEX_PACKING_X64
+    case SimdLevel::AVX2:
+        packUNorm16x4AVX2(srcData.data(), vertices.data(), vertices.size(), indexFieldOffset, offset, scale, output);
+        break;
+    case SimdLevel::SSE2:
+        packUNorm16x4SSE2(srcData.data(), vertices.data(), vertices.size(), indexFieldOffset, offset, scale, output);
+        break;
+#endif
+    default:
+        packUNorm16x4Scalar(srcData.data(), vertices.data(), vertices.size(), indexFieldOffset, offset, scale, output);
+        break;
+    }
+}
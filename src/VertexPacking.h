@@ -0,0 +1,41 @@
+//-----------------------------------------------------------------------------
+// VertexPacking.h
+// Created at 2026.10.17 17:40
+// License: see LICENSE file
+//
+// gather of raw vertex attributes through IndexSet and conversion of double
+// values to stream formats: scalar, SSE2 and AVX2 kernels chosen at runtime
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+
+#include "IndexSet.h"
+#include "RawMesh.h"
+
+enum class SimdLevel
+{
+    Scalar,
+    SSE2,
+    AVX2, // AVX2 and SSE4.1 instructions with OS support of AVX state
+};
+
+// best level supported by CPU and OS, detected once
+SimdLevel getSupportedSimdLevel();
+// level used by packing functions, supported level by default
+SimdLevel getSimdLevel();
+// level is clamped to supported level, returns level which is used now
+SimdLevel setSimdLevel(SimdLevel level);
+const char* getSimdLevelName(SimdLevel level);
+// "scalar", "sse2", "avx2"; returns false for unknown name
+bool parseSimdLevel(const std::string &name, SimdLevel &level);
+
+// destination[vertex] = float3(srcData[vertices[vertex].<field at indexFieldOffset>]),
+// 12 bytes per vertex
+void packFloat3(const std::vector<RawVector4> &srcData, const std::vector<IndexSet> &vertices,
+                uint32_t indexFieldOffset, void *destination);
+// float2, 8 bytes per vertex
+void packFloat2(const std::vector<RawVector2> &srcData, const std::vector<IndexSet> &vertices,
+                uint32_t indexFieldOffset, void *destination);
+// 4 x unorm16 per vertex (w is 0), xyz are quantizeUNorm16(value, offset[axis], scale[axis])
+void packUNorm16x4(const std::vector<RawVector4> &srcData, const std::vector<IndexSet> &vertices,
+                   uint32_t indexFieldOffset, const float offset[3], const float scale[3], void *destination);
@@ -0,0 +1,182 @@
+//-----------------------------------------------------------------------------
+// VertexWeld.cpp
+// Created at 2026.10.17 10:12
+// License: see LICENSE file
+//
+// vertex deduplication: combine triangle corners with equal IndexSet,
+// merge vertices with similar normals
+//-----------------------------------------------------------------------------
+#include "VertexWeld.h"
+
+const uint32_t IndexSetHashMap::EmptyValue;
+
+void IndexSetHashMap::reserve(size_t expectedCount)
+{
+    size_t capacity = 16;
+    uint32_t shift = 60;
+    while (capacity * 3 < expectedCount * 4)
+    {
+        capacity *= 2;
+        --shift;
+    }
+    if (capacity <= _values.size())
+    {
+        return;
+    }
+    std::vector<IndexSet> oldKeys;
+    std::vector<uint32_t> oldValues;
+    oldKeys.swap(_keys);
+    oldValues.swap(_values);
+    _keys.resize(capacity);
+    _values.assign(capacity, EmptyValue);
+    _shift = shift;
+    _size = 0;
+    for (size_t slot = 0; slot < oldValues.size(); ++slot)
+    {
+        if (oldValues[slot] != EmptyValue)
+        {
+            insert(oldKeys[slot], oldValues[slot]);
+        }
+    }
+}
+
+static void weldVerticesOrderedMap(const std::vector<IndexSet> &indexSets,
+                                   std::vector<uint32_t> &indexVector,
+                                   std::vector<IndexSet> &uniqueVertices)
+{
+    std::map<IndexSet, uint32_t> orderedVertices; // vertex stream index set -> index
+    uint32_t currentIndex = 0;
+    for (const auto &indexSet : indexSets)
+    {
+        auto orderedIt = orderedVertices.find(indexSet);
+        if (orderedIt == orderedVertices.end())
+        {
+            orderedVertices.insert(std::make_pair(indexSet, currentIndex));
+            uniqueVertices.push_back(indexSet);
+            indexVector.push_back(currentIndex);
+            currentIndex++;
+        }
+        else
+        {
+            indexVector.push_back(orderedIt->second);
+        }
+    }
+}
+
+static void weldVerticesHashTable(const std::vector<IndexSet> &indexSets,
+                                  std::vector<uint32_t> &indexVector,
+                                  std::vector<IndexSet> &uniqueVertices)
+{
+    // smooth meshes have ~6 corners per vertex, hard edge meshes ~1.5.
+    // start in between, the table grows if that's not enough
+    IndexSetHashMap vertexMap(indexSets.size() / 2 + 16);
+    uniqueVertices.reserve(indexSets.size() / 2 + 16);
+    for (const auto &indexSet : indexSets)
+    {
+        uint32_t newIndex = static_cast<uint32_t>(uniqueVertices.size());
+        auto insertResult = vertexMap.insert(indexSet, newIndex);
+        if (insertResult.second)
+        {
+            uniqueVertices.push_back(indexSet);
+        }
+        indexVector.push_back(insertResult.first);
+    }
+}
+
+void weldVertices(const std::vector<IndexSet> &indexSets,
+                  VertexWeldMethod method,
+                  std::vector<uint32_t> &indexVector,
+                  std::vector<IndexSet> &uniqueVertices)
+{
+    indexVector.clear();
+    uniqueVertices.clear();
+    indexVector.reserve(indexSets.size());
+    switch (method)
+    {
+    case VertexWeldMethod::OrderedMap:
+        weldVerticesOrderedMap(indexSets, indexVector, uniqueVertices);
+        break;
+    case VertexWeldMethod::HashTable:
+    default:
+        weldVerticesHashTable(indexSets, indexVector, uniqueVertices);
+        break;
+    }
+}
+
+void groupVerticesForNormalMerge(const std::vector<IndexSet> &uniqueVertices,
+                                 std::vector<uint32_t> &groupOffsets,
+                                 std::vector<uint32_t> &groupVertices)
+{
+    // group id for each vertex: hash of IndexSet with normal index cleared
+    IndexSetHashMap groupMap(uniqueVertices.size());
+    std::vector<uint32_t> vertexGroups(uniqueVertices.size());
+    uint32_t groupCount = 0;
+    for (size_t vertexIndex = 0; vertexIndex < uniqueVertices.size(); ++vertexIndex)
+    {
+        IndexSet groupKey = uniqueVertices[vertexIndex];
+        groupKey.normal = -1;
+        auto insertResult = groupMap.insert(groupKey, groupCount);
+        if (insertResult.second)
+        {
+            ++groupCount;
+        }
+        vertexGroups[vertexIndex] = insertResult.first;
+    }
+
+    // counting sort by group
+    groupOffsets.assign(groupCount + 1, 0);
+    for (auto group : vertexGroups)
+    {
+        ++groupOffsets[group + 1];
+    }
+    for (uint32_t group = 0; group < groupCount; ++group)
+    {
+        groupOffsets[group + 1] += groupOffsets[group];
+    }
+    groupVertices.resize(uniqueVertices.size());
+    std::vector<uint32_t> groupFill(groupOffsets.begin(), groupOffsets.end() - 1);
+    for (uint32_t vertexIndex = 0; vertexIndex < vertexGroups.size(); ++vertexIndex)
+    {
+        groupVertices[groupFill[vertexGroups[vertexIndex]]++] = vertexIndex;
+    }
+
+    // groups are small, order members by normal index like std::map<IndexSet> does
+    for (uint32_t group = 0; group < groupCount; ++group)
+    {
+        if (groupOffsets[group + 1] - groupOffsets[group] > 1)
+        {
+            std::sort(groupVertices.begin() + groupOffsets[group], groupVertices.begin() + groupOffsets[group + 1],
+                [&uniqueVertices](uint32_t left, uint32_t right)
+            {
+                return uniqueVertices[left].normal < uniqueVertices[right].normal;
+            });
+        }
+    }
+}
+
+void applyVertexMerge(const std::vector<uint32_t> &survivors,
+                      std::vector<IndexSet> &uniqueVertices,
+                      std::vector<uint32_t> &indexVector)
+{
+    // survivors keep their relative order
+    std::vector<uint32_t> remap(uniqueVertices.size(), 0);
+    uint32_t newVertexCount = 0;
+    for (uint32_t vertexIndex = 0; vertexIndex < uniqueVertices.size(); ++vertexIndex)
+    {
+        if (survivors[vertexIndex] == vertexIndex)
+        {
+            remap[vertexIndex] = newVertexCount;
+            uniqueVertices[newVertexCount] = uniqueVertices[vertexIndex];
+            ++newVertexCount;
+        }
+    }
+    for (uint32_t vertexIndex = 0; vertexIndex < remap.size(); ++vertexIndex)
+    {
+        remap[vertexIndex] = remap[survivors[vertexIndex]];
+    }
+    uniqueVertices.resize(newVertexCount);
+    for (auto &index : indexVector)
+    {
+        index = remap[index];
+    }
+}
@@ -0,0 +1,199 @@
+//-----------------------------------------------------------------------------
+// VertexWeld.h
+// Created at 2026.10.17 10:12
+// License: see LICENSE file
+//
+// vertex deduplication: combine triangle corners with equal IndexSet,
+// merge vertices with similar normals
+//-----------------------------------------------------------------------------
+#pragma once
+#include "stdafx.h"
+#include <cmath>
+
+#include "IndexSet.h"
+
+enum class VertexWeldMethod
+{
+    OrderedMap, // std::map<IndexSet, uint32_t>, O(n log n)
+    HashTable,  // open addressing IndexSetHashMap, O(n)
+};
+
+// open addressing (linear probing) hash table IndexSet -> uint32_t
+// keys and values are kept in flat arrays, no per-vertex allocations
+class IndexSetHashMap
+{
+public:
+    IndexSetHashMap() : _size(0), _shift(64) {}
+    explicit IndexSetHashMap(size_t expectedCount) : IndexSetHashMap() { reserve(expectedCount); }
+
+    // makes room for expectedCount keys without rehashing
+    void reserve(size_t expectedCount);
+
+    // returns value stored for the key and true if the key was inserted
+    inline std::pair<uint32_t, bool> insert(const IndexSet &key, uint32_t value)
+    {
+        if ((_size + 1) * 4 > _values.size() * 3) // keep load factor below 0.75
+        {
+            reserve(std::max<size_t>(_size * 2, 16));
+        }
+        size_t mask = _values.size() - 1;
+        size_t slot = static_cast<size_t>(hashIndexSet(key) >> _shift);
+        while (_values[slot] != EmptyValue)
+        {
+            if (_keys[slot] == key)
+            {
+                return std::make_pair(_values[slot], false);
+            }
+            slot = (slot + 1) & mask;
+        }
+        _keys[slot] = key;
+        _values[slot] = value;
+        ++_size;
+        return std::make_pair(value, true);
+    }
+
+    // returns pointer to the value or nullptr if the key wasn't found
+    inline const uint32_t* find(const IndexSet &key) const
+    {
+        if (_values.empty())
+        {
+            return nullptr;
+        }
+        size_t mask = _values.size() - 1;
+        size_t slot = static_cast<size_t>(hashIndexSet(key) >> _shift);
+        while (_values[slot] != EmptyValue)
+        {
+            if (_keys[slot] == key)
+            {
+                return &_values[slot];
+            }
+            slot = (slot + 1) & mask;
+        }
+        return nullptr;
+    }
+
+    inline void clear()
+    {
+        std::fill(_values.begin(), _values.end(), EmptyValue);
+        _size = 0;
+    }
+
+    inline size_t size() const { return _size; }
+    inline size_t capacity() const { return _values.size(); }
+
+private:
+    static const uint32_t EmptyValue = (uint32_t)-1; // values are vertex indices, -1 is never stored
+
+    std::vector<IndexSet> _keys;
+    std::vector<uint32_t> _values;
+    size_t _size;
+    uint32_t _shift; // 64 - log2(capacity), slot is taken from the high bits of the hash
+};
+
+// combines equal triangle corners.
+// indexVector receives one vertex index per corner, uniqueVertices receives
+// vertices in order of first appearance. Both methods give identical results
+void weldVertices(const std::vector<IndexSet> &indexSets,
+                  VertexWeldMethod method,
+                  std::vector<uint32_t> &indexVector,
+                  std::vector<IndexSet> &uniqueVertices);
+
+// sorts vertices into merge candidate groups: vertices of a group have the
+// same IndexSet except normal, inside group vertices are ordered by normal index.
+// vertices of group N are groupVertices[groupOffsets[N]..groupOffsets[N + 1])
+void groupVerticesForNormalMerge(const std::vector<IndexSet> &uniqueVertices,
+                                 std::vector<uint32_t> &groupOffsets,
+                                 std::vector<uint32_t> &groupVertices);
+
+// replaces every vertex with survivors[vertex] in one pass over indexVector,
+// removes merged vertices and renumbers the rest keeping their order
+void applyVertexMerge(const std::vector<uint32_t> &survivors,
+                      std::vector<IndexSet> &uniqueVertices,
+                      std::vector<uint32_t> &indexVector);
+
+// merges vertices which differ only by normal if angle between normals is
+// below threshold. Merged vertex gets normalized average normal, it's written
+// to normals[] at the normal index of the first vertex (lowest normal index).
+// Inside each group the first unmerged vertex is the seed, vertices close
+// enough to the seed normal are merged with it, the rest form next clusters.
+// VectorType is FbxVector4-like type with double mData[4].
+// Returns number of removed vertices
+template <typename VectorType>
+uint32_t mergeVertexNormals(std::vector<IndexSet> &uniqueVertices,
+                            std::vector<uint32_t> &indexVector,
+                            std::vector<VectorType> &normals,
+                            double cosThreshold)
+{
+    std::vector<uint32_t> groupOffsets;
+    std::vector<uint32_t> groupVertices;
+    groupVerticesForNormalMerge(uniqueVertices, groupOffsets, groupVertices);
+
+    std::vector<uint32_t> survivors(uniqueVertices.size());
+    for (uint32_t vertexIndex = 0; vertexIndex < survivors.size(); ++vertexIndex)
+    {
+        survivors[vertexIndex] = vertexIndex;
+    }
+    uint32_t removedCount = 0;
+    std::vector<uint32_t> cluster;
+    for (size_t groupIndex = 0; groupIndex + 1 < groupOffsets.size(); ++groupIndex)
+    {
+        uint32_t groupStart = groupOffsets[groupIndex];
+        uint32_t groupEnd = groupOffsets[groupIndex + 1];
+        if (groupEnd - groupStart < 2)
+        {
+            continue;
+        }
+        for (uint32_t seedPosition = groupStart; seedPosition < groupEnd; ++seedPosition)
+        {
+            uint32_t seed = groupVertices[seedPosition];
+            if (survivors[seed] != seed)
+            {
+                continue; // already merged into previous cluster
+            }
+            const auto &seedNormal = normals[uniqueVertices[seed].normal].mData;
+            cluster.clear();
+            cluster.push_back(seed);
+            for (uint32_t position = seedPosition + 1; position < groupEnd; ++position)
+            {
+                uint32_t vertex = groupVertices[position];
+                if (survivors[vertex] != vertex)
+                {
+                    continue;
+                }
+                const auto &normal = normals[uniqueVertices[vertex].normal].mData;
+                double cosAngle = seedNormal[0] * normal[0] + seedNormal[1] * normal[1] + seedNormal[2] * normal[2];
+                if (cosAngle > cosThreshold)
+                {
+                    cluster.push_back(vertex);
+                }
+            }
+            if (cluster.size() < 2)
+            {
+                continue;
+            }
+            double normalSum[4] = { 0.0, 0.0, 0.0, 0.0 };
+            for (auto vertex : cluster)
+            {
+                const auto &normal = normals[uniqueVertices[vertex].normal].mData;
+                for (int component = 0; component < 4; ++component)
+                {
+                    normalSum[component] += normal[component];
+                }
+                survivors[vertex] = seed;
+            }
+            double length = std::sqrt(normalSum[0] * normalSum[0] + normalSum[1] * normalSum[1] + normalSum[2] * normalSum[2]);
+            auto &mergedNormal = normals[uniqueVertices[seed].normal].mData;
+            for (int component = 0; component < 3; ++component)
+            {
+                mergedNormal[component] = length > 0.0 ? normalSum[component] / length : normalSum[component];
+            }
+            mergedNormal[3] = normalSum[3] / cluster.size();
+            removedCount += static_cast<uint32_t>(cluster.size() - 1);
+        }
+    }
+    if (removedCount > 0)
+    {
+        applyVertexMerge(survivors, uniqueVertices, indexVector);
+    }
+    return removedCount;
+}
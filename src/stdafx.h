@@ -10,10 +10,14 @@
 //-----------------------------------------------------------------------------
 #pragma once
 
+#ifdef _WIN32
 #include "targetver.h"
+#endif
 
 #include <stdio.h>
+#ifdef _WIN32
 #include <tchar.h>
+#endif
 // STL
 #include <cassert>
 #include <string>